@@ -767,7 +767,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  Edges edges(highI + 1);
+  Edges edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
@@ -959,6 +959,14 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
 void ClipperBase::Clear()
 {
   m_MinimaList.clear();
+  if (m_edges_keep_max > 0) {
+    size_t kept = KeptEdgeBuffers();
+    for (Edges &edges : m_edges)
+      if (kept + edges.capacity() <= m_edges_keep_max) {
+        kept += edges.capacity();
+        m_edges_free.emplace_back(std::move(edges));
+      }
+  }
   m_edges.clear();
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
@@ -967,6 +975,51 @@ void ClipperBase::Clear()
 }
 //------------------------------------------------------------------------------
 
+void ClipperBase::KeepEdgeBuffers(size_t max_edges)
+{
+  m_edges_keep_max = max_edges;
+  m_edges_free.clear();
+}
+//------------------------------------------------------------------------------
+
+size_t ClipperBase::KeptEdgeBuffers() const
+{
+  size_t cnt = 0;
+  for (const Edges &edges : m_edges_free)
+    cnt += edges.capacity();
+  return cnt;
+}
+//------------------------------------------------------------------------------
+
+size_t ClipperBase::NumEdges() const
+{
+  size_t cnt = 0;
+  for (const Edges &edges : m_edges)
+    cnt += edges.size();
+  return cnt;
+}
+//------------------------------------------------------------------------------
+
+ClipperBase::Edges ClipperBase::AllocateEdges(size_t num_edges)
+{
+  if (m_edges_free.empty())
+    return Edges(num_edges);
+  // Take the smallest kept array large enough, or the largest one to be grown.
+  auto it_best = m_edges_free.begin();
+  for (auto it = std::next(it_best); it != m_edges_free.end(); ++ it) {
+    bool best_fits = it_best->capacity() >= num_edges;
+    if (it->capacity() >= num_edges ? ! best_fits || it->capacity() < it_best->capacity() : ! best_fits && it->capacity() > it_best->capacity())
+      it_best = it;
+  }
+  std::swap(*it_best, m_edges_free.back());
+  Edges edges = std::move(m_edges_free.back());
+  m_edges_free.pop_back();
+  edges.clear();
+  edges.resize(num_edges);
+  return edges;
+}
+//------------------------------------------------------------------------------
+
 // Initialize the Local Minima List:
 // Sort the LML entries, initialize the left / right bound edges of each Local Minima.
 void ClipperBase::Reset()
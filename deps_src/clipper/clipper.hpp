@@ -58,6 +58,7 @@
 #include <stdexcept>
 #include <cstring>
 #include <cstdlib>
+#include <cassert>
 #include <ostream>
 #include <functional>
 #include <queue>
@@ -189,6 +190,17 @@ public:
     void Clear() {  AllNodes.clear(); Childs.clear(); }
     int Total() const;
     void RemoveOutermostPolygon();
+    // Build the tree from the output of another polygon clipper.
+    // ReserveNodes() has to be called with the total number of nodes first, AddNode() keeps pointers into AllNodes.
+    void ReserveNodes(size_t n) { AllNodes.reserve(n); }
+    PolyNode* AddNode(PolyNode &parent, Path &&contour) {
+        assert(AllNodes.size() < AllNodes.capacity());
+        AllNodes.emplace_back();
+        PolyNode &node = AllNodes.back();
+        node.Contour = std::move(contour);
+        parent.AddChild(node);
+        return &node;
+    }
 private:
     PolyTree(const PolyTree &src) = delete;
     PolyTree& operator=(const PolyTree &src) = delete;
@@ -358,7 +370,7 @@ public:
       return false;
 
     // Allocate a new edge array.
-    std::vector<TEdge, Allocator<TEdge>> edges(num_edges_total);
+    Edges edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -381,6 +393,13 @@ public:
 
   void Clear();
   IntRect GetBounds();
+  // Keep the edge arrays released by Clear() for the following AddPath() / AddPaths() calls, up to max_edges edges in total.
+  // An engine reused for many operations then does not allocate its edges again. Disabled by default.
+  void KeepEdgeBuffers(size_t max_edges);
+  // Number of edges the kept edge arrays have room for.
+  size_t KeptEdgeBuffers() const;
+  // Number of edges of the paths added since the last Clear().
+  size_t NumEdges() const;
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
   // When enabled the PreserveCollinear property prevents this default behavior to allow these inner vertices to appear in the solution.
   bool PreserveCollinear() const {return m_PreserveCollinear;};
@@ -388,6 +407,8 @@ public:
 protected:
   bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
+  // Value initialized edge array, taken from the kept edge arrays if possible.
+  std::vector<TEdge, Allocator<TEdge>> AllocateEdges(size_t num_edges);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
   TEdge* DescendToMin(TEdge *&E);
@@ -407,6 +428,9 @@ protected:
   // A vector of edges per each input path.
   using Edges = std::vector<TEdge, Allocator<TEdge>>;
   std::vector<Edges, Allocator<Edges>> m_edges;
+  // Edge arrays released by Clear(), see KeepEdgeBuffers().
+  std::vector<Edges, Allocator<Edges>> m_edges_free;
+  size_t           m_edges_keep_max { 0 };
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -66,6 +66,8 @@ using namespace nlohmann;
 #include "libslic3r/Format/SL1.hpp"
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/Time.hpp"
+#include "libslic3r/Trace.hpp"
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Thread.hpp"
 #include "libslic3r/BlacklistedLibraryCheck.hpp"
 #include "libslic3r/FlushVolCalc.hpp"
@@ -1442,6 +1444,26 @@ int CLI::run(int argc, char **argv)
         set_logging_file(opt_logfile->value);
     }
 
+    // Per step / per layer timing, written out on any return path.
+    const std::string trace_file    = m_config.opt_string("trace_file", true);
+    const bool        trace_summary = m_config.opt<ConfigOptionBool>("trace_summary") && m_config.opt_bool("trace_summary");
+    ScopeGuard        trace_guard;
+    if (!trace_file.empty() || trace_summary) {
+        Slic3r::Trace::enable(true);
+        trace_guard = ScopeGuard([trace_file, trace_summary]() {
+            Slic3r::Trace::enable(false);
+            if (!trace_file.empty() && Slic3r::Trace::export_chrome_trace(trace_file))
+                BOOST_LOG_TRIVIAL(info) << "Trace written to " << trace_file;
+            if (trace_summary)
+                boost::nowide::cout << Slic3r::Trace::summary_table();
+        });
+    }
+
+    if (m_config.opt<ConfigOptionBool>("clipper2") && m_config.opt_bool("clipper2")) {
+        Slic3r::ClipperUtils::set_backend(Slic3r::ClipperUtils::Backend::Clipper2);
+        BOOST_LOG_TRIVIAL(info) << "Using the Clipper2 backend for polygon operations";
+    }
+
     global_begin_time = (long long)Slic3r::Utils::get_current_time_utc();
     BOOST_LOG_TRIVIAL(warning) << boost::format("cli mode, Current OrcaSlicer Version %1%")%SoftFever_VERSION;
 
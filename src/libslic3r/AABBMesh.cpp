@@ -1,7 +1,7 @@
 #include "AABBMesh.hpp"
 #include <Execution/ExecutionTBB.hpp>
 
-#include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeIndirectParallel.hpp>
 #include <libslic3r/TriangleMesh.hpp>
 
 #include <numeric>
@@ -27,7 +27,7 @@ public:
             if (l > 0)
                 m_triangle_ray_epsilon = 0.000001 * l * l;
         }
-        m_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(
+        m_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set_parallel(
             its.vertices, its.indices);
     }
 
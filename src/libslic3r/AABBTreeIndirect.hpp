@@ -7,6 +7,7 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -91,13 +92,23 @@ public:
 
 	template<typename SourceNode>
 	void build_modify_input(std::vector<SourceNode> &input)
+	{
+		this->build_modify_input(input, [](size_t /* num_entities */, auto &&build_left, auto &&build_right) { build_left(); build_right(); });
+	}
+
+	// BuildSubtrees is called as build_subtrees(num_entities, build_left, build_right) to build the two subtrees
+	// of an inner node over num_entities source entities. The subtrees own disjoint ranges of the input
+	// and disjoint nodes, thus build_subtrees may run them in parallel, see AABBTreeIndirectParallel.hpp.
+	// The resulting tree is the same as if built serially.
+	template<typename SourceNode, typename BuildSubtrees>
+	void build_modify_input(std::vector<SourceNode> &input, const BuildSubtrees &build_subtrees)
 	{
         if (input.empty())
 			clear();
 		else {
 			// Allocate enough memory for a full binary tree.
             m_nodes.assign(next_highest_power_of_2(input.size()) * 2 - 1, Node());
-            build_recursive(input, 0, 0, input.size() - 1);
+            build_recursive(input, 0, 0, input.size() - 1, build_subtrees);
 		}
 	}
 
@@ -120,8 +131,8 @@ public:
 
 private:
 	// Build a balanced tree by splitting the input sequence by an axis aligned plane at a dimension.
-	template<typename SourceNode>
-	void build_recursive(std::vector<SourceNode> &input, size_t node, const size_t left, const size_t right)
+	template<typename SourceNode, typename BuildSubtrees>
+	void build_recursive(std::vector<SourceNode> &input, size_t node, const size_t left, const size_t right, const BuildSubtrees &build_subtrees)
 	{
         assert(node < m_nodes.size());
         assert(left <= right);
@@ -145,8 +156,9 @@ private:
 		// Insert an inner node into the tree. Inner node does not reference any input entity (triangle, line segment etc).
 		m_nodes[node].idx  = inner;
 		m_nodes[node].bbox = bbox;
-        build_recursive(input, node * 2 + 1, left, center);
-		build_recursive(input, node * 2 + 2, center + 1, right);
+		build_subtrees(right - left + 1,
+			[this, &input, node, left, center, &build_subtrees]() { build_recursive(input, node * 2 + 1, left, center, build_subtrees); },
+			[this, &input, node, center, right, &build_subtrees]() { build_recursive(input, node * 2 + 2, center + 1, right, build_subtrees); });
 	}
 
 	// Partition the input m_nodes <left, right> at "k" and "dimension" using the QuickSelect method:
@@ -236,6 +248,38 @@ private:
 };
 
 namespace detail {
+	// Source entity of an AABB tree over an indexed triangle set: a triangle, its bounding box and centroid.
+	template<typename TreeType>
+	struct TriangleSetInput {
+		using VectorType  = typename TreeType::VectorType;
+		using BoundingBox = typename TreeType::BoundingBox;
+
+        size_t 				idx()       const { return m_idx; }
+        const BoundingBox& 	bbox()      const { return m_bbox; }
+        const VectorType& 	centroid()  const { return m_centroid; }
+
+		template<typename VertexType, typename IndexedFaceType>
+		void set(const std::vector<VertexType> &vertices, const std::vector<IndexedFaceType> &faces, size_t idx, const typename VertexType::Scalar eps)
+		{
+	        const IndexedFaceType &face = faces[idx];
+			const VertexType &v1 = vertices[face(0)];
+			const VertexType &v2 = vertices[face(1)];
+			const VertexType &v3 = vertices[face(2)];
+			const VectorType veps(eps, eps, eps);
+	        m_idx      = idx;
+	        m_centroid = (1./3.) * (v1 + v2 + v3);
+	        m_bbox = BoundingBox(v1, v1);
+	        m_bbox.extend(v2);
+	        m_bbox.extend(v3);
+	        m_bbox.min() -= veps;
+	        m_bbox.max() += veps;
+		}
+
+		size_t 		m_idx;
+		BoundingBox m_bbox;
+        VectorType 	m_centroid;
+	};
+
 	template<typename AVertexType, typename AIndexedFaceType, typename ATreeType, typename AVectorType>
 	struct RayIntersector {
 		using VertexType 		= AVertexType;
@@ -271,7 +315,8 @@ namespace detail {
   		const Eigen::MatrixBase<Deriveddir> 	&inv_dir,
   		Eigen::AlignedBox<Scalar,3> 			 box,
   		const Scalar 							&t0,
-  		const Scalar 							&t1) {
+  		const Scalar 							&t1,
+  		Scalar 									&t_entry) {
 		// http://people.csail.mit.edu/amy/papers/box-jgt.pdf
 		// "An Efficient and Robust Ray–Box Intersection Algorithm"
 		if (inv_dir.x() < 0)
@@ -302,9 +347,21 @@ namespace detail {
 			tmin = tzmin;
 		if (tzmax < tmax)
 			tmax = tzmax;
+		t_entry = tmin;
         return tmin < t1 && tmax > t0;
 	}
 
+	template <typename Derivedsource, typename Deriveddir, typename Scalar>
+	inline bool ray_box_intersect_invdir(
+  		const Eigen::MatrixBase<Derivedsource> 	&origin,
+  		const Eigen::MatrixBase<Deriveddir> 	&inv_dir,
+  		const Eigen::AlignedBox<Scalar,3> 		&box,
+  		const Scalar 							&t0,
+  		const Scalar 							&t1) {
+		Scalar t_entry;
+		return ray_box_intersect_invdir(origin, inv_dir, box, t0, t1, t_entry);
+	}
+
 	// The following intersect_triangle() is derived from raytri.c routine intersect_triangle1()
 	// Ray-Triangle Intersection Test Routines
 	// Different optimizations of my and Ben Trumbore's
@@ -470,6 +527,67 @@ namespace detail {
 		}
 	}
 
+	// Non-recursive first hit traversal visiting the closer child first, so that the farther child is mostly culled
+	// by the closest hit found so far. Used for batches of rays, where the function call overhead of the recursion adds up.
+    template<typename RayIntersectorType>
+	static inline bool intersect_ray_first_hit_front_to_back(const RayIntersectorType &ray_intersector, igl::Hit<float> &hit)
+	{
+        using Scalar = typename RayIntersectorType::VectorType::Scalar;
+		const auto &tree = ray_intersector.tree;
+		Scalar      t_entry;
+		if (! ray_box_intersect_invdir(ray_intersector.origin, ray_intersector.invdir, tree.node(0).bbox.template cast<Scalar>(),
+				Scalar(0), std::numeric_limits<Scalar>::infinity(), t_entry))
+			return false;
+		// Nodes to visit with the ray parameters of their entry points. Each level of the balanced tree
+		// postpones at most one node, thus the stack depth is bounded by the tree depth.
+		std::array<std::pair<size_t, Scalar>, 64> stack;
+		size_t stack_size = 0;
+		stack[stack_size ++] = { 0, t_entry };
+		Scalar min_t = std::numeric_limits<Scalar>::infinity();
+		bool   found = false;
+		while (stack_size > 0) {
+			const auto [node_idx, node_t] = stack[-- stack_size];
+			if (node_t >= min_t)
+				continue;
+			const auto &node = tree.node(node_idx);
+			assert(node.is_valid());
+			if (node.is_leaf()) {
+	            auto   face = ray_intersector.faces[node.idx];
+			    double t, u, v;
+			    if (intersect_triangle(
+			    		ray_intersector.origin, ray_intersector.dir, 
+			    		ray_intersector.vertices[face(0)], ray_intersector.vertices[face(1)], ray_intersector.vertices[face(2)], 
+	                    t, u, v, ray_intersector.eps)
+			    	&& t > 0. && Scalar(t) < min_t) {
+					min_t = Scalar(t);
+	                hit   = igl::Hit<float> { int(node.idx), -1, float(u), float(v), float(t) };
+					found = true;
+				}
+			} else {
+				size_t left  = node_idx * 2 + 1;
+				size_t right = left + 1;
+				Scalar t_left, t_right;
+				bool   hit_left  = ray_box_intersect_invdir(ray_intersector.origin, ray_intersector.invdir, tree.node(left).bbox.template cast<Scalar>(), Scalar(0), min_t, t_left);
+				bool   hit_right = ray_box_intersect_invdir(ray_intersector.origin, ray_intersector.invdir, tree.node(right).bbox.template cast<Scalar>(), Scalar(0), min_t, t_right);
+				if (hit_left && hit_right) {
+					assert(stack_size + 2 <= stack.size());
+					// Push the farther child first to pop the closer child first.
+					if (t_left < t_right) {
+						stack[stack_size ++] = { right, t_right };
+						stack[stack_size ++] = { left,  t_left  };
+					} else {
+						stack[stack_size ++] = { left,  t_left  };
+						stack[stack_size ++] = { right, t_right };
+					}
+				} else if (hit_left)
+					stack[stack_size ++] = { left, t_left };
+				else if (hit_right)
+					stack[stack_size ++] = { right, t_right };
+			}
+		}
+		return found;
+	}
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -678,38 +796,10 @@ inline Tree<3, typename VertexType::Scalar> build_aabb_tree_over_indexed_triangl
     const typename VertexType::Scalar 	 eps = 0)
 {
     using 				 TreeType 		= Tree<3, typename VertexType::Scalar>;
-//    using				 CoordType      = typename TreeType::CoordType;
-    using 				 VectorType	    = typename TreeType::VectorType;
-    using 				 BoundingBox 	= typename TreeType::BoundingBox;
-
-	struct InputType {
-        size_t 				idx()       const { return m_idx; }
-        const BoundingBox& 	bbox()      const { return m_bbox; }
-        const VectorType& 	centroid()  const { return m_centroid; }
 
-		size_t 		m_idx;
-		BoundingBox m_bbox;
-        VectorType 	m_centroid;
-	};
-
-	std::vector<InputType> input;
-	input.reserve(faces.size());
-    const VectorType veps(eps, eps, eps);
-	for (size_t i = 0; i < faces.size(); ++ i) {
-        const IndexedFaceType &face = faces[i];
-		const VertexType &v1 = vertices[face(0)];
-		const VertexType &v2 = vertices[face(1)];
-		const VertexType &v3 = vertices[face(2)];
-		InputType n;
-        n.m_idx      = i;
-        n.m_centroid = (1./3.) * (v1 + v2 + v3);
-        n.m_bbox = BoundingBox(v1, v1);
-        n.m_bbox.extend(v2);
-        n.m_bbox.extend(v3);
-        n.m_bbox.min() -= veps;
-        n.m_bbox.max() += veps;
-        input.emplace_back(n);
-	}
+	std::vector<detail::TriangleSetInput<TreeType>> input(faces.size());
+	for (size_t i = 0; i < faces.size(); ++ i)
+		input[i].set(vertices, faces, i, eps);
 
 	TreeType out;
 	out.build(std::move(input));
@@ -787,6 +877,80 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// First hits of a batch of rays, stored as a structure of arrays.
+struct RayHits
+{
+	// Index of the hit triangle, -1 if the ray missed the mesh.
+	std::vector<int>	face;
+	// Barycentric coordinates of the hit point.
+	std::vector<float>	u;
+	std::vector<float>	v;
+	// Ray parameter of the hit point.
+	std::vector<float>	t;
+
+	size_t 	size() const { return face.size(); }
+	bool 	hit(size_t idx) const { return face[idx] != -1; }
+	void 	resize(size_t n) { face.assign(n, -1); u.assign(n, 0.f); v.assign(n, 0.f); t.assign(n, std::numeric_limits<float>::infinity()); }
+};
+
+namespace detail {
+	// Cast the rays [begin, end) of a batch, hits has to be resized to the size of the batch already.
+	template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+	inline void intersect_rays_first_hit(
+		const std::vector<VertexType> 		&vertices,
+		const std::vector<IndexedFaceType> 	&faces,
+		const TreeType 						&tree,
+		const std::vector<VectorType>		&origins,
+		const std::vector<VectorType>		&dirs,
+		RayHits 							&hits,
+		const double 						 eps,
+		const size_t 						 begin,
+		const size_t 						 end)
+	{
+		for (size_t i = begin; i < end; ++ i) {
+			auto ray_intersector = RayIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+				vertices, faces, tree,
+		        origins[i], dirs[i], VectorType(dirs[i].cwiseInverse()),
+		        eps
+			};
+			igl::Hit<float> hit;
+			if (intersect_ray_first_hit_front_to_back(ray_intersector, hit)) {
+				hits.face[i] = hit.id;
+				hits.u[i]    = hit.u;
+				hits.v[i]    = hit.v;
+				hits.t[i]    = hit.t;
+			}
+		}
+	}
+} // namespace detail
+
+// Find the first intersections of a batch of rays with indexed triangle set.
+// The hits are the same as returned by intersect_ray_first_hit() for the single rays,
+// though a different triangle may be reported if a ray hits an edge shared by two triangles.
+// See AABBTreeIndirectParallel.hpp for a variant casting the rays in parallel.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersections of the rays with the indexed triangle set.
+	RayHits 							&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	assert(origins.size() == dirs.size());
+	hits.resize(origins.size());
+	if (! tree.empty())
+		detail::intersect_rays_first_hit(vertices, faces, tree, origins, dirs, hits, eps, 0, origins.size());
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
@@ -0,0 +1,80 @@
+// Parallel construction of AABBTreeIndirect::Tree over an indexed triangle set and parallel ray casting.
+// Kept out of AABBTreeIndirect.hpp, so that the widely included tree header does not pull in TBB.
+
+#ifndef slic3r_AABBTreeIndirectParallel_hpp_
+#define slic3r_AABBTreeIndirectParallel_hpp_
+
+#include "AABBTreeIndirect.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
+namespace Slic3r {
+namespace AABBTreeIndirect {
+
+// Subtrees over fewer entities are not worth spawning a task for.
+static constexpr size_t parallel_build_threshold = 4096;
+
+// Same as build_aabb_tree_over_indexed_triangle_set(), though the source bounding boxes are calculated in parallel
+// and the subtrees over more than parallel_build_threshold triangles are built in parallel.
+// The resulting tree is the same as if built serially.
+template<typename VertexType, typename IndexedFaceType>
+inline Tree<3, typename VertexType::Scalar> build_aabb_tree_over_indexed_triangle_set_parallel(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+    const std::vector<IndexedFaceType> 	&faces,
+    const typename VertexType::Scalar 	 eps = 0)
+{
+    using 				 TreeType 		= Tree<3, typename VertexType::Scalar>;
+
+	std::vector<detail::TriangleSetInput<TreeType>> input(faces.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, faces.size()), [&vertices, &faces, &input, eps](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			input[i].set(vertices, faces, i, eps);
+	});
+
+	TreeType out;
+	out.build_modify_input(input, [](size_t num_entities, auto &&build_left, auto &&build_right) {
+		if (num_entities > parallel_build_threshold)
+			tbb::parallel_invoke(build_left, build_right);
+		else {
+			build_left();
+			build_right();
+		}
+	});
+	return out;
+}
+
+// Same as intersect_rays_first_hit(), though the rays are cast in parallel.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline void intersect_rays_first_hit_parallel(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType>		&dirs,
+	// First intersections of the rays with the indexed triangle set.
+	RayHits 							&hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	assert(origins.size() == dirs.size());
+	hits.resize(origins.size());
+	if (tree.empty())
+		return;
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, origins.size()), [&vertices, &faces, &tree, &origins, &dirs, &hits, eps](const tbb::blocked_range<size_t> &range) {
+		detail::intersect_rays_first_hit(vertices, faces, tree, origins, dirs, hits, eps, range.begin(), range.end());
+	});
+}
+
+} // namespace AABBTreeIndirect
+} // namespace Slic3r
+
+#endif /* slic3r_AABBTreeIndirectParallel_hpp_ */
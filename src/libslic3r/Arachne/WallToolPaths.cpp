@@ -17,6 +17,7 @@
 #include "Utils.hpp"
 
 #include <boost/log/trivial.hpp>
+#include <tbb/parallel_for.h>
 
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
@@ -506,9 +507,10 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
     // Applying Clipper union should be enough to get rid of this issue.
     // Clipper union also fixed an issue in Arachne that in post-processing Voronoi diagram, some edges
     // didn't have twin edges. (a non-planar Voronoi diagram probably caused this).
-    prepared_outline = union_(prepared_outline);
+    // The islands are split apart, as the skeleton inside an island only depends on the contour and holes of that island.
+    const ExPolygons islands = union_ex(prepared_outline);
 
-    if (area(prepared_outline) <= 0) {
+    if (islands.empty()) {
         assert(toolpaths.empty());
         return toolpaths;
     }
@@ -540,17 +542,37 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         );
     const coord_t transition_filter_dist   = scaled<coord_t>(100.f);
     const coord_t allowed_filter_deviation = wall_transition_filter_deviation;
-    SkeletalTrapezoidation wall_maker
-    (
-        prepared_outline,
-        *beading_strat,
-        beading_strat->getTransitioningAngle(),
-        discretization_step_size,
-        transition_filter_dist,
-        allowed_filter_deviation,
-        wall_transition_length
-    );
-    wall_maker.generateToolpaths(toolpaths);
+    auto generate_island_toolpaths = [&](const Polygons &island_outline, std::vector<VariableWidthLines> &island_toolpaths) {
+        SkeletalTrapezoidation wall_maker
+        (
+            island_outline,
+            *beading_strat,
+            beading_strat->getTransitioningAngle(),
+            discretization_step_size,
+            transition_filter_dist,
+            allowed_filter_deviation,
+            wall_transition_length
+        );
+        wall_maker.generateToolpaths(island_toolpaths);
+    };
+    if (islands.size() == 1) {
+        generate_island_toolpaths(to_polygons(islands.front()), toolpaths);
+    } else {
+        // Plates of small text or lattices produce many islands per layer, their skeletons are built in parallel.
+        // The beading strategy is shared, it is not modified by SkeletalTrapezoidation.
+        std::vector<std::vector<VariableWidthLines>> islands_toolpaths(islands.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, islands.size()), [&islands, &islands_toolpaths, &generate_island_toolpaths](const tbb::blocked_range<size_t> &range) {
+            for (size_t island_idx = range.begin(); island_idx < range.end(); ++ island_idx)
+                generate_island_toolpaths(to_polygons(islands[island_idx]), islands_toolpaths[island_idx]);
+        });
+        // Merge the walls of the islands by their inset index, keeping the order of the islands.
+        for (std::vector<VariableWidthLines> &island_toolpaths : islands_toolpaths) {
+            if (toolpaths.size() < island_toolpaths.size())
+                toolpaths.resize(island_toolpaths.size());
+            for (size_t inset_idx = 0; inset_idx < island_toolpaths.size(); ++ inset_idx)
+                append(toolpaths[inset_idx], std::move(island_toolpaths[inset_idx]));
+        }
+    }
 
     stitchToolPaths(toolpaths, this->bead_width_x);
 
@@ -5,8 +5,14 @@
 #define UTILS_HALF_EDGE_GRAPH_H
 
 
-#include <list>
 #include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 
@@ -15,14 +21,199 @@
 
 namespace Slic3r::Arachne
 {
+
+/*!
+ * A doubly linked list with the std::list interface used by the half-edge graph, storing its items in a pool of fixed size chunks.
+ *
+ * The items are linked by their indices into the pool, erased items are recycled, thus building a graph with hundreds of thousands
+ * of edges does not allocate each edge separately. The chunks are never moved, pointers to the items stay valid until the items are erased.
+ */
+template<class T>
+class PooledList
+{
+    static constexpr uint32_t invalid_idx = uint32_t(-1);
+    static constexpr size_t   chunk_bits  = 10;
+    static constexpr size_t   chunk_size  = size_t(1) << chunk_bits;
+
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t prev;
+        uint32_t next;
+
+        T&       value()       { return *std::launder(reinterpret_cast<T*>(storage)); }
+        const T& value() const { return *std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    template<bool is_const>
+    class Iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<is_const, const T*, T*>;
+        using reference         = std::conditional_t<is_const, const T&, T&>;
+        using list_type         = std::conditional_t<is_const, const PooledList, PooledList>;
+
+        Iterator() = default;
+        Iterator(list_type *list, uint32_t idx) : m_list(list), m_idx(idx) {}
+        // Conversion of iterator to const_iterator.
+        template<bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+        Iterator(const Iterator<other_const> &other) : m_list(other.m_list), m_idx(other.m_idx) {}
+
+        reference operator*() const { return m_list->slot(m_idx).value(); }
+        pointer   operator->() const { return &m_list->slot(m_idx).value(); }
+        Iterator& operator++() { m_idx = m_list->slot(m_idx).next; return *this; }
+        Iterator  operator++(int) { Iterator out = *this; ++ *this; return out; }
+        Iterator& operator--() { m_idx = m_idx == invalid_idx ? m_list->m_tail : m_list->slot(m_idx).prev; return *this; }
+        Iterator  operator--(int) { Iterator out = *this; -- *this; return out; }
+        bool      operator==(const Iterator &rhs) const { return m_idx == rhs.m_idx; }
+        bool      operator!=(const Iterator &rhs) const { return m_idx != rhs.m_idx; }
+
+    private:
+        list_type *m_list { nullptr };
+        uint32_t   m_idx  { invalid_idx };
+
+        friend class PooledList;
+        friend class Iterator<! is_const>;
+    };
+
+public:
+    using value_type     = T;
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    PooledList() = default;
+    PooledList(const PooledList &) = delete;
+    PooledList(PooledList &&rhs) noexcept { this->swap(rhs); }
+    PooledList& operator=(const PooledList &) = delete;
+    PooledList& operator=(PooledList &&rhs) noexcept { PooledList tmp(std::move(rhs)); this->swap(tmp); return *this; }
+    ~PooledList() { this->clear(); }
+
+    void swap(PooledList &rhs) noexcept
+    {
+        std::swap(m_chunks, rhs.m_chunks);
+        std::swap(m_head, rhs.m_head);
+        std::swap(m_tail, rhs.m_tail);
+        std::swap(m_free, rhs.m_free);
+        std::swap(m_size, rhs.m_size);
+        std::swap(m_num_slots, rhs.m_num_slots);
+    }
+
+    iterator       begin()        { return { this, m_head }; }
+    iterator       end()          { return { this, invalid_idx }; }
+    const_iterator begin()  const { return { this, m_head }; }
+    const_iterator end()    const { return { this, invalid_idx }; }
+    const_iterator cbegin() const { return this->begin(); }
+    const_iterator cend()   const { return this->end(); }
+
+    size_t   size()  const { return m_size; }
+    bool     empty() const { return m_size == 0; }
+
+    T&       front()       { assert(! this->empty()); return slot(m_head).value(); }
+    const T& front() const { assert(! this->empty()); return slot(m_head).value(); }
+    T&       back()        { assert(! this->empty()); return slot(m_tail).value(); }
+    const T& back()  const { assert(! this->empty()); return slot(m_tail).value(); }
+
+    template<class... Args>
+    T& emplace_front(Args&&... args)
+    {
+        const uint32_t idx = this->construct(std::forward<Args>(args)...);
+        Slot &s = slot(idx);
+        s.prev = invalid_idx;
+        s.next = m_head;
+        if (m_head == invalid_idx)
+            m_tail = idx;
+        else
+            slot(m_head).prev = idx;
+        m_head = idx;
+        return s.value();
+    }
+
+    template<class... Args>
+    T& emplace_back(Args&&... args)
+    {
+        const uint32_t idx = this->construct(std::forward<Args>(args)...);
+        Slot &s = slot(idx);
+        s.prev = m_tail;
+        s.next = invalid_idx;
+        if (m_tail == invalid_idx)
+            m_head = idx;
+        else
+            slot(m_tail).next = idx;
+        m_tail = idx;
+        return s.value();
+    }
+
+    // Returns an iterator to the item following the erased one.
+    iterator erase(const_iterator it)
+    {
+        assert(it.m_list == this && it.m_idx != invalid_idx);
+        const uint32_t idx  = it.m_idx;
+        Slot          &s    = slot(idx);
+        const uint32_t next = s.next;
+        (s.prev == invalid_idx ? m_head : slot(s.prev).next) = s.next;
+        (s.next == invalid_idx ? m_tail : slot(s.next).prev) = s.prev;
+        s.value().~T();
+        s.next = m_free;
+        m_free = idx;
+        -- m_size;
+        return { this, next };
+    }
+
+    void clear()
+    {
+        for (uint32_t idx = m_head; idx != invalid_idx;) {
+            Slot &s = slot(idx);
+            idx = s.next;
+            s.value().~T();
+        }
+        m_chunks.clear();
+        m_head = m_tail = m_free = invalid_idx;
+        m_size = m_num_slots = 0;
+    }
+
+private:
+    Slot&       slot(uint32_t idx)       { return m_chunks[idx >> chunk_bits][idx & (chunk_size - 1)]; }
+    const Slot& slot(uint32_t idx) const { return m_chunks[idx >> chunk_bits][idx & (chunk_size - 1)]; }
+
+    template<class... Args>
+    uint32_t construct(Args&&... args)
+    {
+        uint32_t idx = m_free;
+        if (idx == invalid_idx) {
+            if (m_num_slots == m_chunks.size() * chunk_size)
+                m_chunks.emplace_back(new Slot[chunk_size]);
+            idx = uint32_t(m_num_slots ++);
+        }
+        Slot &s = slot(idx);
+        // Don't take the slot out of the free list before the item is constructed, the constructor may throw.
+        const uint32_t next_free = idx == m_free ? s.next : m_free;
+        new (s.storage) T(std::forward<Args>(args)...);
+        m_free = next_free;
+        ++ m_size;
+        return idx;
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    uint32_t                             m_head      { invalid_idx };
+    uint32_t                             m_tail      { invalid_idx };
+    // Singly linked list of the erased slots, linked by Slot::next.
+    uint32_t                             m_free      { invalid_idx };
+    size_t                               m_size      { 0 };
+    // Number of slots handed out from the chunks, erased slots included.
+    size_t                               m_num_slots { 0 };
+};
+
 template<class node_data_t, class edge_data_t, class derived_node_t, class derived_edge_t> // types of data contained in nodes and edges
 class HalfEdgeGraph
 {
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    using Edges = std::list<edge_t>;
-    using Nodes = std::list<node_t>;
+    using Edges = PooledList<edge_t>;
+    using Nodes = PooledList<node_t>;
     Edges edges;
     Nodes nodes;
 };
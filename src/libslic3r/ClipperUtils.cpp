@@ -1,4 +1,6 @@
+#include <atomic>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <unordered_map>
 
@@ -6,6 +8,8 @@
 #include "Geometry.hpp"
 #include "ShortestPath.hpp"
 
+#include <clipper2/clipper.h>
+
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
@@ -168,8 +172,208 @@ void clip_clipper_polygon_with_subject_bbox(const Polygon &src, const BoundingBo
     out.erase(std::remove_if(out.begin(), out.end(), [](const Polygon &polygon) {return polygon.empty(); }), out.end());
     return out;
 }
+
+static std::atomic<Backend> s_backend { Backend::ClipperLib };
+
+void    set_backend(Backend backend) { s_backend.store(backend, std::memory_order_relaxed); }
+Backend backend() { return s_backend.load(std::memory_order_relaxed); }
+
+struct ThreadClipperSlot {
+    std::unique_ptr<ClipperLib::Clipper> clipper;
+    bool                                 busy { false };
+};
+
+static ThreadClipperSlot& thread_clipper_slot()
+{
+    static thread_local ThreadClipperSlot slot;
+    return slot;
+}
+
+ThreadClipper::ThreadClipper()
+{
+    ThreadClipperSlot &slot = thread_clipper_slot();
+    if (slot.busy) {
+        m_own     = std::make_unique<ClipperLib::Clipper>();
+        m_clipper = m_own.get();
+    } else {
+        if (! slot.clipper) {
+            slot.clipper = std::make_unique<ClipperLib::Clipper>();
+            slot.clipper->KeepEdgeBuffers(keep_edges_max);
+        }
+        slot.busy = true;
+        m_clipper = slot.clipper.get();
+    }
+}
+
+ThreadClipper::~ThreadClipper()
+{
+    if (m_own)
+        return;
+    ThreadClipperSlot &slot = thread_clipper_slot();
+    if (m_clipper->NumEdges() > keep_edges_max)
+        // The other buffers of the engine (local minima, joins, intersections) grew with this operation, don't keep them.
+        slot.clipper.reset();
+    else {
+        m_clipper->Clear();
+        m_clipper->ReverseSolution(false);
+        m_clipper->StrictlySimple(false);
+        m_clipper->PreserveCollinear(false);
+    }
+    slot.busy = false;
+}
+}
+
+// Conversions between ClipperLib and Clipper2Lib for the Clipper2 backend.
+namespace Clipper2Backend {
+
+static inline bool active() { return ClipperUtils::backend() == ClipperUtils::Backend::Clipper2; }
+
+template<typename PathsProvider>
+static Clipper2Lib::Paths64 to_paths64(PathsProvider &&paths)
+{
+    Clipper2Lib::Paths64 out;
+    out.reserve(paths.size());
+    for (const Points &path : paths) {
+        Clipper2Lib::Path64 &dst = out.emplace_back();
+        dst.reserve(path.size());
+        for (const Point &pt : path)
+            dst.emplace_back(pt.x(), pt.y());
+    }
+    return out;
+}
+
+// Drop the vertices closer than shortest_edge_length to the previous kept vertex, and for closed paths the trailing vertices
+// closer than that to the first vertex, the same way ClipperLib::ClipperOffset::AddPath() applies ShortestEdgeLength.
+static Clipper2Lib::Path64 to_path64_offset_input(const Points &path, double shortest_edge_length, bool closed)
+{
+    Clipper2Lib::Path64 out;
+    if (path.empty())
+        return out;
+    const double l2   = shortest_edge_length * shortest_edge_length;
+    auto         same = [shortest_edge_length, l2](const Point &p1, const Point &p2) {
+        return shortest_edge_length > 0. ? (p2 - p1).cast<double>().squaredNorm() < l2 : p1 == p2;
+    };
+    size_t last = path.size() - 1;
+    if (closed)
+        for (; last > 0 && same(path.front(), path[last]); -- last) ;
+    out.reserve(last + 1);
+    out.emplace_back(path.front().x(), path.front().y());
+    for (size_t i = 1, j = 0; i <= last; ++ i)
+        if (! same(path[j], path[i])) {
+            out.emplace_back(path[i].x(), path[i].y());
+            j = i;
+        }
+    return out;
+}
+
+static ClipperLib::Path from_path64(const Clipper2Lib::Path64 &path)
+{
+    ClipperLib::Path out;
+    out.reserve(path.size());
+    for (const Clipper2Lib::Point64 &pt : path)
+        out.emplace_back(pt.x, pt.y);
+    return out;
+}
+
+static ClipperLib::Paths from_paths64(const Clipper2Lib::Paths64 &paths)
+{
+    ClipperLib::Paths out;
+    out.reserve(paths.size());
+    for (const Clipper2Lib::Path64 &path : paths)
+        out.emplace_back(from_path64(path));
+    return out;
+}
+
+static ClipperLib::PolyTree from_polytree64(const Clipper2Lib::PolyTree64 &polytree)
+{
+    struct Inner {
+        static size_t count(const Clipper2Lib::PolyPath64 &node) {
+            size_t cnt = node.Count();
+            for (const auto &child : node)
+                cnt += count(*child);
+            return cnt;
+        }
+        static void add_children(const Clipper2Lib::PolyPath64 &src, ClipperLib::PolyTree &tree, ClipperLib::PolyNode &dst) {
+            for (const auto &child : src)
+                add_children(*child, tree, *tree.AddNode(dst, from_path64(child->Polygon())));
+        }
+    };
+    ClipperLib::PolyTree out;
+    out.ReserveNodes(Inner::count(polytree));
+    Inner::add_children(polytree, out, out);
+    return out;
+}
+
+static Clipper2Lib::ClipType clip_type(ClipperLib::ClipType type)
+{
+    switch (type) {
+    case ClipperLib::ctIntersection: return Clipper2Lib::ClipType::Intersection;
+    case ClipperLib::ctUnion:        return Clipper2Lib::ClipType::Union;
+    case ClipperLib::ctDifference:   return Clipper2Lib::ClipType::Difference;
+    case ClipperLib::ctXor:          return Clipper2Lib::ClipType::Xor;
+    }
+    assert(false);
+    return Clipper2Lib::ClipType::NoClip;
+}
+
+static Clipper2Lib::FillRule fill_rule(ClipperLib::PolyFillType type)
+{
+    switch (type) {
+    case ClipperLib::pftEvenOdd:  return Clipper2Lib::FillRule::EvenOdd;
+    case ClipperLib::pftNonZero:  return Clipper2Lib::FillRule::NonZero;
+    case ClipperLib::pftPositive: return Clipper2Lib::FillRule::Positive;
+    case ClipperLib::pftNegative: return Clipper2Lib::FillRule::Negative;
+    }
+    assert(false);
+    return Clipper2Lib::FillRule::NonZero;
+}
+
+static Clipper2Lib::JoinType join_type(ClipperLib::JoinType type)
+{
+    switch (type) {
+    case ClipperLib::jtSquare: return Clipper2Lib::JoinType::Square;
+    case ClipperLib::jtRound:  return Clipper2Lib::JoinType::Round;
+    case ClipperLib::jtMiter:  return Clipper2Lib::JoinType::Miter;
+    }
+    assert(false);
+    return Clipper2Lib::JoinType::Miter;
+}
+
+static Clipper2Lib::EndType end_type(ClipperLib::EndType type)
+{
+    switch (type) {
+    case ClipperLib::etClosedPolygon: return Clipper2Lib::EndType::Polygon;
+    case ClipperLib::etClosedLine:    return Clipper2Lib::EndType::Joined;
+    case ClipperLib::etOpenButt:      return Clipper2Lib::EndType::Butt;
+    case ClipperLib::etOpenSquare:    return Clipper2Lib::EndType::Square;
+    case ClipperLib::etOpenRound:     return Clipper2Lib::EndType::Round;
+    }
+    assert(false);
+    return Clipper2Lib::EndType::Polygon;
 }
 
+// Clipper64 set up the way ClipperLib::Clipper is used by this file: collinear points are removed.
+struct Clipper : public Clipper2Lib::Clipper64
+{
+    Clipper() { this->PreserveCollinear(false); }
+};
+
+template<class TResult> static TResult execute(Clipper &clipper, ClipperLib::ClipType type, ClipperLib::PolyFillType fill);
+template<> ClipperLib::Paths execute<ClipperLib::Paths>(Clipper &clipper, ClipperLib::ClipType type, ClipperLib::PolyFillType fill)
+{
+    Clipper2Lib::Paths64 out;
+    clipper.Execute(clip_type(type), fill_rule(fill), out);
+    return from_paths64(out);
+}
+template<> ClipperLib::PolyTree execute<ClipperLib::PolyTree>(Clipper &clipper, ClipperLib::ClipType type, ClipperLib::PolyFillType fill)
+{
+    Clipper2Lib::PolyTree64 out;
+    clipper.Execute(clip_type(type), fill_rule(fill), out);
+    return from_polytree64(out);
+}
+
+} // namespace Clipper2Backend
+
 static ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree &&polytree)
 {
     struct Inner {
@@ -265,28 +469,53 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 }
 #endif
 
+// Offset a single path. The outer most contour is offsetted as if it was CCW, the output contours are CCW with both backends.
+static ClipperLib::Paths offset_path(const Points &path, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType)
+{
+    ClipperLib::Paths out;
+    if (Clipper2Backend::active()) {
+        Clipper2Lib::ClipperOffset co;
+        if (joinType == jtRound)
+            co.ArcTolerance(miterLimit);
+        else
+            co.MiterLimit(miterLimit);
+        // Clipper2 keeps the orientation of a CW contour, ClipperLib returns CCW contours.
+        co.ReverseSolution(endType == ClipperLib::etClosedPolygon && ! ClipperLib::Orientation(path));
+        Clipper2Lib::Path64 path64 = Clipper2Backend::to_path64_offset_input(path, std::abs(offset * ClipperOffsetShortestEdgeFactor),
+            endType == ClipperLib::etClosedPolygon || endType == ClipperLib::etClosedLine);
+        // ClipperLib ignores closed polygons degenerated to less than three vertices.
+        if (endType != ClipperLib::etClosedPolygon || path64.size() >= 3) {
+            co.AddPath(path64, Clipper2Backend::join_type(joinType), Clipper2Backend::end_type(endType));
+            Clipper2Lib::Paths64 out64;
+            co.Execute(offset, out64);
+            out = Clipper2Backend::from_paths64(out64);
+        }
+    } else {
+        ClipperLib::ClipperOffset co;
+        if (joinType == jtRound)
+            co.ArcTolerance = miterLimit;
+        else
+            co.MiterLimit = miterLimit;
+        co.ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
+        co.AddPath(path, joinType, endType);
+        co.Execute(out, offset);
+    }
+    return out;
+}
+
 // Offset CCW contours outside, CW contours (holes) inside.
 // Don't calculate union of the output paths.
 template<typename PathsProvider>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType = ClipperLib::etClosedPolygon)
 {
-    ClipperLib::ClipperOffset co;
     ClipperLib::Paths out;
     out.reserve(paths.size());
-    ClipperLib::Paths out_this;
-    if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
-    else
-        co.MiterLimit = miterLimit;
-    co.ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
     for (const ClipperLib::Path &path : paths) {
-        co.Clear();
         // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
         // contours will be CCW oriented even though the input paths are CW oriented.
         // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-        co.AddPath(path, joinType, endType);
         bool ccw = endType == ClipperLib::etClosedPolygon ? ClipperLib::Orientation(path) : true;
-        co.Execute(out_this, ccw ? offset : - offset);
+        ClipperLib::Paths out_this = offset_path(path, ccw ? offset : - offset, joinType, miterLimit, endType);
         if (! ccw) {
             // Reverse the resulting contours.
             for (ClipperLib::Path &path : out_this)
@@ -311,11 +540,17 @@ TResult clipper_do(
     TClip &&                       clip,
     const ClipperLib::PolyFillType fillType)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
-    clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
+    if (Clipper2Backend::active()) {
+        Clipper2Backend::Clipper clipper;
+        clipper.AddSubject(Clipper2Backend::to_paths64(std::forward<TSubj>(subject)));
+        clipper.AddClip(Clipper2Backend::to_paths64(std::forward<TClip>(clip)));
+        return Clipper2Backend::execute<TResult>(clipper, clipType, fillType);
+    }
+    ClipperUtils::ThreadClipper clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    clipper->AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
     TResult retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -340,10 +575,15 @@ TResult clipper_union(
     // fillType pftNonZero and pftPositive "should" produce the same result for "normalized with implicit union" set of polygons
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    if (Clipper2Backend::active()) {
+        Clipper2Backend::Clipper clipper;
+        clipper.AddSubject(Clipper2Backend::to_paths64(std::forward<TSubj>(subject)));
+        return Clipper2Backend::execute<TResult>(clipper, ClipperLib::ctUnion, fillType);
+    }
+    ClipperUtils::ThreadClipper clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     TResult retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+    clipper->Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
 }
 
@@ -383,12 +623,30 @@ static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::Joi
     //assert(offset > 0);
     TResult out;
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
-        clipper.AddPaths(raw, ClipperLib::ptSubject, true);
-        ClipperLib::IntRect r = clipper.GetBounds();
-        clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
-        clipper.ReverseSolution(true);
-        clipper.Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
+        if (Clipper2Backend::active()) {
+            Clipper2Lib::Paths64 raw64 = Clipper2Backend::to_paths64(raw);
+            Clipper2Lib::Rect64  r     = Clipper2Lib::GetBounds(raw64);
+            raw64.push_back({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } });
+            Clipper2Backend::Clipper clipper;
+            clipper.AddSubject(raw64);
+            clipper.ReverseSolution(true);
+            out = Clipper2Backend::execute<TResult>(clipper, ClipperLib::ctUnion, ClipperLib::pftNegative);
+            if constexpr (std::is_same_v<TResult, ClipperLib::Paths>) {
+                // Clipper2 does not output the outermost polygon first.
+                auto it_outermost = std::max_element(out.begin(), out.end(),
+                    [](const ClipperLib::Path &l, const ClipperLib::Path &r) { return std::abs(ClipperLib::Area(l)) < std::abs(ClipperLib::Area(r)); });
+                if (it_outermost != out.end())
+                    out.erase(it_outermost);
+            } else
+                remove_outermost_polygon(out);
+            return out;
+        }
+        ClipperUtils::ThreadClipper clipper;
+        clipper->AddPaths(raw, ClipperLib::ptSubject, true);
+        ClipperLib::IntRect r = clipper->GetBounds();
+        clipper->AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
+        clipper->ReverseSolution(true);
+        clipper->Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
         remove_outermost_polygon(out);
     }
     return out;
@@ -442,17 +700,7 @@ Polygons contour_to_polygons(const Polygons &polygons, const float line_width, C
 static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float delta, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::Paths &out)
 {
     // 1) Offset the outer contour.
-    ClipperLib::Paths contours;
-    {
-        ClipperLib::ClipperOffset co;
-        if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
-        else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
-    }
+    ClipperLib::Paths contours = offset_path(expoly.contour.points, delta, joinType, miterLimit, ClipperLib::etClosedPolygon);
     if (contours.empty())
         // No need to try to offset the holes.
         return 0;
@@ -464,21 +712,11 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
-            for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
-                ClipperLib::Paths out2;
+            for (const Polygon &hole : expoly.holes)
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
                 // contours will be CCW oriented even though the input paths are CW oriented.
                 // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
-                append(holes, std::move(out2));
-            }
+                append(holes, offset_path(hole.points, - delta, joinType, miterLimit, ClipperLib::etClosedPolygon));
         }
 
         // 3) Subtract holes from the contours.
@@ -841,11 +1079,23 @@ Slic3r::ExPolygons xor_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPol
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
-    clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
+    if (Clipper2Backend::active()) {
+        Clipper2Backend::Clipper clipper;
+        clipper.AddOpenSubject(Clipper2Backend::to_paths64(std::forward<PathsProvider1>(subject)));
+        clipper.AddClip(Clipper2Backend::to_paths64(std::forward<PathsProvider2>(clip)));
+        Clipper2Lib::Paths64 closed, open;
+        clipper.Execute(Clipper2Backend::clip_type(clipType), Clipper2Lib::FillRule::NonZero, closed, open);
+        Polylines out;
+        out.reserve(open.size());
+        for (const Clipper2Lib::Path64 &path : open)
+            out.emplace_back(Clipper2Backend::from_path64(path));
+        return out;
+    }
+    ClipperUtils::ThreadClipper clipper;
+    clipper->AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
+    clipper->AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
     ClipperLib::PolyTree retval;
-    clipper.Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    clipper->Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     return PolyTreeToPolylines(std::move(retval));
 }
 
@@ -321,6 +321,41 @@ namespace ClipperUtils {
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygon &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygons &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
 
+    // Library performing the offsets and the boolean operations of the functions below.
+    // The Clipper2 backend converts the paths to Clipper2Lib and back, the results are returned as ClipperLib types,
+    // thus the callers don't need to know which backend is active.
+    enum class Backend {
+        ClipperLib,
+        Clipper2,
+    };
+    // Process wide switch, to be set before the slicing starts (command line option --clipper2).
+    void    set_backend(Backend backend);
+    Backend backend();
+
+    // Lease of the ClipperLib::Clipper of the calling thread, used by the boolean operations below. The engine is cleared and
+    // its options are reset when the lease ends, but it keeps its edge arrays, thus the islands of the layers processed by a thread
+    // don't allocate them again. An operation started while the engine is leased (from a callback) gets an engine of its own.
+    class ThreadClipper
+    {
+    public:
+        ThreadClipper();
+        ~ThreadClipper();
+        ThreadClipper(const ThreadClipper&) = delete;
+        ThreadClipper& operator=(const ThreadClipper&) = delete;
+
+        ClipperLib::Clipper& operator*()  { return *m_clipper; }
+        ClipperLib::Clipper* operator->() { return m_clipper; }
+        // Is the engine of the thread leased, or a private one?
+        bool                 shared() const { return ! m_own; }
+
+        // Up to this number of edges are kept by the engine of a thread. An operation with more edges releases the engine.
+        static constexpr const size_t keep_edges_max = 16384;
+
+    private:
+        ClipperLib::Clipper                  *m_clipper;
+        std::unique_ptr<ClipperLib::Clipper>  m_own;
+    };
+
     }
 
 // Perform union of input polygons using the non-zero rule, convert to ExPolygons.
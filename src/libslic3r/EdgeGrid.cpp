@@ -1,13 +1,18 @@
 #include <algorithm>
+#include <numeric>
 #include <vector>
 #include <float.h>
 #include <unordered_map>
 
 #include <png.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #include "libslic3r.h"
 #include "ClipperUtils.hpp"
 #include "EdgeGrid.hpp"
+#include "Exception.hpp"
 #include "Geometry.hpp"
 #include "SVG.hpp"
 #include "PNGReadWrite.hpp"
@@ -331,6 +336,9 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 		for (visitor.j = 0; visitor.j < contour.num_segments(); ++ visitor.j)
 			this->visit_cells_intersecting_line(contour.segment_start(visitor.j), contour.segment_end(visitor.j), visitor);
 	}
+
+	// The structure of arrays for the batched queries is filled in on demand by prepare_batched_queries().
+	m_edges.clear();
 }
 
 #if 0
@@ -1280,6 +1288,137 @@ bool EdgeGrid::Grid::signed_distance(const Point &pt, coord_t search_radius, coo
 	return true;
 }
 
+void EdgeGrid::Grid::EdgesSoA::resize(size_t n)
+{
+	x1.resize(n); y1.resize(n); vx.resize(n); vy.resize(n); vx_prev.resize(n); vy_prev.resize(n); l2.resize(n); len.resize(n);
+}
+
+void EdgeGrid::Grid::EdgesSoA::set(size_t i, const Contour &contour, size_t ipt)
+{
+	const Slic3r::Point &p0 = contour.segment_prev(ipt);
+	const Slic3r::Point &p1 = contour.segment_start(ipt);
+	const Slic3r::Point &p2 = contour.segment_end(ipt);
+	x1[i]      = p1.x();
+	y1[i]      = p1.y();
+	vx[i]      = int64_t(p2.x()) - p1.x();
+	vy[i]      = int64_t(p2.y()) - p1.y();
+	vx_prev[i] = int64_t(p1.x()) - p0.x();
+	vy_prev[i] = int64_t(p1.y()) - p0.y();
+	l2[i]      = vx[i] * vx[i] + vy[i] * vy[i];
+	len[i]     = sqrt(double(l2[i]));
+}
+
+void EdgeGrid::Grid::prepare_batched_queries()
+{
+	if (! std::all_of(m_contours.begin(), m_contours.end(), [](const Contour &contour) { return contour.closed(); }))
+		throw Slic3r::InvalidArgument("EdgeGrid: The batched signed distance queries are only defined for closed contours");
+	m_edges.clear();
+	m_edges.resize(m_cell_data.size());
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, m_cell_data.size()), [this](const tbb::blocked_range<size_t> &range) {
+		for (size_t i = range.begin(); i < range.end(); ++ i)
+			m_edges.set(i, m_contours[m_cell_data[i].first], m_cell_data[i].second);
+	});
+}
+
+std::vector<EdgeGrid::Grid::ClosestPointResult> EdgeGrid::Grid::closest_points_signed_distance(const Points &pts, coord_t search_radius) const
+{
+	std::vector<ClosestPointResult> out(pts.size());
+	if (pts.empty() || m_cells.empty())
+		return out;
+
+	if (m_edges.size() != m_cell_data.size())
+		throw Slic3r::LogicError("EdgeGrid: prepare_batched_queries() was not called after the grid was created");
+	const EdgesSoA &edges = m_edges;
+
+	// Bucket the query points by their grid cells, so that the queries of neighbor points share the cached edges.
+	// Points outside of the grid are assigned to the closest boundary cell.
+	std::vector<size_t> point_cells(pts.size());
+	std::vector<size_t> bucket_starts(m_cells.size() + 1, 0);
+	for (size_t i = 0; i < pts.size(); ++ i) {
+		const coord_t c = std::clamp<coord_t>((pts[i].x() - m_bbox.min.x()) / m_resolution, 0, coord_t(m_cols) - 1);
+		const coord_t r = std::clamp<coord_t>((pts[i].y() - m_bbox.min.y()) / m_resolution, 0, coord_t(m_rows) - 1);
+		point_cells[i] = size_t(r) * m_cols + size_t(c);
+		++ bucket_starts[point_cells[i] + 1];
+	}
+	std::partial_sum(bucket_starts.begin(), bucket_starts.end(), bucket_starts.begin());
+	std::vector<size_t> order(pts.size());
+	for (size_t i = 0; i < pts.size(); ++ i)
+		order[bucket_starts[point_cells[i]] ++] = i;
+
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, order.size()), [this, &pts, &out, &order, &edges, search_radius](const tbb::blocked_range<size_t> &range) {
+		for (size_t iorder = range.begin(); iorder < range.end(); ++ iorder) {
+			const size_t  ipt = order[iorder];
+			const Point  &pt  = pts[ipt];
+			// Cells of the search radius, the same as in closest_point_signed_distance().
+			const coord_t xmax = pt.x() - m_bbox.min.x() + search_radius;
+			const coord_t ymax = pt.y() - m_bbox.min.y() + search_radius;
+			if (xmax < 0 || ymax < 0)
+				continue;
+			const coord_t cmax = std::min<coord_t>(xmax / m_resolution, coord_t(m_cols) - 1);
+			const coord_t rmax = std::min<coord_t>(ymax / m_resolution, coord_t(m_rows) - 1);
+			const coord_t cmin = std::max<coord_t>(pt.x() - m_bbox.min.x() - search_radius, 0) / m_resolution;
+			const coord_t rmin = std::max<coord_t>(pt.y() - m_bbox.min.y() - search_radius, 0) / m_resolution;
+			double d_min      = double(search_radius);
+			int    sign_min   = 0;
+			double l2_seg_min = 1.;
+			double t_min      = 0.;
+			size_t idx_min    = size_t(-1);
+			for (coord_t r = rmin; r <= rmax; ++ r)
+				for (coord_t c = cmin; c <= cmax; ++ c) {
+					const Cell &cell = m_cells[r * m_cols + c];
+					for (size_t i = cell.begin; i < cell.end; ++ i) {
+						const int64_t px   = int64_t(pt.x()) - edges.x1[i];
+						const int64_t py   = int64_t(pt.y()) - edges.y1[i];
+						// dot(p2-p1, pt-p1)
+						const int64_t t_pt = edges.vx[i] * px + edges.vy[i] * py;
+						if (t_pt < 0) {
+							// Closest to p1, accepted inside the wedge between the previous and the next segment.
+							double dabs = sqrt(double(px * px + py * py));
+							if (dabs < d_min && edges.vx_prev[i] * px + edges.vy_prev[i] * py > 0) {
+								d_min    = dabs;
+								// Set the signum depending on whether the vertex is convex or reflex.
+								sign_min = (edges.vx_prev[i] * edges.vy[i] - edges.vy_prev[i] * edges.vx[i] > 0) ? 1 : -1;
+								t_min    = 0.;
+								idx_min  = i;
+							}
+						} else if (t_pt <= edges.l2[i]) {
+							// Closest to the segment. Closest to p2 is resolved by the segment starting with p2.
+							int64_t d_seg = edges.vy[i] * px - edges.vx[i] * py;
+							double  dabs  = std::abs(double(d_seg) / edges.len[i]);
+							if (dabs < d_min) {
+								d_min      = dabs;
+								sign_min   = (d_seg < 0) ? -1 : ((d_seg == 0) ? 0 : 1);
+								l2_seg_min = double(edges.l2[i]);
+								t_min      = double(t_pt);
+								idx_min    = i;
+							}
+						}
+					}
+				}
+			if (idx_min != size_t(-1)) {
+				ClosestPointResult &result = out[ipt];
+				result.contour_idx     = m_cell_data[idx_min].first;
+				result.start_point_idx = m_cell_data[idx_min].second;
+				result.distance        = d_min * sign_min;
+				result.t               = t_min / l2_seg_min;
+			}
+		}
+	});
+	return out;
+}
+
+std::vector<coordf_t> EdgeGrid::Grid::signed_distances(const Points &pts, coord_t search_radius) const
+{
+	std::vector<ClosestPointResult> closest = this->closest_points_signed_distance(pts, search_radius);
+	std::vector<coordf_t>           out(pts.size(), std::numeric_limits<coordf_t>::max());
+	for (size_t i = 0; i < pts.size(); ++ i)
+		if (closest[i].valid())
+			out[i] = closest[i].distance;
+		else if (! m_signed_distance_field.empty())
+			out[i] = signed_distance_bilinear(pts[i]);
+	return out;
+}
+
 Polygons EdgeGrid::Grid::contours_simplified(coord_t offset, bool fill_holes) const
 {
 	assert(std::abs(2 * offset) < m_resolution);
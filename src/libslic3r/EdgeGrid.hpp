@@ -156,6 +156,18 @@ public:
 	// Only call this function for closed contours!
 	bool signed_distance(const Point &pt, coord_t search_radius, coordf_t &result_min_dist) const;
 
+	// Copy the edges into the structure of arrays read by the batched queries below, in the order of the grid cells filled in by create().
+	// Call once after create(). Throws InvalidArgument if any of the contours is open.
+	void prepare_batched_queries();
+
+	// Batched variants of closest_point_signed_distance() and signed_distance(), prepare_batched_queries() has to be called first.
+	// The query points are bucketed by their grid cells and processed in parallel. Pays off for batches of thousands of points,
+	// the results are the same as of the single point queries.
+	// Distance is negative inside the contours, thus the signed distances also answer point in polygon queries.
+	std::vector<ClosestPointResult> closest_points_signed_distance(const Points &pts, coord_t search_radius) const;
+	// Distance to a point without any edge in search_radius and without m_signed_distance_field is std::numeric_limits<coordf_t>::max().
+	std::vector<coordf_t> signed_distances(const Points &pts, coord_t search_radius) const;
+
 	const BoundingBox& 	bbox() const { return m_bbox; }
 	const coord_t 		resolution() const { return m_resolution; }
 	const size_t		rows() const { return m_rows; }
@@ -370,6 +382,21 @@ protected:
 		size_t end;
 	};
 
+	// Edges of m_cell_data in a structure of arrays layout, thus the edges of a grid cell are stored in a contiguous block.
+	// The previous edge is stored with each edge to resolve the vertex wedges without looking up the contour.
+	struct EdgesSoA {
+		std::vector<int64_t> x1, y1;
+		std::vector<int64_t> vx, vy;
+		std::vector<int64_t> vx_prev, vy_prev;
+		std::vector<int64_t> l2;
+		std::vector<double>  len;
+
+		size_t size() const { return x1.size(); }
+		void   clear() { *this = EdgesSoA(); }
+		void   resize(size_t n);
+		void   set(size_t i, const Contour &contour, size_t ipt);
+	};
+
 	void create_from_m_contours(coord_t resolution);
 #if 0
 	bool line_cell_intersect(const Point &p1, const Point &p2, const Cell &cell);
@@ -405,6 +432,10 @@ protected:
 	// Full grid of cells.
 	std::vector<Cell> 							m_cells;
 
+	// m_cell_data in a structure of arrays layout for closest_points_signed_distance().
+	// Empty until prepare_batched_queries() is called.
+	EdgesSoA 									m_edges;
+
 	// Distance field derived from the edge grid, seed filled by the Danielsson chamfer metric.
 	// May be empty.
 	std::vector<float>							m_signed_distance_field;
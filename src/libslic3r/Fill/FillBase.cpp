@@ -1446,15 +1446,20 @@ BoundaryInfillGraph create_boundary_infill_graph(const Polylines &infill_ordered
             EdgeGrid::Grid grid;
             grid.set_bbox(bbox.inflated(SCALED_EPSILON));
             grid.create(boundary_src, coord_t(scale_(10.)));
-            intersection_points.reserve(infill_ordered.size() * 2);
-            for (const Polyline &pl : infill_ordered)
-                for (const Point *pt : { &pl.points.front(), &pl.points.back() }) {
-                    EdgeGrid::Grid::ClosestPointResult cp = grid.closest_point_signed_distance(*pt, coord_t(SCALED_EPSILON));
-                    if (cp.valid()) {
-                        // The infill end point shall lie on the contour.
-                        assert(cp.distance <= 3.);
-                        intersection_points.emplace_back(cp, (&pl - infill_ordered.data()) * 2 + (pt == &pl.points.front() ? 0 : 1));
-                    }
+            grid.prepare_batched_queries();
+            Points end_points;
+            end_points.reserve(infill_ordered.size() * 2);
+            for (const Polyline &pl : infill_ordered) {
+                end_points.emplace_back(pl.points.front());
+                end_points.emplace_back(pl.points.back());
+            }
+            std::vector<EdgeGrid::Grid::ClosestPointResult> closest = grid.closest_points_signed_distance(end_points, coord_t(SCALED_EPSILON));
+            intersection_points.reserve(end_points.size());
+            for (size_t i = 0; i < closest.size(); ++ i)
+                if (closest[i].valid()) {
+                    // The infill end point shall lie on the contour.
+                    assert(closest[i].distance <= 3.);
+                    intersection_points.emplace_back(closest[i], i);
                 }
             std::sort(intersection_points.begin(), intersection_points.end(), [](const std::pair<EdgeGrid::Grid::ClosestPointResult, size_t> &cp1, const std::pair<EdgeGrid::Grid::ClosestPointResult, size_t> &cp2) {
                 return   cp1.first.contour_idx < cp2.first.contour_idx ||
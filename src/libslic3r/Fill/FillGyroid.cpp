@@ -40,6 +40,10 @@ struct GyroidField
     float                  fy;
     float                  fz;
     float                  isoval = 0.0f;
+    // The field at a fixed z is a sum of products of functions of x and functions of y. Their values at the raster
+    // columns and rows are tabulated, so that sampling the raster does not evaluate any trigonometric function.
+    std::vector<float>     sin_x, cos_x, sin_y, cos_y;
+    float                  sin_z, cos_z;
 
     explicit GyroidField(const BoundingBox bb, const coordf_t z, const float period, const float omega = 1.0f)
         : size{bb.size()}, offs{bb.min}, z{z}
@@ -48,6 +52,26 @@ struct GyroidField
         fx = baseline;
         fy = baseline;
         fz = omega * baseline;
+        const float c = fz * float(z);
+        sin_z = std::sin(c);
+        cos_z = std::cos(c);
+        // The raster is sampled up to and including its size.
+        const size_t ncols = size_t(std::max<coordr_t>(0, to_coordr(size.x()))) + 1;
+        const size_t nrows = size_t(std::max<coordr_t>(0, to_coordr(size.y()))) + 1;
+        sin_x.reserve(ncols);
+        cos_x.reserve(ncols);
+        for (size_t col = 0; col < ncols; ++ col) {
+            const float a = fx * float(to_Pointf(Coord(0, long(col))).x());
+            sin_x.emplace_back(std::sin(a));
+            cos_x.emplace_back(std::cos(a));
+        }
+        sin_y.reserve(nrows);
+        cos_y.reserve(nrows);
+        for (size_t row = 0; row < nrows; ++ row) {
+            const float b = fy * float(to_Pointf(Coord(long(row), 0)).y());
+            sin_y.emplace_back(std::sin(b));
+            cos_y.emplace_back(std::cos(b));
+        }
     }
 
     float get_scalar(coordf_t x, coordf_t y, coordf_t z_arg) const
@@ -60,6 +84,8 @@ struct GyroidField
 
     float get_scalar(Coord p) const
     {
+        if (size_t(p.c) < sin_x.size() && size_t(p.r) < sin_y.size())
+            return sin_x[p.c] * cos_y[p.r] + sin_y[p.r] * cos_z + sin_z * cos_x[p.c];
         Pointf pf = to_Pointf(p);
         return get_scalar(pf.x(), pf.y(), z);
     }
@@ -239,7 +265,7 @@ static inline double compute_omega_factor(double density_adjusted, double line_s
     return std::clamp(raw, 1.0, 2.0);
 }
 
-static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height, GyroidWavePeriods &periods)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -264,9 +290,22 @@ static Polylines make_gyroid_waves(double gridZ, double density_adjusted, double
         std::swap(width,height);
     }
 
-    std::vector<Vec2d> one_period_odd = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance); // creates one period of the waves, so it doesn't have to be recalculated all the time
-    flip = !flip;                                                                   // even polylines are a bit shifted
-    std::vector<Vec2d> one_period_even = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+    // One period of the waves only depends on the width if the surface is narrower than a single period.
+    const double limit = std::min(2*M_PI, width);
+    if (periods.odd.empty() || periods.z_sin != z_sin || periods.z_cos != z_cos || periods.limit != limit || periods.tolerance != tolerance) {
+        // creates one period of the waves, so it doesn't have to be recalculated all the time
+        periods.odd       = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, flip, tolerance);
+        // even polylines are a bit shifted
+        periods.even      = make_one_period(width, scaleFactor, z_cos, z_sin, vertical, ! flip, tolerance);
+        periods.z_sin     = z_sin;
+        periods.z_cos     = z_cos;
+        periods.limit     = limit;
+        periods.tolerance = tolerance;
+        ++ periods.num_generated;
+    }
+    const std::vector<Vec2d> &one_period_odd  = periods.odd;
+    const std::vector<Vec2d> &one_period_even = periods.even;
+    flip = !flip;
     Polylines result;
 
     for (double y0 = lower_bound; y0 < upper_bound + EPSILON; y0 += M_PI) {
@@ -337,7 +376,8 @@ void FillGyroid::_fill_surface_single(
             density_adjusted,
             this->spacing,
             ceil(bb.size()(0) / distance) + 1.,
-            ceil(bb.size()(1) / distance) + 1.);
+            ceil(bb.size()(1) / distance) + 1.,
+            m_wave_periods);
 
         // The parametric generator produces wave coords relative to the grid origin;
         // shift them into absolute layer coords. The marching-squares branch above
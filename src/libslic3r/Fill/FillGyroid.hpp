@@ -1,12 +1,28 @@
 #ifndef slic3r_FillGyroid_hpp_
 #define slic3r_FillGyroid_hpp_
 
+#include <vector>
+
 #include "../libslic3r.h"
 
 #include "FillBase.hpp"
 
 namespace Slic3r {
 
+// One period of the odd and even parametric gyroid waves. The waves only depend on the layer z and the pattern density,
+// thus they are generated once for all the islands of a surface, which are filled by the same Fill instance.
+struct GyroidWavePeriods
+{
+    double              z_sin     { 0. };
+    double              z_cos     { 0. };
+    double              limit     { 0. };
+    double              tolerance { 0. };
+    std::vector<Vec2d>  odd;
+    std::vector<Vec2d>  even;
+    // Number of times the waves were generated.
+    size_t              num_generated { 0 };
+};
+
 class FillGyroid : public Fill
 {
 public:
@@ -27,6 +43,8 @@ public:
     // Gyroid upper resolution tolerance (mm^-2)
     static constexpr double PatternTolerance = 0.2;
 
+    const GyroidWavePeriods& wave_periods() const { return m_wave_periods; }
+
 
 protected:
     void _fill_surface_single(
@@ -35,6 +53,9 @@ protected:
         const std::pair<float, Point>   &direction, 
         ExPolygon                        expolygon,
         Polylines                       &polylines_out) override;
+
+private:
+    GyroidWavePeriods m_wave_periods;
 };
 
 } // namespace Slic3r
@@ -11,6 +11,8 @@
 #include <boost/static_assert.hpp>
 #include <boost/math/constants/constants.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include "../ClipperUtils.hpp"
 #include "../ExPolygon.hpp"
 #include "../Geometry.hpp"
@@ -764,7 +766,35 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
         segs[i].idx = i;
         segs[i].pos = x0 + i * line_spacing;
     }
-    // For each contour
+    auto vlines_range = [x0, line_spacing, n_vlines](coord_t l, coord_t r) {
+        return FillRectilinearScan::vlines_range(x0, line_spacing, n_vlines, l, r);
+    };
+
+    // First pass: Count the intersections of each vertical line to allocate them at once.
+    {
+        std::vector<int> num_intersections(n_vlines + 1, 0);
+        for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
+            const Points &contour = poly_with_offset.contour(iContour).points;
+            if (contour.size() < 2)
+                continue;
+            for (size_t iSegment = 0; iSegment < contour.size(); ++ iSegment) {
+                const Point &p1 = contour[iSegment == 0 ? contour.size() - 1 : iSegment - 1];
+                const Point &p2 = contour[iSegment];
+                auto [il, ir] = vlines_range(std::min(p1.x(), p2.x()), std::max(p1.x(), p2.x()));
+                if (il <= ir) {
+                    ++ num_intersections[il];
+                    -- num_intersections[ir + 1];
+                }
+            }
+        }
+        for (size_t i = 0, num = 0; i < n_vlines; ++ i) {
+            num += num_intersections[i];
+            segs[i].intersections.reserve(num);
+        }
+    }
+
+    // Second pass: Intersect each contour segment with the vertical lines it spans. The contour segments are swept
+    // across the vertical lines, the intersection position of the next line is stepped from the position of the previous line.
     for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
         const Points &contour = poly_with_offset.contour(iContour).points;
         if (contour.size() < 2)
@@ -780,19 +810,14 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
             if (l > r)
                 std::swap(l, r);
             // il, ir are the left / right indices of vertical lines intersecting a segment
-            int il = (l - x0) / line_spacing;
-            while (il * line_spacing + x0 < l)
-                ++ il;
-            il = std::max(int(0), il);
-            int ir = (r - x0 + line_spacing) / line_spacing;
-            while (ir * line_spacing + x0 > r)
-                -- ir;
-            ir = std::min(int(segs.size()) - 1, ir);
+            auto [il, ir] = vlines_range(l, r);
             if (il > ir)
                 // No vertical line intersects this segment.
                 continue;
             assert(il >= 0 && size_t(il) < segs.size());
             assert(ir >= 0 && size_t(ir) < segs.size());
+            // The intersection parameter 't' is a rational number with a non negative denominator, see SegmentVLinesStepper.
+            FillRectilinearScan::SegmentVLinesStepper stepper(p1, p2, line_spacing);
             for (int i = il; i <= ir; ++ i) {
                 coord_t this_x = segs[i].pos;
 				assert(this_x == i * line_spacing + x0);
@@ -823,19 +848,11 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
                     is.pos_p = p2.y();
                     is.pos_q = 1;
                 } else {
-                    // First calculate the intersection parameter 't' as a rational number with non negative denominator.
-                    if (p2.x() > p1.x()) {
-                        is.pos_p = this_x - p1.x();
-                        is.pos_q = p2.x() - p1.x();
-                    } else {
-                        is.pos_p = p1.x() - this_x;
-                        is.pos_q = p1.x() - p2.x();
-                    }
+                    // The segment end points lie on the first and last vertical lines only, thus the vertical lines
+                    // crossing the segment at a general position form a continuous run.
+                    is.pos_p = stepper.next_pos_p(this_x);
+                    is.pos_q = uint32_t(stepper.pos_q());
                     assert(is.pos_q > 1);
-                    assert(is.pos_p > 0 && is.pos_p < is.pos_q);
-                    // Make an intersection point from the 't'.
-                    is.pos_p *= int64_t(p2.y() - p1.y());
-                    is.pos_p += p1.y() * int64_t(is.pos_q);
                 }
                 // +-1 to take rounding into account.
                 assert(is.pos() + 1 >= std::min(p1.y(), p2.y()));
@@ -846,69 +863,72 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
     }
 
     // Sort the intersections along their segments, specify the intersection types.
-    for (size_t i_seg = 0; i_seg < segs.size(); ++ i_seg) {
-        SegmentedIntersectionLine &sil = segs[i_seg];
-        // Sort the intersection points using exact rational arithmetic.
-        std::sort(sil.intersections.begin(), sil.intersections.end());
-        // Assign the intersection types, remove duplicate or overlapping intersection points.
-        // When a loop vertex touches a vertical line, intersection point is generated for both segments.
-        // If such two segments are oriented equally, then one of them is removed.
-        // Otherwise the vertex is tangential to the vertical line and both segments are removed.
-        // The same rule applies, if the loop is pinched into a single point and this point touches the vertical line:
-        // The loop has a zero vertical size at the vertical line, therefore the intersection point is removed.
-        size_t j = 0;
-        for (size_t i = 0; i < sil.intersections.size(); ++ i) {
-            // What is the orientation of the segment at the intersection point?
-            SegmentIntersection       &is       = sil.intersections[i];
-            const size_t               iContour = is.iContour;
-            const Points              &contour  = poly_with_offset.contour(iContour).points;
-            const size_t               iSegment = is.iSegment;
-            const size_t               iPrev    = prev_idx_modulo(iSegment, contour);
-            const coord_t              dir      = contour[iSegment].x() - contour[iPrev].x();
-            const bool                 low      = dir > 0;
-            is.type = poly_with_offset.is_contour_outer(iContour) ?
-                (low ? SegmentIntersection::OUTER_LOW : SegmentIntersection::OUTER_HIGH) :
-                (low ? SegmentIntersection::INNER_LOW : SegmentIntersection::INNER_HIGH);
-            bool take_next = true;
-            if (j > 0) {
-                SegmentIntersection &is2 = sil.intersections[j - 1];
-                if (iContour == is2.iContour && is.pos_q == 1 && is2.pos_q == 1) {
-                    // Two successive intersection points on a vertical line with the same contour, both points are end points of their respective contour segments.
-                    if (is.pos_p == is2.pos_p) {
-                        // Two successive segments meet exactly at the vertical line.
-                        // Verify that the segments of sil.intersections[i] and sil.intersections[j-1] are adjoint.
-                        assert(iSegment == prev_idx_modulo(is2.iSegment, contour) || is2.iSegment == iPrev);
-                        assert(is.type == is2.type);
-                        // Two successive segments of the same direction (both to the right or both to the left)
-                        // meet exactly at the vertical line.
-                        // Remove the second intersection point.
-                        take_next = false;
-                    } else if (is.type == is2.type) {
-                        // Two non successive segments of the same direction (both to the right or both to the left)
-                        // meet exactly at the vertical line. That means there is a Z shaped path, where the center segment
-                        // of the Z shaped path is aligned with this vertical line.
-                        // Remove one of the intersection points while maximizing the vertical segment length.
-                        if (low) {
-                            // Remove the second intersection point, keep the first intersection point.
-                        } else {
-                            // Remove the first intersection point, keep the second intersection point.
-                            sil.intersections[j-1] = sil.intersections[i];
+    // The vertical lines are independent, large regions sort them in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, segs.size(), 64), [&segs, &poly_with_offset](const tbb::blocked_range<size_t> &range) {
+        for (size_t i_seg = range.begin(); i_seg < range.end(); ++ i_seg) {
+            SegmentedIntersectionLine &sil = segs[i_seg];
+            // Sort the intersection points using exact rational arithmetic.
+            std::sort(sil.intersections.begin(), sil.intersections.end());
+            // Assign the intersection types, remove duplicate or overlapping intersection points.
+            // When a loop vertex touches a vertical line, intersection point is generated for both segments.
+            // If such two segments are oriented equally, then one of them is removed.
+            // Otherwise the vertex is tangential to the vertical line and both segments are removed.
+            // The same rule applies, if the loop is pinched into a single point and this point touches the vertical line:
+            // The loop has a zero vertical size at the vertical line, therefore the intersection point is removed.
+            size_t j = 0;
+            for (size_t i = 0; i < sil.intersections.size(); ++ i) {
+                // What is the orientation of the segment at the intersection point?
+                SegmentIntersection       &is       = sil.intersections[i];
+                const size_t               iContour = is.iContour;
+                const Points              &contour  = poly_with_offset.contour(iContour).points;
+                const size_t               iSegment = is.iSegment;
+                const size_t               iPrev    = prev_idx_modulo(iSegment, contour);
+                const coord_t              dir      = contour[iSegment].x() - contour[iPrev].x();
+                const bool                 low      = dir > 0;
+                is.type = poly_with_offset.is_contour_outer(iContour) ?
+                    (low ? SegmentIntersection::OUTER_LOW : SegmentIntersection::OUTER_HIGH) :
+                    (low ? SegmentIntersection::INNER_LOW : SegmentIntersection::INNER_HIGH);
+                bool take_next = true;
+                if (j > 0) {
+                    SegmentIntersection &is2 = sil.intersections[j - 1];
+                    if (iContour == is2.iContour && is.pos_q == 1 && is2.pos_q == 1) {
+                        // Two successive intersection points on a vertical line with the same contour, both points are end points of their respective contour segments.
+                        if (is.pos_p == is2.pos_p) {
+                            // Two successive segments meet exactly at the vertical line.
+                            // Verify that the segments of sil.intersections[i] and sil.intersections[j-1] are adjoint.
+                            assert(iSegment == prev_idx_modulo(is2.iSegment, contour) || is2.iSegment == iPrev);
+                            assert(is.type == is2.type);
+                            // Two successive segments of the same direction (both to the right or both to the left)
+                            // meet exactly at the vertical line.
+                            // Remove the second intersection point.
+                            take_next = false;
+                        } else if (is.type == is2.type) {
+                            // Two non successive segments of the same direction (both to the right or both to the left)
+                            // meet exactly at the vertical line. That means there is a Z shaped path, where the center segment
+                            // of the Z shaped path is aligned with this vertical line.
+                            // Remove one of the intersection points while maximizing the vertical segment length.
+                            if (low) {
+                                // Remove the second intersection point, keep the first intersection point.
+                            } else {
+                                // Remove the first intersection point, keep the second intersection point.
+                                sil.intersections[j-1] = sil.intersections[i];
+                            }
+                            take_next = false;
                         }
-                        take_next = false;
                     }
                 }
+                if (take_next) {
+                    // Vertical line intersects a contour segment at a general position (not at one of its end points).
+                    if (j < i)
+                        sil.intersections[j] = sil.intersections[i];
+                    ++ j;
+                }
             }
-            if (take_next) {
-                // Vertical line intersects a contour segment at a general position (not at one of its end points).
-                if (j < i)
-                    sil.intersections[j] = sil.intersections[i];
-                ++ j;
-            }
+            // Shrink the list of intersections, if any of the intersection was removed during the classification.
+            if (j < sil.intersections.size())
+                sil.intersections.erase(sil.intersections.begin() + j, sil.intersections.end());
         }
-        // Shrink the list of intersections, if any of the intersection was removed during the classification.
-        if (j < sil.intersections.size())
-            sil.intersections.erase(sil.intersections.begin() + j, sil.intersections.end());
-    }
+    });
 
     // Verify the segments. If something is wrong, give up.
 #ifdef INFILL_DEBUG_OUTPUT
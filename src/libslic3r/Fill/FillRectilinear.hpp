@@ -227,6 +227,61 @@ Points sample_grid_pattern(const ExPolygon &expolygon, coord_t spacing, const Bo
 Points sample_grid_pattern(const ExPolygons &expolygons, coord_t spacing, const BoundingBox &global_bounding_box);
 Points sample_grid_pattern(const Polygons &polygons, coord_t spacing, const BoundingBox &global_bounding_box);
 
+// Scan conversion of a contour by the vertical infill lines x0 + i * line_spacing, i = <0, n_vlines).
+// Used by slice_region_by_vertical_lines(), exported for unit tests.
+namespace FillRectilinearScan {
+
+// Indices of the first and last vertical lines intersecting a contour segment spanning <l, r> along the x axis:
+// first = ceil((l - x0) / line_spacing), last = floor((r - x0) / line_spacing), clamped to the vertical lines.
+// No vertical line intersects the segment if first > last.
+inline std::pair<int, int> vlines_range(coord_t x0, coord_t line_spacing, size_t n_vlines, coord_t l, coord_t r)
+{
+    const int64_t dl = int64_t(l) - x0;
+    const int64_t dr = int64_t(r) - x0;
+    int64_t il = dl > 0 ? (dl + line_spacing - 1) / line_spacing : - (- dl / line_spacing);
+    int64_t ir = dr >= 0 ? dr / line_spacing : - ((- dr + line_spacing - 1) / line_spacing);
+    return std::make_pair(int(std::max<int64_t>(0, il)), int(std::min<int64_t>(int64_t(n_vlines) - 1, ir)));
+}
+
+// Intersections of a contour segment p1, p2 with consecutive vertical lines crossing the segment at a general position.
+// The intersection is a rational number pos_p / pos_q with a non negative denominator pos_q = |dx|.
+// The intersection point y * pos_q is linear in x, it is stepped by line_spacing * dy from one vertical line to the next.
+class SegmentVLinesStepper
+{
+public:
+    SegmentVLinesStepper(const Point &p1, const Point &p2, coord_t line_spacing) :
+        m_p1(p1),
+        m_forward(p2.x() > p1.x()),
+        m_q(m_forward ? int64_t(p2.x()) - p1.x() : int64_t(p1.x()) - p2.x()),
+        m_dy(int64_t(p2.y()) - p1.y()),
+        m_step((m_forward ? int64_t(line_spacing) : - int64_t(line_spacing)) * m_dy) {}
+
+    // Numerator of the intersection with the vertical line at this_x. The first call evaluates the intersection,
+    // the following calls step it, thus they have to be made for the vertical lines following this_x of the first call.
+    int64_t next_pos_p(coord_t this_x) {
+        if (m_pos_valid)
+            m_pos_p += m_step;
+        else {
+            m_pos_p     = (m_forward ? int64_t(this_x) - m_p1.x() : int64_t(m_p1.x()) - this_x) * m_dy + int64_t(m_p1.y()) * m_q;
+            m_pos_valid = true;
+        }
+        return m_pos_p;
+    }
+    // Denominator of the intersections.
+    int64_t pos_q() const { return m_q; }
+
+private:
+    Point   m_p1;
+    bool    m_forward;
+    int64_t m_q;
+    int64_t m_dy;
+    int64_t m_step;
+    int64_t m_pos_p     { 0 };
+    bool    m_pos_valid { false };
+};
+
+} // namespace FillRectilinearScan
+
 } // namespace Slic3r
 
 #endif // slic3r_FillRectilinear_hpp_
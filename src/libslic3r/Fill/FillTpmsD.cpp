@@ -18,7 +18,7 @@ static double scaled_floor(double x,double scale){
 	return std::floor(x/scale)*scale;
 }
 
-static Polylines make_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height)
+static Polylines make_waves(double gridZ, double density_adjusted, double line_spacing, double width, double height, TpmsDWavePeriod &period)
 {
     const double scaleFactor = scale_(line_spacing) / density_adjusted;
 
@@ -52,12 +52,14 @@ static Polylines make_waves(double gridZ, double density_adjusted, double line_s
 		std::swap(minU,minV);
 		std::swap(maxU,maxV);
 	}
-	std::vector<std::pair<double,double>> wave;
-	{//fill one wave
+	if (period.wave.empty() || period.a != a || period.b != b || period.tolerance != tolerance) {
+		//fill one wave from u = 0, it is shifted to the start of the pattern and reused by the following islands of the same surface
+		std::vector<std::pair<double,double>> &wave = period.wave;
+		wave.clear();
 		const auto v=[&](double u){return acos(a/b*cos(u));};
 		const int initialSegments=16;
 		for(int c=0;c<=initialSegments;++c){
-			const double u=minU+2*M_PI*c/initialSegments;
+			const double u=2*M_PI*c/initialSegments;
 			wave.emplace_back(u,v(u));
 		}
 		{//refine
@@ -75,6 +77,17 @@ static Polylines make_waves(double gridZ, double density_adjusted, double line_s
 					++current;
 			}
 		}
+		period.a         = a;
+		period.b         = b;
+		period.tolerance = tolerance;
+		++ period.num_generated;
+	}
+	std::vector<std::pair<double,double>> wave;
+	{//repeat the wave from the period containing the start of the pattern up to its end
+		const double uShift=scaled_floor(minU,2*M_PI);
+		wave.reserve(period.wave.size());
+		for(const auto &pair:period.wave)
+			wave.emplace_back(pair.first+uShift,pair.second);
 		for(int c=1;c<int(wave.size()) && wave.back().first<maxU;++c)//we start from 1 because the 0-th one is already duplicated as the last one in a period
 			wave.emplace_back(wave[c].first+2*M_PI,wave[c].second);
 	}
@@ -124,7 +137,8 @@ void FillTpmsD::_fill_surface_single(
         density_adjusted,
         this->spacing,
         ceil(bb.size()(0) / distance) + 1.,
-        ceil(bb.size()(1) / distance) + 1.);
+        ceil(bb.size()(1) / distance) + 1.,
+        m_wave_period);
 
 	// shift the polyline to the grid origin
 	for (Polyline &pl : polylines)
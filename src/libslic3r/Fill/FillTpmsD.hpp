@@ -2,6 +2,7 @@
 #define slic3r_FillTpmsD_hpp_
 
 #include <utility>
+#include <vector>
 
 #include "libslic3r/libslic3r.h"
 #include "FillBase.hpp"
@@ -11,6 +12,18 @@
 namespace Slic3r {
 class Point;
 
+// One period of the wave of the TPMS-D pattern starting at u = 0, refined to the pattern tolerance. The wave only depends
+// on the layer z and the pattern density, thus it is shared by the islands of a surface filled by the same Fill instance.
+struct TpmsDWavePeriod
+{
+    double                                 a         { 0. };
+    double                                 b         { 0. };
+    double                                 tolerance { 0. };
+    std::vector<std::pair<double, double>> wave;
+    // Number of times the wave was generated.
+    size_t                                 num_generated { 0 };
+};
+
 class FillTpmsD : public Fill
 {
 public:
@@ -39,6 +52,10 @@ public:
     // Gyroid upper resolution tolerance (mm^-2)
     static constexpr double PatternTolerance = 0.1;
 
+    const TpmsDWavePeriod& wave_period() const { return m_wave_period; }
+
+private:
+    TpmsDWavePeriod m_wave_period;
 };
 
 } // namespace Slic3r
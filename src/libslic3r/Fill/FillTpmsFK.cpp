@@ -26,10 +26,40 @@ struct ScalarField
     coordf_t               z;                                    // z offset as a float.
     float                  freq;                                 // field frequency in cycles per mm.
     float                  isoval = 0.0;                         // iso value threshold to use.
+    // Values of the x and y terms of the equation at the raster columns and rows, and of the z terms at the field z.
+    std::vector<float>     cos_2x, sin_x, cos_x, cos_2y, sin_y, cos_y;
+    float                  cos_2z, sin_z, cos_z;
 
     explicit ScalarField(const BoundingBox bb, const coordf_t z = 0.0, const float period = 10.0)
         : size{bb.size()}, offs{bb.min}, z{z}, freq{float(2 * PI) / period}
-    {}
+    {
+        const float fz = freq * z;
+        cos_2z = cosf(2 * fz);
+        sin_z  = sinf(fz);
+        cos_z  = cosf(fz);
+        // Tabulate the x and y terms, so that sampling the raster does not evaluate any trigonometric function.
+        // The raster is sampled up to and including its size.
+        const size_t ncols = size_t(std::max<coordr_t>(0, to_coordr(size.x()))) + 1;
+        const size_t nrows = size_t(std::max<coordr_t>(0, to_coordr(size.y()))) + 1;
+        cos_2x.reserve(ncols);
+        sin_x.reserve(ncols);
+        cos_x.reserve(ncols);
+        for (size_t col = 0; col < ncols; ++ col) {
+            const float fx = freq * to_Pointf(Coord(0, long(col))).x();
+            cos_2x.emplace_back(cosf(2 * fx));
+            sin_x.emplace_back(sinf(fx));
+            cos_x.emplace_back(cosf(fx));
+        }
+        cos_2y.reserve(nrows);
+        sin_y.reserve(nrows);
+        cos_y.reserve(nrows);
+        for (size_t row = 0; row < nrows; ++ row) {
+            const float fy = freq * to_Pointf(Coord(long(row), 0)).y();
+            cos_2y.emplace_back(cosf(2 * fy));
+            sin_y.emplace_back(sinf(fy));
+            cos_y.emplace_back(cosf(fy));
+        }
+    }
 
     // Get the scalar field value at x,y,z in coordf_t coordinates.
     float get_scalar(coordf_t x, coordf_t y, coordf_t z) const
@@ -46,6 +76,8 @@ struct ScalarField
     // Get the scalar field value at a Coord for the current z value.
     float get_scalar(Coord p) const
     {
+        if (size_t(p.c) < sin_x.size() && size_t(p.r) < sin_y.size())
+            return cos_2x[p.c] * sin_y[p.r] * cos_z + cos_2y[p.r] * sin_z * cos_x[p.c] + cos_2z * sin_x[p.c] * cos_y[p.r];
         Pointf pf = to_Pointf(p);
         return get_scalar(pf.x(), pf.y(), z);
     }
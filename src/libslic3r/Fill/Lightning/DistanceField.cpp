@@ -35,12 +35,14 @@ void export_distance_field_to_svg(const std::string &path, const Polygons &outli
 }
 #endif
 
-DistanceField::DistanceField(const coord_t& radius, const Polygons& current_outline, const BoundingBox& current_outlines_bbox, const Polygons& current_overhang) :
-    m_cell_size(radius / radius_per_cell_size),
-    m_supporting_radius(radius),
-    m_unsupported_points_bbox(current_outlines_bbox)
+void DistanceField::initialize(const coord_t& radius, const Polygons& current_outline, const BoundingBox& current_outlines_bbox, const Polygons& current_overhang)
 {
-    m_supporting_radius2 = Slic3r::sqr(int64_t(radius));
+    m_cell_size               = radius / radius_per_cell_size;
+    m_supporting_radius       = radius;
+    m_supporting_radius2      = Slic3r::sqr(int64_t(radius));
+    m_unsupported_points_bbox = current_outlines_bbox;
+    // Keep the capacity of the cells allocated for the layer above.
+    m_unsupported_points.clear();
     // Sample source polygons with a regular grid sampling pattern.
     const BoundingBox overhang_bbox = get_extents(current_overhang);
     ExPolygons expolys = offset2_ex(union_ex(current_overhang), -m_cell_size / 2, m_cell_size / 2); // remove dangling lines which causes sample_grid_pattern crash (fails the OUTER_LOW assertions)
@@ -76,8 +78,7 @@ DistanceField::DistanceField(const coord_t& radius, const Polygons& current_outl
                (PointHash{}(a.loc) % prime_for_hash) < (PointHash{}(b.loc) % prime_for_hash);
         });
 
-    m_unsupported_points_erased.resize(m_unsupported_points.size());
-    std::fill(m_unsupported_points_erased.begin(), m_unsupported_points_erased.end(), false);
+    m_unsupported_points_erased.assign(m_unsupported_points.size(), false);
 
     m_unsupported_points_grid.initialize(m_unsupported_points, [&self = std::as_const(*this)](const Point &p) -> Point { return self.to_grid_point(p); });
 
@@ -24,15 +24,18 @@ namespace Slic3r::FillLightning
 class DistanceField
 {
 public:
+    DistanceField() = default;
+
     /*!
-     * Construct a new field to calculate Lightning Infill with.
+     * Initialize the field to calculate Lightning Infill of a single layer with.
+     * The field is reinitialized for each layer, reusing the memory of the cells and of their grid.
      * \param radius The radius of influence that an infill line is expected to
      * support in the layer above.
      * \param current_outline The total infill area on this layer.
      * \param current_overhang The overhang that needs to be supported on this
      * layer.
      */
-    DistanceField(const coord_t& radius, const Polygons& current_outline, const BoundingBox& current_outlines_bbox, const Polygons& current_overhang);
+    void initialize(const coord_t& radius, const Polygons& current_outline, const BoundingBox& current_outlines_bbox, const Polygons& current_overhang);
     
     /*!
      * Gets the next unsupported location to be supported by a new branch.
@@ -100,7 +103,7 @@ protected:
     /*!
      * BoundingBox of all points in m_unsupported_points. Used for mapping of sign integer numbers to positive integer numbers.
      */
-    const BoundingBox          m_unsupported_points_bbox;
+    BoundingBox                m_unsupported_points_bbox;
 
     /*!
      * Links the unsupported points to a grid point, so that we can quickly look
@@ -113,8 +116,14 @@ protected:
         UnsupportedPointsGrid() = default;
         void initialize(const std::vector<UnsupportedCell> &unsupported_points, const std::function<Point(const Point &)> &map_cell_to_grid)
         {
-            if (unsupported_points.empty())
+            if (unsupported_points.empty()) {
+                m_size       = 0;
+                m_grid_range = BoundingBox();
+                m_grid_size  = Point::Zero();
+                m_data.clear();
+                m_data_erased.clear();
                 return;
+            }
 
             BoundingBox unsupported_points_bbox;
             for (const UnsupportedCell &cell : unsupported_points)
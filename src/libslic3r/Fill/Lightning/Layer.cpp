@@ -21,10 +21,10 @@ coord_t Layer::getWeightedDistance(const Point& boundary_loc, const Point& unsup
     return coord_t((boundary_loc - unsupported_location).cast<double>().norm());
 }
 
-Point GroundingLocation::p() const
+Point GroundingLocation::p(const NodePool &nodes) const
 {
-    assert(tree_node || boundary_location);
-    return tree_node ? tree_node->getLocation() : *boundary_location;
+    assert(tree_node != invalid_node_idx || boundary_location);
+    return tree_node != invalid_node_idx ? nodes.getLocation(tree_node) : *boundary_location;
 }
 
 inline static Point to_grid_point(const Point &point, const BoundingBox &bbox)
@@ -34,15 +34,16 @@ inline static Point to_grid_point(const Point &point, const BoundingBox &bbox)
 
 void Layer::fillLocator(SparseNodeGrid &tree_node_locator, const BoundingBox& current_outlines_bbox)
 {
-    std::function<void(NodeSPtr)> add_node_to_locator_func = [&tree_node_locator, &current_outlines_bbox](const NodeSPtr &node) {
-        tree_node_locator.insert(std::make_pair(to_grid_point(node->getLocation(), current_outlines_bbox), node));
+    std::function<void(NodeIdx)> add_node_to_locator_func = [this, &tree_node_locator, &current_outlines_bbox](NodeIdx node) {
+        tree_node_locator.insert(std::make_pair(to_grid_point(nodes.getLocation(node), current_outlines_bbox), node));
     };
-    for (auto& tree : tree_roots)
-        tree->visitNodes(add_node_to_locator_func);
+    for (NodeIdx tree : tree_roots)
+        nodes.visitNodes(tree, add_node_to_locator_func);
 }
 
 void Layer::generateNewTrees
 (
+    DistanceField& distance_field,
     const Polygons& current_overhang,
     const Polygons& current_outlines,
     const BoundingBox& current_outlines_bbox,
@@ -52,7 +53,7 @@ void Layer::generateNewTrees
     const std::function<void()> &throw_on_cancel_callback
 )
 {
-    DistanceField distance_field(supporting_radius, current_outlines, current_outlines_bbox, current_overhang);
+    distance_field.initialize(supporting_radius, current_outlines, current_outlines_bbox, current_overhang);
     throw_on_cancel_callback();
 
     SparseNodeGrid tree_node_locator;
@@ -67,20 +68,20 @@ void Layer::generateNewTrees
         GroundingLocation grounding_loc = getBestGroundingLocation(
             unsupported_location, current_outlines, current_outlines_bbox, outlines_locator, supporting_radius, wall_supporting_radius, tree_node_locator);
 
-        NodeSPtr new_parent;
-        NodeSPtr new_child;
+        NodeIdx new_parent = invalid_node_idx;
+        NodeIdx new_child;
         this->attach(unsupported_location, grounding_loc, new_child, new_parent);
-        tree_node_locator.insert(std::make_pair(to_grid_point(new_child->getLocation(), current_outlines_bbox), new_child));
-        if (new_parent)
-            tree_node_locator.insert(std::make_pair(to_grid_point(new_parent->getLocation(), current_outlines_bbox), new_parent));
+        tree_node_locator.insert(std::make_pair(to_grid_point(nodes.getLocation(new_child), current_outlines_bbox), new_child));
+        if (new_parent != invalid_node_idx)
+            tree_node_locator.insert(std::make_pair(to_grid_point(nodes.getLocation(new_parent), current_outlines_bbox), new_parent));
         // update distance field
-        distance_field.update(grounding_loc.p(), unsupported_location);
+        distance_field.update(grounding_loc.p(nodes), unsupported_location);
     }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
     {
         static int iRun = 0;
-        export_to_svg(debug_out_path("FillLightning-TreeNodes-%d.svg", iRun++), current_outlines, this->tree_roots);
+        export_to_svg(debug_out_path("FillLightning-TreeNodes-%d.svg", iRun++), current_outlines, this->nodes, this->tree_roots);
     }
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 }
@@ -123,7 +124,7 @@ GroundingLocation Layer::getBestGroundingLocation
     const coord_t supporting_radius,
     const coord_t wall_supporting_radius,
     const SparseNodeGrid& tree_node_locator,
-    const NodeSPtr& exclude_tree
+    const NodeIdx exclude_tree
 )
 {
     // Closest point on current_outlines to unsupported_location:
@@ -146,7 +147,7 @@ GroundingLocation Layer::getBestGroundingLocation
 
     const auto within_dist = coord_t((node_location - unsupported_location).cast<double>().norm());
 
-    NodeSPtr sub_tree{nullptr};
+    NodeIdx  sub_tree{invalid_node_idx};
     coord_t  current_dist = getWeightedDistance(node_location, unsupported_location);
     if (current_dist >= wall_supporting_radius) { // Only reconnect tree roots to other trees if they are not already close to the outlines.
         const coord_t search_radius = std::min(current_dist, within_dist);
@@ -156,19 +157,18 @@ GroundingLocation Layer::getBestGroundingLocation
 
         Point      current_dist_grid_addr{std::numeric_limits<coord_t>::lowest(), std::numeric_limits<coord_t>::lowest()};
         std::mutex current_dist_mutex;
-        tbb::parallel_for(tbb::blocked_range2d<coord_t>(region.min.y(), region.max.y(), region.min.x(), region.max.x()), [&current_dist, current_dist_copy = current_dist, &current_dist_mutex, &sub_tree, &current_dist_grid_addr, &exclude_tree = std::as_const(exclude_tree), &outline_locator = std::as_const(outline_locator), &supporting_radius = std::as_const(supporting_radius), &tree_node_locator = std::as_const(tree_node_locator), &unsupported_location = std::as_const(unsupported_location)](const tbb::blocked_range2d<coord_t> &range) -> void {
+        tbb::parallel_for(tbb::blocked_range2d<coord_t>(region.min.y(), region.max.y(), region.min.x(), region.max.x()), [&current_dist, current_dist_copy = current_dist, &current_dist_mutex, &sub_tree, &current_dist_grid_addr, exclude_tree, &nodes = std::as_const(nodes), &outline_locator = std::as_const(outline_locator), &supporting_radius = std::as_const(supporting_radius), &tree_node_locator = std::as_const(tree_node_locator), &unsupported_location = std::as_const(unsupported_location)](const tbb::blocked_range2d<coord_t> &range) -> void {
             for (coord_t grid_addr_y = range.rows().begin(); grid_addr_y < range.rows().end(); ++grid_addr_y)
                 for (coord_t grid_addr_x = range.cols().begin(); grid_addr_x < range.cols().end(); ++grid_addr_x) {
                     const Point local_grid_addr{grid_addr_x, grid_addr_y};
-                    NodeSPtr    local_sub_tree{nullptr};
+                    NodeIdx     local_sub_tree{invalid_node_idx};
                     coord_t     local_current_dist = current_dist_copy;
                     const auto  it_range           = tree_node_locator.equal_range(local_grid_addr);
                     for (auto it = it_range.first; it != it_range.second; ++it) {
-                        const NodeSPtr candidate_sub_tree = it->second.lock();
-                        if ((candidate_sub_tree && candidate_sub_tree != exclude_tree) &&
-                            !(exclude_tree && exclude_tree->hasOffspring(candidate_sub_tree)) &&
-                            !polygonCollidesWithLineSegment(unsupported_location, candidate_sub_tree->getLocation(), outline_locator)) {
-                            if (const coord_t candidate_dist = candidate_sub_tree->getWeightedDistance(unsupported_location, supporting_radius); candidate_dist < local_current_dist) {
+                        const NodeIdx candidate_sub_tree = it->second;
+                        if (!(exclude_tree != invalid_node_idx && nodes.hasOffspring(exclude_tree, candidate_sub_tree)) &&
+                            !polygonCollidesWithLineSegment(unsupported_location, nodes.getLocation(candidate_sub_tree), outline_locator)) {
+                            if (const coord_t candidate_dist = nodes.getWeightedDistance(candidate_sub_tree, unsupported_location, supporting_radius); candidate_dist < local_current_dist) {
                                 local_current_dist = candidate_dist;
                                 local_sub_tree     = candidate_sub_tree;
                             }
@@ -194,32 +194,32 @@ GroundingLocation Layer::getBestGroundingLocation
         }); // end of parallel_for
     }
 
-    return ! sub_tree ?
-        GroundingLocation{ nullptr, node_location } :
+    return sub_tree == invalid_node_idx ?
+        GroundingLocation{ invalid_node_idx, node_location } :
         GroundingLocation{ sub_tree, std::optional<Point>() };
 }
 
 bool Layer::attach(
     const Point& unsupported_location,
     const GroundingLocation& grounding_loc,
-    NodeSPtr& new_child,
-    NodeSPtr& new_root)
+    NodeIdx& new_child,
+    NodeIdx& new_root)
 {
     // Update trees & distance fields.
     if (grounding_loc.boundary_location) {
-        new_root = Node::create(grounding_loc.p(), std::make_optional(grounding_loc.p()));
-        new_child = new_root->addChild(unsupported_location);
+        new_root = nodes.addNode(*grounding_loc.boundary_location, grounding_loc.boundary_location);
+        new_child = nodes.addChild(new_root, unsupported_location);
         tree_roots.push_back(new_root);
         return true;
     } else {
-        new_child = grounding_loc.tree_node->addChild(unsupported_location);
+        new_child = nodes.addChild(grounding_loc.tree_node, unsupported_location);
         return false;
     }
 }
 
 void Layer::reconnectRoots
 (
-    std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+    const std::vector<NodeIdx>& to_be_reconnected_tree_roots,
     const Polygons& current_outlines,
     const BoundingBox& current_outlines_bbox,
     const EdgeGrid::Grid& outline_locator,
@@ -233,25 +233,25 @@ void Layer::reconnectRoots
     fillLocator(tree_node_locator, current_outlines_bbox);
 
     const coord_t within_max_dist = outline_locator.resolution() * 2;
-    for (const auto &root_ptr : to_be_reconnected_tree_roots)
+    for (const NodeIdx root_idx : to_be_reconnected_tree_roots)
     {
-        auto old_root_it = std::find(tree_roots.begin(), tree_roots.end(), root_ptr);
+        auto old_root_it = std::find(tree_roots.begin(), tree_roots.end(), root_idx);
 
-        if (root_ptr->getLastGroundingLocation())
+        if (const std::optional<Point> &last_grounding_location = nodes[root_idx].last_grounding_location; last_grounding_location)
         {
-            const Point& ground_loc = *root_ptr->getLastGroundingLocation();
-            if (ground_loc != root_ptr->getLocation())
+            const Point ground_loc = *last_grounding_location;
+            if (ground_loc != nodes.getLocation(root_idx))
             {
                 Point new_root_pt;
-                // Find an intersection of the line segment from root_ptr->getLocation() to ground_loc, at within_max_dist from ground_loc.
-                if (lineSegmentPolygonsIntersection(root_ptr->getLocation(), ground_loc, outline_locator, new_root_pt, within_max_dist)) {
-                    auto new_root = Node::create(new_root_pt, new_root_pt);
-                    root_ptr->addChild(new_root);
-                    new_root->reroot();
+                // Find an intersection of the line segment from root_idx location to ground_loc, at within_max_dist from ground_loc.
+                if (lineSegmentPolygonsIntersection(nodes.getLocation(root_idx), ground_loc, outline_locator, new_root_pt, within_max_dist)) {
+                    auto new_root = nodes.addNode(new_root_pt, new_root_pt);
+                    nodes.addChild(root_idx, new_root);
+                    nodes.reroot(new_root);
 
-                    tree_node_locator.insert(std::make_pair(to_grid_point(new_root->getLocation(), current_outlines_bbox), new_root));
+                    tree_node_locator.insert(std::make_pair(to_grid_point(nodes.getLocation(new_root), current_outlines_bbox), new_root));
 
-                    *old_root_it = std::move(new_root); // replace old root with new root
+                    *old_root_it = new_root; // replace old root with new root
                     continue;
                 }
             }
@@ -261,43 +261,43 @@ void Layer::reconnectRoots
         GroundingLocation ground =
             getBestGroundingLocation
             (
-                root_ptr->getLocation(),
+                nodes.getLocation(root_idx),
                 current_outlines,
                 current_outlines_bbox,
                 outline_locator,
                 supporting_radius,
                 tree_connecting_ignore_width,
                 tree_node_locator,
-                root_ptr
+                root_idx
             );
         if (ground.boundary_location)
         {
-            if (*ground.boundary_location == root_ptr->getLocation())
+            if (*ground.boundary_location == nodes.getLocation(root_idx))
                 continue; // Already on the boundary.
 
-            auto new_root = Node::create(ground.p(), ground.p());
-            auto attach_ptr = root_ptr->closestNode(new_root->getLocation());
-            attach_ptr->reroot();
+            auto new_root = nodes.addNode(*ground.boundary_location, ground.boundary_location);
+            auto attach_idx = nodes.closestNode(root_idx, nodes.getLocation(new_root));
+            nodes.reroot(attach_idx);
 
-            new_root->addChild(attach_ptr);
-            tree_node_locator.insert(std::make_pair(to_grid_point(new_root->getLocation(), current_outlines_bbox), new_root));
+            nodes.addChild(new_root, attach_idx);
+            tree_node_locator.insert(std::make_pair(to_grid_point(nodes.getLocation(new_root), current_outlines_bbox), new_root));
 
-            *old_root_it = std::move(new_root); // replace old root with new root
+            *old_root_it = new_root; // replace old root with new root
         }
         else
         {
-            assert(ground.tree_node);
-            assert(ground.tree_node != root_ptr);
-            assert(!root_ptr->hasOffspring(ground.tree_node));
-            assert(!ground.tree_node->hasOffspring(root_ptr));
+            assert(ground.tree_node != invalid_node_idx);
+            assert(ground.tree_node != root_idx);
+            assert(!nodes.hasOffspring(root_idx, ground.tree_node));
+            assert(!nodes.hasOffspring(ground.tree_node, root_idx));
 
-            auto attach_ptr = root_ptr->closestNode(ground.tree_node->getLocation());
-            attach_ptr->reroot();
+            auto attach_idx = nodes.closestNode(root_idx, nodes.getLocation(ground.tree_node));
+            nodes.reroot(attach_idx);
 
-            ground.tree_node->addChild(attach_ptr);
+            nodes.addChild(ground.tree_node, attach_idx);
 
             // remove old root
-            *old_root_it = std::move(tree_roots.back());
+            *old_root_it = tree_roots.back();
             tree_roots.pop_back();
         }
     }
@@ -433,14 +433,20 @@ static unsigned int moveInside(const Polygons& polygons, Point& from, int distan
 }
 #endif
 
+void Layer::propagateToNextLayer(Layer& layer_below, const Polygons& next_outlines, const EdgeGrid::Grid& outline_locator,
+                                 const coord_t prune_distance, const coord_t smooth_magnitude, const coord_t max_remove_colinear_dist) const
+{
+    nodes.propagateToNextLayer(tree_roots, layer_below.nodes, layer_below.tree_roots, next_outlines, outline_locator, prune_distance, smooth_magnitude, max_remove_colinear_dist);
+}
+
 Polylines Layer::convertToLines(const Polygons& limit_to_outline, const coord_t line_overlap) const
 {
     if (tree_roots.empty())
         return {};
 
     Polylines result_lines;
-    for (const auto &tree : tree_roots)
-        tree->convertToPolylines(result_lines, line_overlap);
+    for (NodeIdx tree : tree_roots)
+        nodes.convertToPolylines(tree, result_lines, line_overlap);
 
     return intersection_pl(result_lines, limit_to_outline);
 }
@@ -6,6 +6,7 @@
 
 #include "../../EdgeGrid.hpp"
 #include "../../Polygon.hpp"
+#include "TreeNode.hpp"
 
 #include <memory>
 #include <vector>
@@ -16,15 +17,14 @@
 namespace Slic3r::FillLightning
 {
 
-class Node;
-using NodeSPtr = std::shared_ptr<Node>;
-using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
+class DistanceField;
+using SparseNodeGrid = std::unordered_multimap<Point, NodeIdx, PointHash>;
 
 struct GroundingLocation
 {
-    NodeSPtr tree_node; //!< not null if the gounding location is on a tree
+    NodeIdx tree_node; //!< valid if the gounding location is on a tree
     std::optional<Point> boundary_location; //!< in case the gounding location is on the boundary
-    Point p() const;
+    Point p(const NodePool &nodes) const;
 };
 
 /*!
@@ -35,10 +35,12 @@ struct GroundingLocation
 class Layer
 {
 public:
-    std::vector<NodeSPtr> tree_roots;
+    NodePool             nodes;
+    std::vector<NodeIdx> tree_roots;
 
     void generateNewTrees
     (
+        DistanceField& distance_field,
         const Polygons& current_overhang,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
@@ -60,7 +62,7 @@ public:
         coord_t supporting_radius,
         coord_t wall_supporting_radius,
         const SparseNodeGrid& tree_node_locator,
-        const NodeSPtr& exclude_tree = nullptr
+        NodeIdx exclude_tree = invalid_node_idx
     );
 
     /*!
@@ -68,11 +70,11 @@ public:
      * \param[out] new_root The new root node if one had been made
      * \return Whether a new root was added
      */
-    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeSPtr& new_child, NodeSPtr& new_root);
+    bool attach(const Point& unsupported_location, const GroundingLocation& ground, NodeIdx& new_child, NodeIdx& new_root);
 
     void reconnectRoots
     (
-        std::vector<NodeSPtr>& to_be_reconnected_tree_roots,
+        const std::vector<NodeIdx>& to_be_reconnected_tree_roots,
         const Polygons& current_outlines,
         const BoundingBox& current_outlines_bbox,
         const EdgeGrid::Grid& outline_locator,
@@ -80,6 +82,12 @@ public:
         coord_t wall_supporting_radius
     );
 
+    /*!
+     * Initialize the trees of \p layer_below from the trees of this layer, see NodePool::propagateToNextLayer().
+     */
+    void propagateToNextLayer(Layer& layer_below, const Polygons& next_outlines, const EdgeGrid::Grid& outline_locator,
+                              coord_t prune_distance, coord_t smooth_magnitude, coord_t max_remove_colinear_dist) const;
+
     Polylines convertToLines(const Polygons& limit_to_outline, coord_t line_overlap) const;
 
     coord_t getWeightedDistance(const Point& boundary_loc, const Point& unsupported_location);
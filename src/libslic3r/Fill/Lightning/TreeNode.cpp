@@ -7,131 +7,177 @@
 
 namespace Slic3r::FillLightning {
 
-coord_t Node::getWeightedDistance(const Point& unsupported_location, const coord_t& supporting_radius) const
+coord_t NodePool::getWeightedDistance(NodeIdx idx, const Point& unsupported_location, const coord_t& supporting_radius) const
 {
     constexpr coord_t min_valence_for_boost = 0;
     constexpr coord_t max_valence_for_boost = 4;
     constexpr coord_t valence_boost_multiplier = 4;
 
-    const size_t valence = (!m_is_root) + m_children.size();
+    const Node   &node = (*this)[idx];
+    const size_t valence = (!node.isRoot()) + node.num_children;
     const coord_t valence_boost = (min_valence_for_boost < valence && valence < max_valence_for_boost) ? valence_boost_multiplier * supporting_radius : 0;
-    const auto dist_here = coord_t((getLocation() - unsupported_location).cast<double>().norm());
+    const auto dist_here = coord_t((node.p - unsupported_location).cast<double>().norm());
     return dist_here - valence_boost;
 }
 
-bool Node::hasOffspring(const NodeSPtr& to_be_checked) const
+bool NodePool::hasOffspring(NodeIdx idx, NodeIdx to_be_checked) const
 {
-    if (to_be_checked == shared_from_this())
-        return true;
-
-    for (auto& child_ptr : m_children)
-        if (child_ptr->hasOffspring(to_be_checked)) 
+    for (NodeIdx ancestor = to_be_checked; ancestor != invalid_node_idx; ancestor = (*this)[ancestor].parent)
+        if (ancestor == idx)
             return true;
-
     return false;
 }
 
-NodeSPtr Node::addChild(const Point& child_loc)
+NodeIdx NodePool::addNode(const Point &p, const std::optional<Point> &last_grounding_location)
 {
-    assert(m_p != child_loc);
-    NodeSPtr child = Node::create(child_loc);
-    return addChild(child);
+    assert(m_nodes.size() < size_t(invalid_node_idx));
+    m_nodes.emplace_back(p, last_grounding_location);
+    return NodeIdx(m_nodes.size() - 1);
 }
 
-NodeSPtr Node::addChild(NodeSPtr& new_child)
+NodeIdx NodePool::addChild(NodeIdx parent, const Point& child_loc)
 {
-    assert(new_child != shared_from_this());
+    assert((*this)[parent].p != child_loc);
+    return this->addChild(parent, this->addNode(child_loc));
+}
+
+NodeIdx NodePool::addChild(NodeIdx parent, NodeIdx new_child)
+{
+    assert(new_child != parent);
+    assert((*this)[new_child].isRoot() && (*this)[new_child].prev_sibling == invalid_node_idx && (*this)[new_child].next_sibling == invalid_node_idx);
     //assert(p != new_child->p); // NOTE: No problem for now. Issue to solve later. Maybe even afetr final. Low prio.
-    m_children.push_back(new_child);
-    new_child->m_parent = shared_from_this();
-    new_child->m_is_root = false;
+    Node &parent_node = (*this)[parent];
+    Node &child_node  = (*this)[new_child];
+    child_node.parent       = parent;
+    child_node.prev_sibling = parent_node.last_child;
+    if (parent_node.last_child == invalid_node_idx)
+        parent_node.first_child = new_child;
+    else
+        (*this)[parent_node.last_child].next_sibling = new_child;
+    parent_node.last_child = new_child;
+    ++ parent_node.num_children;
     return new_child;
 }
 
-void Node::propagateToNextLayer(
-    std::vector<NodeSPtr>& next_trees,
+void NodePool::detachChild(NodeIdx parent, NodeIdx child)
+{
+    Node &parent_node = (*this)[parent];
+    Node &child_node  = (*this)[child];
+    assert(child_node.parent == parent && parent_node.num_children > 0);
+    (child_node.prev_sibling == invalid_node_idx ? parent_node.first_child : (*this)[child_node.prev_sibling].next_sibling) = child_node.next_sibling;
+    (child_node.next_sibling == invalid_node_idx ? parent_node.last_child : (*this)[child_node.next_sibling].prev_sibling) = child_node.prev_sibling;
+    -- parent_node.num_children;
+    child_node.parent       = invalid_node_idx;
+    child_node.prev_sibling = invalid_node_idx;
+    child_node.next_sibling = invalid_node_idx;
+}
+
+void NodePool::propagateToNextLayer(
+    const std::vector<NodeIdx>& tree_roots,
+    NodePool& pool_below,
+    std::vector<NodeIdx>& next_trees,
     const Polygons& next_outlines,
     const EdgeGrid::Grid& outline_locator,
     const coord_t prune_distance,
     const coord_t smooth_magnitude,
     const coord_t max_remove_colinear_dist) const
 {
-    auto tree_below = deepCopy();
-    tree_below->prune(prune_distance);
-    tree_below->straighten(smooth_magnitude, max_remove_colinear_dist);
-    if (tree_below->realign(next_outlines, outline_locator, next_trees))
-        next_trees.push_back(tree_below);
+    // Copy all the trees at once, only the roots remember where they were grounded.
+    pool_below.m_nodes = m_nodes;
+    for (Node &node : pool_below.m_nodes)
+        node.last_grounding_location = node.isRoot() ? std::make_optional(node.last_grounding_location.value_or(node.p)) : std::nullopt;
+
+    for (NodeIdx tree_below : tree_roots) {
+        pool_below.prune(tree_below, prune_distance);
+        pool_below.straighten(tree_below, smooth_magnitude, max_remove_colinear_dist);
+        if (pool_below.realign(tree_below, next_outlines, outline_locator, next_trees))
+            next_trees.push_back(tree_below);
+    }
+
+    pool_below.compact(next_trees);
 }
 
-// NOTE: Depth-first, as currently implemented.
-//       Skips the root (because that has no root itself), but all initial nodes will have the root point anyway.
-void Node::visitBranches(const std::function<void(const Point&, const Point&)>& visitor) const
+void NodePool::compact(std::vector<NodeIdx>& tree_roots)
 {
-    for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
-        visitor(m_p, node->m_p);
-        node->visitBranches(visitor);
+    // Renumber the nodes reachable from the roots in depth-first pre-order.
+    std::vector<NodeIdx> new_idx(m_nodes.size(), invalid_node_idx);
+    std::vector<NodeIdx> old_idx;
+    old_idx.reserve(m_nodes.size());
+    std::vector<NodeIdx> stack;
+    for (NodeIdx root : tree_roots) {
+        stack.push_back(root);
+        while (! stack.empty()) {
+            const NodeIdx idx = stack.back();
+            stack.pop_back();
+            assert(new_idx[idx] == invalid_node_idx);
+            new_idx[idx] = NodeIdx(old_idx.size());
+            old_idx.push_back(idx);
+            for (NodeIdx child = m_nodes[idx].last_child; child != invalid_node_idx; child = m_nodes[child].prev_sibling)
+                stack.push_back(child);
+        }
+    }
+
+    auto remap = [&new_idx](NodeIdx idx) { return idx == invalid_node_idx ? invalid_node_idx : new_idx[idx]; };
+    std::vector<Node> nodes;
+    nodes.reserve(old_idx.size());
+    for (NodeIdx idx : old_idx) {
+        Node &node = nodes.emplace_back(std::move(m_nodes[idx]));
+        node.parent       = remap(node.parent);
+        node.first_child  = remap(node.first_child);
+        node.last_child   = remap(node.last_child);
+        node.prev_sibling = remap(node.prev_sibling);
+        node.next_sibling = remap(node.next_sibling);
     }
+    m_nodes = std::move(nodes);
+
+    for (NodeIdx &root : tree_roots)
+        root = new_idx[root];
 }
 
 // NOTE: Depth-first, as currently implemented.
-void Node::visitNodes(const std::function<void(NodeSPtr)>& visitor)
+//       Skips the root (because that has no root itself), but all initial nodes will have the root point anyway.
+void NodePool::visitBranches(NodeIdx idx, const std::function<void(const Point&, const Point&)>& visitor) const
 {
-    visitor(shared_from_this());
-    for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
-        node->visitNodes(visitor);
+    for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx; child = (*this)[child].next_sibling) {
+        assert((*this)[child].parent == idx);
+        visitor((*this)[idx].p, (*this)[child].p);
+        this->visitBranches(child, visitor);
     }
 }
 
-Node::Node(const Point& p, const std::optional<Point>& last_grounding_location /*= std::nullopt*/) : 
-    m_is_root(true), m_p(p), m_last_grounding_location(last_grounding_location)
-{}
-
-NodeSPtr Node::deepCopy() const
+// NOTE: Depth-first, as currently implemented.
+void NodePool::visitNodes(NodeIdx idx, const std::function<void(NodeIdx)>& visitor) const
 {
-    NodeSPtr local_root = Node::create(m_p);
-    local_root->m_is_root = m_is_root;
-    if (m_is_root)
-    {
-        local_root->m_last_grounding_location = m_last_grounding_location.value_or(m_p);
+    visitor(idx);
+    for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx; child = (*this)[child].next_sibling) {
+        assert((*this)[child].parent == idx);
+        this->visitNodes(child, visitor);
     }
-    local_root->m_children.reserve(m_children.size());
-    for (const auto& node : m_children)
-    {
-        NodeSPtr child = node->deepCopy();
-        child->m_parent = local_root;
-        local_root->m_children.push_back(child);
-    }
-    return local_root;
 }
 
-void Node::reroot(const NodeSPtr &new_parent)
+void NodePool::reroot(NodeIdx idx, NodeIdx new_parent)
 {
-    if (! m_is_root) {
-        auto old_parent = m_parent.lock();
-        old_parent->reroot(shared_from_this());
-        m_children.push_back(old_parent);
+    if (const NodeIdx old_parent = (*this)[idx].parent; old_parent != invalid_node_idx) {
+        // Detaches this node from old_parent, old_parent becomes a root.
+        this->reroot(old_parent, idx);
+        this->addChild(idx, old_parent);
     }
 
-    if (new_parent) {
-        m_children.erase(std::remove(m_children.begin(), m_children.end(), new_parent), m_children.end());
-        m_is_root = false;
-        m_parent = new_parent;
-    } else {
-        m_is_root = true;
-        m_parent.reset();
-    }
+    if (new_parent != invalid_node_idx)
+        // The caller attaches this node to new_parent.
+        this->detachChild(idx, new_parent);
+
+    assert((*this)[idx].isRoot());
 }
 
-NodeSPtr Node::closestNode(const Point& loc)
+NodeIdx NodePool::closestNode(NodeIdx idx, const Point& loc) const
 {
-    NodeSPtr result = shared_from_this();
-    auto closest_dist2 = coord_t((m_p - loc).cast<double>().norm());
+    NodeIdx result = idx;
+    auto closest_dist2 = coord_t(((*this)[idx].p - loc).cast<double>().norm());
 
-    for (const auto& child : m_children) {
-        NodeSPtr candidate_node = child->closestNode(loc);
-        const auto child_dist2 = coord_t((candidate_node->m_p - loc).cast<double>().norm());
+    for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx; child = (*this)[child].next_sibling) {
+        const NodeIdx candidate_node = this->closestNode(child, loc);
+        const auto child_dist2 = coord_t(((*this)[candidate_node].p - loc).cast<double>().norm());
         if (child_dist2 < closest_dist2) {
             closest_dist2 = child_dist2;
             result = candidate_node;
@@ -187,52 +233,55 @@ bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeG
     return false;
 }
 
-bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts)
+bool NodePool::realign(NodeIdx idx, const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeIdx>& rerooted_parts)
 {
     if (outlines.empty())
         return false;
 
-    if (inside(outlines, m_p)) {
+    if (inside(outlines, (*this)[idx].p)) {
         // Only keep children that have an unbroken connection to here, realign will put the rest in rerooted parts due to recursion:
         Point coll;
         bool reground_me = false;
-        m_children.erase(std::remove_if(m_children.begin(), m_children.end(), [&](const NodeSPtr &child) {
-            bool connect_branch = child->realign(outlines, outline_locator, rerooted_parts);
+        for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx;) {
+            const NodeIdx next_child = (*this)[child].next_sibling;
+            bool connect_branch = this->realign(child, outlines, outline_locator, rerooted_parts);
             // Find an intersection of the line segment from p to child->p, at maximum outline_locator.resolution() * 2 distance from p.
-            if (connect_branch && lineSegmentPolygonsIntersection(child->m_p, m_p, outline_locator, coll, outline_locator.resolution() * 2)) {
-                child->m_last_grounding_location.reset();
-                child->m_parent.reset();
-                child->m_is_root = true;
+            if (connect_branch && lineSegmentPolygonsIntersection((*this)[child].p, (*this)[idx].p, outline_locator, coll, outline_locator.resolution() * 2)) {
+                (*this)[child].last_grounding_location.reset();
+                this->detachChild(idx, child);
                 rerooted_parts.push_back(child);
                 reground_me = true;
-                connect_branch = false;
-            }
-            return ! connect_branch;
-        }), m_children.end());
+            } else if (! connect_branch)
+                this->detachChild(idx, child);
+            child = next_child;
+        }
         if (reground_me)
-            m_last_grounding_location.reset();
+            (*this)[idx].last_grounding_location.reset();
         return true;
     }
 
     // 'Lift' any decendants out of this tree:
-    for (auto& child : m_children)
-        if (child->realign(outlines, outline_locator, rerooted_parts)) {
-            child->m_last_grounding_location = m_p;
-            child->m_parent.reset();
-            child->m_is_root = true;
+    for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx;) {
+        const NodeIdx next_child = (*this)[child].next_sibling;
+        const bool    keep_child = this->realign(child, outlines, outline_locator, rerooted_parts);
+        this->detachChild(idx, child);
+        if (keep_child) {
+            (*this)[child].last_grounding_location = (*this)[idx].p;
             rerooted_parts.push_back(child);
         }
+        child = next_child;
+    }
 
-    m_children.clear();
     return false;
 }
 
-void Node::straighten(const coord_t magnitude, const coord_t max_remove_colinear_dist)
+void NodePool::straighten(NodeIdx idx, const coord_t magnitude, const coord_t max_remove_colinear_dist)
 {
-    straighten(magnitude, m_p, 0, int64_t(max_remove_colinear_dist) * int64_t(max_remove_colinear_dist));
+    this->straighten(idx, magnitude, (*this)[idx].p, 0, int64_t(max_remove_colinear_dist) * int64_t(max_remove_colinear_dist));
 }
 
-Node::RectilinearJunction Node::straighten(
+NodePool::RectilinearJunction NodePool::straighten(
+    NodeIdx idx,
     const coord_t magnitude,
     const Point& junction_above,
     const coord_t accumulated_dist,
@@ -241,12 +290,14 @@ Node::RectilinearJunction Node::straighten(
     constexpr coord_t junction_magnitude_factor_numerator = 3;
     constexpr coord_t junction_magnitude_factor_denominator = 4;
 
+    // No nodes are added while straightening, thus the reference stays valid.
+    Node &node = (*this)[idx];
     const coord_t junction_magnitude = magnitude * junction_magnitude_factor_numerator / junction_magnitude_factor_denominator;
-    if (m_children.size() == 1)
+    if (node.num_children == 1)
     {
-        auto child_p = m_children.front();
-        auto child_dist = coord_t((m_p - child_p->m_p).cast<double>().norm());
-        RectilinearJunction junction_below = child_p->straighten(magnitude, junction_above, accumulated_dist + child_dist, max_remove_colinear_dist2);
+        NodeIdx child = node.first_child;
+        auto child_dist = coord_t((node.p - (*this)[child].p).cast<double>().norm());
+        RectilinearJunction junction_below = this->straighten(child, magnitude, junction_above, accumulated_dist + child_dist, max_remove_colinear_dist2);
         coord_t total_dist_to_junction_below = junction_below.total_recti_dist;
         const Point& a = junction_above;
         Point        b = junction_below.junction_loc;
@@ -254,28 +305,33 @@ Node::RectilinearJunction Node::straighten(
         {
             Point ab = b - a;
             Point destination = (a.cast<int64_t>() + ab.cast<int64_t>() * int64_t(accumulated_dist) / std::max(int64_t(1), int64_t(total_dist_to_junction_below))).cast<coord_t>();
-            if ((destination - m_p).cast<int64_t>().squaredNorm() <= int64_t(magnitude) * int64_t(magnitude))
-                m_p = destination;
+            if ((destination - node.p).cast<int64_t>().squaredNorm() <= int64_t(magnitude) * int64_t(magnitude))
+                node.p = destination;
             else
-                m_p += ((destination - m_p).cast<double>().normalized() * magnitude).cast<coord_t>();
+                node.p += ((destination - node.p).cast<double>().normalized() * magnitude).cast<coord_t>();
         }
         { // remove nodes on linear segments
             constexpr coord_t close_enough = 10;
 
-            child_p = m_children.front(); //recursive call to straighten might have removed the child
-            const NodeSPtr& parent_node = m_parent.lock();
-            if (parent_node &&
-                (child_p->m_p - parent_node->m_p).cast<int64_t>().squaredNorm() < max_remove_colinear_dist2 &&
-                Line::distance_to_squared(m_p, parent_node->m_p, child_p->m_p) < close_enough * close_enough) {
-                child_p->m_parent = m_parent;
-                for (auto& sibling : parent_node->m_children)
-                { // find this node among siblings
-                    if (sibling == shared_from_this())
-                    {
-                        sibling = child_p; // replace this node by child
-                        break;
-                    }
-                }
+            child = node.first_child; //recursive call to straighten might have removed the child
+            Node &child_node = (*this)[child];
+            if (const NodeIdx parent = node.parent;
+                parent != invalid_node_idx &&
+                (child_node.p - (*this)[parent].p).cast<int64_t>().squaredNorm() < max_remove_colinear_dist2 &&
+                Line::distance_to_squared(node.p, (*this)[parent].p, child_node.p) < close_enough * close_enough) {
+                // Replace this node by its child in the list of children of the parent.
+                Node &parent_node = (*this)[parent];
+                child_node.parent       = parent;
+                child_node.prev_sibling = node.prev_sibling;
+                child_node.next_sibling = node.next_sibling;
+                (node.prev_sibling == invalid_node_idx ? parent_node.first_child : (*this)[node.prev_sibling].next_sibling) = child;
+                (node.next_sibling == invalid_node_idx ? parent_node.last_child : (*this)[node.next_sibling].prev_sibling) = child;
+                node.parent       = invalid_node_idx;
+                node.first_child  = invalid_node_idx;
+                node.last_child   = invalid_node_idx;
+                node.prev_sibling = invalid_node_idx;
+                node.next_sibling = invalid_node_idx;
+                node.num_children = 0;
             }
         }
         return junction_below;
@@ -283,100 +339,109 @@ Node::RectilinearJunction Node::straighten(
     else
     {
         constexpr coord_t weight = 1000;
-        Point junction_moving_dir = ((junction_above - m_p).cast<double>().normalized() * weight).cast<coord_t>();
+        Point junction_moving_dir = ((junction_above - node.p).cast<double>().normalized() * weight).cast<coord_t>();
         bool prevent_junction_moving = false;
-        for (auto& child_p : m_children)
+        for (NodeIdx child = node.first_child; child != invalid_node_idx;)
         {
-            const auto child_dist = coord_t((m_p - child_p->m_p).cast<double>().norm());
-            RectilinearJunction below = child_p->straighten(magnitude, m_p, child_dist, max_remove_colinear_dist2);
+            // The recursive call to straighten may replace the child by its own child, but it keeps its siblings.
+            const NodeIdx next_child = (*this)[child].next_sibling;
+            const auto child_dist = coord_t((node.p - (*this)[child].p).cast<double>().norm());
+            RectilinearJunction below = this->straighten(child, magnitude, node.p, child_dist, max_remove_colinear_dist2);
 
-            junction_moving_dir += ((below.junction_loc - m_p).cast<double>().normalized() * weight).cast<coord_t>();
+            junction_moving_dir += ((below.junction_loc - node.p).cast<double>().normalized() * weight).cast<coord_t>();
             if (below.total_recti_dist < magnitude) // TODO: make configurable?
             {
                 prevent_junction_moving = true; // prevent flipflopping in branches due to straightening and junctoin moving clashing
             }
+            child = next_child;
         }
-        if (junction_moving_dir != Point(0, 0) && ! m_children.empty() && ! m_is_root && ! prevent_junction_moving)
+        if (junction_moving_dir != Point(0, 0) && node.num_children > 0 && ! node.isRoot() && ! prevent_junction_moving)
         {
             auto junction_moving_dir_len = coord_t(junction_moving_dir.norm());
             if (junction_moving_dir_len > junction_magnitude)
             {
                 junction_moving_dir = junction_moving_dir * junction_magnitude / junction_moving_dir_len;
             }
-            m_p += junction_moving_dir;
+            node.p += junction_moving_dir;
         }
-        return RectilinearJunction{ accumulated_dist, m_p };
+        return RectilinearJunction{ accumulated_dist, node.p };
     }
 }
 
 // Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
-coord_t Node::prune(const coord_t& pruning_distance)
+coord_t NodePool::prune(NodeIdx idx, const coord_t& pruning_distance)
 {
     if (pruning_distance <= 0)
         return 0;
 
     coord_t max_distance_pruned = 0;
-    for (auto child_it = m_children.begin(); child_it != m_children.end(); ) {
-        auto& child = *child_it;
-        coord_t dist_pruned_child = child->prune(pruning_distance);
+    for (NodeIdx child = (*this)[idx].first_child; child != invalid_node_idx; ) {
+        const NodeIdx next_child = (*this)[child].next_sibling;
+        coord_t dist_pruned_child = this->prune(child, pruning_distance);
         if (dist_pruned_child >= pruning_distance)
         { // pruning is finished for child; dont modify further
             max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child);
-            ++child_it;
         } else {
-            const Point a = getLocation();
-            const Point b = child->getLocation();
+            const Point a = (*this)[idx].p;
+            const Point b = (*this)[child].p;
             const Point ba = a - b;
             const auto ab_len = coord_t(ba.cast<double>().norm());
-            if (dist_pruned_child + ab_len <= pruning_distance) { 
+            if (dist_pruned_child + ab_len <= pruning_distance) {
                 // we're still in the process of pruning
-                assert(child->m_children.empty() && "when pruning away a node all it's children must already have been pruned away");
+                assert((*this)[child].num_children == 0 && "when pruning away a node all it's children must already have been pruned away");
                 max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child + ab_len);
-                child_it = m_children.erase(child_it);
+                this->detachChild(idx, child);
             } else {
                 // pruning stops in between this node and the child
                 const Point n = b + (ba.cast<double>().normalized() * (pruning_distance - dist_pruned_child)).cast<coord_t>();
                 assert(std::abs((n - b).cast<double>().norm() + dist_pruned_child - pruning_distance) < 10 && "total pruned distance must be equal to the pruning_distance");
                 max_distance_pruned = std::max(max_distance_pruned, pruning_distance);
-                child->setLocation(n);
-                ++child_it;
+                (*this)[child].p = n;
             }
         }
+        child = next_child;
     }
 
     return max_distance_pruned;
 }
 
-void Node::convertToPolylines(Polylines &output, const coord_t line_overlap) const
+void NodePool::convertToPolylines(NodeIdx root, Polylines &output, const coord_t line_overlap) const
 {
     Polylines result;
     result.emplace_back();
-    convertToPolylines(0, result);
+    this->convertToPolylines(root, 0, result);
     removeJunctionOverlap(result, line_overlap);
     append(output, std::move(result));
 }
 
-void Node::convertToPolylines(size_t long_line_idx, Polylines &output) const
+void NodePool::convertToPolylines(NodeIdx idx, size_t long_line_idx, Polylines &output) const
 {
-    if (m_children.empty()) {
-        output[long_line_idx].points.push_back(m_p);
+    const Node &node = (*this)[idx];
+    if (node.num_children == 0) {
+        output[long_line_idx].points.push_back(node.p);
         return;
     }
-    size_t first_child_idx = rand() % m_children.size();
-    m_children[first_child_idx]->convertToPolylines(long_line_idx, output);
-    output[long_line_idx].points.push_back(m_p);
-
-    for (size_t idx_offset = 1; idx_offset < m_children.size(); idx_offset++) {
-        size_t child_idx = (first_child_idx + idx_offset) % m_children.size();
-        const Node& child = *m_children[child_idx];
+    size_t  first_child_idx = rand() % node.num_children;
+    NodeIdx first_child     = node.first_child;
+    for (size_t i = 0; i < first_child_idx; ++ i)
+        first_child = (*this)[first_child].next_sibling;
+    this->convertToPolylines(first_child, long_line_idx, output);
+    output[long_line_idx].points.push_back(node.p);
+
+    NodeIdx child = first_child;
+    for (size_t idx_offset = 1; idx_offset < node.num_children; idx_offset++) {
+        // Continue with the siblings following the first child, wrapping around.
+        child = (*this)[child].next_sibling;
+        if (child == invalid_node_idx)
+            child = node.first_child;
         output.emplace_back();
         size_t child_line_idx = output.size() - 1;
-        child.convertToPolylines(child_line_idx, output);
-        output[child_line_idx].points.emplace_back(m_p);
+        this->convertToPolylines(child, child_line_idx, output);
+        output[child_line_idx].points.emplace_back(node.p);
     }
 }
 
-void Node::removeJunctionOverlap(Polylines &result_lines, const coord_t line_overlap) const
+void NodePool::removeJunctionOverlap(Polylines &result_lines, const coord_t line_overlap)
 {
     const coord_t reduction    = line_overlap;
     size_t        res_line_idx = 0;
@@ -413,27 +478,20 @@ void Node::removeJunctionOverlap(Polylines &result_lines, const coord_t line_ove
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg)
+void export_to_svg(const NodePool &nodes, NodeIdx root_node, SVG &svg)
 {
-    for (const NodeSPtr &children : root_node->m_children) {
-        svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
-        export_to_svg(children, svg);
-    }
+    nodes.visitBranches(root_node, [&svg](const Point &a, const Point &b) { svg.draw(Line(a, b), "red"); });
 }
 
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes) {
+void export_to_svg(const std::string &path, const Polygons &contour, const NodePool &nodes, const std::vector<NodeIdx> &root_nodes) {
     BoundingBox bbox = get_extents(contour);
 
     bbox.offset(SCALED_EPSILON);
     SVG svg(path, bbox);
     svg.draw_outline(contour, "blue");
 
-    for (const NodeSPtr &root_node: root_nodes) {
-        for (const NodeSPtr &children: root_node->m_children) {
-            svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
-            export_to_svg(children, svg);
-        }
-    }
+    for (NodeIdx root_node : root_nodes)
+        export_to_svg(nodes, root_node, svg);
 }
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 
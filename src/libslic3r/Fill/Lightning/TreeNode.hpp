@@ -4,8 +4,10 @@
 #ifndef LIGHTNING_TREE_NODE_H
 #define LIGHTNING_TREE_NODE_H
 
+#include <cassert>
+#include <cstdint>
 #include <functional>
-#include <memory>
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -20,9 +22,9 @@ namespace Slic3r::FillLightning
 
 inline coord_t locator_cell_size() { return scaled<coord_t>(4.); }
 
-class Node;
-
-using NodeSPtr = std::shared_ptr<Node>;
+// Index of a node into the NodePool of a single layer.
+using NodeIdx = uint32_t;
+constexpr NodeIdx invalid_node_idx = std::numeric_limits<NodeIdx>::max();
 
 // NOTE: As written, this struct will only be valid for a single layer, will have to be updated for the next.
 // NOTE: Reasons for implementing this with some separate closures:
@@ -35,105 +37,96 @@ using NodeSPtr = std::shared_ptr<Node>;
  *
  * In essence these vertices are just a position linked to other positions in
  * 2D. The nodes have a hierarchical structure of parents and children, forming
- * a tree. The class also has some helper functions specific to Lightning Infill
- * e.g. to straighten the paths around this node.
+ * a tree. The links are indices into the NodePool owning the node, the children
+ * of a node form a doubly linked list of siblings.
  */
-class Node : public std::enable_shared_from_this<Node>
+struct Node
 {
-public:
-    // Workaround for private/protected constructors and 'make_shared': https://stackoverflow.com/a/27832765
-    template<typename ...Arg> NodeSPtr static create(Arg&&...arg)
-    {
-        struct EnableMakeShared : public Node
-        {
-            explicit EnableMakeShared(Arg&&...arg) : Node(std::forward<Arg>(arg)...) {}
-        };
-        return std::make_shared<EnableMakeShared>(std::forward<Arg>(arg)...);
-    }
+    explicit Node(const Point &p, const std::optional<Point> &last_grounding_location = std::nullopt) :
+        p(p), last_grounding_location(last_grounding_location) {}
 
     /*!
-     * Get the position on this layer that this node represents, a vertex of the
-     * path to print.
-     * \return The position that this node represents.
+     * Returns whether this node is the root of a lightning tree. It is the root
+     * if it has no parents.
+     */
+    bool isRoot() const { return parent == invalid_node_idx; }
+
+    //! The position on this layer that this node represents, a vertex of the path to print.
+    Point    p;
+    NodeIdx  parent       { invalid_node_idx };
+    NodeIdx  first_child  { invalid_node_idx };
+    NodeIdx  last_child   { invalid_node_idx };
+    NodeIdx  prev_sibling { invalid_node_idx };
+    NodeIdx  next_sibling { invalid_node_idx };
+    uint32_t num_children { 0 };
+
+    /*! If this was ever a direct child of the root, it'll have a previous grounding location.
+     *
+     * This needs to be known when roots are reconnected, so that the last (higher) layer is supported by the next one.
      */
-    const Point& getLocation() const { return m_p; }
+    std::optional<Point> last_grounding_location;
+};
+
+/*!
+ * The nodes of all Lightning Trees of a single layer, stored in a flat array.
+ *
+ * Nodes are addressed by their indices, which stay valid while nodes are being added.
+ * Nodes cut off a tree are not removed from the array, they are dropped when the trees
+ * are propagated to the layer below by compact().
+ */
+class NodePool
+{
+public:
+    size_t      size()  const { return m_nodes.size(); }
+    bool        empty() const { return m_nodes.empty(); }
+
+    Node&       operator[](NodeIdx idx)       { assert(idx < m_nodes.size()); return m_nodes[idx]; }
+    const Node& operator[](NodeIdx idx) const { assert(idx < m_nodes.size()); return m_nodes[idx]; }
+
+    const Point& getLocation(NodeIdx idx) const { return (*this)[idx].p; }
 
     /*!
-     * Change the position on this layer that the node represents.
-     * \param p The position that the node needs to represent.
+     * Construct a new root node.
+     * \param p The physical location in the 2D layer that this node represents.
+     * Connecting other nodes to this node indicates that a line segment should
+     * be drawn between those two physical positions.
+     * \return Index of the new node.
      */
-    void setLocation(const Point& p) { m_p = p; }
+    NodeIdx addNode(const Point &p, const std::optional<Point> &last_grounding_location = std::nullopt);
 
     /*!
-     * Construct a new ``Node`` instance and add it as a child of
-     * this node.
+     * Construct a new ``Node`` instance and add it as a child of \p parent.
      * \param p The location of the new node.
-     * \return A shared pointer to the new node.
+     * \return Index of the new node.
      */
-    NodeSPtr addChild(const Point& p);
+    NodeIdx addChild(NodeIdx parent, const Point &p);
 
     /*!
-     * Add an existing ``Node`` as a child of this node.
+     * Add an existing root node as the last child of \p parent.
      * \param new_child The node that must be added as a child.
      * \return Always returns \p new_child.
      */
-    NodeSPtr addChild(NodeSPtr& new_child);
+    NodeIdx addChild(NodeIdx parent, NodeIdx new_child);
 
     /*!
-     * Propagate this node's sub-tree to the next layer.
-     *
-     * Creates a copy of this tree, realign it to the new layer boundaries
-     * \p next_outlines and reduce (i.e. prune and straighten) it. A copy of
-     * this node and all of its descendant nodes will be added to the
-     * \p next_trees vector.
-     * \param next_trees A collection of tree nodes to use for the next layer.
-     * \param next_outlines The shape of the layer below, to make sure that the
-     * tree stays within the bounds of the infill area.
-     * \param prune_distance The maximum distance that a leaf node may be moved
-     * such that it still supports the current node.
-     * \param smooth_magnitude The maximum distance that a line may be shifted
-     * to straighten the tree's paths, such that it still supports the current
-     * paths.
-     * \param max_remove_colinear_dist The maximum distance of a line-segment
-     * from which straightening may remove a colinear point.
-     */
-    void propagateToNextLayer
-    (
-        std::vector<NodeSPtr>& next_trees,
-        const Polygons& next_outlines,
-        const EdgeGrid::Grid& outline_locator,
-        coord_t prune_distance,
-        coord_t smooth_magnitude,
-        coord_t max_remove_colinear_dist
-    ) const;
-
-    /*!
-     * Executes a given function for every line segment in this node's sub-tree.
+     * Executes a given function for every line segment in the sub-tree of \p idx.
      *
      * The function takes two `Point` arguments. These arguments will be filled
      * in with the higher-order node (closer to the root) first, and the
      * downtree node (closer to the leaves) as the second argument. The segment
-     * from this node's parent to this node itself is not included.
+     * from the parent of \p idx to \p idx itself is not included.
      * The order in which the segments are visited is depth-first.
-     * \param visitor A function to execute for every branch in the node's sub-
-     * tree.
      */
-    void visitBranches(const std::function<void(const Point&, const Point&)>& visitor) const;
+    void visitBranches(NodeIdx idx, const std::function<void(const Point&, const Point&)>& visitor) const;
 
     /*!
-     * Execute a given function for every node in this node's sub-tree.
-     *
-     * The visitor function takes a node as input. This node is not const, so
-     * this can be used to change the tree.
-     * Nodes are visited in depth-first order. This node itself is visited as
-     * well (pre-order).
-     * \param visitor A function to execute for every node in this node's sub-
-     * tree.
+     * Execute a given function for every node in the sub-tree of \p idx,
+     * \p idx included, in depth-first pre-order.
      */
-    void visitNodes(const std::function<void(NodeSPtr)>& visitor);
+    void visitNodes(NodeIdx idx, const std::function<void(NodeIdx)>& visitor) const;
 
     /*!
-     * Get a weighted distance from an unsupported point to this node (given the current supporting radius).
+     * Get a weighted distance from an unsupported point to the node \p idx (given the current supporting radius).
      *
      * When attaching a unsupported location to a node, not all nodes have the same priority.
      * (Eucludian) closer nodes are prioritised, but that's not the whole story.
@@ -142,65 +135,80 @@ public:
      * \param supporting_radius The maximum distance which can be bridged without (infill) supporting it.
      * \return The weighted distance.
      */
-    coord_t getWeightedDistance(const Point& unsupported_location, const coord_t& supporting_radius) const;
+    coord_t getWeightedDistance(NodeIdx idx, const Point& unsupported_location, const coord_t& supporting_radius) const;
 
     /*!
-     * Returns whether this node is the root of a lightning tree. It is the root
-     * if it has no parents.
-     * \return ``true`` if this node is the root (no parents) or ``false`` if it
-     * is a child node of some other node.
-     */
-    bool isRoot() const { return m_is_root; }
-
-    /*!
-     * Reverse the parent-child relationship all the way to the root, from this node onward.
-     * This has the effect of 're-rooting' the tree at the current node if no immediate parent is given as argument.
-     * That is, the current node will become the root, it's (former) parent if any, will become one of it's children.
+     * Reverse the parent-child relationship all the way to the root, from node \p idx onward.
+     * This has the effect of 're-rooting' the tree at \p idx if no immediate parent is given as argument.
+     * That is, \p idx will become the root, it's (former) parent if any, will become one of it's children.
      * This is then recursively bubbled up until it reaches the (former) root, which then will become a leaf.
-     * \param new_parent The (new) parent-node of the root, useful for recursing or immediately attaching the node to another tree.
+     * \param new_parent The child of \p idx becoming its parent, used for recursing. It is detached from \p idx, the caller attaches \p idx to it.
      */
-    void reroot(const NodeSPtr &new_parent = nullptr);
+    void reroot(NodeIdx idx, NodeIdx new_parent = invalid_node_idx);
 
     /*!
      * Retrieves the closest node to the specified location.
      * \param loc The specified location.
-     * \result The branch that starts at the position closest to the location within this tree.
+     * \result The branch that starts at the position closest to the location within the tree of \p idx.
      */
-    NodeSPtr closestNode(const Point& loc);
+    NodeIdx closestNode(NodeIdx idx, const Point& loc) const;
 
     /*!
-     * Returns whether the given tree node is a descendant of this node.
+     * Returns whether the node \p to_be_checked is a descendant of node \p idx.
      *
-     * If this node itself is given, it is also considered to be a descendant.
-     * \param to_be_checked A node to find out whether it is a descendant of
-     * this node.
-     * \return ``true`` if the given node is a descendant or this node itself,
-     * or ``false`` if it is not in the sub-tree.
+     * Node \p idx itself is also considered to be its descendant.
+     * Walks the parent links up from \p to_be_checked, thus the cost is the depth of the tree,
+     * not the size of the sub-tree of \p idx.
      */
-    bool hasOffspring(const NodeSPtr& to_be_checked) const;
+    bool hasOffspring(NodeIdx idx, NodeIdx to_be_checked) const;
 
-    Node() = delete; // Don't allow empty contruction
-
-protected:
     /*!
-     * Construct a new node, either for insertion in a tree or as root.
-     * \param p The physical location in the 2D layer that this node represents.
-     * Connecting other nodes to this node indicates that a line segment should
-     * be drawn between those two physical positions.
+     * Copy the trees of \p tree_roots into \p pool_below and reduce (i.e. prune and straighten) them,
+     * realigned to the new layer boundaries \p next_outlines.
+     *
+     * The whole node array is copied at once, the pruned and cut off nodes are dropped afterwards by compacting
+     * the copy, thus the trees are not copied node by node.
+     * \param next_trees Roots of the trees in \p pool_below.
+     * \param next_outlines The shape of the layer below, to make sure that the
+     * tree stays within the bounds of the infill area.
+     * \param prune_distance The maximum distance that a leaf node may be moved
+     * such that it still supports the current node.
+     * \param smooth_magnitude The maximum distance that a line may be shifted
+     * to straighten the tree's paths, such that it still supports the current
+     * paths.
+     * \param max_remove_colinear_dist The maximum distance of a line-segment
+     * from which straightening may remove a colinear point.
      */
-    explicit Node(const Point& p, const std::optional<Point>& last_grounding_location = std::nullopt);
+    void propagateToNextLayer
+    (
+        const std::vector<NodeIdx>& tree_roots,
+        NodePool& pool_below,
+        std::vector<NodeIdx>& next_trees,
+        const Polygons& next_outlines,
+        const EdgeGrid::Grid& outline_locator,
+        coord_t prune_distance,
+        coord_t smooth_magnitude,
+        coord_t max_remove_colinear_dist
+    ) const;
 
     /*!
-     * Copy this node and its entire sub-tree.
-     * \return The equivalent of this node in the copy (the root of the new sub-
-     * tree).
+     * Convert the tree of \p root into polylines
+     *
+     * At each junction one line is chosen at random to continue
+     *
+     * The lines start at a leaf and end in a junction
+     *
+     * \param output all branches in this tree connected into polylines
      */
-    NodeSPtr deepCopy() const;
+    void convertToPolylines(NodeIdx root, Polylines &output, coord_t line_overlap) const;
 
+    void draw_tree(NodeIdx idx, SVG& svg) const { this->visitBranches(idx, [&svg](const Point &a, const Point &b) { svg.draw(Line(a, b), "yellow"); }); }
+
+protected:
     /*! Reconnect trees from the layer above to the new outlines of the lower layer.
      * \return Wether or not the root is kept (false is no, true is yes).
      */
-    bool realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts);
+    bool realign(NodeIdx idx, const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeIdx>& rerooted_parts);
 
     struct RectilinearJunction
     {
@@ -214,7 +222,7 @@ protected:
      * \param magnitude The maximum allowed distance to move the node.
      * \param max_remove_colinear_dist Maximum distance of the (compound) line-segment from which a co-linear point may be removed.
      */
-    void straighten(coord_t magnitude, coord_t max_remove_colinear_dist);
+    void straighten(NodeIdx idx, coord_t magnitude, coord_t max_remove_colinear_dist);
 
     /*! Recursive part of \ref straighten(.)
      * \param junction_above The last seen junction with multiple children above
@@ -222,87 +230,53 @@ protected:
      * \param max_remove_colinear_dist2 Maximum distance _squared_ of the (compound) line-segment from which a co-linear point may be removed.
      * \return the total distance along the tree from the last junction above to the first next junction below and the location of the next junction below
      */
-    RectilinearJunction straighten(coord_t magnitude, const Point& junction_above, coord_t accumulated_dist, int64_t max_remove_colinear_dist2);
+    RectilinearJunction straighten(NodeIdx idx, coord_t magnitude, const Point& junction_above, coord_t accumulated_dist, int64_t max_remove_colinear_dist2);
 
     /*! Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
      * \return The distance that has been pruned. If less than \p distance, then the whole tree was puned away.
      */
-    coord_t prune(const coord_t& distance);
+    coord_t prune(NodeIdx idx, const coord_t& distance);
 
-public:
     /*!
-     * Convert the tree into polylines
-     * 
-     * At each junction one line is chosen at random to continue
-     * 
-     * The lines start at a leaf and end in a junction
-     * 
-     * \param output all branches in this tree connected into polylines
+     * Drop the nodes not reachable from \p tree_roots, renumber the remaining ones in depth-first
+     * pre-order of the trees and update \p tree_roots accordingly.
      */
-    void convertToPolylines(Polylines &output, coord_t line_overlap) const;
+    void compact(std::vector<NodeIdx>& tree_roots);
 
-    /*! If this was ever a direct child of the root, it'll have a previous grounding location.
-     *
-     * This needs to be known when roots are reconnected, so that the last (higher) layer is supported by the next one.
-     */
-    const std::optional<Point>& getLastGroundingLocation() const { return m_last_grounding_location; }
-
-    void draw_tree(SVG& svg) { for (auto& child : m_children) { svg.draw(Line(m_p, child->getLocation()), "yellow"); child->draw_tree(svg); } }
+    // Unlink \p child from the list of children of \p parent, \p child becomes a root.
+    void detachChild(NodeIdx parent, NodeIdx child);
 
-protected:
     /*!
      * Convert the tree into polylines
-     * 
+     *
      * At each junction one line is chosen at random to continue
-     * 
+     *
      * The lines start at a leaf and end in a junction
-     * 
+     *
      * \param long_line a reference to a polyline in \p output which to continue building on in the recursion
      * \param output all branches in this tree connected into polylines
      */
-    void convertToPolylines(size_t long_line_idx, Polylines &output) const;
-
-    void removeJunctionOverlap(Polylines &polylines, coord_t line_overlap) const;
+    void convertToPolylines(NodeIdx idx, size_t long_line_idx, Polylines &output) const;
 
-    bool m_is_root;
-    Point m_p;
-    std::weak_ptr<Node> m_parent;
-    std::vector<NodeSPtr> m_children;
+    static void removeJunctionOverlap(Polylines &polylines, coord_t line_overlap);
 
-    std::optional<Point> m_last_grounding_location;  //<! The last known grounding location, see 'getLastGroundingLocation()'.
-
-    friend BoundingBox get_extents(const NodeSPtr &root_node);
-    friend BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots);
-
-#ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-    friend void export_to_svg(const NodeSPtr &root_node, Slic3r::SVG &svg);
-    friend void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
-#endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
+    std::vector<Node> m_nodes;
 };
 
 bool inside(const Polygons &polygons, const Point &p);
 bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeGrid::Grid& outline_locator, Point& result, coord_t within_max_dist);
 
-inline BoundingBox get_extents(const NodeSPtr &root_node)
-{
-    BoundingBox bbox;
-    for (const NodeSPtr &children : root_node->m_children)
-        bbox.merge(get_extents(children));
-    bbox.merge(root_node->getLocation());
-    return bbox;
-}
-
-inline BoundingBox get_extents(const std::vector<NodeSPtr> &tree_roots)
+inline BoundingBox get_extents(const NodePool &nodes, const std::vector<NodeIdx> &tree_roots)
 {
     BoundingBox bbox;
-    for (const NodeSPtr &root_node : tree_roots)
-        bbox.merge(get_extents(root_node));
+    for (NodeIdx root_node : tree_roots)
+        nodes.visitNodes(root_node, [&nodes, &bbox](NodeIdx idx) { bbox.merge(nodes.getLocation(idx)); });
     return bbox;
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg);
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes);
+void export_to_svg(const NodePool &nodes, NodeIdx root_node, SVG &svg);
+void export_to_svg(const std::string &path, const Polygons &contour, const NodePool &nodes, const std::vector<NodeIdx> &root_nodes);
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 
 } // namespace Slic3r::FillLightning
@@ -4,9 +4,11 @@
 
 #include "OBJ.hpp"
 #include "objparser.hpp"
+#include "StreamingMeshImport.hpp"
 
 #include <string>
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/log/trivial.hpp>
 
 #ifdef _WIN32
@@ -21,10 +23,52 @@
 
 namespace Slic3r {
 
+static bool mesh_from_obj_its(const char *path, indexed_triangle_set &&its, TriangleMesh &mesh, std::string &message)
+{
+    mesh = TriangleMesh(std::move(its));
+    if (mesh.empty()) {
+        BOOST_LOG_TRIVIAL(error) << "load_obj: This OBJ file couldn't be read because it's empty. " << path;
+        message = _L("This OBJ file couldn't be read because it's empty.");
+        return false;
+    }
+    if (mesh.volume() < 0)
+        mesh.flip_triangles();
+    return true;
+}
+
 bool load_obj(const char *path, TriangleMesh *meshptr, ObjInfo& obj_info, std::string &message)
 {
     if (meshptr == nullptr)
         return false;
+    boost::system::error_code ec;
+    if (uintmax_t file_size = boost::filesystem::file_size(boost::filesystem::path(path), ec); ! ec && file_size > STREAMING_MESH_IMPORT_MIN_FILE_SIZE) {
+        // Very large file, parse it directly into an indexed triangle set without keeping the ObjData around.
+        indexed_triangle_set its;
+        switch (its_load_obj_streaming(path, its)) {
+        case ObjStreamingResult::Ok:
+            return mesh_from_obj_its(path, std::move(its), *meshptr, message);
+        case ObjStreamingResult::Unsupported:
+            // Materials or vertex colors, parse the file with ObjParser below.
+            break;
+        case ObjStreamingResult::PolygonWithMoreThan4Vertices:
+            BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains polygons with more than 4 vertices.";
+            message = _L("The file contains polygons with more than 4 vertices.");
+            return false;
+        case ObjStreamingResult::PolygonWithLessThan3Vertices:
+            BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains polygons with less than 2 vertices.";
+            message = _L("The file contains polygons with less than 2 vertices.");
+            return false;
+        case ObjStreamingResult::InvalidVertexIndex:
+            BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains invalid vertex index.";
+            message = _L("The file contains invalid vertex index.");
+            return false;
+        case ObjStreamingResult::Failed:
+        default:
+            BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path;
+            message = _L("load_obj: failed to parse");
+            return false;
+        }
+    }
     // Parse the OBJ file.
     ObjParser::ObjData data;
     ObjParser::MtlData mtl_data;
@@ -202,15 +246,7 @@ bool load_obj(const char *path, TriangleMesh *meshptr, ObjInfo& obj_info, std::s
             }
         }
 
-    *meshptr = TriangleMesh(std::move(its));
-    if (meshptr->empty()) {
-        BOOST_LOG_TRIVIAL(error) << "load_obj: This OBJ file couldn't be read because it's empty. " << path;
-        message = _L("This OBJ file couldn't be read because it's empty.");
-        return false;
-    }
-    if (meshptr->volume() < 0)
-        meshptr->flip_triangles();
-    return true;
+    return mesh_from_obj_its(path, std::move(its), *meshptr, message);
 }
 
 bool load_obj(const char *path, Model *model, ObjInfo& obj_info, std::string &message, const char *object_name_in)
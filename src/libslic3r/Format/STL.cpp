@@ -1,11 +1,15 @@
 #include "../libslic3r.h"
 #include "../Model.hpp"
 #include "../TriangleMesh.hpp"
+#include "../TriangleMeshRepair.hpp"
 
 #include "STL.hpp"
+#include "StreamingMeshImport.hpp"
 
 #include <string>
 
+#include <boost/filesystem/operations.hpp>
+
 #ifdef _WIN32
 #define DIR_SEPARATOR '\\'
 #else
@@ -19,7 +23,15 @@ bool load_stl(const char *path, Model *model, const char *object_name_in, Import
     TriangleMesh mesh;
     std::string design_id;
 
-    if (!mesh.ReadSTLFile(path, true, stlFn, custom_header_length)) {
+    boost::system::error_code ec;
+    if (uintmax_t file_size = boost::filesystem::file_size(boost::filesystem::path(path), ec); ! ec && file_size > STREAMING_MESH_IMPORT_MIN_FILE_SIZE) {
+        // Very large file, don't keep the admesh stl_file next to the indexed triangle set,
+        // repair the indexed triangle set in parallel instead of running the admesh repair.
+        indexed_triangle_set its;
+        if (! its_load_stl_streaming(path, its, stlFn, custom_header_length))
+            return false;
+        mesh = TriangleMesh(std::move(its), MeshRepairParams());
+    } else if (!mesh.ReadSTLFile(path, true, stlFn, custom_header_length)) {
         //    die "Failed to open $file\n" if !-e $path;
         return false;
     }
@@ -0,0 +1,641 @@
+#include "SliceCache.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "libslic3r/Exception.hpp"
+#include "libslic3r/ExtrusionEntityCollection.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Model.hpp"
+
+namespace Slic3r {
+
+static_assert(sizeof(Point) == 2 * sizeof(coord_t) && sizeof(Point3) == 3 * sizeof(coord_t), "Points are expected to be tightly packed");
+
+// Extrusion entities of a record are prefixed by their type.
+enum class SliceCacheEntityType : uint8_t { Path, MultiPath, Loop, Collection };
+
+class SliceCacheWriter
+{
+public:
+    template<typename T> void put(const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values are written as is");
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+    void put_count(size_t count) { this->put(uint32_t(count)); }
+    void put_string(const std::string &str)
+    {
+        this->put_count(str.size());
+        m_data.insert(m_data.end(), str.begin(), str.end());
+    }
+    void put_points(const Points &points)
+    {
+        this->put_count(points.size());
+        const coord_t *coords = points.empty() ? nullptr : points.front().data();
+        m_coords.insert(m_coords.end(), coords, coords + 2 * points.size());
+    }
+    void put_points(const Points3 &points)
+    {
+        this->put_count(points.size());
+        const coord_t *coords = points.empty() ? nullptr : points.front().data();
+        m_coords.insert(m_coords.end(), coords, coords + 3 * points.size());
+    }
+    void put_point(const Point &point) { this->put(point.x()); this->put(point.y()); }
+
+    SliceCacheRecord record() const
+    {
+        const uint64_t   num_coords = m_coords.size();
+        SliceCacheRecord out(sizeof(num_coords) + sizeof(coord_t) * m_coords.size() + m_data.size());
+        std::memcpy(out.data(), &num_coords, sizeof(num_coords));
+        if (! m_coords.empty())
+            std::memcpy(out.data() + sizeof(num_coords), m_coords.data(), sizeof(coord_t) * m_coords.size());
+        if (! m_data.empty())
+            std::memcpy(out.data() + sizeof(num_coords) + sizeof(coord_t) * m_coords.size(), m_data.data(), m_data.size());
+        return out;
+    }
+
+private:
+    std::vector<coord_t> m_coords;
+    std::vector<uint8_t> m_data;
+};
+
+// Reads a record written by SliceCacheWriter from the memory mapped file. Throws on reading past the end of the record.
+class SliceCacheReader
+{
+public:
+    SliceCacheReader(const uint8_t *begin, const uint8_t *end, const std::string &file_name) : m_file_name(file_name)
+    {
+        uint64_t num_coords = 0;
+        if (size_t(end - begin) < sizeof(num_coords))
+            this->throw_corrupted();
+        std::memcpy(&num_coords, begin, sizeof(num_coords));
+        begin += sizeof(num_coords);
+        if (num_coords > size_t(end - begin) / sizeof(coord_t))
+            this->throw_corrupted();
+        m_coords     = begin;
+        m_coords_end = begin + sizeof(coord_t) * num_coords;
+        m_data       = m_coords_end;
+        m_data_end   = end;
+    }
+
+    template<typename T> T get()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values are read as is");
+        if (size_t(m_data_end - m_data) < sizeof(T))
+            this->throw_corrupted();
+        T value;
+        std::memcpy(&value, m_data, sizeof(T));
+        m_data += sizeof(T);
+        return value;
+    }
+    // Each counted item takes at least a byte, thus a count exceeding the rest of the record is rejected
+    // before anything is allocated for it.
+    size_t get_count()
+    {
+        const size_t count = this->get<uint32_t>();
+        if (count > size_t(m_data_end - m_data))
+            this->throw_corrupted();
+        return count;
+    }
+    std::string get_string()
+    {
+        const size_t count = this->get_count();
+        std::string  out(reinterpret_cast<const char*>(m_data), count);
+        m_data += count;
+        return out;
+    }
+    void get_points(Points &points)    { this->get_coords(points, 2); }
+    void get_points(Points3 &points)   { this->get_coords(points, 3); }
+    Point get_point()
+    {
+        const coord_t x = this->get<coord_t>();
+        return { x, this->get<coord_t>() };
+    }
+
+    // Throws if the record was not read till its end.
+    void finish() const
+    {
+        if (m_data != m_data_end || m_coords != m_coords_end)
+            this->throw_corrupted();
+    }
+
+    [[noreturn]] void throw_corrupted() const { throw Slic3r::FileIOError("Corrupted slice cache " + m_file_name); }
+
+private:
+    template<typename PointsType> void get_coords(PointsType &points, size_t dimension)
+    {
+        const uint32_t count = this->get<uint32_t>();
+        if (count > size_t(m_coords_end - m_coords) / (dimension * sizeof(coord_t)))
+            this->throw_corrupted();
+        points.resize(count);
+        if (count > 0)
+            std::memcpy(points.front().data(), m_coords, dimension * sizeof(coord_t) * count);
+        m_coords += dimension * sizeof(coord_t) * count;
+    }
+
+    const std::string &m_file_name;
+    const uint8_t     *m_coords;
+    const uint8_t     *m_coords_end;
+    const uint8_t     *m_data;
+    const uint8_t     *m_data_end;
+};
+
+static void to_binary(SliceCacheWriter &w, const ExPolygon &polygon)
+{
+    w.put_points(polygon.contour.points);
+    w.put_count(polygon.holes.size());
+    for (const Polygon &hole : polygon.holes)
+        w.put_points(hole.points);
+}
+
+static void to_binary(SliceCacheWriter &w, const ExPolygons &polygons)
+{
+    w.put_count(polygons.size());
+    for (const ExPolygon &polygon : polygons)
+        to_binary(w, polygon);
+}
+
+static void to_binary(SliceCacheWriter &w, const BoundingBox &bbox)
+{
+    w.put_point(bbox.min);
+    w.put_point(bbox.max);
+}
+
+static void to_binary(SliceCacheWriter &w, const Surfaces &surfaces)
+{
+    w.put_count(surfaces.size());
+    for (const Surface &surf : surfaces) {
+        w.put(int32_t(surf.surface_type));
+        to_binary(w, surf.expolygon);
+        w.put(surf.thickness);
+        w.put(surf.thickness_layers);
+        w.put(surf.bridge_angle);
+        w.put(surf.extra_perimeters);
+    }
+}
+
+static void to_binary(SliceCacheWriter &w, const std::vector<PathFittingData> &fitting_result)
+{
+    w.put_count(fitting_result.size());
+    for (const PathFittingData &path_fitting : fitting_result) {
+        w.put(uint64_t(path_fitting.start_point_index));
+        w.put(uint64_t(path_fitting.end_point_index));
+        w.put(path_fitting.path_type);
+        // Same as the json cache, the arc is only stored if it is valid.
+        const ArcSegment &arc_seg = path_fitting.arc_data;
+        w.put(uint8_t(arc_seg.is_arc));
+        if (arc_seg.is_arc) {
+            w.put(arc_seg.length);
+            w.put(arc_seg.angle_radians);
+            w.put(arc_seg.polar_start_theta);
+            w.put(arc_seg.polar_end_theta);
+            w.put_point(arc_seg.start_point);
+            w.put_point(arc_seg.end_point);
+            w.put(arc_seg.direction);
+            w.put(arc_seg.radius);
+            w.put_point(arc_seg.center);
+        }
+    }
+}
+
+static void to_binary(SliceCacheWriter &w, const Polylines &polylines)
+{
+    w.put_count(polylines.size());
+    for (const Polyline &polyline : polylines) {
+        w.put_points(polyline.points);
+        to_binary(w, polyline.fitting_result);
+    }
+}
+
+static void to_binary(SliceCacheWriter &w, const ExtrusionPath &path)
+{
+    w.put_points(path.polyline.points);
+    to_binary(w, path.polyline.fitting_result);
+    w.put(path.mm3_per_mm);
+    w.put(path.width);
+    w.put(path.height);
+    w.put(path.role());
+    w.put(uint8_t(path.is_force_no_extrusion()));
+}
+
+static void to_binary(SliceCacheWriter &w, const ExtrusionPaths &paths)
+{
+    w.put_count(paths.size());
+    for (const ExtrusionPath &path : paths)
+        to_binary(w, path);
+}
+
+// Same classification as convert_extrusion_to_json().
+static void to_binary(SliceCacheWriter &w, const ExtrusionEntity &entity)
+{
+    if (const auto *collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        w.put(SliceCacheEntityType::Collection);
+        w.put(uint8_t(collection->no_sort));
+        w.put_count(collection->entities.size());
+        for (const ExtrusionEntity *child : collection->entities)
+            to_binary(w, *child);
+    } else if (const auto *path = dynamic_cast<const ExtrusionPath*>(&entity)) {
+        w.put(SliceCacheEntityType::Path);
+        to_binary(w, *path);
+    } else if (const auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity)) {
+        w.put(SliceCacheEntityType::MultiPath);
+        to_binary(w, multipath->paths);
+    } else if (const auto *loop = dynamic_cast<const ExtrusionLoop*>(&entity)) {
+        w.put(SliceCacheEntityType::Loop);
+        w.put(loop->loop_role());
+        to_binary(w, loop->paths);
+    } else
+        throw Slic3r::RuntimeError("Slice cache: invalid extrusion entity type");
+}
+
+static void to_binary(SliceCacheWriter &w, const Layer &layer)
+{
+    to_binary(w, layer.lslices);
+    w.put_count(layer.lslices_bboxes.size());
+    for (const BoundingBox &bbox : layer.lslices_bboxes)
+        to_binary(w, bbox);
+    to_binary(w, layer.loverhangs);
+    to_binary(w, layer.loverhangs_bbox);
+    w.put_count(layer.region_count());
+    for (const LayerRegion *layer_region : layer.regions()) {
+        to_binary(w, layer_region->slices.surfaces);
+        to_binary(w, layer_region->raw_slices);
+        to_binary(w, layer_region->thin_fills);
+        to_binary(w, layer_region->fill_expolygons);
+        to_binary(w, layer_region->fill_surfaces.surfaces);
+        to_binary(w, layer_region->fill_no_overlap_expolygons);
+        to_binary(w, layer_region->unsupported_bridge_edges);
+        to_binary(w, layer_region->perimeters);
+        to_binary(w, layer_region->fills);
+    }
+}
+
+static void to_binary(SliceCacheWriter &w, const SupportLayer &support_layer)
+{
+    to_binary(w, static_cast<const Layer&>(support_layer));
+    w.put(int32_t(support_layer.support_type));
+    to_binary(w, support_layer.support_islands);
+    to_binary(w, support_layer.support_fills);
+}
+
+static void to_binary(SliceCacheWriter &w, const SliceCacheObjectInfo &info)
+{
+    w.put_string(info.name);
+    w.put(uint64_t(info.identify_id));
+    for (const std::vector<SliceCacheLayerInfo> *layers : { &info.layers, &info.support_layers }) {
+        w.put_count(layers->size());
+        for (const SliceCacheLayerInfo &layer : *layers) {
+            w.put(uint64_t(layer.id));
+            w.put(uint64_t(layer.interface_id));
+            w.put(layer.height);
+            w.put(layer.print_z);
+            w.put(layer.slice_z);
+            w.put_count(layer.region_config_hashes.size());
+            for (size_t config_hash : layer.region_config_hashes)
+                w.put(uint64_t(config_hash));
+        }
+    }
+    w.put_count(info.first_layer_groups.size());
+    for (const groupedVolumeSlices &group : info.first_layer_groups) {
+        w.put(int32_t(group.groupId));
+        w.put_count(group.volume_ids.size());
+        for (const ObjectID &volume_id : group.volume_ids)
+            w.put(uint64_t(volume_id.id));
+        to_binary(w, group.slices);
+    }
+}
+
+static void from_binary(SliceCacheReader &r, ExPolygon &polygon)
+{
+    r.get_points(polygon.contour.points);
+    polygon.holes.resize(r.get_count());
+    for (Polygon &hole : polygon.holes)
+        r.get_points(hole.points);
+}
+
+static void from_binary(SliceCacheReader &r, ExPolygons &polygons)
+{
+    polygons.resize(r.get_count());
+    for (ExPolygon &polygon : polygons)
+        from_binary(r, polygon);
+}
+
+static void from_binary(SliceCacheReader &r, BoundingBox &bbox)
+{
+    bbox.min     = r.get_point();
+    bbox.max     = r.get_point();
+    bbox.defined = true;
+}
+
+static void from_binary(SliceCacheReader &r, Surfaces &surfaces)
+{
+    size_t count = r.get_count();
+    surfaces.reserve(count);
+    for (; count > 0; -- count) {
+        Surface &surf = surfaces.emplace_back(SurfaceType(r.get<int32_t>()));
+        from_binary(r, surf.expolygon);
+        surf.thickness        = r.get<double>();
+        surf.thickness_layers = r.get<unsigned short>();
+        surf.bridge_angle     = r.get<double>();
+        surf.extra_perimeters = r.get<unsigned short>();
+    }
+}
+
+static void from_binary(SliceCacheReader &r, std::vector<PathFittingData> &fitting_result)
+{
+    fitting_result.resize(r.get_count());
+    for (PathFittingData &path_fitting : fitting_result) {
+        path_fitting.start_point_index = size_t(r.get<uint64_t>());
+        path_fitting.end_point_index   = size_t(r.get<uint64_t>());
+        path_fitting.path_type         = r.get<EMovePathType>();
+        ArcSegment &arc_seg = path_fitting.arc_data;
+        arc_seg.is_arc = r.get<uint8_t>() != 0;
+        if (arc_seg.is_arc) {
+            arc_seg.length            = r.get<double>();
+            arc_seg.angle_radians     = r.get<double>();
+            arc_seg.polar_start_theta = r.get<double>();
+            arc_seg.polar_end_theta   = r.get<double>();
+            arc_seg.start_point       = r.get_point();
+            arc_seg.end_point         = r.get_point();
+            arc_seg.direction         = r.get<ArcDirection>();
+            arc_seg.radius            = r.get<double>();
+            arc_seg.center            = r.get_point();
+        }
+    }
+}
+
+static void from_binary(SliceCacheReader &r, Polylines &polylines)
+{
+    polylines.resize(r.get_count());
+    for (Polyline &polyline : polylines) {
+        r.get_points(polyline.points);
+        from_binary(r, polyline.fitting_result);
+    }
+}
+
+static void from_binary(SliceCacheReader &r, ExtrusionPath &path)
+{
+    r.get_points(path.polyline.points);
+    from_binary(r, path.polyline.fitting_result);
+    path.mm3_per_mm = r.get<double>();
+    path.width      = r.get<float>();
+    path.height     = r.get<float>();
+    path.set_extrusion_role(r.get<ExtrusionRole>());
+    path.set_force_no_extrusion(r.get<uint8_t>() != 0);
+}
+
+static void from_binary(SliceCacheReader &r, ExtrusionPaths &paths)
+{
+    paths.resize(r.get_count());
+    for (ExtrusionPath &path : paths)
+        from_binary(r, path);
+}
+
+static void from_binary(SliceCacheReader &r, ExtrusionEntityCollection &collection);
+
+// Reads an entity written by to_binary(SliceCacheWriter&, const ExtrusionEntity&) and appends it to the collection.
+static void append_from_binary(SliceCacheReader &r, ExtrusionEntityCollection &parent)
+{
+    switch (r.get<SliceCacheEntityType>()) {
+    case SliceCacheEntityType::Path: {
+        auto path = std::make_unique<ExtrusionPath>();
+        from_binary(r, *path);
+        parent.entities.push_back(path.release());
+        break;
+    }
+    case SliceCacheEntityType::MultiPath: {
+        auto multipath = std::make_unique<ExtrusionMultiPath>();
+        from_binary(r, multipath->paths);
+        parent.entities.push_back(multipath.release());
+        break;
+    }
+    case SliceCacheEntityType::Loop: {
+        auto loop = std::make_unique<ExtrusionLoop>();
+        loop->set_loop_role(r.get<ExtrusionLoopRole>());
+        from_binary(r, loop->paths);
+        parent.entities.push_back(loop.release());
+        break;
+    }
+    case SliceCacheEntityType::Collection: {
+        auto collection = std::make_unique<ExtrusionEntityCollection>();
+        from_binary(r, *collection);
+        parent.entities.push_back(collection.release());
+        break;
+    }
+    default:
+        r.throw_corrupted();
+    }
+}
+
+// Reads the tag, the flags and the children of a collection written by to_binary(SliceCacheWriter&, const ExtrusionEntity&).
+static void from_binary_collection(SliceCacheReader &r, ExtrusionEntityCollection &collection)
+{
+    if (r.get<SliceCacheEntityType>() != SliceCacheEntityType::Collection)
+        r.throw_corrupted();
+    from_binary(r, collection);
+}
+
+static void from_binary(SliceCacheReader &r, ExtrusionEntityCollection &collection)
+{
+    collection.no_sort = r.get<uint8_t>() != 0;
+    size_t count = r.get_count();
+    collection.entities.reserve(count);
+    for (; count > 0; -- count)
+        append_from_binary(r, collection);
+}
+
+// The regions of the layer are expected to be created already, see load_cached_data().
+static void from_binary(SliceCacheReader &r, Layer &layer)
+{
+    from_binary(r, layer.lslices);
+    layer.lslices_bboxes.resize(r.get_count());
+    for (BoundingBox &bbox : layer.lslices_bboxes)
+        from_binary(r, bbox);
+    from_binary(r, layer.loverhangs);
+    from_binary(r, layer.loverhangs_bbox);
+    if (r.get_count() != layer.region_count())
+        r.throw_corrupted();
+    for (LayerRegion *layer_region : layer.regions()) {
+        from_binary(r, layer_region->slices.surfaces);
+        from_binary(r, layer_region->raw_slices);
+        from_binary_collection(r, layer_region->thin_fills);
+        from_binary(r, layer_region->fill_expolygons);
+        from_binary(r, layer_region->fill_surfaces.surfaces);
+        from_binary(r, layer_region->fill_no_overlap_expolygons);
+        from_binary(r, layer_region->unsupported_bridge_edges);
+        from_binary_collection(r, layer_region->perimeters);
+        from_binary_collection(r, layer_region->fills);
+    }
+}
+
+static void from_binary(SliceCacheReader &r, SupportLayer &support_layer)
+{
+    from_binary(r, static_cast<Layer&>(support_layer));
+    support_layer.support_type = SupportInnerType(r.get<int32_t>());
+    from_binary(r, support_layer.support_islands);
+    from_binary_collection(r, support_layer.support_fills);
+}
+
+static void from_binary(SliceCacheReader &r, SliceCacheObjectInfo &info)
+{
+    info.name        = r.get_string();
+    info.identify_id = size_t(r.get<uint64_t>());
+    for (std::vector<SliceCacheLayerInfo> *layers : { &info.layers, &info.support_layers }) {
+        layers->resize(r.get_count());
+        for (SliceCacheLayerInfo &layer : *layers) {
+            layer.id           = size_t(r.get<uint64_t>());
+            layer.interface_id = size_t(r.get<uint64_t>());
+            layer.height       = r.get<coordf_t>();
+            layer.print_z      = r.get<coordf_t>();
+            layer.slice_z      = r.get<coordf_t>();
+            layer.region_config_hashes.resize(r.get_count());
+            for (size_t &config_hash : layer.region_config_hashes)
+                config_hash = size_t(r.get<uint64_t>());
+        }
+    }
+    info.first_layer_groups.resize(r.get_count());
+    for (groupedVolumeSlices &group : info.first_layer_groups) {
+        group.groupId = r.get<int32_t>();
+        group.volume_ids.resize(r.get_count());
+        for (ObjectID &volume_id : group.volume_ids)
+            volume_id.id = size_t(r.get<uint64_t>());
+        from_binary(r, group.slices);
+    }
+}
+
+SliceCacheRecord slice_cache_record(const Layer &layer)
+{
+    SliceCacheWriter writer;
+    to_binary(writer, layer);
+    return writer.record();
+}
+
+SliceCacheRecord slice_cache_record(const SupportLayer &support_layer)
+{
+    SliceCacheWriter writer;
+    to_binary(writer, support_layer);
+    return writer.record();
+}
+
+SliceCacheRecord slice_cache_record(const SliceCacheObjectInfo &info)
+{
+    SliceCacheWriter writer;
+    to_binary(writer, info);
+    return writer.record();
+}
+
+std::string slice_cache_file_name(const std::string &directory, size_t identify_id, bool binary)
+{
+    return directory + "/obj_" + std::to_string(identify_id) + (binary ? ".bin" : ".json");
+}
+
+uint64_t slice_cache_hash(const PrintObject &obj)
+{
+    size_t seed = obj.config().hash();
+    for (size_t i = 0; i < obj.num_printing_regions(); ++ i)
+        boost::hash_combine(seed, obj.printing_region(i).config_hash());
+    const Transform3d &trafo = obj.trafo();
+    boost::hash_combine(seed, boost::hash_range(trafo.data(), trafo.data() + 16));
+    for (const ModelVolume *volume : obj.model_object()->volumes) {
+        const indexed_triangle_set &its = volume->mesh().its;
+        boost::hash_combine(seed, int(volume->type()));
+        const Transform3d &volume_matrix = volume->get_matrix();
+        boost::hash_combine(seed, boost::hash_range(volume_matrix.data(), volume_matrix.data() + 16));
+        boost::hash_combine(seed, its.vertices.size());
+        boost::hash_combine(seed, its.indices.size());
+        if (! its.vertices.empty())
+            boost::hash_combine(seed, boost::hash_range(its.vertices.front().data(), its.vertices.front().data() + 3 * its.vertices.size()));
+        if (! its.indices.empty())
+            boost::hash_combine(seed, boost::hash_range(its.indices.front().data(), its.indices.front().data() + 3 * its.indices.size()));
+    }
+    return uint64_t(seed);
+}
+
+void save_slice_cache(const std::string &file_name, const std::vector<SliceCacheRecord> &records, uint64_t hash)
+{
+    const uint64_t         num_records = records.size();
+    std::vector<uint64_t>  record_ends;
+    record_ends.reserve(num_records);
+    for (const SliceCacheRecord &record : records)
+        record_ends.emplace_back((record_ends.empty() ? 0 : record_ends.back()) + record.size());
+
+    SliceCacheHeader header;
+    std::memcpy(header.magic, SLICE_CACHE_MAGIC, sizeof(header.magic));
+    header.version      = SLICE_CACHE_VERSION;
+    header.reserved     = 0;
+    header.hash         = hash;
+    header.payload_size = sizeof(uint64_t) * (num_records + 1) + (record_ends.empty() ? 0 : record_ends.back());
+
+    boost::nowide::ofstream c(file_name, std::ios::out | std::ios::trunc | std::ios::binary);
+    c.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    c.write(reinterpret_cast<const char*>(&num_records), sizeof(num_records));
+    c.write(reinterpret_cast<const char*>(record_ends.data()), std::streamsize(sizeof(uint64_t) * record_ends.size()));
+    for (const SliceCacheRecord &record : records)
+        c.write(reinterpret_cast<const char*>(record.data()), std::streamsize(record.size()));
+    c.close();
+    if (c.fail())
+        throw Slic3r::FileIOError("Failed writing slice cache " + file_name);
+}
+
+SliceCacheFile::SliceCacheFile(const std::string &file_name) : m_file_name(file_name), m_file{boost::filesystem::path{file_name}}
+{
+    if (m_file.size() < sizeof(SliceCacheHeader))
+        throw Slic3r::FileIOError("Truncated slice cache " + file_name);
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+    if (std::memcmp(m_header.magic, SLICE_CACHE_MAGIC, sizeof(m_header.magic)) != 0)
+        throw Slic3r::FileIOError("Not a slice cache " + file_name);
+}
+
+SliceCacheObjectInfo SliceCacheFile::object_info()
+{
+    assert(m_header.version == SLICE_CACHE_VERSION);
+    const uint8_t *payload     = reinterpret_cast<const uint8_t*>(m_file.data()) + sizeof(SliceCacheHeader);
+    uint64_t       num_records = 0;
+    if (m_header.payload_size != m_file.size() - sizeof(SliceCacheHeader) || m_header.payload_size < sizeof(num_records))
+        throw Slic3r::FileIOError("Truncated slice cache " + m_file_name);
+    std::memcpy(&num_records, payload, sizeof(num_records));
+    if (num_records == 0 || num_records > (m_header.payload_size - sizeof(num_records)) / sizeof(uint64_t))
+        throw Slic3r::FileIOError("Corrupted slice cache " + m_file_name);
+    std::vector<uint64_t> record_ends(num_records);
+    std::memcpy(record_ends.data(), payload + sizeof(num_records), sizeof(uint64_t) * num_records);
+    const uint8_t *records      = payload + sizeof(uint64_t) * (num_records + 1);
+    const uint64_t records_size = m_header.payload_size - sizeof(uint64_t) * (num_records + 1);
+    m_records.clear();
+    m_records.reserve(num_records);
+    for (uint64_t i = 0, begin = 0; i < num_records; begin = record_ends[i ++]) {
+        if (record_ends[i] < begin || record_ends[i] > records_size)
+            throw Slic3r::FileIOError("Corrupted slice cache " + m_file_name);
+        m_records.emplace_back(records + begin, records + record_ends[i]);
+    }
+    SliceCacheObjectInfo info;
+    SliceCacheReader     reader(m_records.front().first, m_records.front().second, m_file_name);
+    from_binary(reader, info);
+    reader.finish();
+    if (this->num_layer_records() != info.layers.size() + info.support_layers.size())
+        reader.throw_corrupted();
+    return info;
+}
+
+void SliceCacheFile::load_layer(size_t idx, Layer &layer) const
+{
+    SliceCacheReader reader(m_records[idx + 1].first, m_records[idx + 1].second, m_file_name);
+    from_binary(reader, layer);
+    reader.finish();
+}
+
+void SliceCacheFile::load_layer(size_t idx, SupportLayer &support_layer) const
+{
+    SliceCacheReader reader(m_records[idx + 1].first, m_records[idx + 1].second, m_file_name);
+    from_binary(reader, support_layer);
+    reader.finish();
+}
+
+} // namespace Slic3r
@@ -0,0 +1,104 @@
+#ifndef slic3r_Format_SliceCache_hpp_
+#define slic3r_Format_SliceCache_hpp_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "libslic3r/Print.hpp"
+
+namespace Slic3r {
+
+class Layer;
+class SupportLayer;
+
+// Binary slice cache written by Print::export_cached_data() and read by Print::load_cached_data():
+// a fixed header followed by a table of records. The first record describes the object: its layers
+// and support layers with the config hashes of their regions and the first layer groups, see SliceCacheObjectInfo.
+// It is followed by a record for each layer and for each support layer, so that the layers are encoded and decoded
+// one by one and in parallel. A record starts with a flat array of the coordinates of all its polygons and polylines,
+// followed by the structure, which stores the number of points of each polygon and polyline in the order they were
+// written to the coordinate array. Text json of the whole object is only written for debugging.
+static constexpr char     SLICE_CACHE_MAGIC[8]  = { 'O', 'R', 'C', 'A', 'S', 'L', 'C', '\0' };
+static constexpr uint32_t SLICE_CACHE_VERSION   = 3;
+
+struct SliceCacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    // Hash of the object configuration, of its regions and of its meshes, see slice_cache_hash().
+    uint64_t hash;
+    // Size of the record table: number of records, end offsets of the records and the records themselves.
+    uint64_t payload_size;
+};
+static_assert(sizeof(SliceCacheHeader) == 32, "SliceCacheHeader is expected to be tightly packed");
+
+using SliceCacheRecord = std::vector<uint8_t>;
+
+// Layers and support layers of a cached object, created by load_cached_data() before their data is extracted.
+struct SliceCacheLayerInfo
+{
+    size_t              id { 0 };
+    size_t              interface_id { 0 };
+    coordf_t            height { 0. };
+    coordf_t            print_z { 0. };
+    coordf_t            slice_z { 0. };
+    std::vector<size_t> region_config_hashes;
+};
+
+struct SliceCacheObjectInfo
+{
+    std::string                       name;
+    size_t                            identify_id { 0 };
+    std::vector<SliceCacheLayerInfo>  layers;
+    std::vector<SliceCacheLayerInfo>  support_layers;
+    // Volume IDs are indices of the volumes of the model object.
+    std::vector<groupedVolumeSlices>  first_layer_groups;
+};
+
+extern SliceCacheRecord slice_cache_record(const Layer &layer);
+extern SliceCacheRecord slice_cache_record(const SupportLayer &support_layer);
+extern SliceCacheRecord slice_cache_record(const SliceCacheObjectInfo &info);
+
+extern std::string slice_cache_file_name(const std::string &directory, size_t identify_id, bool binary);
+
+// Hash of everything the cached layers were produced from, so that a cache exported for a different
+// mesh or different object / region settings is rejected instead of being silently reused.
+extern uint64_t slice_cache_hash(const PrintObject &obj);
+
+// Write the records, the object record first, followed by the layer records.
+extern void save_slice_cache(const std::string &file_name, const std::vector<SliceCacheRecord> &records, uint64_t hash);
+
+// Memory mapped binary slice cache, the layer records are decoded on demand.
+class SliceCacheFile
+{
+public:
+    // Throws on I/O errors and on a malformed file.
+    explicit SliceCacheFile(const std::string &file_name);
+
+    const SliceCacheHeader& header() const { return m_header; }
+
+    // Parse the record table and decode the object record.
+    // Only call for a file of the current version.
+    SliceCacheObjectInfo object_info();
+
+    size_t num_layer_records() const { return m_records.empty() ? 0 : m_records.size() - 1; }
+    // Layers are followed by the support layers. The regions of the layer are expected to be created already.
+    // Throws on a corrupted record. Thread safe.
+    void load_layer(size_t idx, Layer &layer) const;
+    void load_layer(size_t idx, SupportLayer &support_layer) const;
+
+private:
+    std::string                                               m_file_name;
+    boost::iostreams::mapped_file_source                      m_file;
+    SliceCacheHeader                                          m_header;
+    std::vector<std::pair<const uint8_t*, const uint8_t*>>    m_records;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_Format_SliceCache_hpp_ */
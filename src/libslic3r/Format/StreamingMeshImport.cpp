@@ -0,0 +1,535 @@
+#include "../libslic3r.h"
+
+#include "StreamingMeshImport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/predef/other/endian.h>
+
+#include <fast_float/fast_float.h>
+#include <ankerl/unordered_dense.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
+#if BOOST_ENDIAN_BIG_BYTE
+extern void stl_internal_reverse_quads(char *buf, size_t cnt);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+
+namespace Slic3r {
+
+namespace {
+
+// Large enough to amortize the task overhead, small enough to keep the blocks in flight in a few hundred MB.
+constexpr size_t block_size = 4 * 1024 * 1024;
+
+inline bool is_space(char c) { return c == ' ' || c == '\t'; }
+inline bool is_end_of_line(char c) { return c == '\r' || c == '\n'; }
+
+inline const char* skip_spaces(const char *c, const char *end)
+{
+    for (; c != end && is_space(*c); ++ c) ;
+    return c;
+}
+
+inline const char* skip_word(const char *c, const char *end)
+{
+    for (; c != end && ! is_space(*c) && ! is_end_of_line(*c); ++ c) ;
+    return c;
+}
+
+inline const char* find_end_of_line(const char *c, const char *end)
+{
+    for (; c != end && ! is_end_of_line(*c); ++ c) ;
+    return c;
+}
+
+// Does the line start with a keyword followed by a white space or by the end of line?
+inline bool starts_with_keyword(const char *c, const char *end, std::string_view keyword)
+{
+    return size_t(end - c) >= keyword.size() && memcmp(c, keyword.data(), keyword.size()) == 0 &&
+           (c + keyword.size() == end || is_space(c[keyword.size()]) || is_end_of_line(c[keyword.size()]));
+}
+
+// Parse a number, accepting an explicit plus sign as strtod() and strtol() do. Returns nullptr on error.
+inline const char* parse_float(const char *c, const char *end, float &out)
+{
+    c = skip_spaces(c, end);
+    if (c != end && *c == '+')
+        ++ c;
+    auto [ptr, ec] = fast_float::from_chars(c, end, out);
+    return ec == std::errc() ? ptr : nullptr;
+}
+
+inline const char* parse_int(const char *c, const char *end, int64_t &out)
+{
+    if (c != end && *c == '+')
+        ++ c;
+    auto [ptr, ec] = std::from_chars(c, end, out);
+    return ec == std::errc() ? ptr : nullptr;
+}
+
+bool map_file(const char *path, boost::iostreams::mapped_file_source &file)
+{
+    boost::system::error_code ec;
+    if (boost::filesystem::file_size(boost::filesystem::path(path), ec) == 0 || ec) {
+        // Empty file cannot be mapped.
+        BOOST_LOG_TRIVIAL(error) << "StreamingMeshImport: The input is an empty or unreadable file: " << path;
+        return false;
+    }
+    try {
+        file.open(boost::filesystem::path(path));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "StreamingMeshImport: Unable to map file " << path << ": " << ex.what();
+        return false;
+    }
+    return true;
+}
+
+// Hash set of indices into its.vertices, hashed and compared by the coordinates of the vertices they point to.
+// Storing indices instead of the vertices halves the memory of the set, which is significant next to the mesh itself.
+struct VertexIndexHash
+{
+    using is_avalanching = void;
+    const std::vector<stl_vertex> *vertices;
+    uint64_t operator()(uint32_t idx) const {
+        return ankerl::unordered_dense::detail::wyhash::hash((*vertices)[idx].data(), 3 * sizeof(float));
+    }
+};
+
+struct VertexIndexEqual
+{
+    const std::vector<stl_vertex> *vertices;
+    bool operator()(uint32_t lhs, uint32_t rhs) const { return (*vertices)[lhs] == (*vertices)[rhs]; }
+};
+
+class VertexMerger
+{
+public:
+    VertexMerger(indexed_triangle_set &its) :
+        m_its(its), m_set(0, VertexIndexHash{ &its.vertices }, VertexIndexEqual{ &its.vertices }) {}
+
+    void reserve(size_t num_facets) {
+        // A closed triangle mesh has about half as many vertices as facets.
+        m_its.indices.reserve(num_facets);
+        m_its.vertices.reserve(num_facets / 2 + 16);
+        m_set.reserve(num_facets / 2 + 16);
+    }
+
+    // Add facets of a soup of three vertices per facet.
+    void add_facets(const std::vector<stl_vertex> &soup) {
+        for (size_t i = 0; i < soup.size(); i += 3) {
+            stl_triangle_vertex_indices facet(this->vertex_index(soup[i]), this->vertex_index(soup[i + 1]), this->vertex_index(soup[i + 2]));
+            if (facet[0] == facet[1] || facet[1] == facet[2] || facet[2] == facet[0])
+                ++ m_degenerate_facets;
+            else
+                m_its.indices.emplace_back(facet);
+        }
+    }
+
+    size_t degenerate_facets() const { return m_degenerate_facets; }
+
+private:
+    int vertex_index(const stl_vertex &v) {
+        // Insert the vertex speculatively to probe the hash set just once.
+        m_its.vertices.emplace_back(v);
+        auto [it, inserted] = m_set.insert(uint32_t(m_its.vertices.size() - 1));
+        if (! inserted)
+            m_its.vertices.pop_back();
+        return int(*it);
+    }
+
+    indexed_triangle_set                                                         &m_its;
+    ankerl::unordered_dense::set<uint32_t, VertexIndexHash, VertexIndexEqual>     m_set;
+    size_t                                                                        m_degenerate_facets { 0 };
+};
+
+// Add a facet to a soup of three vertices per facet, unless one of its vertices is NaN.
+inline void append_facet(const stl_vertex (&facet)[3], std::vector<stl_vertex> &soup)
+{
+    for (const stl_vertex &v : facet)
+        if (std::isnan(v.x()) || std::isnan(v.y()) || std::isnan(v.z()))
+            return;
+    // Adding zero turns a negative zero into a positive one, thus the bitwise hash of equal vertices is equal.
+    for (const stl_vertex &v : facet)
+        soup.emplace_back((v.array() + 0.f).matrix());
+}
+
+void parse_binary_stl_facets(const char *begin, const char *end, std::vector<stl_vertex> &soup)
+{
+    soup.reserve(3 * (end - begin) / SIZEOF_STL_FACET);
+    stl_vertex facet[3];
+    for (const char *record = begin; record != end; record += SIZEOF_STL_FACET) {
+        // Skip the normal, it is recalculated from the vertices.
+        for (int i = 0; i < 3; ++ i) {
+            float xyz[3];
+            memcpy(xyz, record + 12 * (i + 1), sizeof(xyz));
+#if BOOST_ENDIAN_BIG_BYTE
+            // Convert the loaded little endian data to big endian.
+            stl_internal_reverse_quads(reinterpret_cast<char*>(xyz), sizeof(xyz));
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+            facet[i] = stl_vertex(xyz[0], xyz[1], xyz[2]);
+        }
+        append_facet(facet, soup);
+    }
+}
+
+// Only the vertices of the facets are read, the normals and any text following "endloop" or "endfacet" is ignored.
+// Returns false if a loop has other than 3 vertices or a vertex could not be parsed.
+bool parse_ascii_stl_facets(const char *begin, const char *end, std::vector<stl_vertex> &soup)
+{
+    stl_vertex facet[3];
+    int        num_vertices = 0;
+    for (const char *c = begin; c != end;) {
+        const char *line_end = find_end_of_line(c, end);
+        c = skip_spaces(c, line_end);
+        if (starts_with_keyword(c, line_end, "vertex")) {
+            if (num_vertices == 3)
+                return false;
+            stl_vertex &v = facet[num_vertices ++];
+            c += 6;
+            for (int i = 0; i < 3; ++ i)
+                if (c = parse_float(c, line_end, v[i]); c == nullptr)
+                    return false;
+        } else if (starts_with_keyword(c, line_end, "endloop")) {
+            if (num_vertices != 3)
+                return false;
+            append_facet(facet, soup);
+            num_vertices = 0;
+        }
+        for (c = line_end; c != end && is_end_of_line(*c); ++ c) ;
+    }
+    return num_vertices == 0;
+}
+
+// Designer model id and country code stored into the name of the solid as "solid <name> MW 1.0 <model id> <country code>".
+void parse_designer_id(const char *begin, const char *end, std::string &model_id, std::string &country_code)
+{
+    const char *c = begin;
+    for (; c != end && (is_space(*c) || is_end_of_line(*c)); ++ c) ;
+    if (! starts_with_keyword(c, end, "solid"))
+        return;
+    const std::string name(c + 5, find_end_of_line(c + 5, end));
+    if (size_t mw = name.find("MW"); mw != std::string::npos) {
+        std::istringstream in(name.substr(std::min(mw + 3, name.size())));
+        std::string version, id, code;
+        if (in >> version >> id >> code && version == "1.0") {
+            model_id     = id;
+            country_code = code;
+        }
+    }
+}
+
+} // namespace
+
+bool its_load_stl_streaming(const char *path, indexed_triangle_set &its, ImportstlProgressFn stlFn, int custom_header_length)
+{
+    its.clear();
+    boost::iostreams::mapped_file_source file;
+    if (! map_file(path, file))
+        return false;
+    const char  *data = file.data();
+    const size_t size = file.size();
+
+    // Check for binary or ASCII file the same way stl_open() does.
+    if (custom_header_length < LABEL_SIZE)
+        custom_header_length = LABEL_SIZE;
+    const size_t header_size = size_t(custom_header_length) + NUM_FACET_SIZE;
+    if (size < header_size + 128) {
+        BOOST_LOG_TRIVIAL(error) << "its_load_stl_streaming: The input is an empty file: " << path;
+        return false;
+    }
+    const bool binary = std::any_of(data + header_size, data + header_size + 128, [](char c) { return static_cast<unsigned char>(c) > 127; });
+    if (binary && ((size - header_size) % SIZEOF_STL_FACET != 0 || size < STL_MIN_FILE_SIZE)) {
+        BOOST_LOG_TRIVIAL(error) << "its_load_stl_streaming: The file " << path << " has the wrong size.";
+        return false;
+    }
+
+    std::string model_id, country_code;
+    if (! binary)
+        parse_designer_id(data, data + size, model_id, country_code);
+
+    // Block of whole facets of the mapped file, parsed into a soup of vertices by the parallel stage of the pipeline.
+    struct Block {
+        size_t                  begin { 0 };
+        size_t                  end { 0 };
+        std::vector<stl_vertex> soup;
+        bool                    valid { true };
+    };
+    using BlockPtr = std::shared_ptr<Block>;
+
+    const size_t max_blocks = std::clamp<size_t>(2 * tbb::this_task_arena::max_concurrency(), 4, 16);
+    size_t            file_pos  = binary ? header_size : 0;
+    // The pipeline is run in rounds, each one stops reading at the first block boundary past round_end.
+    size_t            round_end = 0;
+    std::atomic<bool> stop { false };
+
+    const auto reader = tbb::make_filter<void, BlockPtr>(slic3r_tbb_filtermode::serial_in_order,
+        [data, size, binary, &file_pos, &round_end, &stop](tbb::flow_control &fc) -> BlockPtr {
+            if (file_pos == size || file_pos >= round_end || stop) {
+                fc.stop();
+                return {};
+            }
+            auto block = std::make_shared<Block>();
+            block->begin = file_pos;
+            if (binary) {
+                block->end = std::min(file_pos + block_size / SIZEOF_STL_FACET * SIZEOF_STL_FACET, size);
+            } else {
+                block->end = std::min(file_pos + block_size, size);
+                if (block->end < size) {
+                    // Cut the block after the line of the next "endfacet", so that a block contains whole facets.
+                    const std::string_view rest(data + block->end - 7, size - block->end + 7);
+                    const size_t           endfacet = rest.find("endfacet");
+                    const void            *eol      = endfacet == std::string_view::npos ? nullptr :
+                        std::memchr(rest.data() + endfacet, '\n', rest.size() - endfacet);
+                    block->end = eol ? static_cast<const char*>(eol) - data + 1 : size;
+                }
+            }
+            file_pos = block->end;
+            return block;
+        });
+
+    const auto parser = tbb::make_filter<BlockPtr, BlockPtr>(slic3r_tbb_filtermode::parallel,
+        [data, binary](BlockPtr block) -> BlockPtr {
+            if (block) {
+                if (binary)
+                    parse_binary_stl_facets(data + block->begin, data + block->end, block->soup);
+                else
+                    block->valid = parse_ascii_stl_facets(data + block->begin, data + block->end, block->soup);
+            }
+            return block;
+        });
+
+    VertexMerger merger(its);
+    if (binary)
+        merger.reserve((size - header_size) / SIZEOF_STL_FACET);
+    bool valid  = true;
+    bool cancel = false;
+    const auto consumer = tbb::make_filter<BlockPtr, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&](BlockPtr block) {
+            if (! block || stop)
+                return;
+            if (! block->valid) {
+                valid = false;
+                stop  = true;
+                return;
+            }
+            if (! binary && block->begin == 0 && block->end < size)
+                // Estimate the number of facets from the first block to avoid growing the mesh by reallocation.
+                merger.reserve(size_t(double(block->soup.size() / 3) * double(size) / double(block->end) * 1.05));
+            merger.add_facets(block->soup);
+            // Release the soup before the block leaves the pipeline.
+            block->soup = {};
+        });
+
+    // stlFn may update the GUI, thus it is called from this thread between the rounds, not from the pipeline.
+    // A round is a twentieth of the file, the same number of steps stl_read() reports, but at least enough blocks to keep the pipeline busy.
+    const size_t round_size = std::max(size / 20, max_blocks * block_size);
+    while (file_pos < size && ! stop) {
+        if (stlFn) {
+            stlFn(int(100 * file_pos / size), 100, cancel, model_id, country_code);
+            if (cancel)
+                break;
+        }
+        round_end = file_pos + round_size;
+        tbb::parallel_pipeline(max_blocks, reader & parser & consumer);
+    }
+
+    if (! valid) {
+        BOOST_LOG_TRIVIAL(error) << "its_load_stl_streaming: Something is syntactically very wrong with this ASCII STL: " << path;
+        its.clear();
+        return false;
+    }
+    if (cancel) {
+        its.clear();
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(info) << "its_load_stl_streaming: Loaded " << its.indices.size() << " facets, " << its.vertices.size() << " vertices, dropped " <<
+        merger.degenerate_facets() << " degenerate facets from " << path;
+    return true;
+}
+
+ObjStreamingResult its_load_obj_streaming(const char *path, indexed_triangle_set &its)
+{
+    its.clear();
+    boost::iostreams::mapped_file_source file;
+    if (! map_file(path, file))
+        return ObjStreamingResult::Failed;
+    const char  *data = file.data();
+    const size_t size = file.size();
+
+    // Blocks of whole lines of the mapped file. The first pass counts the vertices and triangles of each block,
+    // the second pass parses each block directly into its place in the indexed_triangle_set.
+    struct Block {
+        size_t             begin { 0 };
+        size_t             end { 0 };
+        size_t             num_vertices { 0 };
+        size_t             num_triangles { 0 };
+        size_t             first_vertex { 0 };
+        size_t             first_triangle { 0 };
+        ObjStreamingResult result { ObjStreamingResult::Ok };
+    };
+    std::vector<Block> blocks;
+    for (size_t pos = 0; pos < size;) {
+        Block &block = blocks.emplace_back();
+        block.begin = pos;
+        block.end   = std::min(pos + block_size, size);
+        if (block.end < size) {
+            const void *eol = std::memchr(data + block.end - 1, '\n', size - block.end + 1);
+            block.end = eol ? static_cast<const char*>(eol) - data + 1 : size;
+        }
+        pos = block.end;
+    }
+
+    enum class LineType { Other, Vertex, Face, Material };
+    // Returns the type of a line and moves the pointer past its keyword.
+    auto line_type = [](const char *&c, const char *line_end) {
+        if (starts_with_keyword(c, line_end, "v")) {
+            ++ c;
+            return LineType::Vertex;
+        } else if (starts_with_keyword(c, line_end, "f")) {
+            ++ c;
+            return LineType::Face;
+        } else if (starts_with_keyword(c, line_end, "mtllib") || starts_with_keyword(c, line_end, "usemtl"))
+            return LineType::Material;
+        return LineType::Other;
+    };
+    auto for_each_line = [data](const Block &block, auto &&fn) {
+        for (const char *c = data + block.begin, *end = data + block.end; c != end;) {
+            const char *line_end = find_end_of_line(c, end);
+            if (! fn(skip_spaces(c, line_end), line_end))
+                return;
+            for (c = line_end; c != end && is_end_of_line(*c); ++ c) ;
+        }
+    };
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&blocks, &line_type, &for_each_line](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            Block &block = blocks[block_idx];
+            for_each_line(block, [&block, &line_type](const char *c, const char *line_end) {
+                switch (line_type(c, line_end)) {
+                case LineType::Vertex:
+                    ++ block.num_vertices;
+                    break;
+                case LineType::Face: {
+                    int num_face_vertices = 0;
+                    for (c = skip_spaces(c, line_end); c != line_end; c = skip_spaces(skip_word(c, line_end), line_end))
+                        ++ num_face_vertices;
+                    if (num_face_vertices > 4)
+                        block.result = ObjStreamingResult::PolygonWithMoreThan4Vertices;
+                    else if (num_face_vertices > 0 && num_face_vertices < 3)
+                        block.result = ObjStreamingResult::PolygonWithLessThan3Vertices;
+                    else if (num_face_vertices > 0)
+                        block.num_triangles += num_face_vertices - 2;
+                    break;
+                }
+                case LineType::Material:
+                    block.result = ObjStreamingResult::Unsupported;
+                    break;
+                default:
+                    break;
+                }
+                return block.result == ObjStreamingResult::Ok;
+            });
+        }
+    });
+
+    size_t num_vertices  = 0;
+    size_t num_triangles = 0;
+    for (Block &block : blocks) {
+        if (block.result != ObjStreamingResult::Ok)
+            return block.result;
+        block.first_vertex   = num_vertices;
+        block.first_triangle = num_triangles;
+        num_vertices  += block.num_vertices;
+        num_triangles += block.num_triangles;
+    }
+    if (num_vertices > size_t(std::numeric_limits<int>::max()))
+        return ObjStreamingResult::Unsupported;
+    its.vertices.resize(num_vertices);
+    its.indices.resize(num_triangles);
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&blocks, &its, &line_type, &for_each_line, num_vertices](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            Block  &block        = blocks[block_idx];
+            size_t  vertex_idx   = block.first_vertex;
+            size_t  triangle_idx = block.first_triangle;
+            for_each_line(block, [&](const char *c, const char *line_end) {
+                switch (line_type(c, line_end)) {
+                case LineType::Vertex: {
+                    stl_vertex &v = its.vertices[vertex_idx ++];
+                    for (int i = 0; i < 3 && block.result == ObjStreamingResult::Ok; ++ i)
+                        if (c = parse_float(c, line_end, v[i]); c == nullptr || (c != line_end && ! is_space(*c)))
+                            block.result = ObjStreamingResult::Unsupported;
+                    // Vertex colors or other data following the position are left to ObjParser.
+                    if (block.result == ObjStreamingResult::Ok && skip_spaces(c, line_end) != line_end)
+                        block.result = ObjStreamingResult::Unsupported;
+                    break;
+                }
+                case LineType::Face: {
+                    int indices[4];
+                    int cnt = 0;
+                    for (c = skip_spaces(c, line_end); c != line_end && block.result == ObjStreamingResult::Ok; c = skip_spaces(c, line_end)) {
+                        int64_t idx;
+                        if (c = parse_int(c, line_end, idx); c == nullptr || (c != line_end && ! is_space(*c) && *c != '/')) {
+                            block.result = ObjStreamingResult::Unsupported;
+                            break;
+                        }
+                        // Relative indices refer to the vertices defined before this line.
+                        idx = idx < 0 ? idx + int64_t(vertex_idx) : idx - 1;
+                        if (idx < 0 || idx >= int64_t(num_vertices))
+                            block.result = ObjStreamingResult::InvalidVertexIndex;
+                        indices[cnt ++] = int(idx);
+                        // Skip the texture coordinate and normal indices.
+                        c = skip_word(c, line_end);
+                    }
+                    if (block.result == ObjStreamingResult::Ok && cnt > 0) {
+                        // Triangulate a quad the same way load_obj() does.
+                        its.indices[triangle_idx ++] = stl_triangle_vertex_indices(indices[0], indices[1], indices[2]);
+                        if (cnt == 4)
+                            its.indices[triangle_idx ++] = stl_triangle_vertex_indices(indices[0], indices[2], indices[3]);
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+                return block.result == ObjStreamingResult::Ok;
+            });
+        }
+    });
+
+    for (const Block &block : blocks)
+        if (block.result != ObjStreamingResult::Ok) {
+            // Release the mesh allocated for the whole file before the caller falls back to ObjParser.
+            its = indexed_triangle_set();
+            return block.result;
+        }
+    return ObjStreamingResult::Ok;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,41 @@
+#ifndef slic3r_Format_StreamingMeshImport_hpp_
+#define slic3r_Format_StreamingMeshImport_hpp_
+
+#include <admesh/stl.h>
+
+#include <cstddef>
+
+namespace Slic3r {
+
+// Importers of very large STL and OBJ files (photogrammetry scans and similar).
+// The file is memory mapped and parsed by blocks in parallel, the triangles are written directly into an indexed_triangle_set.
+// Neither the admesh stl_file nor ObjParser::ObjData is created, thus the peak memory stays close to the size of the resulting mesh.
+
+// load_stl() and load_obj() switch to the streaming importers for files larger than this.
+constexpr size_t STREAMING_MESH_IMPORT_MIN_FILE_SIZE = size_t(256) * 1024 * 1024;
+
+// Load a binary or ASCII STL file. Vertices with bitwise equal coordinates are merged on the fly through a hash set,
+// facets with NaN vertices and facets degenerated by merging their vertices are dropped.
+// Unlike TriangleMesh::ReadSTLFile(), admesh does not repair the mesh: nearby vertices are not merged
+// and the orientation of the facets is not fixed. load_stl() repairs the result with its_repair().
+// stlFn is called with current / total being the portion of the file processed.
+extern bool its_load_stl_streaming(const char *path, indexed_triangle_set &its, ImportstlProgressFn stlFn = nullptr, int custom_header_length = 80);
+
+enum class ObjStreamingResult {
+    Ok,
+    // The file could not be read or it is malformed.
+    Failed,
+    // The file references materials or contains vertex colors, it has to be loaded with ObjParser.
+    Unsupported,
+    PolygonWithMoreThan4Vertices,
+    PolygonWithLessThan3Vertices,
+    InvalidVertexIndex,
+};
+
+// Load the vertex positions and the faces of an OBJ file, quads are split into two triangles the same way load_obj() does.
+// Normals, texture coordinates, groups and objects are ignored.
+extern ObjStreamingResult its_load_obj_streaming(const char *path, indexed_triangle_set &its);
+
+} // namespace Slic3r
+
+#endif /* slic3r_Format_StreamingMeshImport_hpp_ */
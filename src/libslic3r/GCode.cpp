@@ -23,6 +23,7 @@
 #include "LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
 #include "Time.hpp"
+#include "Trace.hpp"
 #include "GCode/ExtrusionProcessor.hpp"
 #include <algorithm>
 #include <cfloat>
@@ -2428,6 +2429,7 @@ WipeTowerType GCode::wipe_tower_type()
 void GCode::do_export(Print* print, const char* path, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb)
 {
     PROFILE_CLEAR();
+    Trace::Span span("export_gcode", "GCode");
 
     // BBS
     m_curr_print = print;
@@ -4273,6 +4275,7 @@ void GCode::process_layers(
                     return LayerResult::make_nop_layer_result();
                 }
             } else {
+                Trace::Span span("generate_layer", "process_layers", -1, int(layer_to_print_idx));
                 const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
                 print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
@@ -4294,28 +4297,53 @@ void GCode::process_layers(
         	if (in.nop_layer_result)
                 return in;
                 
+            Trace::Span span("spiral_vase", "process_layers", -1, int(in.layer_id));
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush};
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+            Trace::Span span("pressure_equalizer", "process_layers", -1, in.nop_layer_result ? -1 : int(in.layer_id));
             return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> std::string {
-        	if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    // The cooling buffer only carries the position, the extruder and the fan state from layer to layer in the serial stages,
+    // the G-code parsing and the slow down calculation run in parallel over the layers.
+    const auto cooling = tbb::make_filter<LayerResult, CoolingBuffer::LayerJob>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> CoolingBuffer::LayerJob {
+            if (in.nop_layer_result) {
+                CoolingBuffer::LayerJob job;
+                job.gcode = std::move(in.gcode);
+                return job;
+            }
+            Trace::Span span("cooling_collect", "process_layers", -1, int(in.layer_id));
+            return cooling_buffer.collect_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+        }) &
+        tbb::make_filter<CoolingBuffer::LayerJob, CoolingBuffer::LayerJob>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](CoolingBuffer::LayerJob job) -> CoolingBuffer::LayerJob {
+            Trace::Span span("cooling", "process_layers", -1, job.cool ? int(job.layer_id) : -1);
+            cooling_buffer.calculate_slowdown(job);
+            return job;
+        }) &
+        tbb::make_filter<CoolingBuffer::LayerJob, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](CoolingBuffer::LayerJob job) -> std::string {
+            if (! job.cool)
+                return std::move(job.gcode);
+            Trace::Span span("cooling_apply", "process_layers", -1, int(job.layer_id));
+            return cooling_buffer.apply_slowdown(std::move(job));
         });
     const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
             [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
+                Trace::Span span("pa_processor", "process_layers");
                 return pa_processor.process_layer(std::move(in));
             }
         );
     
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) {
+            Trace::Span span("output", "process_layers");
+            output_stream.write(s);
+        }
     );
 
     const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
@@ -4333,6 +4361,7 @@ void GCode::process_layers(
                     config.fan_speedup_overhangs.value,
                     (float)config.fan_kickstart.value));
             //flush as it's a whole layer
+            Trace::Span span("fan_mover", "process_layers");
             return fan_mover->process_gcode(in, true);
         }
         return in;
@@ -4377,6 +4406,7 @@ void GCode::process_layers(
                     return LayerResult::make_nop_layer_result();
                 }
             } else {
+                Trace::Span span("generate_layer", "process_layers", -1, int(layer_to_print_idx));
                 LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
                 print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
                 //BBS
@@ -4394,28 +4424,53 @@ void GCode::process_layers(
         [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
             if (in.nop_layer_result)
                 return in;
+            Trace::Span span("spiral_vase", "process_layers", -1, int(in.layer_id));
             spiral_mode.enable(in.spiral_vase_enable);
             bool last_layer = in.layer_id == layers_to_print.size() - 1;
             return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
+            Trace::Span span("pressure_equalizer", "process_layers", -1, in.nop_layer_result ? -1 : int(in.layer_id));
              return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
-            if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    // The cooling buffer only carries the position, the extruder and the fan state from layer to layer in the serial stages,
+    // the G-code parsing and the slow down calculation run in parallel over the layers.
+    const auto cooling = tbb::make_filter<LayerResult, CoolingBuffer::LayerJob>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> CoolingBuffer::LayerJob {
+            if (in.nop_layer_result) {
+                CoolingBuffer::LayerJob job;
+                job.gcode = std::move(in.gcode);
+                return job;
+            }
+            Trace::Span span("cooling_collect", "process_layers", -1, int(in.layer_id));
+            return cooling_buffer.collect_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+        }) &
+        tbb::make_filter<CoolingBuffer::LayerJob, CoolingBuffer::LayerJob>(slic3r_tbb_filtermode::parallel,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](CoolingBuffer::LayerJob job) -> CoolingBuffer::LayerJob {
+            Trace::Span span("cooling", "process_layers", -1, job.cool ? int(job.layer_id) : -1);
+            cooling_buffer.calculate_slowdown(job);
+            return job;
+        }) &
+        tbb::make_filter<CoolingBuffer::LayerJob, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](CoolingBuffer::LayerJob job) -> std::string {
+            if (! job.cool)
+                return std::move(job.gcode);
+            Trace::Span span("cooling_apply", "process_layers", -1, int(job.layer_id));
+            return cooling_buffer.apply_slowdown(std::move(job));
         });
     const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
         [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
+            Trace::Span span("pa_processor", "process_layers");
             return pa_processor.process_layer(std::move(in));
         }
     );
     
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
+        [&output_stream](std::string s) {
+            Trace::Span span("output", "process_layers");
+            output_stream.write(s);
+        }
     );
 
     const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
@@ -4431,6 +4486,7 @@ void GCode::process_layers(
                     config.fan_speedup_overhangs.value,
                     (float)config.fan_kickstart.value));
             //flush as it's a whole layer
+            Trace::Span span("fan_mover", "process_layers");
             return fan_mover->process_gcode(in, true);
         }
         return in;
@@ -7,8 +7,12 @@
 #include "AdaptivePAProcessor.hpp"
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include <cctype>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
 
 namespace Slic3r {
 
@@ -55,6 +59,50 @@ AdaptivePAInterpolator* AdaptivePAProcessor::getInterpolator(unsigned int tool_i
     return nullptr;  // Handle the case where the tool_id was not found
 }
 
+// Parse the feedrate of a "G1 F" line in mm/s. The line is a view into the layer buffer, which keeps it terminated
+// by '\n' or '\0', thus strtod() stops at the end of the line. Returns nothing if the F word is malformed.
+static std::optional<double> parse_feedrate(std::string_view line)
+{
+    const std::size_t pos = line.find('F');
+    if (pos == std::string_view::npos)
+        return std::nullopt;
+    const char *begin = line.data() + pos + 1;
+    char       *end   = nullptr;
+    const double feedrate = std::strtod(begin, &end);
+    if (end == begin || end > line.data() + line.size())
+        return std::nullopt;
+    return feedrate / 60.0; // Convert from mm/min to mm/s
+}
+
+// The feedrate the main pass of process_layer() would end the layer with: the last "G1 F" line outside a wipe.
+// Walks the lines backwards once. Candidate feedrates stay pending until the closest preceding line with a wipe tag
+// tells whether they were emitted during a wipe; candidates before the first wipe tag are outside of any wipe.
+static std::optional<double> last_feedrate(std::string_view gcode)
+{
+    static constexpr std::string_view feedrate_prefix = "G1 F";
+    std::optional<double> pending;
+    for (size_t line_end = gcode.size();;) {
+        const size_t           prev_eol   = line_end == 0 ? std::string_view::npos : gcode.rfind('\n', line_end - 1);
+        const size_t           line_start = prev_eol == std::string_view::npos ? 0 : prev_eol + 1;
+        const std::string_view line       = gcode.substr(line_start, line_end - line_start);
+        const bool wipe_start = line.find("WIPE_START") != std::string_view::npos;
+        const bool wipe_end   = line.find("WIPE_END") != std::string_view::npos;
+        // The main pass leaves a line tagged with WIPE_END outside of a wipe, even if it is tagged with WIPE_START too.
+        if (wipe_end) {
+            if (pending)
+                return pending;
+        } else if (wipe_start)
+            pending.reset();
+        // Speed changes are ignored from the line with WIPE_START till the line with WIPE_END.
+        if (! pending && ! wipe_start && line.substr(0, feedrate_prefix.size()) == feedrate_prefix)
+            pending = parse_feedrate(line);
+        if (line_start == 0)
+            break;
+        line_end = line_start - 1;
+    }
+    return pending;
+}
+
 /**
  * @brief Processes a layer of G-code and applies adaptive pressure advance.
  *
@@ -65,40 +113,64 @@ AdaptivePAInterpolator* AdaptivePAProcessor::getInterpolator(unsigned int tool_i
  * @return A string containing the processed G-code with adaptive pressure advance applied.
  */
 std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
-    std::istringstream stream(gcode);
-    std::string line;
-    std::ostringstream output;
+    // Fast path: the PA_CHANGE tags are only emitted for tools with adaptive PA enabled.
+    // Without them this filter would only copy the layer line by line, so hand the buffer through,
+    // terminating the last line the same way the line by line copy does.
+    // The feedrate is still tracked, a following layer with PA_CHANGE tags starts from it.
+    if (gcode.find("; PA_CHANGE") == std::string::npos) {
+        if (std::optional<double> feedrate = last_feedrate(gcode); feedrate)
+            m_current_feedrate = *feedrate;
+        if (! gcode.empty() && gcode.back() != '\n')
+            gcode += '\n';
+        return std::move(gcode);
+    }
+
+    // Split the layer into line views over the input buffer once. Both the main pass and the
+    // look-ahead below work on these views, so no per-line strings are allocated.
+    std::vector<std::string_view> lines;
+    lines.reserve(std::count(gcode.begin(), gcode.end(), '\n') + 1);
+    for (size_t start = 0; start < gcode.size();) {
+        size_t end = gcode.find('\n', start);
+        if (end == std::string::npos)
+            end = gcode.size();
+        lines.emplace_back(gcode.data() + start, end - start);
+        start = end + 1;
+    }
+
+    auto starts_with = [](std::string_view line, std::string_view prefix) { return line.substr(0, prefix.size()) == prefix; };
+
+    std::string output;
+    output.reserve(gcode.size() + gcode.size() / 16);
     double mm3mm_value = 0.0;
     unsigned int accel_value = 0;
-    std::string pa_change_line;
     bool wipe_command = false;
+    std::cmatch match;
 
     // Iterate through each line of the layer G-code
-    while (std::getline(stream, line)) {
-        
+    for (size_t line_idx = 0; line_idx < lines.size(); ++ line_idx) {
+        const std::string_view line = lines[line_idx];
+
         // If a wipe start command is found, ignore all speed changes till the wipe end part is found
-        if (line.find("WIPE_START") != std::string::npos) {
+        if (line.find("WIPE_START") != std::string_view::npos) {
             wipe_command = true;
         }
-                
+
         // Update current feed rate (this is preceding an extrude or wipe command only). Ignore any speed changes that are emitted during a wipe move.
         // Travel feedrate is output as part of a G1 X Y (Z) F command
-        if ( (line.find("G1 F") == 0) && (!wipe_command) ) { // prune lines quickly before running pattern matching
-            std::size_t pos = line.find('F');
-            if (pos != std::string::npos){
-                m_current_feedrate = std::stod(line.substr(pos + 1)) / 60.0; // Convert from mm/min to mm/s
-            }
+        if (starts_with(line, "G1 F") && (!wipe_command)) { // prune lines quickly before running pattern matching
+            if (std::optional<double> feedrate = parse_feedrate(line); feedrate)
+                m_current_feedrate = *feedrate;
         }
-        
+
         // Wipe end found, continue searching for current feed rate.
-        if (line.find("WIPE_END") != std::string::npos) {
+        if (line.find("WIPE_END") != std::string_view::npos) {
             wipe_command = false;
         }
-        
+
         // Reset next feedrate to zero enable searching for the first encountered
         // feedrate change command after the PA change tag.
         m_next_feedrate = 0;
-        
+
         // Check for PA_CHANGE pattern in the line
         // We will only find this pattern for extruders where adaptive PA is enabled.
         // If there is mixed extruders in the layer (i.e. with adaptive PA on and off
@@ -106,121 +178,116 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
         // as these are the only ones where the PA pattern is output
         // For a mixed extruder layer with both adaptive PA enabled and disabled when the new tool is selected
         // the PA for that material is set. As no tag below will be found for this extruder, the original PA is retained.
-        if (line.find("; PA_CHANGE") == 0) { // prune lines quickly before running regex check as regex is more expensive to run
-            if (std::regex_search(line, m_match, m_pa_change_pattern)) {
-                int extruder_id = std::stoi(m_match[1].str());
-                mm3mm_value = std::stod(m_match[2].str());
-                accel_value = std::stod(m_match[3].str());
-                int isBridge = std::stoi(m_match[4].str());
-                int roleChange = std::stoi(m_match[5].str());
-                int isOverhang = std::stoi(m_match[6].str());
-                
+        if (starts_with(line, "; PA_CHANGE")) { // prune lines quickly before running regex check as regex is more expensive to run
+            if (std::regex_search(line.data(), line.data() + line.size(), match, m_pa_change_pattern)) {
+                int extruder_id = std::stoi(match[1].str());
+                mm3mm_value = std::stod(match[2].str());
+                accel_value = std::stod(match[3].str());
+                int isBridge = std::stoi(match[4].str());
+                int roleChange = std::stoi(match[5].str());
+                int isOverhang = std::stoi(match[6].str());
+
                 // Check if the extruder ID has changed
                 bool extruder_changed = (extruder_id != m_last_extruder_id);
                 m_last_extruder_id = extruder_id;
-                
-                // Save the PA_CHANGE line to output later after finding feedrate
-                pa_change_line = line;
-                
+
                 // Look ahead for feedrate before any line containing both G and E commands
-                std::streampos current_pos = stream.tellg();
-                std::string next_line;
                 double temp_feed_rate = 0;
                 bool extrude_move_found = false;
                 int line_counter = 0;
-                
+
                 // Carry on searching on the layer gcode lines to find the print speed
                 // If a G1 Fxxxx pattern is found, the new speed is identified
                 // Carry on searching for feedrates to find the maximum print speed
                 // until a feature change pattern or a wipe command is detected
-                while (std::getline(stream, next_line)) {
+                for (size_t next_idx = line_idx + 1; next_idx < lines.size(); ++ next_idx) {
+                    const std::string_view next_line = lines[next_idx];
                     line_counter++;
                     // Found an extrude move, set extrude move found flag and move to the next line
-                    if ((!extrude_move_found) && next_line.find("G1 ") == 0 &&
-                        next_line.find('X') != std::string::npos &&
-                        next_line.find('Y') != std::string::npos &&
-                        next_line.find('E') != std::string::npos) {
+                    if ((!extrude_move_found) && starts_with(next_line, "G1 ") &&
+                        next_line.find('X') != std::string_view::npos &&
+                        next_line.find('Y') != std::string_view::npos &&
+                        next_line.find('E') != std::string_view::npos) {
                         // Pattern matched, break the loop
                         extrude_move_found = true;
                         continue;
                     }
-                    
+
                     // Found a travel move after we've found at least one extrude move
                     // We now need to stop searching for speeds as we're done printing this island
-                    if (next_line.find("G1 ") == 0 &&
-                        next_line.find('X') != std::string::npos && // X is present
-                        next_line.find('Y') != std::string::npos && // Y is present
-                        next_line.find('E') == std::string::npos && // no "E" present
-                        extrude_move_found) {                       // An extrude move has happened already
+                    if (starts_with(next_line, "G1 ") &&
+                        next_line.find('X') != std::string_view::npos && // X is present
+                        next_line.find('Y') != std::string_view::npos && // Y is present
+                        next_line.find('E') == std::string_view::npos && // no "E" present
+                        extrude_move_found) {                            // An extrude move has happened already
                         // First travel move after extrude move found. Stop searching
                         break;
                     }
-                    
+
                     // Found a WIPE command
                     // If we have a wipe command, usually the wipe speed is different (larger) than the max print speed
                     // for that feature. So stop searching if a wipe command is found because we do not want to overwrite the
                     // speed used for PA calculation by the Wipe speed.
-                    if (next_line.find("WIPE") != std::string::npos) {
+                    if (next_line.find("WIPE") != std::string_view::npos) {
                         break; // Stop searching if wipe command is found
                     }
-                    
+
                     // Found another PA_CHANGE pattern
                     // If RC = 1, it means we have a role change, so stop trying to find the max speed for the feature.
                     // This is possibly redundant as a new feature would always have a travel move preceding it
                     // but check anyway. However check last so to not invoke it without reason...
-                    if (next_line.find("; PA_CHANGE") == 0) { // prune lines quickly before running pattern matching
+                    if (starts_with(next_line, "; PA_CHANGE")) { // prune lines quickly before running pattern matching
                         std::size_t rc_pos = next_line.rfind("RC:");
-                        if (rc_pos != std::string::npos) {
-                            int rc_value = std::stoi(next_line.substr(rc_pos + 3));
-                            if (rc_value == 1) {
+                        if (rc_pos != std::string_view::npos) {
+                            // Lines are terminated by '\n' or '\0', thus strtol() stops at the end of the line.
+                            const char *rc_begin = next_line.data() + rc_pos + 3;
+                            char       *rc_end   = nullptr;
+                            int rc_value = int(std::strtol(rc_begin, &rc_end, 10));
+                            if (rc_end != rc_begin && rc_value == 1) {
                                 break; // Role change found, stop searching
                             }
                         }
                     }
-                    
+
                     // Found a Feedrate change command
                     // If the new feedrate is greater than any feedrate encountered so far after the PA change command, use that to calculate the PA value
                     // Also if this is the first feedrate we encounter, store it as the next feedrate.
-                    if (next_line.find("G1 F") == 0) { // prune lines quickly before running pattern matching
-                        std::size_t pos = next_line.find('F');
-                        if (pos != std::string::npos) {
-                            double feedrate = std::stod(next_line.substr(pos + 1)) / 60.0; // Convert from mm/min to mm/s
-                            if(line_counter==1){ // this is the first command after the PA change pattern, and hence before any extrusion has happened. Reset
-                                                // the current speed to this one
-                                m_current_feedrate = feedrate;
-                            }
-                            if (temp_feed_rate < feedrate) {
-                                temp_feed_rate = feedrate;
-                            }
-                            if(m_next_feedrate < EPSILON){ // This the first feedrate found after the PA Change command
-                                m_next_feedrate = feedrate;
-                            }
+                    if (starts_with(next_line, "G1 F")) { // prune lines quickly before running pattern matching
+                        std::optional<double> parsed_feedrate = parse_feedrate(next_line);
+                        if (! parsed_feedrate)
+                            continue;
+                        double feedrate = *parsed_feedrate;
+                        if(line_counter==1){ // this is the first command after the PA change pattern, and hence before any extrusion has happened. Reset
+                                            // the current speed to this one
+                            m_current_feedrate = feedrate;
+                        }
+                        if (temp_feed_rate < feedrate) {
+                            temp_feed_rate = feedrate;
+                        }
+                        if(m_next_feedrate < EPSILON){ // This the first feedrate found after the PA Change command
+                            m_next_feedrate = feedrate;
                         }
                         continue;
                     }
                 }
-                
+
                 // If we found a new maximum feedrate after the PA change command, use it
                 if (temp_feed_rate > 0) {
                     m_max_next_feedrate = temp_feed_rate;
                 } else // If we didnt find a new feedrate at all after the PA change command, use the current feedrate.
                     m_max_next_feedrate = m_current_feedrate;
-                
-                // Restore stream position
-                stream.clear();
-                stream.seekg(current_pos);
-                
+
                 // Calculate the predicted PA using the upcomming feature maximum feedrate
                 // Get the interpolator for the active tool
                 AdaptivePAInterpolator* interpolator = getInterpolator(m_last_extruder_id);
-                
+
                 double predicted_pa = 0;
                 double adaptive_PA_speed = 0;
-            
+
                 if(!interpolator){ // Tool not found in the interpolator map
                     // Tool not found in the PA interpolator to tool map
                     predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                    if(m_config.gcode_comments) output << "; APA: Tool doesnt have APA enabled\n";
+                    if(m_config.gcode_comments) output += "; APA: Tool doesnt have APA enabled\n";
                 } else if (!interpolator->isInitialised() || (!m_config.adaptive_pressure_advance.get_at(m_last_extruder_id)) )
                     // Check if the model is not initialised by the constructor for the active extruder
                     // Also check that adaptive PA is enabled for that extruder. This should not be needed
@@ -229,7 +296,7 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                 {
                     // Model failed or adaptive pressure advance not enabled - use default value from m_config
                     predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                    if(m_config.gcode_comments) output << "; APA: Interpolator setup failed, using default pressure advance\n";
+                    if(m_config.gcode_comments) output += "; APA: Interpolator setup failed, using default pressure advance\n";
                 } else { // Model setup succeeded
                     // Proceed to identify the print speed to use to calculate the adaptive PA value
                     if(isOverhang > 0){  // If we are in an overhang area, use the minimum between current print speed
@@ -244,43 +311,45 @@ std::string AdaptivePAProcessor::process_layer(std::string &&gcode) {
                                           // upcomming speeds for the island.
                         adaptive_PA_speed = std::max(m_max_next_feedrate,m_current_feedrate);
                     }
-                    
+
                     // Calculate the adaptive PA value
                     predicted_pa = (*interpolator)(mm3mm_value * adaptive_PA_speed, accel_value);
-                    
+
                     // This is a bridge, use the dedicated PA setting.
                     if(isBridge && m_config.adaptive_pressure_advance_bridges.get_at(m_last_extruder_id) > EPSILON)
                         predicted_pa = m_config.adaptive_pressure_advance_bridges.get_at(m_last_extruder_id);
-                    
+
                     if (predicted_pa < 0) { // If extrapolation fails, fall back to the default PA for the extruder.
                         predicted_pa = m_config.enable_pressure_advance.get_at(m_last_extruder_id) ? m_config.pressure_advance.get_at(m_last_extruder_id) : 0;
-                        if(m_config.gcode_comments) output << "; APA: Interpolation failed, using fallback pressure advance value\n";
+                        if(m_config.gcode_comments) output += "; APA: Interpolation failed, using fallback pressure advance value\n";
                     }
                 }
                 if(m_config.gcode_comments) {
                     // Output debug GCode comments
-                    output << pa_change_line << '\n'; // Output PA change command tag
+                    output.append(line.data(), line.size()); // Output PA change command tag
+                    output += '\n';
                     if(isBridge && m_config.adaptive_pressure_advance_bridges.get_at(m_last_extruder_id) > EPSILON)
-                        output << "; APA Model Override (bridge)\n";
-                    output << "; APA Current Speed: " << std::to_string(m_current_feedrate) << "\n";
-                    output << "; APA Next Speed: " << std::to_string(m_next_feedrate) << "\n";
-                    output << "; APA Max Next Speed: " << std::to_string(m_max_next_feedrate) << "\n";
-                    output << "; APA Speed Used: " << std::to_string(adaptive_PA_speed) << "\n";
-                    output << "; APA Flow rate: " << std::to_string(mm3mm_value * m_max_next_feedrate) << "\n";
-                    output << "; APA Prev PA: " << std::to_string(m_last_predicted_pa) << " New PA: " << std::to_string(predicted_pa) << "\n"; 
+                        output += "; APA Model Override (bridge)\n";
+                    output += "; APA Current Speed: " + std::to_string(m_current_feedrate) + "\n";
+                    output += "; APA Next Speed: " + std::to_string(m_next_feedrate) + "\n";
+                    output += "; APA Max Next Speed: " + std::to_string(m_max_next_feedrate) + "\n";
+                    output += "; APA Speed Used: " + std::to_string(adaptive_PA_speed) + "\n";
+                    output += "; APA Flow rate: " + std::to_string(mm3mm_value * m_max_next_feedrate) + "\n";
+                    output += "; APA Prev PA: " + std::to_string(m_last_predicted_pa) + " New PA: " + std::to_string(predicted_pa) + "\n";
                 }
                 if (extruder_changed || std::fabs(predicted_pa - m_last_predicted_pa) > EPSILON) {
-                    output << m_gcodegen.writer().set_pressure_advance(predicted_pa); // Use m_writer to set pressure advance
+                    output += m_gcodegen.writer().set_pressure_advance(predicted_pa); // Use m_writer to set pressure advance
                     m_last_predicted_pa = predicted_pa; // Update the last predicted PA value
                 }
             }
         }else {
             // Output the current line as this isn't a PA change tag
-            output << line << '\n';
+            output.append(line.data(), line.size());
+            output += '\n';
         }
     }
 
-    return output.str();
+    return output;
 }
 
 std::string AdaptivePAProcessor::validate_adaptive_pa_model(const std::string& model_str)
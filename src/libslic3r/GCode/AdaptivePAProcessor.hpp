@@ -80,7 +80,6 @@ private:
 
     std::regex m_pa_change_pattern; ///< Regular expression to detect PA_CHANGE pattern.
     std::regex m_g1_f_pattern; ///< Regular expression to detect G1 F pattern.
-    std::smatch m_match; ///< Match results for regular expressions.
 
     /**
      * @brief Get the PA interpolator attached to the specified tool ID.
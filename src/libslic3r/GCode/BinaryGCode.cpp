@@ -0,0 +1,455 @@
+#include "BinaryGCode.hpp"
+
+#include "../libslic3r.h"
+#include "../Exception.hpp"
+#include "../PrintConfig.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/beast/core/detail/base64.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#include <miniz.h>
+
+namespace Slic3r {
+namespace BinaryGCode {
+
+static constexpr const char     FILE_MAGIC[4]        = { 'G', 'C', 'D', 'E' };
+static constexpr const uint32_t FILE_VERSION         = 1;
+static constexpr const uint16_t CHECKSUM_CRC32       = 1;
+static constexpr const uint16_t COMPRESSION_NONE     = 0;
+static constexpr const uint16_t COMPRESSION_DEFLATE  = 1;
+// Metadata encoded as "key=value" lines.
+static constexpr const uint16_t METADATA_ENCODING_INI = 0;
+static constexpr const uint16_t GCODE_ENCODING_NONE   = 0;
+// Size of the uncompressed G-code stored into a single block.
+static constexpr const size_t   GCODE_BLOCK_SIZE      = 65536;
+
+using FilePtr = std::unique_ptr<FILE, decltype(&std::fclose)>;
+
+static void put_u16(std::string &out, uint16_t v)
+{
+    out += char(v & 0xff);
+    out += char(v >> 8);
+}
+
+static void put_u32(std::string &out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++ i)
+        out += char((v >> (8 * i)) & 0xff);
+}
+
+static uint16_t get_u16(const unsigned char *p) { return uint16_t(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const unsigned char *p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+
+static std::string encode_key_values(const KeyValues &key_values)
+{
+    std::string out;
+    for (const auto &[key, value] : key_values)
+        out += key + "=" + value + "\n";
+    return out;
+}
+
+Writer::Writer(FILE *file, const Metadata &metadata, const std::vector<Thumbnail> &thumbnails) : m_file(file)
+{
+    std::string header(FILE_MAGIC, sizeof(FILE_MAGIC));
+    put_u32(header, FILE_VERSION);
+    put_u16(header, CHECKSUM_CRC32);
+    m_error = ::fwrite(header.data(), 1, header.size(), m_file) != header.size();
+
+    // The order of the blocks is given by the format.
+    std::string printer = encode_key_values(metadata.printer);
+    this->write_block(BlockType::PrinterMetadata, { METADATA_ENCODING_INI }, printer.data(), printer.size(), true);
+    for (const Thumbnail &thumbnail : thumbnails)
+        // Images are compressed already.
+        this->write_block(BlockType::Thumbnail, { uint16_t(thumbnail.format), thumbnail.width, thumbnail.height },
+                          thumbnail.data.data(), thumbnail.data.size(), false);
+    std::string print = encode_key_values(metadata.print);
+    this->write_block(BlockType::PrintMetadata, { METADATA_ENCODING_INI }, print.data(), print.size(), true);
+    std::string slicer = encode_key_values(metadata.slicer);
+    this->write_block(BlockType::SlicerMetadata, { METADATA_ENCODING_INI }, slicer.data(), slicer.size(), true);
+}
+
+void Writer::append_gcode(const char *data, size_t size)
+{
+    m_gcode.append(data, size);
+    if (m_gcode.size() >= GCODE_BLOCK_SIZE)
+        this->write_gcode_blocks(false);
+}
+
+void Writer::flush()
+{
+    this->write_gcode_blocks(true);
+    if (m_file != nullptr && ::fflush(m_file) != 0)
+        m_error = true;
+}
+
+void Writer::write_gcode_blocks(bool flush_all)
+{
+    size_t begin = 0;
+    while (m_gcode.size() - begin >= GCODE_BLOCK_SIZE) {
+        // Cut the block after the last complete line, a single line longer than the block is stored whole.
+        size_t end = m_gcode.rfind('\n', begin + GCODE_BLOCK_SIZE - 1);
+        end = (end == std::string::npos || end < begin) ? m_gcode.find('\n', begin + GCODE_BLOCK_SIZE) : end;
+        if (end == std::string::npos)
+            break;
+        ++ end;
+        this->write_block(BlockType::GCode, { GCODE_ENCODING_NONE }, m_gcode.data() + begin, end - begin, true);
+        begin = end;
+    }
+    if (flush_all && begin < m_gcode.size()) {
+        this->write_block(BlockType::GCode, { GCODE_ENCODING_NONE }, m_gcode.data() + begin, m_gcode.size() - begin, true);
+        begin = m_gcode.size();
+    }
+    m_gcode.erase(0, begin);
+}
+
+void Writer::write_block(BlockType type, const std::vector<uint16_t> &params, const char *data, size_t size, bool compress)
+{
+    std::string compressed;
+    if (compress && size > 0) {
+        mz_ulong compressed_size = mz_compressBound(mz_ulong(size));
+        compressed.resize(compressed_size);
+        if (mz_compress2(reinterpret_cast<unsigned char*>(compressed.data()), &compressed_size, reinterpret_cast<const unsigned char*>(data),
+                mz_ulong(size), MZ_DEFAULT_LEVEL) == MZ_OK && compressed_size < size)
+            compressed.resize(compressed_size);
+        else
+            // Not worth it, store the data as they are.
+            compressed.clear();
+    }
+    const bool is_compressed = ! compressed.empty();
+
+    std::string block;
+    block.reserve(32 + (is_compressed ? compressed.size() : size));
+    put_u16(block, uint16_t(type));
+    put_u16(block, is_compressed ? COMPRESSION_DEFLATE : COMPRESSION_NONE);
+    put_u32(block, uint32_t(size));
+    if (is_compressed)
+        put_u32(block, uint32_t(compressed.size()));
+    for (uint16_t param : params)
+        put_u16(block, param);
+    if (is_compressed)
+        block += compressed;
+    else
+        block.append(data, size);
+    put_u32(block, uint32_t(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(block.data()), block.size())));
+
+    if (! m_error && ::fwrite(block.data(), 1, block.size(), m_file) != block.size())
+        m_error = true;
+}
+
+bool is_binary_gcode_file(const std::string &path)
+{
+    FilePtr file(boost::nowide::fopen(path.c_str(), "rb"), &std::fclose);
+    char magic[sizeof(FILE_MAGIC)];
+    return file && ::fread(magic, 1, sizeof(magic), file.get()) == sizeof(magic) && std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+Metadata metadata_from_config(const DynamicPrintConfig &config)
+{
+    Metadata metadata;
+    for (const char *key : { "printer_model", "printer_settings_id", "nozzle_diameter", "filament_type", "filament_settings_id",
+                             "print_settings_id", "layer_height", "curr_bed_type" })
+        if (config.has(key))
+            metadata.printer.emplace_back(key, config.opt_serialize(key));
+    metadata.slicer.emplace_back("Producer", std::string(SLIC3R_APP_NAME) + " " + SoftFever_VERSION);
+    return metadata;
+}
+
+// Thumbnails written by GCodeThumbnails::export_thumbnails_to_file() which have a binary G-code counterpart.
+static bool thumbnail_tag(std::string_view line, std::string_view suffix, ThumbnailFormat &format, std::string &tag)
+{
+    static constexpr const std::array<std::pair<std::string_view, ThumbnailFormat>, 3> tags { {
+        { "thumbnail", ThumbnailFormat::PNG }, { "thumbnail_JPG", ThumbnailFormat::JPG }, { "thumbnail_QOI", ThumbnailFormat::QOI } } };
+    if (! boost::starts_with(line, "; "))
+        return false;
+    line.remove_prefix(2);
+    for (const auto &[t, f] : tags)
+        if (boost::starts_with(line, t) && boost::starts_with(line.substr(t.size()), suffix)) {
+            format = f;
+            tag    = std::string(t);
+            return true;
+        }
+    return false;
+}
+
+static std::string thumbnail_format_tag(ThumbnailFormat format)
+{
+    switch (format) {
+    case ThumbnailFormat::JPG: return "thumbnail_JPG";
+    case ThumbnailFormat::QOI: return "thumbnail_QOI";
+    default:                   return "thumbnail";
+    }
+}
+
+// Reads the G-code file line by line, calls f(line, offset_of_the_line) with the line including its end of line.
+// Stops when f() returns false.
+template<typename Fn>
+static void for_each_line(FILE *file, Fn &&f)
+{
+    std::vector<char> buffer(GCODE_BLOCK_SIZE);
+    std::string       line;
+    size_t            offset = 0;
+    for (;;) {
+        size_t read = ::fread(buffer.data(), 1, buffer.size(), file);
+        if (read == 0)
+            break;
+        for (const char *p = buffer.data(), *end = buffer.data() + read; p != end;) {
+            const char *eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            line.append(p, eol == nullptr ? end : eol + 1);
+            p = eol == nullptr ? end : eol + 1;
+            if (eol != nullptr) {
+                if (! f(std::string_view(line), offset))
+                    return;
+                offset += line.size();
+                line.clear();
+            }
+        }
+    }
+    if (! line.empty())
+        f(std::string_view(line), offset);
+}
+
+static std::string_view trim_eol(std::string_view line)
+{
+    while (! line.empty() && (line.back() == '\n' || line.back() == '\r'))
+        line.remove_suffix(1);
+    return line;
+}
+
+void convert_ascii_to_binary(const std::string &src_path, const std::string &dst_path, Metadata metadata)
+{
+    FilePtr src(boost::nowide::fopen(src_path.c_str(), "rb"), &std::fclose);
+    if (! src)
+        throw Slic3r::RuntimeError(std::string("Binary G-code export failed.\nCannot open the G-code file ") + src_path + ".\n");
+
+    // 1st pass: the thumbnails and the header block precede the first G-code command. Collect them
+    // and the ranges of the source to be left out of the G-code blocks.
+    std::vector<Thumbnail>                   thumbnails;
+    std::vector<std::pair<size_t, size_t>>   skip;
+    {
+        bool        in_header     = false;
+        bool        in_thumbnail  = false;
+        size_t      range_begin   = size_t(-1);
+        size_t      wrapper_begin = size_t(-1);
+        std::string tag;
+        std::string encoded;
+        Thumbnail   thumbnail;
+        for_each_line(src.get(), [&](std::string_view raw_line, size_t offset) {
+            const std::string_view line = trim_eol(raw_line);
+            if (in_thumbnail) {
+                if (boost::starts_with(line, "; " + tag + " end")) {
+                    in_thumbnail = false;
+                    thumbnail.data.resize(boost::beast::detail::base64::decoded_size(encoded.size()));
+                    thumbnail.data.resize(boost::beast::detail::base64::decode(thumbnail.data.data(), encoded.data(), encoded.size()).first);
+                    thumbnails.emplace_back(std::move(thumbnail));
+                    thumbnail = {};
+                    skip.emplace_back(range_begin, offset + raw_line.size());
+                } else if (boost::starts_with(line, "; "))
+                    encoded.append(line.substr(2));
+                return true;
+            }
+            ThumbnailFormat format;
+            if (thumbnail_tag(line, " begin ", format, tag)) {
+                unsigned int width = 0, height = 0;
+                if (sscanf(std::string(line.substr(tag.size() + 9)).c_str(), "%ux%u", &width, &height) == 2) {
+                    in_thumbnail     = true;
+                    thumbnail.format = format;
+                    thumbnail.width  = uint16_t(width);
+                    thumbnail.height = uint16_t(height);
+                    encoded.clear();
+                    range_begin = wrapper_begin == size_t(-1) ? offset : wrapper_begin;
+                }
+            } else if (line == "; THUMBNAIL_BLOCK_START") {
+                wrapper_begin = offset;
+            } else if (line == "; THUMBNAIL_BLOCK_END") {
+                if (! skip.empty() && skip.back().first == wrapper_begin)
+                    skip.back().second = offset + raw_line.size();
+                wrapper_begin = size_t(-1);
+            } else if (line == "; HEADER_BLOCK_START") {
+                in_header = true;
+            } else if (line == "; HEADER_BLOCK_END") {
+                in_header = false;
+            } else if (in_header && boost::starts_with(line, "; ")) {
+                std::string_view entry = line.substr(2);
+                size_t           sep   = std::min(entry.find(':'), entry.find('='));
+                if (sep != std::string_view::npos) {
+                    std::string key(entry.substr(0, sep)), value(entry.substr(sep + 1));
+                    boost::trim(key);
+                    boost::trim(value);
+                    if (! key.empty())
+                        metadata.print.emplace_back(std::move(key), std::move(value));
+                }
+            } else if (! line.empty() && line.front() != ';') {
+                // The first G-code command, there are no thumbnails below.
+                return false;
+            } else if (line != ";" && ! line.empty()) {
+                wrapper_begin = size_t(-1);
+            }
+            return true;
+        });
+    }
+
+    // 2nd pass: stream the G-code into the compressed blocks.
+    ::rewind(src.get());
+    FilePtr dst(boost::nowide::fopen(dst_path.c_str(), "wb"), &std::fclose);
+    if (! dst)
+        throw Slic3r::RuntimeError(std::string("Binary G-code export failed.\nCannot open the file ") + dst_path + " for writing.\n");
+    bool error = false;
+    {
+        Writer              writer(dst.get(), metadata, thumbnails);
+        std::vector<char>   buffer(GCODE_BLOCK_SIZE);
+        size_t              offset   = 0;
+        auto                skip_it  = skip.begin();
+        for (;;) {
+            size_t read = ::fread(buffer.data(), 1, buffer.size(), src.get());
+            if (read == 0)
+                break;
+            // Copy the parts of [offset, offset + read) outside of the skipped ranges.
+            size_t pos = offset;
+            const size_t end = offset + read;
+            while (pos < end) {
+                while (skip_it != skip.end() && skip_it->second <= pos)
+                    ++ skip_it;
+                if (skip_it != skip.end() && skip_it->first <= pos) {
+                    pos = std::min(end, skip_it->second);
+                    continue;
+                }
+                size_t copy_end = skip_it == skip.end() ? end : std::min(end, skip_it->first);
+                writer.append_gcode(buffer.data() + (pos - offset), copy_end - pos);
+                pos = copy_end;
+            }
+            offset = end;
+        }
+        error = ::ferror(src.get()) != 0;
+        writer.flush();
+        error |= writer.is_error();
+    }
+    if (error) {
+        dst.reset();
+        boost::nowide::remove(dst_path.c_str());
+        throw Slic3r::RuntimeError(std::string("Binary G-code export to ") + dst_path + " failed.\nIs the disk full?\n");
+    }
+    BOOST_LOG_TRIVIAL(info) << "Binary G-code exported to " << dst_path << " with " << thumbnails.size() << " thumbnails";
+}
+
+void convert_binary_to_ascii(const std::string &src_path, const std::string &dst_path)
+{
+    auto fail = [&src_path](const std::string &reason) {
+        throw Slic3r::RuntimeError(std::string("Failed to read the binary G-code file ") + src_path + ".\n" + reason + "\n");
+    };
+    FilePtr src(boost::nowide::fopen(src_path.c_str(), "rb"), &std::fclose);
+    if (! src)
+        fail("Cannot open the file.");
+    unsigned char header[10];
+    if (::fread(header, 1, sizeof(header), src.get()) != sizeof(header) || std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+        fail("Not a binary G-code file.");
+    if (get_u32(header + 4) != FILE_VERSION)
+        fail("Unsupported version.");
+    const bool has_checksum = get_u16(header + 8) == CHECKSUM_CRC32;
+
+    FilePtr dst(boost::nowide::fopen(dst_path.c_str(), "wb"), &std::fclose);
+    if (! dst)
+        fail("Cannot open " + dst_path + " for writing.");
+
+    std::string block;
+    std::string data;
+    for (;;) {
+        unsigned char block_header[12];
+        size_t        read = ::fread(block_header, 1, 8, src.get());
+        if (read == 0)
+            break;
+        if (read != 8)
+            fail("Truncated block header.");
+        const auto     type              = BlockType(get_u16(block_header));
+        const uint16_t compression       = get_u16(block_header + 2);
+        const uint32_t uncompressed_size = get_u32(block_header + 4);
+        size_t         header_size       = 8;
+        uint32_t       stored_size       = uncompressed_size;
+        if (compression != COMPRESSION_NONE) {
+            if (compression != COMPRESSION_DEFLATE)
+                fail("Unsupported compression.");
+            if (::fread(block_header + 8, 1, 4, src.get()) != 4)
+                fail("Truncated block header.");
+            stored_size = get_u32(block_header + 8);
+            header_size = 12;
+        }
+        const size_t params_size = type == BlockType::Thumbnail ? 6 : 2;
+        block.assign(reinterpret_cast<const char*>(block_header), header_size);
+        block.resize(header_size + params_size + stored_size);
+        if (::fread(block.data() + header_size, 1, params_size + stored_size, src.get()) != params_size + stored_size)
+            fail("Truncated block.");
+        if (has_checksum) {
+            unsigned char crc[4];
+            if (::fread(crc, 1, 4, src.get()) != 4 ||
+                get_u32(crc) != uint32_t(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(block.data()), block.size())))
+                fail("Block checksum mismatch.");
+        }
+        const unsigned char *params  = reinterpret_cast<const unsigned char*>(block.data()) + header_size;
+        const char          *payload = block.data() + header_size + params_size;
+        if (compression == COMPRESSION_DEFLATE) {
+            data.resize(uncompressed_size);
+            mz_ulong size = uncompressed_size;
+            if (mz_uncompress(reinterpret_cast<unsigned char*>(data.data()), &size, reinterpret_cast<const unsigned char*>(payload), stored_size) != MZ_OK ||
+                size != uncompressed_size)
+                fail("Corrupted block.");
+        } else
+            data.assign(payload, stored_size);
+
+        std::string out;
+        if (type == BlockType::GCode) {
+            if (get_u16(params) != GCODE_ENCODING_NONE)
+                fail("Unsupported G-code encoding.");
+            out = std::move(data);
+        } else if (type == BlockType::Thumbnail) {
+            // Restore the thumbnail the same way GCodeThumbnails::export_thumbnails_to_file() writes it.
+            static constexpr const size_t max_row_length = 78;
+            const std::string tag = thumbnail_format_tag(ThumbnailFormat(get_u16(params)));
+            std::string encoded;
+            encoded.resize(boost::beast::detail::base64::encoded_size(data.size()));
+            encoded.resize(boost::beast::detail::base64::encode(encoded.data(), data.data(), data.size()));
+            out = "; THUMBNAIL_BLOCK_START\n" +
+                  (boost::format("\n;\n; %s begin %dx%d %d\n") % tag % get_u16(params + 2) % get_u16(params + 4) % encoded.size()).str();
+            for (size_t i = 0; i < encoded.size(); i += max_row_length)
+                out += "; " + encoded.substr(i, max_row_length) + "\n";
+            out += "; " + tag + " end\n; THUMBNAIL_BLOCK_END\n\n";
+        }
+        // The metadata blocks were derived from the header block of the G-code and from the config, nothing to restore.
+        if (! out.empty() && ::fwrite(out.data(), 1, out.size(), dst.get()) != out.size())
+            fail("Failed to write " + dst_path + ".");
+    }
+    if (::fflush(dst.get()) != 0)
+        fail("Failed to write " + dst_path + ".");
+}
+
+DecodedFile::DecodedFile(const std::string &src_path) :
+    m_path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("." SLIC3R_APP_KEY ".bgcode.%%%%-%%%%-%%%%-%%%%.gcode")).string())
+{
+    try {
+        convert_binary_to_ascii(src_path, m_path);
+    } catch (...) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(m_path, ec);
+        throw;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Binary G-code " << src_path << " decoded to " << m_path;
+}
+
+DecodedFile::~DecodedFile()
+{
+    boost::system::error_code ec;
+    if (! boost::filesystem::remove(m_path, ec) && ec)
+        BOOST_LOG_TRIVIAL(error) << "Failed to remove the decoded G-code " << m_path << ": " << ec.message();
+}
+
+} // namespace BinaryGCode
+} // namespace Slic3r
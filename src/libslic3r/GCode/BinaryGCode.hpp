@@ -0,0 +1,111 @@
+#ifndef slic3r_BinaryGCode_hpp_
+#define slic3r_BinaryGCode_hpp_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+class DynamicPrintConfig;
+
+// Block based binary G-code, following the layout of the "bgcode" format version 1:
+// file header, printer metadata, thumbnails, print metadata, slicer metadata and G-code blocks,
+// each block protected by a CRC32 checksum. The metadata and the G-code blocks are deflate compressed,
+// the G-code is stored without MeatPack encoding.
+namespace BinaryGCode {
+
+enum class BlockType : uint16_t {
+    FileMetadata    = 0,
+    GCode           = 1,
+    SlicerMetadata  = 2,
+    PrinterMetadata = 3,
+    PrintMetadata   = 4,
+    Thumbnail       = 5,
+};
+
+enum class ThumbnailFormat : uint16_t {
+    PNG = 0,
+    JPG = 1,
+    QOI = 2,
+};
+
+using KeyValues = std::vector<std::pair<std::string, std::string>>;
+
+struct Metadata
+{
+    KeyValues printer;
+    KeyValues print;
+    KeyValues slicer;
+};
+
+struct Thumbnail
+{
+    ThumbnailFormat format { ThumbnailFormat::PNG };
+    uint16_t        width  { 0 };
+    uint16_t        height { 0 };
+    // Encoded image (PNG, JPG or QOI file content).
+    std::string     data;
+};
+
+// Writes a binary G-code file block by block. The G-code is appended in pieces of any size,
+// it is cut into compressed blocks at line boundaries, so only a single block is kept in memory.
+class Writer
+{
+public:
+    // The file is owned by the caller. Writes the file header and all the blocks preceding the G-code.
+    Writer(FILE *file, const Metadata &metadata, const std::vector<Thumbnail> &thumbnails);
+    ~Writer() { this->flush(); }
+
+    void append_gcode(const char *data, size_t size);
+    // Writes the pending G-code block.
+    void flush();
+    bool is_error() const { return m_error; }
+
+private:
+    void write_block(BlockType type, const std::vector<uint16_t> &params, const char *data, size_t size, bool compress);
+    void write_gcode_blocks(bool flush_all);
+
+    FILE       *m_file;
+    std::string m_gcode;
+    bool        m_error { false };
+};
+
+// Tests the file header.
+bool is_binary_gcode_file(const std::string &path);
+
+// Fill in the printer and slicer metadata from the full print config.
+Metadata metadata_from_config(const DynamicPrintConfig &config);
+
+// Converts a G-code file exported by the slicer into a binary G-code file. The thumbnails are moved from the
+// G-code comments into thumbnail blocks, the header block of the G-code is copied into the print metadata.
+// Throws Slic3r::RuntimeError on failure.
+void convert_ascii_to_binary(const std::string &src_path, const std::string &dst_path, Metadata metadata);
+
+// Converts a binary G-code file back to a plain text G-code, the thumbnails are written as G-code comments.
+// Throws Slic3r::RuntimeError on failure, for example if a block checksum does not match.
+void convert_binary_to_ascii(const std::string &src_path, const std::string &dst_path);
+
+// Plain text G-code decoded from a binary G-code into a unique file in the temp directory.
+// The file is removed when this object is destroyed.
+class DecodedFile
+{
+public:
+    // Throws Slic3r::RuntimeError on failure, see convert_binary_to_ascii().
+    explicit DecodedFile(const std::string &src_path);
+    ~DecodedFile();
+    DecodedFile(const DecodedFile &) = delete;
+    DecodedFile& operator=(const DecodedFile &) = delete;
+
+    const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+};
+
+} // namespace BinaryGCode
+} // namespace Slic3r
+
+#endif // slic3r_BinaryGCode_hpp_
@@ -3,7 +3,9 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
+#include <algorithm>
 #include <iostream>
+#include <charconv>
 #include <float.h>
 #include <system_error>
 #include <unordered_map>
@@ -313,7 +315,19 @@ finished:
 	return new_feedrate;
 }
 
+CoolingBuffer::LayerJob::LayerJob() = default;
+CoolingBuffer::LayerJob::LayerJob(LayerJob &&) = default;
+CoolingBuffer::LayerJob& CoolingBuffer::LayerJob::operator=(LayerJob &&) = default;
+CoolingBuffer::LayerJob::~LayerJob() = default;
+
 std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
+{
+    LayerJob job = this->collect_layer(std::move(gcode), layer_id, flush);
+    this->calculate_slowdown(job);
+    return this->apply_slowdown(std::move(job));
+}
+
+CoolingBuffer::LayerJob CoolingBuffer::collect_layer(std::string &&gcode, size_t layer_id, bool flush)
 {
     // Cache the input G-code.
     if (m_gcode.empty())
@@ -321,21 +335,146 @@ std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, b
     else
         m_gcode += gcode;
 
-    std::string out;
+    LayerJob job;
+    job.layer_id = layer_id;
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
-        float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
-        out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
+        job.cool           = true;
+        job.start_pos      = m_current_pos;
+        job.start_extruder = m_collected_extruder;
+        job.gcode          = std::move(m_gcode);
         m_gcode.clear();
+        this->advance_collected_state(job.gcode);
     }
-    return out;
+    return job;
+}
+
+void CoolingBuffer::calculate_slowdown(LayerJob &job) const
+{
+    if (job.cool) {
+        job.per_extruder_adjustments = this->parse_layer_gcode(job.gcode, job.start_pos, job.start_extruder);
+        job.layer_time               = calculate_layer_slowdown(job.per_extruder_adjustments);
+    }
+}
+
+std::string CoolingBuffer::apply_slowdown(LayerJob &&job)
+{
+    if (! job.cool)
+        return {};
+    return this->apply_layer_cooldown(job.gcode, job.layer_id, job.layer_time, job.per_extruder_adjustments);
+}
+
+// Parse the axis words of a G0 / G1 / G2 / G3 / G92 line, c points after the command, the line ends at end or at the terminating zero.
+// Calls f(axis, value) for X, Y, Z, E, F, I, J (axes 0 to 6) with the value as written, F in mm/min.
+template<typename Fn>
+static void parse_axis_words(const char *c, const char *end, Fn &&f)
+{
+    for (;;) {
+        // Skip whitespaces.
+        for (; c != end && (*c == ' ' || *c == '\t'); ++ c);
+        if (c == end || *c == 0 || *c == ';')
+            break;
+
+        assert(is_decimal_separator_point()); // for atof
+        //BBS: Parse the axis.
+        size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
+                      (*c == 'E') ? 3 : (*c == 'F') ? 4 :
+                      (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
+        // atof() stops at the end of line or at the terminating zero.
+        if (axis != size_t(-1))
+            f(axis, float(atof(++c)));
+        // Skip this word.
+        for (; c != end && *c != ' ' && *c != '\t' && *c != 0; ++ c);
+    }
+}
+
+static inline bool is_move_or_set_position(std::string_view sline)
+{
+    return boost::starts_with(sline, "G0 ") || boost::starts_with(sline, "G1 ") || boost::starts_with(sline, "G92 ") ||
+           boost::starts_with(sline, "G2 ") || boost::starts_with(sline, "G3 ");
+}
+
+void CoolingBuffer::advance_collected_state(const std::string &gcode)
+{
+    advance_end_state(gcode, m_toolchange_prefix, m_num_extruders, m_current_pos, m_collected_extruder);
+}
+
+// Produces the same end state as parse_layer_gcode() for X, Y, Z, E, F and the active extruder, but only their last values
+// matter, thus the G-code is scanned from its end and the scan stops as soon as X, Y, Z, E and F were found.
+// I and J are only updated if they are met before the scan stops, they are written by every arc, thus the values
+// carried over from the preceding layers are never used.
+// This is the only part of the cooling which has to see the layers in order before the slow down is calculated.
+void CoolingBuffer::advance_end_state(std::string_view gcode, std::string_view toolchange_prefix, unsigned int num_extruders,
+                                      std::vector<float> &current_pos, unsigned int &current_extruder)
+{
+    std::vector<float> end_pos(current_pos);
+    // X, Y, Z, E, F, I, J resolved; I and J are stored relative to the position preceding their line,
+    // thus they are resolved once the X (Y) of a preceding line is found.
+    bool               found[7]   = { false, false, false, false, false, false, false };
+    bool               pending[2] = { false, false };
+    float              center[2]  = { 0.f, 0.f };
+    auto all_found = [&found, &pending]() {
+        return ! pending[0] && ! pending[1] && std::all_of(std::begin(found), std::begin(found) + 5, [](bool b) { return b; });
+    };
+
+    size_t line_end = gcode.size();
+    while (line_end > 0 && ! all_found()) {
+        size_t content_end = line_end;
+        if (gcode[content_end - 1] == '\n')
+            -- content_end;
+        size_t line_begin = content_end == 0 ? std::string_view::npos : gcode.rfind('\n', content_end - 1);
+        line_begin = line_begin == std::string_view::npos ? 0 : line_begin + 1;
+        line_end   = line_begin;
+        const std::string_view sline = gcode.substr(line_begin, content_end - line_begin);
+        if (is_move_or_set_position(sline)) {
+            float value[7];
+            bool  has[7] = { false, false, false, false, false, false, false };
+            parse_axis_words(sline.data() + 3, sline.data() + sline.size(), [&value, &has](size_t axis, float v) { value[axis] = v; has[axis] = true; });
+            for (size_t i = 0; i < 2; ++ i)
+                if (pending[i] && has[i]) {
+                    end_pos[5 + i] = center[i] + value[i];
+                    pending[i]     = false;
+                }
+            for (size_t axis = 0; axis < 7; ++ axis)
+                if (has[axis] && ! found[axis]) {
+                    found[axis] = true;
+                    if (axis < 5)
+                        end_pos[axis] = axis == 4 ? value[axis] / 60.f : value[axis];
+                    else {
+                        center[axis - 5]  = value[axis];
+                        pending[axis - 5] = true;
+                    }
+                }
+        }
+    }
+    // The arc center was set relative to a position carried over from the preceding layers.
+    for (size_t i = 0; i < 2; ++ i)
+        if (pending[i])
+            end_pos[5 + i] = center[i] + current_pos[i];
+    current_pos = std::move(end_pos);
+
+    // The last tool change may be anywhere in the layer, search for it without splitting the G-code into lines.
+    if (! toolchange_prefix.empty())
+        for (size_t pos = gcode.size(); pos > 0;) {
+            pos = gcode.rfind(toolchange_prefix, pos - 1);
+            if (pos == std::string_view::npos)
+                break;
+            if (pos > 0 && gcode[pos - 1] != '\n')
+                continue;
+            const char  *end          = gcode.data() + std::min(gcode.find('\n', pos), gcode.size());
+            unsigned int new_extruder = 0;
+            auto ret = std::from_chars(gcode.data() + pos + toolchange_prefix.size(), end, new_extruder);
+            if (std::errc::invalid_argument != ret.ec && new_extruder < num_extruders) {
+                current_extruder = new_extruder;
+                break;
+            }
+        }
 }
 
 // Parse the layer G-code for the moves, which could be adjusted.
 // Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> current_pos, unsigned int current_extruder) const
 {
     std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
     std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
@@ -351,7 +490,6 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
         map_extruder_to_per_extruder_adjustment[extruder_id] = i;
     }
 
-    unsigned int      current_extruder  = m_current_extruder;
     PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
     const char       *line_start = gcode.c_str();
     const char       *line_end   = line_start;
@@ -387,34 +525,19 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
             // G0, G1 or G92
             // Parse the G-code line.
             std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
-            for (;;) {
-                // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
-                    break;
-
-                assert(is_decimal_separator_point()); // for atof
-                //BBS: Parse the axis.
-                size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
-                              (*c == 'E') ? 3 : (*c == 'F') ? 4 :
-                              (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
-                if (axis != size_t(-1)) {
-                    new_pos[axis] = float(atof(++c));
-                    if (axis == 4) {
-                        // Convert mm/min to mm/sec.
-                        new_pos[4] /= 60.f;
-                        if ((line.type & CoolingLine::TYPE_G92) == 0)
-                            // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
-                            line.type |= CoolingLine::TYPE_HAS_F;
-                    } else if (axis == 5 || axis == 6) {
-                        // BBS: get position of arc center
-                        new_pos[axis] += current_pos[axis - 5];
-                    }
+            parse_axis_words(sline.data() + 3, sline.data() + sline.size(), [&line, &new_pos, &current_pos](size_t axis, float value) {
+                new_pos[axis] = value;
+                if (axis == 4) {
+                    // Convert mm/min to mm/sec.
+                    new_pos[4] /= 60.f;
+                    if ((line.type & CoolingLine::TYPE_G92) == 0)
+                        // This is G0 or G1 line and it sets the feedrate. This mark is used for reducing the duplicate F calls.
+                        line.type |= CoolingLine::TYPE_HAS_F;
+                } else if (axis == 5 || axis == 6) {
+                    // BBS: get position of arc center
+                    new_pos[axis] += current_pos[axis - 5];
                 }
-                // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
-            }
+            });
             bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
             bool wipe               = boost::contains(sline, ";_WIPE");
             if (external_perimeter)
@@ -3,7 +3,9 @@
 
 #include "../libslic3r.h"
 #include <map>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <cfloat>
 
 namespace Slic3r {
@@ -23,15 +25,49 @@ struct PerExtruderAdjustments;
 //
 class CoolingBuffer {
 public:
+    // A layer travelling through the stages of process_layer().
+    struct LayerJob {
+        LayerJob();
+        LayerJob(LayerJob &&);
+        LayerJob& operator=(LayerJob &&);
+        ~LayerJob();
+
+        std::string                         gcode;
+        size_t                              layer_id { 0 };
+        // False if the G-code is passed through unchanged: it is cached until the next object layer.
+        bool                                cool { false };
+        // Position and extruder at the start of the layer, carried over from the preceding layers.
+        std::vector<float>                  start_pos;
+        unsigned int                        start_extruder { 0 };
+        // Filled in by calculate_slowdown().
+        std::vector<PerExtruderAdjustments> per_extruder_adjustments;
+        float                               layer_time { 0.f };
+    };
+
     CoolingBuffer(GCode &gcodegen);
     void        reset(const Vec3d &position);
-    void        set_current_extruder(unsigned int extruder_id, unsigned int nozzle_id) { m_current_extruder = extruder_id; m_current_nozzle = nozzle_id; }
+    void        set_current_extruder(unsigned int extruder_id, unsigned int nozzle_id) { m_current_extruder = m_collected_extruder = extruder_id; m_current_nozzle = nozzle_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
 
+    // process_layer() split into stages, so that G-code export may run them as separate pipeline filters.
+    // collect_layer() and apply_slowdown() have to be called in the layer order, they carry the position,
+    // the active extruder and the fan state over from layer to layer.
+    // calculate_slowdown() only reads the configuration, it may process multiple layers in parallel.
+    LayerJob    collect_layer(std::string &&gcode, size_t layer_id, bool flush);
+    void        calculate_slowdown(LayerJob &job) const;
+    std::string apply_slowdown(LayerJob &&job);
+
+    // Update current_pos (X, Y, Z, E, F, I, J, F in mm/sec) and current_extruder to the state at the end of gcode,
+    // scanning gcode backwards. Missing axes and a missing tool change keep their values.
+    static void advance_end_state(std::string_view gcode, std::string_view toolchange_prefix, unsigned int num_extruders,
+                                  std::vector<float> &current_pos, unsigned int &current_extruder);
+
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const;
-    float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> current_pos, unsigned int current_extruder) const;
+    // Update m_current_pos and m_collected_extruder to the state at the end of gcode.
+    void        advance_collected_state(const std::string &gcode);
+    static float calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
     std::string apply_layer_cooldown(const std::string &gcode, size_t layer_id, float layer_time, std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
@@ -41,7 +77,10 @@ private:
     // Internal data.
     // BBS: X,Y,Z,E,F,I,J
     std::vector<char>           m_axis;
+    // Position at the end of the G-code collected so far.
     std::vector<float>          m_current_pos;
+    // Extruder active at the end of the G-code collected so far.
+    unsigned int                m_collected_extruder { 0 };
     // Current known fan speed or -1 if not known yet.
     int                         m_fan_speed;
     int                         m_additional_fan_speed;
@@ -54,6 +93,7 @@ private:
     // Referencs GCode::m_config, which is FullPrintConfig. While the PrintObjectConfig slice of FullPrintConfig is being modified,
     // the PrintConfig slice of FullPrintConfig is constant, thus no thread synchronization is required.
     const PrintConfig          &m_config;
+    // Extruder active at the G-code line being emitted by apply_slowdown().
     unsigned int                m_current_extruder;
     unsigned int                m_current_nozzle;
     //BBS: current fan speed
@@ -7,6 +7,8 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/format.hpp"
+#include "libslic3r/Trace.hpp"
+#include "BinaryGCode.hpp"
 #include "GCodeProcessor.hpp"
 
 #include <boost/log/trivial.hpp>
@@ -20,6 +22,7 @@
 
 #include <float.h>
 #include <assert.h>
+#include <cstring>
 #include <regex>
 #include <sstream>
 #include <charconv>
@@ -1784,13 +1787,12 @@ void GCodeProcessor::run_post_process()
 // handle_offsets_of_second_process). It runs only when m_enable_pre_heating — the byte-frozen fleet
 // (X1/P1/A1/H2S) never sets the flag, so it never enters this pass. The PreCoolingInjector (below)
 // fills the map; when the injector produces no lines (no idle windows / no usage blocks) the map is
-// empty and the pass is a byte-for-byte identity rewrite of the finished file.
+// empty and the finished file is left untouched.
 void GCodeProcessor::run_second_pass_injection()
 {
     // The ordered map of M632/M400/M104/M633 lines to splice into the finished g-code, keyed on the
     // final output line id. Populated by the PreCoolingInjector below. If the injector produces
-    // nothing (no idle windows / no usage blocks), the map stays empty and the rewrite below is a
-    // byte-for-byte identity pass.
+    // nothing (no idle windows / no usage blocks), the map stays empty and the rewrite below is skipped.
     TimeProcessor::InsertedLinesMap inserted_operation_lines;
 
     // The enable_pre_heating orchestration block. Build the injector from the reconciled first-pass
@@ -1809,7 +1811,7 @@ void GCodeProcessor::run_second_pass_injection()
         }
         // Reach the concrete layer-aware grouping (get_nozzle_from_id / is_support_dynamic_nozzle_map
         // are not on the base interface). Orca: nil-guard it — on a slicing path that never populated
-        // the grouping, skip injection → empty map → identity rewrite. The shared_ptr local keeps the
+        // the grouping, skip injection → empty map → no rewrite. The shared_ptr local keeps the
         // object alive for the injector's const ref.
         auto layered_ngr = std::dynamic_pointer_cast<MultiNozzleUtils::LayeredNozzleGroupResult>(m_result.nozzle_group_result);
         if (layered_ngr) {
@@ -1872,6 +1874,11 @@ void GCodeProcessor::run_second_pass_injection()
         }
     }
 
+    // Nothing to splice: the rewrite would be a byte-for-byte identity of the finished file, its lines_ends and
+    // the moves' gcode_ids are already final. Skip the second read/write pass over the whole output.
+    if (inserted_operation_lines.empty())
+        return;
+
     FilePtr in{ boost::nowide::fopen(m_result.filename.c_str(), "rb") };
     if (in.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor pre-heat injection pass failed.\nCannot open file for reading.\n"));
@@ -1881,8 +1888,7 @@ void GCodeProcessor::run_second_pass_injection()
     if (out.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor pre-heat injection pass failed.\nCannot open file for writing.\n"));
 
-    // The rewrite may shift byte positions (once the injector inserts lines), so rebuild lines_ends from scratch.
-    // With an empty map the scanned '\n' offsets reproduce the current lines_ends exactly.
+    // The rewrite shifts byte positions after the first spliced line, so rebuild lines_ends from scratch.
     m_result.lines_ends.clear();
     size_t out_file_pos = 0;
 
@@ -1895,76 +1901,97 @@ void GCodeProcessor::run_second_pass_injection()
             boost::nowide::remove(out_path.c_str());
             throw Slic3r::RuntimeError(std::string("GCode processor pre-heat injection pass failed.\nIs the disk full?\n"));
         }
-        for (size_t i = 0; i < str.size(); ++i) {
-            if (str[i] == '\n')
-                m_result.lines_ends.emplace_back(out_file_pos + i + 1);
-        }
+        for (const char *c = str.data(), *end = c + str.size(); (c = static_cast<const char*>(std::memchr(c, '\n', end - c))) != nullptr; ++ c)
+            m_result.lines_ends.emplace_back(out_file_pos + (c - str.data()) + 1);
         out_file_pos += str.size();
         str.clear();
     };
 
-    // Orca: read/split lines with EOL-preserving semantics (keep the original \r and \n bytes, and
-    // synthesize no trailing newline). This is required for the empty-map identity: normalizing every
-    // line ending to "\n" would not be byte-identical if the finished file used \r\n or lacked a
-    // final newline.
-    std::string gcode_line;
+    // Orca: lines are delimited with EOL-preserving semantics: "\r", "\n" and "\r\n" each end one line, the original
+    // bytes are kept and no trailing newline is synthesized. The input is not split into lines at all: whole spans of
+    // the read buffer are copied to the output, they are only cut at the lines after which the injector lines are spliced.
     std::string export_buffer;
     unsigned int line_id = 0;
     auto op_it = inserted_operation_lines.begin();
+    // Start of the not yet exported part of the read buffer.
+    const char *span = nullptr;
+    // Called after the end of line characters of each line.
+    auto on_line_end = [&](const char *after_eol) {
+        ++line_id;
+        // Splice any injector lines registered at this output line id after the line including its EOL.
+        // PlaceholderReplace / TimePredict / ExtruderChangePredict are handled in the first pass and skipped here.
+        if (op_it != inserted_operation_lines.end() && line_id == op_it->first) {
+            export_buffer.append(span, after_eol);
+            span = after_eol;
+            for (const auto& elem : op_it->second) {
+                switch (elem.second) {
+                case TimeProcessor::InsertLineType::PreCooling:
+                case TimeProcessor::InsertLineType::PreHeating:
+                case TimeProcessor::InsertLineType::FilamentChangePredict:
+                    export_buffer += elem.first;
+                    break;
+                default:
+                    break;
+                }
+            }
+            ++op_it;
+        }
+    };
+
     std::vector<char> buffer(65536 * 10, 0);
+    // The previous read ended with '\r', a '\n' at the start of this one belongs to the same end of line.
+    bool pending_cr = false;
+    // Some bytes of the current line were already seen (the file may end without an end of line).
+    bool line_open = false;
     for (;;) {
         size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
         if (::ferror(in.f))
             throw Slic3r::RuntimeError(std::string("GCode processor pre-heat injection pass failed.\nError while reading from file.\n"));
-        bool eof       = cnt_read == 0;
-        auto it        = buffer.begin();
-        auto it_bufend = buffer.begin() + cnt_read;
-        while (it != it_bufend || (eof && !gcode_line.empty())) {
-            bool eol    = false;
-            auto it_end = it;
-            for (; it_end != it_bufend && !(eol = *it_end == '\r' || *it_end == '\n'); ++it_end);
-            eol |= eof && it_end == it_bufend;
-            gcode_line.insert(gcode_line.end(), it, it_end);
-            it = it_end;
-            if (it != it_bufend && *it == '\r')
-                gcode_line += *it++;
-            if (it != it_bufend && *it == '\n')
-                gcode_line += *it++;
-            if (eol) {
-                ++line_id;
-                // Splice any injector lines registered at this output line id. They are appended to the
-                // end of the current line's text (which already carries its EOL), so they land AFTER
-                // this line. PlaceholderReplace / TimePredict / ExtruderChangePredict are handled in the
-                // first pass and skipped here.
-                if (op_it != inserted_operation_lines.end() && line_id == op_it->first) {
-                    for (const auto& elem : op_it->second) {
-                        switch (elem.second) {
-                        case TimeProcessor::InsertLineType::PreCooling:
-                        case TimeProcessor::InsertLineType::PreHeating:
-                        case TimeProcessor::InsertLineType::FilamentChangePredict:
-                            gcode_line += elem.first;
-                            break;
-                        default:
-                            break;
-                        }
-                    }
-                    ++op_it;
+        const char *begin = buffer.data();
+        const char *end   = begin + cnt_read;
+        const char *p     = begin;
+        span = begin;
+        if (cnt_read == 0) {
+            // End of file terminates the last line.
+            if (pending_cr || line_open)
+                on_line_end(end);
+            break;
+        }
+        if (pending_cr) {
+            pending_cr = false;
+            if (*p == '\n')
+                ++ p;
+            on_line_end(p);
+        }
+        while (p != end) {
+            const char *eol = p;
+            for (; eol != end && *eol != '\r' && *eol != '\n'; ++ eol) ;
+            if (eol == end) {
+                line_open = true;
+                break;
+            }
+            line_open = false;
+            if (*eol == '\r') {
+                if (eol + 1 == end) {
+                    pending_cr = true;
+                    break;
                 }
-                export_buffer += gcode_line;
-                gcode_line.clear();
-                if (export_buffer.length() >= 65536)
-                    write_out(export_buffer);
+                if (eol[1] == '\n')
+                    ++ eol;
             }
+            p = eol + 1;
+            on_line_end(p);
         }
-        if (eof)
-            break;
+        export_buffer.append(span, end);
+        if (export_buffer.length() >= 65536)
+            write_out(export_buffer);
     }
     write_out(export_buffer);
 
     out.close();
     in.close();
 
-    // Re-shift the moves by the inserted-line counts (no-op with an empty map).
+    // Re-shift the moves by the inserted-line counts.
     handle_offsets_of_second_process(inserted_operation_lines);
 
     if (rename_file(out_path, m_result.filename))
@@ -2519,6 +2546,7 @@ void GCodeProcessorResult::reset() {
 
     moves.clear();
     lines_ends.clear();
+    decoded_gcode.reset();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -3596,6 +3624,18 @@ DynamicConfig GCodeProcessor::export_config_for_render() const
 // throws CanceledException through print->throw_if_canceled() (sent by the caller as callback).
 void GCodeProcessor::process_file(const std::string& filename, std::function<void()> cancel_callback)
 {
+    if (BinaryGCode::is_binary_gcode_file(filename)) {
+        // Decode into a plain text G-code, which is kept as the preview reads the G-code lines from m_result.filename.
+        // The decoded file is removed if processing throws.
+        auto decoded = std::make_shared<const BinaryGCode::DecodedFile>(filename);
+        this->process_file(decoded->path(), cancel_callback);
+        m_result.decoded_gcode = std::move(decoded);
+        return;
+    }
+    // Release the G-code decoded by the previous call.
+    m_result.decoded_gcode.reset();
+
+    Trace::Span span("process_file", "GCodeProcessor");
     CNumericLocalesSetter locales_setter;
 
     // pre-processing
@@ -3656,7 +3696,9 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.id = ++s_result_id;
     initialize_result_moves();
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    // Lines are tokenized in parallel, while process_gcode_line() runs serially in the file order,
+    // as the move classification and the time estimate depend on the machine state of the preceding lines.
+    m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
@@ -3689,6 +3731,7 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
 
 void GCodeProcessor::finalize(bool post_process)
 {
+    Trace::Span span("finalize", "GCodeProcessor");
     m_result.z_offset = m_z_offset;
 
     // update width/height of wipe moves
@@ -3721,8 +3764,7 @@ void GCodeProcessor::finalize(bool post_process)
         run_post_process();
         // Additive pre-heat/pre-cool injection second pass. Gated on m_enable_pre_heating so the
         // byte-frozen fleet (X1/P1/A1/H2S) never enters it. When the injector produces no lines the
-        // InsertedLinesMap is empty, so this is a byte-for-byte identity rewrite; it exercises the
-        // merge/offset machinery on the multi-nozzle fleet (H2D/X2D/H2D-Pro/H2C).
+        // InsertedLinesMap is empty and the finished file is not rewritten at all.
         if (m_enable_pre_heating)
             run_second_pass_injection();
     }
@@ -7024,7 +7066,6 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type,
         // ORCA: Add Jerk visualization support
         move_jerk,
         { 0.0f, 0.0f }, // time
-        static_cast<float>(m_layer_id), //layer_duration: set later
         std::max<unsigned int>(1, m_layer_id) - 1,
         internal_only,
         m_object_label_id,
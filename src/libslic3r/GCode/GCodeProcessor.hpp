@@ -19,6 +19,7 @@
 namespace Slic3r {
 
 class Print;
+namespace BinaryGCode { class DecodedFile; }
 
 // slice warnings enum strings
 #define NOZZLE_HRC_CHECKER                                          "the_actual_nozzle_hrc_smaller_than_the_required_nozzle_hrc"
@@ -236,7 +237,6 @@ class Print;
             // ORCA: Add Jerk visualization support
             float jerk{ 0.0f }; // mm/s
             std::array<float, static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count)> time{ 0.0f, 0.0f }; // s
-            float layer_duration{ 0.0f }; // s
             unsigned int layer_id{ 0 };
             bool internal_only{ false };
 
@@ -256,6 +256,9 @@ class Print;
         };
 
         std::string filename;
+        // Owns this->filename if it was decoded from a binary G-code, the decoded file is removed
+        // once neither the processor nor any result extracted from it refer to it.
+        std::shared_ptr<const BinaryGCode::DecodedFile> decoded_gcode;
         unsigned int id;
         std::vector<MoveVertex> moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
@@ -323,6 +326,7 @@ class Print;
         GCodeProcessorResult& operator=(const GCodeProcessorResult &other)
         {
             filename = other.filename;
+            decoded_gcode = other.decoded_gcode;
             id = other.id;
             moves = other.moves;
             lines_ends = other.lines_ends;
@@ -771,8 +775,8 @@ class Print;
             // splices into the finished g-code, keyed by output-line id. Orca keeps its single-pass
             // run_post_process (M73 / filament stats / ActualSpeedMove / Backtrace /
             // machine_tool_change_time) intact and applies this map in a separate, gated ADDITIVE
-            // second file-rewrite pass (run_second_pass_injection); with an empty map that pass is a
-            // byte-for-byte identity rewrite. The map is populated by the PreCoolingInjector.
+            // second file-rewrite pass (run_second_pass_injection); with an empty map that pass is
+            // skipped. The map is populated by the PreCoolingInjector.
             enum InsertLineType
             {
                 PlaceholderReplace,
@@ -1463,7 +1467,7 @@ class Print;
         // Additive second file-rewrite pass. Splices the pre-heat/pre-cool injector's InsertedLinesMap
         // into the finished g-code and re-shifts every move's gcode_id by the number of inserted lines
         // before it. Runs only when m_enable_pre_heating, AFTER run_post_process, so single-nozzle
-        // printers (X1/P1/A1/H2S) never enter it; with an empty map it is a byte-for-byte identity rewrite.
+        // printers (X1/P1/A1/H2S) never enter it; with an empty map the file is not rewritten.
         void run_second_pass_injection();
         // Shift each move's gcode_id by the count of injector lines inserted before it. No-op when the
         // map is empty.
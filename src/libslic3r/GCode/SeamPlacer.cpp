@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <queue>
 
+#include "libslic3r/AABBTreeIndirectParallel.hpp"
 #include "libslic3r/AABBTreeLines.hpp"
 #include "libslic3r/KDTreeIndirect.hpp"
 #include "libslic3r/ExtrusionEntity.hpp"
@@ -155,6 +156,10 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                      &raycasting_tree, &result, &samples, seam_position](tbb::blocked_range<size_t> r) {
                       // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                       std::vector<igl::Hit<float>> hits;
+                      // Rays of a single sample, cast as a batch if the model has no negative volumes.
+                      std::vector<Vec3d> ray_origins;
+                      std::vector<Vec3d> ray_dirs;
+                      AABBTreeIndirect::RayHits ray_hits;
                       for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                         result[s_idx] = 1.0f;
                         constexpr float decrease_step = 1.0f
@@ -171,49 +176,55 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                         Frame f;
                         f.set_from_z(normal);
 
-                        for (const auto &dir : precomputed_sample_directions) {
-                          Vec3f final_ray_dir = (f.to_world(dir));
-                          if (!model_contains_negative_parts) {
-                            igl::Hit<float> hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
+                        if (!model_contains_negative_parts) {
+                          // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
+                          // direction.
+                          ray_origins.assign(precomputed_sample_directions.size(), (center + normal * 0.01f).cast<double>()); // start above surface.
+                          ray_dirs.clear();
+                          for (const auto &dir : precomputed_sample_directions)
+                            ray_dirs.emplace_back(f.to_world(dir).cast<double>());
+                          AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices, triangles.indices, raycasting_tree,
+                                                                     ray_origins, ray_dirs, ray_hits);
+                          for (size_t ray_idx = 0; ray_idx < ray_hits.size(); ++ray_idx) {
+                            if (ray_hits.hit(ray_idx) &&
+                                its_face_normal(triangles, ray_hits.face[ray_idx]).dot(ray_dirs[ray_idx].cast<float>()) <= 0) {
                               result[s_idx] -= decrease_step;
                             }
-                          } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                                                >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                                                                     triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                              int counter = 0;
-                              // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                              //  It cannot be inside model, and it cannot be inside negative volume
-                              for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                  counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                                                                               // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                } else {
-                                  counter += sgn(face_normal.dot(final_ray_dir));
-                                }
-                              }
-                              if (counter == 0) {
-                                result[s_idx] -= decrease_step;
+                          }
+                          continue;
+                        }
+
+                        for (const auto &dir : precomputed_sample_directions) {
+                          Vec3f final_ray_dir = (f.to_world(dir));
+                          //TODO improve logic for order based boolean operations - consider order of volumes
+                          bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                                                              >= negative_volumes_start_index;
+
+                          Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                          if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                          }
+                          Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                          bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                                                                   triangles.indices, raycasting_tree,
+                                                                                   ray_origin_d, final_ray_dir_d, hits);
+                          if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                              Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                              if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                                                                             // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                              } else {
+                                counter += sgn(face_normal.dot(final_ray_dir));
                               }
                             }
+                            if (counter == 0) {
+                              result[s_idx] -= decrease_step;
+                            }
                           }
                         }
                       }
@@ -694,7 +705,7 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
 
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: build AABB tree: start";
-  auto raycasting_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(triangle_set.vertices,
+  auto raycasting_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set_parallel(triangle_set.vertices,
                                                                                      triangle_set.indices);
 
   throw_if_canceled();
@@ -4,6 +4,8 @@
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -14,6 +16,23 @@
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include <tbb/task_arena.h>
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -30,6 +49,33 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
 {
     PROFILE_FUNC();
 
+    const char *c = tokenize_axes(ptr, end, gline.m_axis, gline.m_mask, command);
+    
+    if (gline.has(E) && m_config.use_relative_e_distances)
+        m_position[E] = 0;
+
+    // Copy the raw string including the comment, without the trailing newlines.
+    if (c > ptr) {
+        PROFILE_BLOCK(copy_raw_string);
+        gline.m_raw.assign(ptr, c);
+    }
+
+    // Skip the trailing newlines.
+	if (*c == '\r')
+		++ c;
+	if (*c == '\n')
+		++ c;
+
+    if (m_verbose)
+        std::cout << gline.m_raw << std::endl;
+
+    return c;
+}
+
+// Parse the command and the axis values of a line, returns the end of the line (the first end of line character).
+// Does not depend on the reader state, thus it may be called from multiple threads over independent lines.
+const char* GCodeReader::tokenize_axes(const char *ptr, const char *end, float *axes, uint32_t &mask, std::pair<const char*, const char*> &command)
+{
     assert(is_decimal_separator_point());
     
     // command and args
@@ -71,8 +117,8 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 if (pend != c && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
-	                    gline.m_axis[int(axis)] = float(v);
-                    gline.m_mask |= 1 << int(axis);
+	                    axes[int(axis)] = float(v);
+                    mask |= 1 << int(axis);
                     c = pend;
                 } else
                     // Skip the rest of the word.
@@ -82,28 +128,10 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
     // Skip the rest of the line.
     for (; ! is_end_of_line(*c); ++ c);
 
-    // Copy the raw string including the comment, without the trailing newlines.
-    if (c > ptr) {
-        PROFILE_BLOCK(copy_raw_string);
-        gline.m_raw.assign(ptr, c);
-    }
-
-    // Skip the trailing newlines.
-	if (*c == '\r')
-		++ c;
-	if (*c == '\n')
-		++ c;
-
-    if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
-
     return c;
 }
 
@@ -215,6 +243,141 @@ bool GCodeReader::parse_file(const std::string &file, callback_t callback, std::
     return ret;
 }
 
+bool GCodeReader::parse_file_parallel(const std::string &filename, callback_t callback, std::vector<size_t> &lines_ends)
+{
+    lines_ends.clear();
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file_parallel %1%") % filename.c_str();
+
+    boost::system::error_code ec;
+    if (boost::filesystem::file_size(boost::filesystem::path(filename), ec) == 0)
+        // Empty file cannot be mapped. Nothing to parse anyways.
+        return ! ec;
+
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(boost::filesystem::path(filename));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Unable to map file " << filename << ": " << ex.what();
+        return false;
+    }
+    const char  *file_begin = file.data();
+    const size_t file_size  = file.size();
+
+    // Tokenized line. Its raw text is referenced in place in the mapped file, so the parallel stage
+    // does not allocate per line and the serial stage copies the text into a single reused GCodeLine.
+    struct LineView {
+        std::string_view raw;
+        float            axis[NUM_AXES];
+        uint32_t         mask;
+    };
+    // Block of whole lines of the mapped file, tokenized by the parallel stage of the pipeline.
+    struct Block {
+        size_t                begin { 0 };
+        size_t                end { 0 };
+        std::vector<LineView> lines;
+        std::vector<size_t>   lines_ends;
+        // Copy of the last line of a file not terminated by an end of line, as the tokenizer
+        // needs a terminating character, which the mapping does not provide past its end.
+        std::string           last_line;
+    };
+    using BlockPtr = std::shared_ptr<Block>;
+
+    // Large enough to amortize the task overhead, small enough to keep the blocks in flight in a few hundred MB.
+    static constexpr size_t block_size = 1024 * 1024;
+    const size_t            max_blocks = std::clamp<size_t>(2 * tbb::this_task_arena::max_concurrency(), 4, 16);
+
+    size_t            file_pos = 0;
+    std::atomic<bool> stop { false };
+    m_parsing = true;
+
+    const auto reader = tbb::make_filter<void, BlockPtr>(slic3r_tbb_filtermode::serial_in_order,
+        [file_begin, file_size, &file_pos, &stop](tbb::flow_control &fc) -> BlockPtr {
+            if (file_pos == file_size || stop) {
+                fc.stop();
+                return {};
+            }
+            auto block = std::make_shared<Block>();
+            block->begin = file_pos;
+            block->end   = std::min(file_pos + block_size, file_size);
+            // Cut the block after the next '\n', so that a "\r\n" pair is never split between two blocks.
+            if (block->end < file_size) {
+                const void *eol = std::memchr(file_begin + block->end - 1, '\n', file_size - block->end + 1);
+                block->end      = eol ? static_cast<const char*>(eol) - file_begin + 1 : file_size;
+            }
+            file_pos = block->end;
+            return block;
+        });
+
+    const auto tokenizer = tbb::make_filter<BlockPtr, BlockPtr>(slic3r_tbb_filtermode::parallel,
+        [file_begin, file_size](BlockPtr block) -> BlockPtr {
+            if (! block)
+                return block;
+            const char *begin = file_begin + block->begin;
+            const char *end   = file_begin + block->end;
+            block->lines.reserve(std::count(begin, end, '\n') + 1);
+            std::pair<const char*, const char*> command;
+            for (const char *ptr = begin; ptr != end;) {
+                const char *line_end = ptr;
+                for (; line_end != end && *line_end != '\r' && *line_end != '\n'; ++ line_end) ;
+                const char *next = line_end;
+                if (line_end == file_begin + file_size) {
+                    // Last line of the file without an end of line, tokenize a zero terminated copy.
+                    block->last_line.assign(ptr, line_end);
+                    ptr      = block->last_line.c_str();
+                    line_end = ptr + block->last_line.size();
+                }
+                // Skip the line number, see parse_file_internal().
+                const char *line_begin = skip_whitespaces(ptr);
+                if (std::toupper(*line_begin) == 'N')
+                    line_begin = skip_whitespaces(skip_word(line_begin));
+                LineView &line = block->lines.emplace_back();
+                memset(line.axis, 0, sizeof(line.axis));
+                line.mask = 0;
+                const char *raw_end = tokenize_axes(line_begin, line_end, line.axis, line.mask, command);
+                line.raw = std::string_view(line_begin, raw_end - line_begin);
+                ptr = next;
+                if (ptr != end && *ptr == '\r')
+                    ++ ptr;
+                if (ptr != end && *ptr == '\n')
+                    block->lines_ends.emplace_back(++ ptr - file_begin);
+            }
+            return block;
+        });
+
+    GCodeLine gline;
+    const auto consumer = tbb::make_filter<BlockPtr, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &callback, &lines_ends, &stop, &gline](BlockPtr block) {
+            if (! block || stop)
+                return;
+            lines_ends.insert(lines_ends.end(), block->lines_ends.begin(), block->lines_ends.end());
+            for (const LineView &line : block->lines) {
+                // Reuses the capacity of gline.m_raw, thus no allocation once the longest line was seen.
+                gline.m_raw.assign(line.raw.data(), line.raw.size());
+                memcpy(gline.m_axis, line.axis, sizeof(gline.m_axis));
+                gline.m_mask = line.mask;
+                // State dependent part of parse_line_internal().
+                if (gline.has(E) && m_config.use_relative_e_distances)
+                    m_position[E] = 0;
+                if (m_verbose)
+                    std::cout << gline.m_raw << std::endl;
+                callback(*this, gline);
+                const std::string_view cmd = gline.cmd();
+                std::pair<const char*, const char*> command(cmd.data(), cmd.data() + cmd.size());
+                update_coordinates(gline, command);
+                if (! m_parsing) {
+                    // The callback wishes to exit.
+                    stop = true;
+                    break;
+                }
+            }
+        });
+
+    tbb::parallel_pipeline(max_blocks, reader & tokenizer & consumer);
+
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file_parallel %1%") % filename.c_str();
+    return true;
+}
+
 bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_t line_callback)
 {
     return this->parse_file_raw_internal(filename,
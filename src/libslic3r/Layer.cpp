@@ -7,6 +7,7 @@
 #include "BoundingBox.hpp"
 
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
 
 namespace Slic3r {
 
@@ -281,6 +282,102 @@ void Layer::make_perimeters()
     BOOST_LOG_TRIVIAL(trace) << "Generating perimeters for layer " << this->id() << " - Done";
 }
 
+static void hash_combine_polygon(size_t &seed, const Polygon &polygon)
+{
+    boost::hash_combine(seed, polygon.points.size());
+    for (const Point &pt : polygon.points) {
+        boost::hash_combine(seed, pt.x());
+        boost::hash_combine(seed, pt.y());
+    }
+}
+
+static void hash_combine_expolygon(size_t &seed, const ExPolygon &expolygon)
+{
+    hash_combine_polygon(seed, expolygon.contour);
+    boost::hash_combine(seed, expolygon.holes.size());
+    for (const Polygon &hole : expolygon.holes)
+        hash_combine_polygon(seed, hole);
+}
+
+static void hash_combine_surfaces(size_t &seed, const SurfaceCollection &surfaces)
+{
+    boost::hash_combine(seed, surfaces.surfaces.size());
+    for (const Surface &surface : surfaces.surfaces) {
+        boost::hash_combine(seed, int(surface.surface_type));
+        boost::hash_combine(seed, surface.extra_perimeters);
+        hash_combine_expolygon(seed, surface.expolygon);
+    }
+}
+
+static bool surfaces_equal(const SurfaceCollection &lhs, const SurfaceCollection &rhs)
+{
+    return std::equal(lhs.surfaces.begin(), lhs.surfaces.end(), rhs.surfaces.begin(), rhs.surfaces.end(), [](const Surface &l, const Surface &r) {
+        return l.surface_type == r.surface_type && l.extra_perimeters == r.extra_perimeters && l.thickness == r.thickness &&
+               l.thickness_layers == r.thickness_layers && l.bridge_angle == r.bridge_angle && l.expolygon == r.expolygon;
+    });
+}
+
+size_t Layer::perimeters_inputs_hash() const
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, this->id() % 2);
+    boost::hash_combine(seed, this->height);
+    for (const LayerRegion *layerm : m_regions)
+        hash_combine_surfaces(seed, layerm->slices);
+    boost::hash_combine(seed, this->lower_layer != nullptr);
+    if (this->lower_layer != nullptr)
+        for (const ExPolygon &expolygon : this->lower_layer->lslices)
+            hash_combine_expolygon(seed, expolygon);
+    boost::hash_combine(seed, this->upper_layer != nullptr);
+    if (this->upper_layer != nullptr) {
+        for (const ExPolygon &expolygon : this->upper_layer->lslices)
+            hash_combine_expolygon(seed, expolygon);
+        for (const LayerRegion *layerm : this->upper_layer->regions())
+            hash_combine_surfaces(seed, layerm->slices);
+    }
+    return seed;
+}
+
+bool Layer::perimeters_inputs_equal(const Layer &other) const
+{
+    if (this->id() % 2 != other.id() % 2 || this->height != other.height || m_regions.size() != other.m_regions.size() ||
+        (this->lower_layer == nullptr) != (other.lower_layer == nullptr) || (this->upper_layer == nullptr) != (other.upper_layer == nullptr))
+        return false;
+    for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id)
+        if (&m_regions[region_id]->region() != &other.m_regions[region_id]->region() ||
+            ! surfaces_equal(m_regions[region_id]->slices, other.m_regions[region_id]->slices))
+            return false;
+    if (this->lower_layer != nullptr && this->lower_layer->lslices != other.lower_layer->lslices)
+        return false;
+    if (this->upper_layer != nullptr) {
+        if (this->upper_layer->lslices != other.upper_layer->lslices || this->upper_layer->region_count() != other.upper_layer->region_count())
+            return false;
+        for (size_t region_id = 0; region_id < this->upper_layer->region_count(); ++ region_id)
+            if (! surfaces_equal(this->upper_layer->get_region(region_id)->slices, other.upper_layer->get_region(region_id)->slices))
+                return false;
+    }
+    return true;
+}
+
+// The extrusions don't store their z coordinate, thus the results of make_perimeters() are copied over verbatim.
+void Layer::copy_perimeters_from(const Layer &other)
+{
+    assert(m_regions.size() == other.m_regions.size());
+    for (size_t region_id = 0; region_id < m_regions.size(); ++ region_id) {
+        LayerRegion       *layerm = m_regions[region_id];
+        const LayerRegion *src    = other.m_regions[region_id];
+        layerm->perimeters = src->perimeters;
+        layerm->thin_fills = src->thin_fills;
+        layerm->fills.clear();
+        if (! layerm->slices.empty()) {
+            // make_perimeters() does not touch the fill surfaces of empty regions.
+            layerm->fill_surfaces              = src->fill_surfaces;
+            layerm->fill_expolygons            = src->fill_expolygons;
+            layerm->fill_no_overlap_expolygons = src->fill_no_overlap_expolygons;
+        }
+    }
+}
+
 void Layer::export_region_slices_to_svg(const char *path) const
 {
     BoundingBox bbox;
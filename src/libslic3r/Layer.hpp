@@ -193,6 +193,13 @@ public:
     // Whether two regions can be printed in a continues perimeter
     static bool             is_perimeter_compatible(const Print& print, const PrintRegion& a, const PrintRegion& b);
     void                    make_perimeters();
+    // Memoization of make_perimeters() over the layers of a PrintObject, see PrintObject::make_perimeters().
+    // Besides the configs of the regions, make_perimeters() depends on the region slices, the layer height, the parity of the layer id
+    // (alternate extra wall) and the neighbor layers: the lower islands decide on overhangs, the upper islands and region slices on top surfaces.
+    size_t                  perimeters_inputs_hash() const;
+    bool                    perimeters_inputs_equal(const Layer &other) const;
+    // Copy the results of make_perimeters() from a layer with equal inputs.
+    void                    copy_perimeters_from(const Layer &other);
     // Phony version of make_fills() without parameters for Perl integration only.
     void                    make_fills() { this->make_fills(nullptr, nullptr); }
     void                    make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive::Octree* support_fill_octree, FillLightning::Generator* lightning_generator = nullptr);
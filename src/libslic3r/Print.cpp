@@ -11,6 +11,7 @@
 #include "ShortestPath.hpp"
 #include "Thread.hpp"
 #include "Time.hpp"
+#include "Trace.hpp"
 #include "GCode.hpp"
 #include "GCode/WipeTower.hpp"
 #include "GCode/WipeTower2.hpp"
@@ -23,6 +24,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <unordered_map>
 #include <unordered_set>
@@ -32,6 +34,7 @@
 #include <boost/log/trivial.hpp>
 #include <boost/regex.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
@@ -40,6 +43,7 @@
 #include "nlohmann/json.hpp"
 
 #include "GCode/ConflictChecker.hpp"
+#include "Format/SliceCache.hpp"
 #include "ParameterUtils.hpp"
 
 #include <codecvt>
@@ -180,6 +184,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
         "extrusion_rate_smoothing_external_perimeter_only",
         "reduce_infill_retraction",
         "filename_format",
+        "binary_gcode",
         "retraction_minimum_travel",
         "retract_before_wipe",
         // Orca:
@@ -2236,6 +2241,7 @@ std::map<ObjectID, unsigned int> getObjectExtruderMap(const Print& print) {
 // Slicing process, running at a background thread.
 void Print::process(long long *time_cost_with_cache, bool use_cache)
 {
+    Trace::Span span("process", "Print");
     long long start_time = 0, end_time = 0;
     if (time_cost_with_cache)
         *time_cost_with_cache = 0;
@@ -2360,131 +2366,156 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
                 run_pipeline_hook(sstep, obj);
         };
 
-        // SlicingPipeline: dedicated slice loop so the Slice boundary is hookable before perimeters.
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                const bool was_done = obj->is_step_done(posSlice);
-                obj->slice();
-                hook_after(obj, was_done, posSlice, SlicingPipelineStepPlugin::posSlice);
-                // re-snapshot each layer's raw_slices AFTER the Slice hook ran, so the
-                // plugin's mutation becomes the untyped baseline. Without this, a later
-                // perimeter-only re-run (make_perimeters -> restore_untyped_slices) reverts
-                // slices to the PRE-hook geometry while posSlice stays cached (the hook does
-                // not re-fire), silently un-applying the mutation; raw_slices consumers
-                // (sharp-tail support, ToolOrdering) also read this backup directly. Gated on
-                // an active plugin AND a genuine (re)slice, so the inactive path is untouched
-                // and re-backing-up an unmutated layer is a harmless identical copy.
-                if (m_pipeline_plugin_active && !was_done && obj->is_step_done(posSlice))
-                    for (Layer *layer : obj->layers())
-                        layer->backup_untyped_slices();
-            } else {
-                if (obj->set_started(posSlice)) obj->set_done(posSlice);   // shared/duplicate — no hook
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                const bool was_done = obj->is_step_done(posPerimeters);
-                obj->make_perimeters();   // slice() inside is a no-op: posSlice already DONE
-                hook_after(obj, was_done, posPerimeters, SlicingPipelineStepPlugin::posPerimeters);
-            } else {
-                if (obj->set_started(posPerimeters)) obj->set_done(posPerimeters);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                const bool was_done = obj->is_step_done(posEstimateCurledExtrusions);
-                obj->estimate_curled_extrusions();
-                hook_after(obj, was_done, posEstimateCurledExtrusions, SlicingPipelineStepPlugin::posEstimateCurledExtrusions);
-            }
-            else {
-                if (obj->set_started(posEstimateCurledExtrusions))
-                    obj->set_done(posEstimateCurledExtrusions);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                // split prepare_infill (fill-surface prep) from infill (make_fills) so a
-                // plugin can mutate fill surfaces at the PrepareInfill seam and have make_fills
-                // consume them (unlike the Infill seam, which fires after the fills are already
-                // built). infill() re-invokes prepare_infill() as a no-op once posPrepareInfill
-                // is DONE, so this is a mechanical split mirroring the slice/perimeters loop.
-                const bool prepare_was_done = obj->is_step_done(posPrepareInfill);
-                obj->prepare_infill();
-                hook_after(obj, prepare_was_done, posPrepareInfill, SlicingPipelineStepPlugin::posPrepareInfill);
-                const bool was_done = obj->is_step_done(posInfill);
-                obj->infill();
-                hook_after(obj, was_done, posInfill, SlicingPipelineStepPlugin::posInfill);
-            }
-            else {
-                if (obj->set_started(posPrepareInfill))
-                    obj->set_done(posPrepareInfill);
-                if (obj->set_started(posInfill))
-                    obj->set_done(posInfill);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                const bool was_done = obj->is_step_done(posIroning);
-                obj->ironing();
-                hook_after(obj, was_done, posIroning, SlicingPipelineStepPlugin::posIroning);
-            }
-            else {
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-            }
-        }
-
-        // Z-Contouring
-        for (PrintObject *obj : m_objects) {
-            bool need_contouring = need_slicing_objects.count(obj) != 0 && obj->need_z_contouring();
-            if (need_contouring) {
-                const bool was_done = obj->is_step_done(posContouring);
-                obj->contour_z();
-                hook_after(obj, was_done, posContouring, SlicingPipelineStepPlugin::posContouring);
-            } else {
-                if (obj->set_started(posContouring))
+        // The steps of each PrintObject in the order they are run, with the SlicingPipeline seam fired after each of them.
+        // posContouring is only run for the objects which need it, otherwise it is marked done without firing the hook.
+        static constexpr std::pair<PrintObjectStep, SlicingPipelineStepPlugin> object_steps[] = {
+            { posSlice,                     SlicingPipelineStepPlugin::posSlice },
+            { posPerimeters,                SlicingPipelineStepPlugin::posPerimeters },
+            { posEstimateCurledExtrusions,  SlicingPipelineStepPlugin::posEstimateCurledExtrusions },
+            // prepare_infill (fill-surface prep) is split from infill (make_fills), so a plugin can mutate fill surfaces
+            // at the PrepareInfill seam and have make_fills consume them (unlike the Infill seam, which fires after the fills
+            // are already built). infill() re-invokes prepare_infill() as a no-op once posPrepareInfill is DONE.
+            { posPrepareInfill,             SlicingPipelineStepPlugin::posPrepareInfill },
+            { posInfill,                    SlicingPipelineStepPlugin::posInfill },
+            { posIroning,                   SlicingPipelineStepPlugin::posIroning },
+            { posContouring,                SlicingPipelineStepPlugin::posContouring },
+            { posSupportMaterial,           SlicingPipelineStepPlugin::posSupportMaterial },
+            { posDetectOverhangsForLift,    SlicingPipelineStepPlugin::posDetectOverhangsForLift },
+        };
+        auto run_step = [](PrintObject *obj, PrintObjectStep pstep) {
+            switch (pstep) {
+            case posSlice:                      obj->slice(); break;
+            case posPerimeters:                 obj->make_perimeters(); break;
+            case posEstimateCurledExtrusions:   obj->estimate_curled_extrusions(); break;
+            case posPrepareInfill:              obj->prepare_infill(); break;
+            case posInfill:                     obj->infill(); break;
+            case posIroning:                    obj->ironing(); break;
+            case posContouring:
+                if (obj->need_z_contouring())
+                    obj->contour_z();
+                else if (obj->set_started(posContouring))
                     obj->set_done(posContouring);
+                break;
+            case posSupportMaterial:            obj->generate_support_material(); break;
+            case posDetectOverhangsForLift:     obj->detect_overhangs_for_lift(); break;
+            default:                            assert(false);
             }
-        }
-
-        // SlicingPipeline: support runs in the parallel block below; the hook must fire in a
-        // sequential loop afterward. Snapshot per-object done-state just before the parallel_for.
-        std::vector<char> sup_was_done(m_objects.size(), 1);
-        if (m_pipeline_plugin_active)
-            for (size_t i = 0; i < m_objects.size(); ++i)
-                sup_was_done[i] = m_objects[i]->is_step_done(posSupportMaterial) ? 1 : 0;
+        };
 
-        tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
-            [this, need_slicing_objects](const tbb::blocked_range<int>& range) {
-                for (int i = range.begin(); i < range.end(); i++) {
-                    PrintObject* obj = m_objects[i];
-                    if (need_slicing_objects.count(obj) != 0) {
-                        obj->generate_support_material();
+        // Without a pipeline plugin there is no hook to fire between the steps, so the objects don't need to
+        // wait for each other at every step: run the chain of steps of each object up to the support generation
+        // as an independent task. A small object then does not leave the cores idle while a complex one is still
+        // being sliced, the per-layer loops inside the steps are scheduled by TBB alongside the tasks of the other objects.
+        // The per-step loops below then only find these steps done and mark the steps of the shared objects.
+        //
+        // The steps of the chains only read and write the layers of their own object. Besides that they share
+        // the following state of the Print:
+        // - the configs and m_objects, which are read only while processing,
+        // - the step states, which are guarded by the state mutex of the Print,
+        // - the cancellation status, which is atomic,
+        // - the status callback, which is serialized below.
+        // The support generation is not part of the chains, it runs after a barrier in the per-step loop below:
+        // the tree support reads the layer counts of all the objects of the Print (see TreeSupport::generate()),
+        // thus all objects have to be sliced before any support is generated.
+        // A shared object is never processed, its steps are only marked done after its source object was processed.
+        if (! m_pipeline_plugin_active) {
+            // The objects report the progress of their steps concurrently. Serialize the callback, and only pass
+            // the progress updates which do not go back, so that the progress does not jump back and forth
+            // when an object starts a step another object has already passed. Warnings and scene reloads are always passed.
+            boost::mutex status_mutex;
+            ScopeGuard   restore_status_callback;
+            if (m_status_callback) {
+                restore_status_callback = ScopeGuard([this, status_callback = m_status_callback]() { m_status_callback = status_callback; });
+                m_status_callback = [status_callback = m_status_callback, &status_mutex, max_percent = -1](const SlicingStatus &status) mutable {
+                    boost::lock_guard<boost::mutex> lock(status_mutex);
+                    if (status.percent >= 0 && status.percent < max_percent) {
+                        if (status.flags == SlicingStatus::DEFAULT)
+                            return;
+                        SlicingStatus clamped = status;
+                        clamped.percent = max_percent;
+                        status_callback(clamped);
+                        return;
                     }
-                    else {
-                        if (obj->set_started(posSupportMaterial))
-                            obj->set_done(posSupportMaterial);
+                    max_percent = std::max(max_percent, status.percent);
+                    status_callback(status);
+                };
+            }
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+                [this, &need_slicing_objects, &run_step](const tbb::blocked_range<size_t>& range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i) {
+                        PrintObject *obj = m_objects[i];
+                        if (need_slicing_objects.count(obj) != 0)
+                            for (const auto &step : object_steps) {
+                                if (step.first == posSupportMaterial)
+                                    break;
+                                run_step(obj, step.first);
+                            }
                     }
-                }
+                });
+        }
+
+        // The per-step loops run a stage of steps for all objects before the next stage. prepare_infill and infill
+        // form a single stage, so that the PrepareInfill and Infill hooks of an object fire one after the other.
+        for (size_t first_step = 0; first_step < std::size(object_steps);) {
+            const size_t last_step = object_steps[first_step].first == posPrepareInfill ? first_step + 2 : first_step + 1;
+            assert(object_steps[first_step].first != posPrepareInfill || object_steps[first_step + 1].first == posInfill);
+            if (object_steps[first_step].first == posSupportMaterial) {
+                // SlicingPipeline: support runs in the parallel block below; the hook must fire in a
+                // sequential loop afterward. Snapshot per-object done-state just before the parallel_for.
+                std::vector<char> sup_was_done(m_objects.size(), 1);
+                if (m_pipeline_plugin_active)
+                    for (size_t i = 0; i < m_objects.size(); ++i)
+                        sup_was_done[i] = m_objects[i]->is_step_done(posSupportMaterial) ? 1 : 0;
+
+                tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
+                    [this, &need_slicing_objects](const tbb::blocked_range<int>& range) {
+                        for (int i = range.begin(); i < range.end(); i++) {
+                            PrintObject* obj = m_objects[i];
+                            if (need_slicing_objects.count(obj) != 0) {
+                                obj->generate_support_material();
+                            }
+                            else {
+                                if (obj->set_started(posSupportMaterial))
+                                    obj->set_done(posSupportMaterial);
+                            }
+                        }
+                    }
+                );
+
+                if (m_pipeline_plugin_active)
+                    for (size_t i = 0; i < m_objects.size(); ++i)
+                        if (need_slicing_objects.count(m_objects[i]) != 0 && !sup_was_done[i]
+                            && m_objects[i]->is_step_done(posSupportMaterial))
+                            run_pipeline_hook(SlicingPipelineStepPlugin::posSupportMaterial, m_objects[i]);
+                first_step = last_step;
+                continue;
             }
-        );
 
-        if (m_pipeline_plugin_active)
-            for (size_t i = 0; i < m_objects.size(); ++i)
-                if (need_slicing_objects.count(m_objects[i]) != 0 && !sup_was_done[i]
-                    && m_objects[i]->is_step_done(posSupportMaterial))
-                    run_pipeline_hook(SlicingPipelineStepPlugin::posSupportMaterial, m_objects[i]);
-
-        for (PrintObject* obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                const bool was_done = obj->is_step_done(posDetectOverhangsForLift);
-                obj->detect_overhangs_for_lift();
-                hook_after(obj, was_done, posDetectOverhangsForLift, SlicingPipelineStepPlugin::posDetectOverhangsForLift);
-            }
-            else {
-                if (obj->set_started(posDetectOverhangsForLift))
-                    obj->set_done(posDetectOverhangsForLift);
-            }
+            for (PrintObject *obj : m_objects)
+                for (size_t step_idx = first_step; step_idx < last_step; ++ step_idx) {
+                    const auto &[pstep, sstep] = object_steps[step_idx];
+                    if (need_slicing_objects.count(obj) != 0 && (pstep != posContouring || obj->need_z_contouring())) {
+                        const bool was_done = obj->is_step_done(pstep);
+                        run_step(obj, pstep);
+                        hook_after(obj, was_done, pstep, sstep);
+                        // re-snapshot each layer's raw_slices AFTER the Slice hook ran, so the
+                        // plugin's mutation becomes the untyped baseline. Without this, a later
+                        // perimeter-only re-run (make_perimeters -> restore_untyped_slices) reverts
+                        // slices to the PRE-hook geometry while posSlice stays cached (the hook does
+                        // not re-fire), silently un-applying the mutation; raw_slices consumers
+                        // (sharp-tail support, ToolOrdering) also read this backup directly. Gated on
+                        // an active plugin AND a genuine (re)slice, so the inactive path is untouched
+                        // and re-backing-up an unmutated layer is a harmless identical copy.
+                        if (pstep == posSlice && m_pipeline_plugin_active && !was_done && obj->is_step_done(posSlice))
+                            for (Layer *layer : obj->layers())
+                                layer->backup_untyped_slices();
+                    } else {
+                        // shared/duplicate — no hook
+                        if (obj->set_started(pstep))
+                            obj->set_done(pstep);
+                    }
+                }
+            first_step = last_step;
         }
     }
     else {
@@ -4396,6 +4427,13 @@ std::string Print::output_filename(const std::string &filename_base) const
     }
     config.set_key_value("filament_name", new ConfigOptionString(filament_name));
 
+    if (m_config.binary_gcode.value) {
+        // The filename format usually ends with ".gcode", binary G-code files use the ".bgcode" extension.
+        boost::filesystem::path filename = this->PrintBase::output_filename(m_config.filename_format.value, ".bgcode", filename_base, &config);
+        if (boost::iequals(filename.extension().string(), ".gcode"))
+            filename.replace_extension(".bgcode");
+        return filename.string();
+    }
     return this->PrintBase::output_filename(m_config.filename_format.value, ".gcode", filename_base, &config);
 }
 
@@ -4604,6 +4642,7 @@ const std::string PrintStatistics::TotalFilamentUsedWipeTowerValueMask = "; tota
 #define JSON_ARC_FITTING            "arc_fitting"
 #define JSON_OBJECT_NAME            "name"
 #define JSON_IDENTIFY_ID          "identify_id"
+#define JSON_SLICE_CACHE_HASH     "slice_cache_hash"
 
 
 #define JSON_LAYERS                  "layers"
@@ -5337,6 +5376,33 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
+// Object info of a text cache, the layer data are extracted from the json tree by extract_layer().
+static SliceCacheObjectInfo slice_cache_object_info(const json &root_json)
+{
+    SliceCacheObjectInfo info;
+    info.name        = root_json.at(JSON_OBJECT_NAME);
+    info.identify_id = root_json.at(JSON_IDENTIFY_ID);
+    for (const json &layer_json : root_json.at(JSON_LAYERS)) {
+        SliceCacheLayerInfo &layer = info.layers.emplace_back();
+        layer.id      = layer_json.at(JSON_LAYER_ID);
+        layer.height  = layer_json.at(JSON_LAYER_HEIGHT);
+        layer.print_z = layer_json.at(JSON_LAYER_PRINT_Z);
+        layer.slice_z = layer_json.at(JSON_LAYER_SLICE_Z);
+        for (const json &region_json : layer_json.at(JSON_LAYER_REGIONS))
+            layer.region_config_hashes.emplace_back(region_json.at(JSON_LAYER_REGION_CONFIG_HASH));
+    }
+    for (const json &layer_json : root_json.at(JSON_SUPPORT_LAYERS)) {
+        SliceCacheLayerInfo &layer = info.support_layers.emplace_back();
+        layer.id           = layer_json.at(JSON_LAYER_ID);
+        layer.interface_id = layer_json.at(JSON_SUPPORT_LAYER_INTERFACE_ID);
+        layer.height       = layer_json.at(JSON_LAYER_HEIGHT);
+        layer.print_z      = layer_json.at(JSON_LAYER_PRINT_Z);
+    }
+    for (const json &group_json : root_json.at(JSON_FIRSTLAYER_GROUPS))
+        info.first_layer_groups.emplace_back(group_json.get<groupedVolumeSlices>());
+    return info;
+}
+
 int Print::export_cached_data(const std::string& directory, bool with_space)
 {
     int ret = 0;
@@ -5404,7 +5470,12 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 
     int count = 0;
     std::vector<std::string> filename_vector;
+    // Text cache: the json tree of the object.
     std::vector<json> json_vector;
+    // Binary cache: the object record followed by the layer and support layer records.
+    std::vector<std::vector<SliceCacheRecord>> records_vector;
+    std::vector<uint64_t> hash_vector;
+    const bool binary = !with_space;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         if (obj->get_shared_object()) {
@@ -5415,159 +5486,205 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const PrintInstance &print_instance = obj->instances()[0];
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = slice_cache_file_name(directory, identify_id, binary);
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
         try {
-            json root_json, layers_json = json::array(), support_layers_json = json::array(), first_layer_groups = json::array();
+            const uint64_t hash = slice_cache_hash(*obj);
 
-            root_json[JSON_OBJECT_NAME] = model_obj->name;
-            root_json[JSON_IDENTIFY_ID] = identify_id;
-
-            //export the layers
-            std::vector<json> layers_json_vector(obj->layer_count());
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->layer_count()),
-                [&layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& layer_range) {
-                    for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
-                        const Layer *layer = obj->get_layer(layer_index);
-                        json layer_json;
-                        convert_layer_to_json(layer_json, layer);
-                        layers_json_vector[layer_index] = std::move(layer_json);
+            // The volume IDs of the first layer groups are stored as indices of the volumes of the model object.
+            std::vector<groupedVolumeSlices> first_layer_groups = obj->firstLayerObjGroups();
+            for (groupedVolumeSlices &group : first_layer_groups) {
+                //convert the id
+                for (ObjectID& obj_id : group.volume_ids)
+                {
+                    const ModelVolume* currentModelVolumePtr = nullptr;
+                    //BBS: support shared object logic
+                    const PrintObject* shared_object = obj->get_shared_object();
+                    if (!shared_object)
+                        shared_object = obj;
+                    const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
+                    size_t volume_count = volumes_ptr.size();
+                    for (size_t index = 0; index < volume_count; index ++) {
+                        currentModelVolumePtr = volumes_ptr[index];
+                        if (currentModelVolumePtr->id() == obj_id) {
+                            obj_id.id = index;
+                            break;
+                        }
                     }
                 }
-            );
-            for (int l_index = 0; l_index < layers_json_vector.size(); l_index++) {
-                layers_json.push_back(std::move(layers_json_vector[l_index]));
             }
-            layers_json_vector.clear();
-            /*for (const Layer *layer : obj->layers()) {
-                // for each layer
-                json layer_json;
-
-                convert_layer_to_json(layer_json, layer);
 
-                layers_json.push_back(std::move(layer_json));
-            }*/
-
-            root_json[JSON_LAYERS] = std::move(layers_json);
-
-            //export the support layers
-            std::vector<json> support_layers_json_vector(obj->support_layer_count());
-            tbb::parallel_for(
-                tbb::blocked_range<size_t>(0, obj->support_layer_count()),
-                [&support_layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& support_layer_range) {
-                    for (size_t s_layer_index = support_layer_range.begin(); s_layer_index < support_layer_range.end(); ++ s_layer_index) {
-                        const SupportLayer *support_layer = obj->get_support_layer(s_layer_index);
-                        json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
-
-                        convert_layer_to_json(support_layer_json, support_layer);
-
-                        support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
-                        support_layer_json[JSON_SUPPORT_LAYER_TYPE] = support_layer->support_type;
-
-                        //support_islands
-                        for (const ExPolygon& support_island : support_layer->support_islands) {
-                            json support_island_json = support_island;
-                            support_islands_json.push_back(std::move(support_island_json));
+            if (binary) {
+                // The object record is followed by a record for each layer and for each support layer.
+                std::vector<SliceCacheRecord> records(1 + obj->layer_count() + obj->support_layer_count());
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, obj->layer_count()),
+                    [&records, obj](const tbb::blocked_range<size_t>& layer_range) {
+                        for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
+                            records[1 + layer_index] = slice_cache_record(*obj->get_layer(layer_index));
                         }
-                        support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
-
-                        //support_fills
-                        support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
-                        support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
-                        for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
-                            json supportfill_entity_json, supportfill_entity_paths_json = json::array();
-                            bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
-                            if (!ret)
-                                continue;
-
-                            supportfills_entities_json.push_back(std::move(supportfill_entity_json));
+                    }
+                );
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, obj->support_layer_count()),
+                    [&records, obj](const tbb::blocked_range<size_t>& support_layer_range) {
+                        for (size_t s_layer_index = support_layer_range.begin(); s_layer_index < support_layer_range.end(); ++ s_layer_index) {
+                            records[1 + obj->layer_count() + s_layer_index] = slice_cache_record(*obj->get_support_layer(s_layer_index));
                         }
-                        support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
-                        support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
+                    }
+                );
+
+                SliceCacheObjectInfo info;
+                info.name        = model_obj->name;
+                info.identify_id = identify_id;
+                for (const Layer *layer : obj->layers()) {
+                    SliceCacheLayerInfo &layer_info = info.layers.emplace_back();
+                    layer_info.id      = layer->id();
+                    layer_info.height  = layer->height;
+                    layer_info.print_z = layer->print_z;
+                    layer_info.slice_z = layer->slice_z;
+                    for (const LayerRegion *layer_region : layer->regions())
+                        layer_info.region_config_hashes.emplace_back(layer_region->region().config_hash());
+                }
+                for (const SupportLayer *support_layer : obj->support_layers()) {
+                    SliceCacheLayerInfo &layer_info = info.support_layers.emplace_back();
+                    layer_info.id           = support_layer->id();
+                    layer_info.interface_id = support_layer->interface_id();
+                    layer_info.height       = support_layer->height;
+                    layer_info.print_z      = support_layer->print_z;
+                    layer_info.slice_z      = support_layer->slice_z;
+                }
+                info.first_layer_groups = std::move(first_layer_groups);
+                records.front() = slice_cache_record(info);
 
-                        support_layers_json_vector[s_layer_index] = std::move(support_layer_json);
+                json_vector.emplace_back();
+                records_vector.push_back(std::move(records));
+            } else {
+                json root_json, layers_json = json::array(), support_layers_json = json::array(), first_layer_groups_json = json::array();
+
+                root_json[JSON_OBJECT_NAME] = model_obj->name;
+                root_json[JSON_IDENTIFY_ID] = identify_id;
+                root_json[JSON_SLICE_CACHE_HASH] = hash;
+
+                //export the layers
+                std::vector<json> layers_json_vector(obj->layer_count());
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, obj->layer_count()),
+                    [&layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& layer_range) {
+                        for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
+                            const Layer *layer = obj->get_layer(layer_index);
+                            json layer_json;
+                            convert_layer_to_json(layer_json, layer);
+                            layers_json_vector[layer_index] = std::move(layer_json);
+                        }
                     }
+                );
+                for (int l_index = 0; l_index < layers_json_vector.size(); l_index++) {
+                    layers_json.push_back(std::move(layers_json_vector[l_index]));
                 }
-            );
-            for (int s_index = 0; s_index < support_layers_json_vector.size(); s_index++) {
-                support_layers_json.push_back(std::move(support_layers_json_vector[s_index]));
-            }
-            support_layers_json_vector.clear();
+                layers_json_vector.clear();
+                /*for (const Layer *layer : obj->layers()) {
+                    // for each layer
+                    json layer_json;
 
-            /*for (const SupportLayer *support_layer : obj->support_layers()) {
-                json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
+                    convert_layer_to_json(layer_json, layer);
 
-                convert_layer_to_json(support_layer_json, support_layer);
+                    layers_json.push_back(std::move(layer_json));
+                }*/
 
-                support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
+                root_json[JSON_LAYERS] = std::move(layers_json);
 
-                //support_islands
-                for (const ExPolygon& support_island : support_layer->support_islands.expolygons) {
-                    json support_island_json = support_island;
-                    support_islands_json.push_back(std::move(support_island_json));
-                }
-                support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
-
-                //support_fills
-                support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
-                support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
-                for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
-                    json supportfill_entity_json, supportfill_entity_paths_json = json::array();
-                    bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
-                    if (!ret)
-                        continue;
+                //export the support layers
+                std::vector<json> support_layers_json_vector(obj->support_layer_count());
+                tbb::parallel_for(
+                    tbb::blocked_range<size_t>(0, obj->support_layer_count()),
+                    [&support_layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& support_layer_range) {
+                        for (size_t s_layer_index = support_layer_range.begin(); s_layer_index < support_layer_range.end(); ++ s_layer_index) {
+                            const SupportLayer *support_layer = obj->get_support_layer(s_layer_index);
+                            json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
 
-                    supportfills_entities_json.push_back(std::move(supportfill_entity_json));
-                }
-                support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
-                support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
+                            convert_layer_to_json(support_layer_json, support_layer);
 
-                support_layers_json.push_back(std::move(support_layer_json));
-            } // for each layer*/
-            root_json[JSON_SUPPORT_LAYERS] = std::move(support_layers_json);
+                            support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
+                            support_layer_json[JSON_SUPPORT_LAYER_TYPE] = support_layer->support_type;
 
-            const std::vector<groupedVolumeSlices> &first_layer_obj_groups =  obj->firstLayerObjGroups();
-            for (size_t s_group_index = 0; s_group_index < first_layer_obj_groups.size(); ++ s_group_index) {
-                groupedVolumeSlices group = first_layer_obj_groups[s_group_index];
+                            //support_islands
+                            for (const ExPolygon& support_island : support_layer->support_islands) {
+                                json support_island_json = support_island;
+                                support_islands_json.push_back(std::move(support_island_json));
+                            }
+                            support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
+
+                            //support_fills
+                            support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
+                            support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
+                            for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
+                                json supportfill_entity_json, supportfill_entity_paths_json = json::array();
+                                bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
+                                if (!ret)
+                                    continue;
+
+                                supportfills_entities_json.push_back(std::move(supportfill_entity_json));
+                            }
+                            support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
+                            support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
 
-                //convert the id
-                for (ObjectID& obj_id : group.volume_ids)
-                {
-                    const ModelVolume* currentModelVolumePtr = nullptr;
-                    //BBS: support shared object logic
-                    const PrintObject* shared_object = obj->get_shared_object();
-                    if (!shared_object)
-                        shared_object = obj;
-                    const ModelVolumePtrs& volumes_ptr = shared_object->model_object()->volumes;
-                    size_t volume_count = volumes_ptr.size();
-                    for (size_t index = 0; index < volume_count; index ++) {
-                        currentModelVolumePtr = volumes_ptr[index];
-                        if (currentModelVolumePtr->id() == obj_id) {
-                            obj_id.id = index;
-                            break;
+                            support_layers_json_vector[s_layer_index] = std::move(support_layer_json);
                         }
                     }
+                );
+                for (int s_index = 0; s_index < support_layers_json_vector.size(); s_index++) {
+                    support_layers_json.push_back(std::move(support_layers_json_vector[s_index]));
                 }
+                support_layers_json_vector.clear();
 
-                json first_layer_group_json;
+                /*for (const SupportLayer *support_layer : obj->support_layers()) {
+                    json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
 
-                first_layer_group_json = group;
-                first_layer_groups.push_back(std::move(first_layer_group_json));
-            }
-            root_json[JSON_FIRSTLAYER_GROUPS] = std::move(first_layer_groups);
+                    convert_layer_to_json(support_layer_json, support_layer);
+
+                    support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
+
+                    //support_islands
+                    for (const ExPolygon& support_island : support_layer->support_islands.expolygons) {
+                        json support_island_json = support_island;
+                        support_islands_json.push_back(std::move(support_island_json));
+                    }
+                    support_layer_json[JSON_SUPPORT_LAYER_ISLANDS] = std::move(support_islands_json);
+
+                    //support_fills
+                    support_fills_json[JSON_EXTRUSION_NO_SORT] = support_layer->support_fills.no_sort;
+                    support_fills_json[JSON_EXTRUSION_ENTITY_TYPE] = JSON_EXTRUSION_TYPE_COLLECTION;
+                    for (const ExtrusionEntity* extrusion_entity : support_layer->support_fills.entities) {
+                        json supportfill_entity_json, supportfill_entity_paths_json = json::array();
+                        bool ret = convert_extrusion_to_json(supportfill_entity_json, supportfill_entity_paths_json, extrusion_entity);
+                        if (!ret)
+                            continue;
+
+                        supportfills_entities_json.push_back(std::move(supportfill_entity_json));
+                    }
+                    support_fills_json[JSON_EXTRUSION_ENTITIES] = std::move(supportfills_entities_json);
+                    support_layer_json[JSON_SUPPORT_LAYER_FILLS] = std::move(support_fills_json);
+
+                    support_layers_json.push_back(std::move(support_layer_json));
+                } // for each layer*/
+                root_json[JSON_SUPPORT_LAYERS] = std::move(support_layers_json);
+
+                for (const groupedVolumeSlices &group : first_layer_groups) {
+                    json first_layer_group_json;
 
+                    first_layer_group_json = group;
+                    first_layer_groups_json.push_back(std::move(first_layer_group_json));
+                }
+                root_json[JSON_FIRSTLAYER_GROUPS] = std::move(first_layer_groups_json);
+
+                json_vector.push_back(std::move(root_json));
+                records_vector.emplace_back();
+            }
             filename_vector.push_back(file_name);
-            json_vector.push_back(std::move(root_json));
-            /*boost::nowide::ofstream c;
-            c.open(file_name, std::ios::out | std::ios::trunc);
-            if (with_space)
-                c << root_json.dump(1, '\t') << std::endl;
-            else
-                c << root_json.dump(0) << std::endl;
-            c.close();*/
+            hash_vector.push_back(hash);
             count ++;
             BOOST_LOG_TRIVIAL(info) << boost::format("will dump object %1%'s json to %2%.")%model_obj->name%file_name;
         }
@@ -5580,16 +5697,21 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     boost::mutex mutex;
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, filename_vector.size()),
-        [filename_vector, &json_vector, with_space, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
+        [&filename_vector, &json_vector, &records_vector, &hash_vector, binary, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
             for (size_t object_index = output_range.begin(); object_index < output_range.end(); ++ object_index) {
                 try {
-                    boost::nowide::ofstream c;
-                    c.open(filename_vector[object_index], std::ios::out | std::ios::trunc);
-                    if (with_space)
+                    if (binary)
+                        save_slice_cache(filename_vector[object_index], records_vector[object_index], hash_vector[object_index]);
+                    else {
+                        // Human readable cache for debugging.
+                        boost::nowide::ofstream c;
+                        c.open(filename_vector[object_index], std::ios::out | std::ios::trunc);
                         c << json_vector[object_index].dump(1, '\t') << std::endl;
-                    else
-                        c << json_vector[object_index].dump(0) << std::endl;
-                    c.close();
+                        c.close();
+                    }
+                    // Release the object as soon as it is written, the data of all objects are alive otherwise.
+                    json_vector[object_index] = json();
+                    records_vector[object_index] = std::vector<SliceCacheRecord>();
                 }
                 catch(std::exception &err) {
                     BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": save to "<<filename_vector[object_index]<<" got a generic exception, reason = " << err.what();
@@ -5644,7 +5766,9 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
             //continue;
         }
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = slice_cache_file_name(directory, identify_id, true);
+        if (!fs::exists(file_name))
+            file_name = slice_cache_file_name(directory, identify_id, false);
 
         if (!fs::exists(file_name)) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": file %1% not exist, maybe a shared object, skip it")%file_name;
@@ -5654,16 +5778,50 @@ int Print::load_cached_data(const std::string& directory)
     }
 
     boost::mutex mutex;
+    std::vector<SliceCacheObjectInfo> object_infos(object_filenames.size());
+    // Text caches hold the layers in their json tree.
     std::vector<json> object_jsons(object_filenames.size());
+    // Binary caches with the layer records, null for the text caches.
+    std::vector<std::unique_ptr<SliceCacheFile>> object_caches(object_filenames.size());
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, object_filenames.size()),
-        [object_filenames, &ret, &object_jsons, &mutex](const tbb::blocked_range<size_t>& filename_range) {
+        [&object_filenames, &ret, &object_infos, &object_jsons, &object_caches, &mutex](const tbb::blocked_range<size_t>& filename_range) {
             for (size_t filename_index = filename_range.begin(); filename_index < filename_range.end(); ++ filename_index) {
                 try {
-                    json root_json;
-                    boost::nowide::ifstream ifs(object_filenames[filename_index].first);
-                    ifs >> root_json;
-                    object_jsons[filename_index] = std::move(root_json);
+                    const std::string &file_name = object_filenames[filename_index].first;
+                    const uint64_t     expected_hash = slice_cache_hash(*object_filenames[filename_index].second);
+                    if (boost::algorithm::ends_with(file_name, ".bin")) {
+                        auto cache = std::make_unique<SliceCacheFile>(file_name);
+                        if (cache->header().version != SLICE_CACHE_VERSION || cache->header().hash != expected_hash) {
+                            if (cache->header().version != SLICE_CACHE_VERSION)
+                                BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% has version %2%, expected %3%") % file_name % cache->header().version % SLICE_CACHE_VERSION;
+                            else
+                                BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% was exported for different mesh or settings") % file_name;
+                            boost::unique_lock l(mutex);
+                            if (ret == 0)
+                                ret = CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+                            continue;
+                        }
+                        object_infos[filename_index]  = cache->object_info();
+                        object_caches[filename_index] = std::move(cache);
+                    } else {
+                        json root_json;
+                        boost::nowide::ifstream ifs(file_name);
+                        ifs >> root_json;
+                        // The layout of the text cache did not change. Text caches written before the hash was stored
+                        // are loaded without validation, as they always were.
+                        if (auto it = root_json.find(JSON_SLICE_CACHE_HASH); it == root_json.end())
+                            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% has no hash, it is not validated") % file_name;
+                        else if (it->get<uint64_t>() != expected_hash) {
+                            BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": %1% was exported for different mesh or settings") % file_name;
+                            boost::unique_lock l(mutex);
+                            if (ret == 0)
+                                ret = CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+                            continue;
+                        }
+                        object_infos[filename_index] = slice_cache_object_info(root_json);
+                        object_jsons[filename_index] = std::move(root_json);
+                    }
                 }
                 catch(std::exception &err) {
                     BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": load from "<<object_filenames[filename_index].first<<" got a generic exception, reason = " << err.what();
@@ -5675,25 +5833,27 @@ int Print::load_cached_data(const std::string& directory)
     );
 
     if (ret) {
-        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": load json failed.");
+        BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": load cache failed, ret=%1%.")%ret;
         return ret;
     }
 
-    for (int obj_index = 0; obj_index < object_jsons.size(); obj_index++) {
-        json& root_json = object_jsons[obj_index];
+    for (int obj_index = 0; obj_index < object_infos.size(); obj_index++) {
+        SliceCacheObjectInfo &info = object_infos[obj_index];
+        const json &root_json = object_jsons[obj_index];
+        const SliceCacheFile *cache = object_caches[obj_index].get();
         PrintObject *obj = object_filenames[obj_index].second;
 
         try {
             //boost::nowide::ifstream ifs(file_name);
             //ifs >> root_json;
 
-            std::string name = root_json.at(JSON_OBJECT_NAME);
-            int identify_id = root_json.at(JSON_IDENTIFY_ID);
+            const std::string &name = info.name;
+            size_t identify_id = info.identify_id;
             int layer_count = 0, support_layer_count = 0, firstlayer_group_count = 0;
 
-            layer_count = root_json[JSON_LAYERS].size();
-            support_layer_count = root_json[JSON_SUPPORT_LAYERS].size();
-            firstlayer_group_count = root_json[JSON_FIRSTLAYER_GROUPS].size();
+            layer_count = info.layers.size();
+            support_layer_count = info.support_layers.size();
+            firstlayer_group_count = info.first_layer_groups.size();
 
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, firstlayer_group_count %5%")
                 %name %identify_id %layer_count %support_layer_count %firstlayer_group_count;
@@ -5702,8 +5862,8 @@ int Print::load_cached_data(const std::string& directory)
             //create layer and layer regions
             for (int index = 0; index < layer_count; index++)
             {
-                json& layer_json = root_json[JSON_LAYERS][index];
-                Layer* new_layer = obj->add_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z], layer_json[JSON_LAYER_SLICE_Z]);
+                const SliceCacheLayerInfo &layer_info = info.layers[index];
+                Layer* new_layer = obj->add_layer(layer_info.id, layer_info.height, layer_info.print_z, layer_info.slice_z);
                 if (!new_layer) {
                     BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":create_layer failed, out of memory");
                     return CLI_OUT_OF_MEMORY;
@@ -5715,11 +5875,10 @@ int Print::load_cached_data(const std::string& directory)
                 previous_layer = new_layer;
 
                 //layer regions
-                int layer_regions_count = layer_json[JSON_LAYER_REGIONS].size();
+                int layer_regions_count = layer_info.region_config_hashes.size();
                 for (int region_index = 0; region_index < layer_regions_count; region_index++)
                 {
-                    json& region_json = layer_json[JSON_LAYER_REGIONS][region_index];
-                    size_t config_hash = region_json[JSON_LAYER_REGION_CONFIG_HASH];
+                    size_t config_hash = layer_info.region_config_hashes[region_index];
                     const PrintRegion *print_region = find_region(obj, config_hash);
 
                     if (!print_region){
@@ -5738,11 +5897,13 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": load the layers in parallel");
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, obj->layer_count()),
-                [&root_json, &obj](const tbb::blocked_range<size_t>& layer_range) {
+                [&root_json, cache, &obj](const tbb::blocked_range<size_t>& layer_range) {
                     for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
-                        const json& layer_json = root_json[JSON_LAYERS][layer_index];
                         Layer* layer = obj->get_layer(layer_index);
-                        extract_layer(layer_json, *layer);
+                        if (cache)
+                            cache->load_layer(layer_index, *layer);
+                        else
+                            extract_layer(root_json[JSON_LAYERS][layer_index], *layer);
                     }
                 }
             );
@@ -5752,8 +5913,8 @@ int Print::load_cached_data(const std::string& directory)
             //create support_layers
             for (int index = 0; index < support_layer_count; index++)
             {
-                json& layer_json = root_json[JSON_SUPPORT_LAYERS][index];
-                SupportLayer* new_support_layer = obj->add_support_layer(layer_json[JSON_LAYER_ID], layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID], layer_json[JSON_LAYER_HEIGHT], layer_json[JSON_LAYER_PRINT_Z]);
+                const SliceCacheLayerInfo &layer_info = info.support_layers[index];
+                SupportLayer* new_support_layer = obj->add_support_layer(layer_info.id, layer_info.interface_id, layer_info.height, layer_info.print_z);
                 if (!new_support_layer) {
                     BOOST_LOG_TRIVIAL(error) <<__FUNCTION__<< boost::format(":add_support_layer failed, out of memory");
                     return CLI_OUT_OF_MEMORY;
@@ -5768,11 +5929,13 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": finished load layers, start to load support_layers.");
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, obj->support_layer_count()),
-                [&root_json, &obj](const tbb::blocked_range<size_t>& support_layer_range) {
+                [&root_json, cache, &obj](const tbb::blocked_range<size_t>& support_layer_range) {
                     for (size_t layer_index = support_layer_range.begin(); layer_index < support_layer_range.end(); ++ layer_index) {
-                        const json& layer_json = root_json[JSON_SUPPORT_LAYERS][layer_index];
                         SupportLayer* support_layer = obj->get_support_layer(layer_index);
-                        extract_support_layer(layer_json, *support_layer);
+                        if (cache)
+                            cache->load_layer(obj->layer_count() + layer_index, *support_layer);
+                        else
+                            extract_support_layer(root_json[JSON_SUPPORT_LAYERS][layer_index], *support_layer);
                     }
                 }
             );
@@ -5781,8 +5944,7 @@ int Print::load_cached_data(const std::string& directory)
             std::vector<groupedVolumeSlices>& firstlayer_objgroups = obj->firstLayerObjGroupsMod();
             for (int index = 0; index < firstlayer_group_count; index++)
             {
-                json& firstlayer_group_json = root_json[JSON_FIRSTLAYER_GROUPS][index];
-                groupedVolumeSlices firstlayer_group = firstlayer_group_json;
+                groupedVolumeSlices firstlayer_group = std::move(info.first_layer_groups[index]);
                 //convert the id
                 for (ObjectID& obj_id : firstlayer_group.volume_ids)
                 {
@@ -5815,7 +5977,9 @@ int Print::load_cached_data(const std::string& directory)
         }
     }
 
+    object_infos.clear();
     object_jsons.clear();
+    object_caches.clear();
     object_filenames.clear();
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": total printobject count %1%, loaded %2%, ret=%3%")%m_objects.size() %count %ret;
     return ret;
@@ -478,6 +478,8 @@ public:
     // SoftFever
     size_t get_id() const { return m_id; }
     void set_id(size_t id) { m_id = id; }
+    // Index of this object in Print::objects(), labels the Trace spans. -1 if not found or if tracing is disabled.
+    int trace_id() const;
 
   private:
     // to be called from Print only.
@@ -7769,6 +7769,14 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionBool(true));
 
+    def = this->add("binary_gcode", coBool);
+    def->label = L("Binary G-code");
+    def->tooltip = L("Export the G-code in the binary G-code format (.bgcode). The G-code is stored in compressed, "
+                   "checksummed blocks together with the thumbnails and the print metadata. "
+                   "Enable only if the printer firmware supports binary G-code.");
+    def->mode = comAdvanced;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("wall_generator", coEnum);
     def->label = L("Wall generator");
     def->category = L("Quality");
@@ -12154,6 +12162,23 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "file";
     def->set_default_value(new ConfigOptionString());
 
+    def = this->add("trace_file", coString);
+    def->label = L("Trace file");
+    def->tooltip = L("Record the duration of the slicing and G-code export steps per object and per layer, "
+                     "and save them to the given file in the Chrome trace format.");
+    def->cli_params = "trace.json";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("trace_summary", coBool);
+    def->label = L("Trace summary");
+    def->tooltip = L("Record the duration of the slicing and G-code export steps and print a summary table when finished.");
+    def->set_default_value(new ConfigOptionBool(false));
+
+    def = this->add("clipper2", coBool);
+    def->label = L("Use Clipper2");
+    def->tooltip = L("Use the Clipper2 library instead of ClipperLib for the polygon clipping and offsetting operations.");
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("enable_timelapse", coBool);
     def->label = L("Enable timelapse for print");
     def->tooltip = L("If enabled, this slicing will be considered using timelapse.");
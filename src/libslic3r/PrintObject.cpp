@@ -18,6 +18,7 @@
 #include "Surface.hpp"
 #include "Slicing.hpp"
 #include "Tesselate.hpp"
+#include "Trace.hpp"
 #include "TriangleMeshSlicer.hpp"
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
@@ -30,7 +31,9 @@
 #include <float.h>
 #include <iterator>
 #include <mutex>
+#include <numeric>
 #include <string>
+#include <unordered_map>
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
@@ -449,6 +452,57 @@ std::vector<std::set<int>> PrintObject::detect_extruder_geometric_unprintables()
     return geometric_unprintables;
 }
 
+int PrintObject::trace_id() const
+{
+    // Only look the object up if the spans are recorded.
+    if (! Trace::enabled())
+        return -1;
+    const auto &objects = m_print->objects();
+    auto        it      = std::find(objects.begin(), objects.end(), this);
+    return it == objects.end() ? -1 : int(it - objects.begin());
+}
+
+// For each layer, the index of a layer with the same inputs of Layer::make_perimeters() to copy the perimeters from,
+// or the index of the layer itself if its perimeters have to be generated. Prismatic objects (brackets, enclosures, extrusions)
+// produce long runs of layers with equal slices, their perimeters are only generated for the first layer of such a run.
+static std::vector<size_t> perimeters_source_layers(const PrintObject &object, const LayerPtrs &layers, std::function<void()> throw_if_canceled)
+{
+    std::vector<size_t> source(layers.size());
+    std::iota(source.begin(), source.end(), 0);
+    // The vase mode switches on above the bottom shell and the fuzzy skin noise depends on z,
+    // both make the perimeters depend on the layer z.
+    if (object.print()->config().spiral_mode)
+        return source;
+    for (size_t region_id = 0; region_id < object.num_printing_regions(); ++ region_id)
+        if (object.printing_region(region_id).config().fuzzy_skin.value != FuzzySkinType::None)
+            return source;
+
+    std::vector<size_t> hashes(layers.size(), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &hashes, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            throw_if_canceled();
+            hashes[layer_idx] = layers[layer_idx]->perimeters_inputs_hash();
+        }
+    });
+    // The first layer of each hash is the source of the following layers with the same hash.
+    // The first object layer and the raft interface are special cased by the perimeter generator, they are always generated.
+    std::unordered_map<size_t, size_t> first_layer_with_hash;
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+        if (layers[layer_idx]->id() > size_t(object.config().raft_layers.value))
+            if (auto [it, inserted] = first_layer_with_hash.emplace(hashes[layer_idx], layer_idx); ! inserted)
+                source[layer_idx] = it->second;
+    // Hash collisions are resolved by comparing the inputs.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &source, &throw_if_canceled](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            if (source[layer_idx] != layer_idx) {
+                throw_if_canceled();
+                if (! layers[layer_idx]->perimeters_inputs_equal(*layers[source[layer_idx]]))
+                    source[layer_idx] = layer_idx;
+            }
+    });
+    return source;
+}
+
 // 1) Merges typed region slices into stInternal type.
 // 2) Increases an "extra perimeters" counter at region slices where needed.
 // 3) Generates perimeters, gap fills and fill regions (fill regions of type stInternal).
@@ -460,6 +514,7 @@ void PrintObject::make_perimeters()
     if (! this->set_started(posPerimeters))
         return;
 
+    Trace::Span span("make_perimeters", "PrintObject", this->trace_id());
     m_print->set_status(15, L("Generating walls"));
     BOOST_LOG_TRIVIAL(info) << "Generating walls..." << log_memory_info();
 
@@ -543,18 +598,38 @@ void PrintObject::make_perimeters()
         BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
     }
 
+    const std::vector<size_t> perimeters_source = perimeters_source_layers(*this, m_layers, [print = m_print]() { print->throw_if_canceled(); });
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
-                m_print->throw_if_canceled();
-                m_layers[layer_idx]->make_perimeters();
-            }
+        [this, &perimeters_source, trace_id = this->trace_id()](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                if (perimeters_source[layer_idx] == layer_idx) {
+                    m_print->throw_if_canceled();
+                    Trace::Span layer_span("make_perimeters", "Layer", trace_id, int(layer_idx));
+                    m_layers[layer_idx]->make_perimeters();
+                }
         }
     );
     m_print->throw_if_canceled();
-    BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
+    // Copy the perimeters to the layers with the same inputs.
+    size_t num_copied = 0;
+    for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+        num_copied += perimeters_source[layer_idx] != layer_idx;
+    if (num_copied > 0) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &perimeters_source](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                    if (size_t source_idx = perimeters_source[layer_idx]; source_idx != layer_idx) {
+                        m_print->throw_if_canceled();
+                        m_layers[layer_idx]->copy_perimeters_from(*m_layers[source_idx]);
+                    }
+            }
+        );
+        m_print->throw_if_canceled();
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end, copied the perimeters of " << num_copied << " of " << m_layers.size() << " layers";
 
     this->set_done(posPerimeters);
 }
@@ -704,6 +779,7 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
+        Trace::Span span("infill", "PrintObject", this->trace_id());
         m_print->set_status(35, L("Generating infill toolpath"));
 
         // Orca: precompute the object's 3D connected bodies for separated infills / per-model
@@ -777,9 +853,10 @@ void PrintObject::infill()
         BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree](const tbb::blocked_range<size_t>& range) {
+            [this, &adaptive_fill_octree = adaptive_fill_octree, &support_fill_octree = support_fill_octree, trace_id = this->trace_id()](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
+                    Trace::Span layer_span("make_fills", "Layer", trace_id, int(layer_idx));
                     m_layers[layer_idx]->make_fills(adaptive_fill_octree.get(), support_fill_octree.get(), this->m_lightning_generator.get());
                 }
             }
@@ -918,6 +995,7 @@ void PrintObject::detect_overhangs_for_lift()
 void PrintObject::generate_support_material()
 {
     if (this->set_started(posSupportMaterial)) {
+        Trace::Span span("generate_support_material", "PrintObject", this->trace_id());
         this->clear_support_layers();
 
         if(!has_support() && !m_print->get_no_check_flag()) {
@@ -1092,8 +1170,12 @@ FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
 void PrintObject::clear_layers()
 {
     if (!m_shared_object) {
-        for (Layer *l : m_layers)
-            delete l;
+        // Each layer owns trees of heap allocated extrusion entities and polylines, releasing millions of them
+        // one layer after the other dominates the time to invalidate a large print. The layers are independent.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                delete m_layers[i];
+        });
         m_layers.clear();
     }
 }
@@ -1119,8 +1201,10 @@ SupportLayer* PrintObject::get_support_layer_at_printz(coordf_t print_z, coordf_
 void PrintObject::clear_support_layers()
 {
     if (!m_shared_object) {
-        for (SupportLayer* l : m_support_layers)
-            delete l;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_support_layers.size()), [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                delete m_support_layers[i];
+        });
         m_support_layers.clear();
         for (auto l : m_layers) {
             l->sharp_tails.clear();
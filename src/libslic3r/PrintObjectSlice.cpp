@@ -11,6 +11,7 @@
 #include "Print.hpp"
 //BBS
 #include "ShortestPath.hpp"
+#include "Trace.hpp"
 #include "libslic3r/Feature/Interlocking/InterlockingGenerator.hpp"
 
 //! macro used to mark string used at localization, return same string
@@ -818,6 +819,7 @@ void PrintObject::slice()
 {
     if (! this->set_started(posSlice))
         return;
+    Trace::Span span("slice", "PrintObject", this->trace_id());
     //BBS: add flag to reload scene for shell rendering
     m_print->set_status(5, L("Slicing mesh"), PrintBase::SlicingStatus::RELOAD_SCENE);
     std::vector<coordf_t> layer_height_profile;
@@ -1,6 +1,9 @@
 #include "QuadricEdgeCollapse.hpp"
 #include <tuple>
 #include <optional>
+#include <numeric>
+#include <mutex>
+#include <unordered_map>
 #include "MutablePriorityQueue.hpp"
 #include <tbb/parallel_for.h>
 
@@ -93,6 +96,8 @@ namespace QuadricEdgeCollapse {
         EdgeInfo() = default;
     };
     using EdgeInfos = std::vector<EdgeInfo>;
+    // Vertices which are neither moved nor removed, edges touching them are never collapsed.
+    using LockedVertices = std::vector<bool>;
 
     // DTO for change neighbors
     struct CopyEdgeInfo {
@@ -115,8 +120,23 @@ namespace QuadricEdgeCollapse {
     // calculate error for vertex and quadrics, triangle quadrics and triangle vertex give zero, only pozitive number
     double vertex_error(const SymMat &q, const Vec3d &vertex);
     SymMat create_quadric(const Triangle &t, const Vec3d& n, const Vertices &vertices);
+    // sum of quadrics of triangles around each vertex
+    std::vector<SymMat> create_vertex_quadrics(const indexed_triangle_set &its, ThrowOnCancel &throw_on_cancel);
+    // vertex_quadrics are used instead of the sums of the triangle quadrics when not nullptr
     std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-    init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
+    init(const indexed_triangle_set &its, const std::vector<SymMat> *vertex_quadrics, const LockedVertices &locked,
+         ThrowOnCancel& throw_on_cancel, StatusFn& status_fn);
+    // Collapse edges until triangle_count or maximal_error is reached, deleted triangles and vertices are left in its
+    // and marked in t_infos and v_infos. Returns the error of the last collapsed edge.
+    float collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+                   const std::vector<SymMat> *vertex_quadrics, const LockedVertices &locked,
+                   ThrowOnCancel &throw_on_cancel, StatusFn &status_fn,
+                   TriangleInfos &t_infos, VertexInfos &v_infos, EdgeInfos &e_infos);
+    // Split the mesh into num_parts spatially compact parts, collapse their interiors in parallel with the vertices
+    // shared between the parts locked, then collapse the whole mesh to triangle_count to simplify the seams.
+    float collapse_partitioned(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, size_t num_parts,
+                               ThrowOnCancel &throw_on_cancel, StatusFn &status_fn);
+    std::vector<uint32_t> split_into_parts(const indexed_triangle_set &its, size_t num_parts);
     std::optional<uint32_t> find_triangle_index1(uint32_t vi, const VertexInfo& v_info,
         uint32_t ti, const EdgeInfos& e_infos, const Indices& indices);
     void reorder_edges(EdgeInfos &e_infos, const VertexInfo &v_info, uint32_t ti0, uint32_t ti1);
@@ -127,8 +147,8 @@ namespace QuadricEdgeCollapse {
     bool create_no_volume(uint32_t vi0, uint32_t vi1, uint32_t ti0, uint32_t ti1,
         const VertexInfo &v_info0, const VertexInfo &v_info1, const EdgeInfos &e_infos, const Indices &indices);
     // find edge with smallest error in triangle
-    Vec3d calculate_3errors(const Triangle &t, const Vertices &vertices, const VertexInfos &v_infos);
-    Error calculate_error(uint32_t ti, const Triangle& t,const Vertices &vertices, const VertexInfos& v_infos, unsigned char& min_index);
+    Vec3d calculate_3errors(const Triangle &t, const Vertices &vertices, const VertexInfos &v_infos, const LockedVertices &locked);
+    Error calculate_error(uint32_t ti, const Triangle& t,const Vertices &vertices, const VertexInfos& v_infos, const LockedVertices &locked, unsigned char& min_index);
     void remove_triangle(EdgeInfos &e_infos, VertexInfo &v_info, uint32_t ti);
     void change_neighbors(EdgeInfos &e_infos, VertexInfos &v_infos, uint32_t ti0, uint32_t ti1,
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
@@ -153,6 +173,11 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // partitioned simplification of big meshes
+    const size_t min_triangle_count_for_one_part = 50000;
+    // Independent of the number of threads, thus the result does not depend on the machine.
+    const size_t max_num_parts = 16;
+    const int status_parts_size = 80; // in percents, the rest is the seam pass
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -171,16 +196,38 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    // Big meshes are split into parts simplified in parallel, each part having enough triangles to pay off its seam.
+    size_t num_parts = 1;
+    const size_t num_parts_max = std::min(max_num_parts, its.indices.size() / min_triangle_count_for_one_part);
+    while (2 * num_parts <= num_parts_max) num_parts *= 2;
+
+    float last_collapsed_error;
+    if (num_parts > 1) {
+        last_collapsed_error = collapse_partitioned(its, triangle_count, maximal_error, num_parts, throw_on_cancel, status_fn);
+    } else {
+        TriangleInfos t_infos; // only normals with information about deleted triangle
+        VertexInfos   v_infos;
+        EdgeInfos     e_infos;
+        last_collapsed_error = collapse(its, triangle_count, maximal_error, nullptr, LockedVertices(),
+                                        throw_on_cancel, status_fn, t_infos, v_infos, e_infos);
+        // compact triangle
+        compact(v_infos, t_infos, e_infos, its);
+    }
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error,
+                                    const std::vector<SymMat> *vertex_quadrics, const LockedVertices &locked,
+                                    ThrowOnCancel &throw_on_cancel, StatusFn &status_fn,
+                                    TriangleInfos &t_infos, VertexInfos &v_infos, EdgeInfos &e_infos)
+{
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
     };
 
-    TriangleInfos t_infos; // only normals with information about deleted triangle
-    VertexInfos   v_infos;
-    EdgeInfos     e_infos;
     Errors        errors;
-    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, vertex_quadrics, locked, throw_on_cancel, init_status_fn);
     throw_on_cancel();
     status_fn(status_init_size);
 
@@ -204,6 +251,7 @@ void Slic3r::its_quadric_edge_collapse(
     changed_triangle_indices.reserve(2 * max_triangle_count_for_one_vertex);
 
     uint32_t actual_triangle_count = its.indices.size();
+    if (actual_triangle_count <= triangle_count) return 0.f;
     uint32_t count_triangle_to_reduce = actual_triangle_count - triangle_count;
     auto increase_status = [&]() { 
         double reduced = (actual_triangle_count - triangle_count) /
@@ -262,7 +310,7 @@ void Slic3r::its_quadric_edge_collapse(
             is_flipped(new_vertex0, ti0, ti1, v_info0, t_infos, e_infos, its) ||
             is_flipped(new_vertex0, ti0, ti1, v_info1, t_infos, e_infos, its)) {
             // try other triangle's edge
-            Vec3d errors = calculate_3errors(t0, its.vertices, v_infos);
+            Vec3d errors = calculate_3errors(t0, its.vertices, v_infos, locked);
             Vec3i32 ord = (errors[0] < errors[1]) ? 
                 ((errors[0] < errors[2])? 
                     ((errors[1] < errors[2]) ? Vec3i32(0, 1, 2) : Vec3i32(0, 2, 1)) :
@@ -326,7 +374,7 @@ void Slic3r::its_quadric_edge_collapse(
             size_t priority_queue_index = ti_2_mpqi[ti];
             TriangleInfo& t_info = t_infos[ti];
             t_info.n = create_normal(its.indices[ti], its.vertices).cast<float>(); // recalc normals
-            mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_info.min_index);
+            mpq[priority_queue_index] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, locked, t_info.min_index);
             mpq.update(priority_queue_index);
         }
 
@@ -340,10 +388,189 @@ void Slic3r::its_quadric_edge_collapse(
         assert(check_neighbors(its, t_infos, v_infos, e_infos));
 #endif // EXPENSIVE_DEBUG_CHECKS
     }
+    return last_collapsed_error;
+}
+
+std::vector<SymMat> QuadricEdgeCollapse::create_vertex_quadrics(const indexed_triangle_set &its, ThrowOnCancel &throw_on_cancel)
+{
+    std::vector<SymMat> triangle_quadrics(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            triangle_quadrics[i] = create_quadric(t, create_normal(t, its.vertices), its.vertices);
+        }
+    }); // END parallel for
+    throw_on_cancel();
+    std::vector<SymMat> vertex_quadrics(its.vertices.size());
+    for (size_t i = 0; i < its.indices.size(); i++)
+        for (size_t e = 0; e < 3; e++)
+            vertex_quadrics[its.indices[i][e]] += triangle_quadrics[i];
+    return vertex_quadrics;
+}
 
-    // compact triangle
+std::vector<uint32_t> QuadricEdgeCollapse::split_into_parts(const indexed_triangle_set &its, size_t num_parts)
+{
+    assert(num_parts > 0 && (num_parts & (num_parts - 1)) == 0);
+    std::vector<Vec3f> centers(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i) {
+            const Triangle &t = its.indices[i];
+            centers[i] = (its.vertices[t[0]] + its.vertices[t[1]] + its.vertices[t[2]]) / 3.f;
+        }
+    }); // END parallel for
+
+    // k-d tree like split: halve the triangles by the median of their centers along the longest axis
+    std::vector<uint32_t> order(its.indices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint32_t> triangle_part(its.indices.size());
+    std::function<void(size_t, size_t, size_t, size_t)> split = [&](size_t begin, size_t end, size_t part, size_t count) {
+        if (count == 1) {
+            for (size_t i = begin; i < end; ++i) triangle_part[order[i]] = part;
+            return;
+        }
+        Vec3f min = centers[order[begin]], max = min;
+        for (size_t i = begin; i < end; ++i) {
+            min = min.cwiseMin(centers[order[i]]);
+            max = max.cwiseMax(centers[order[i]]);
+        }
+        int axis;
+        (max - min).maxCoeff(&axis);
+        size_t mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+            [&centers, axis](uint32_t ti0, uint32_t ti1) { return centers[ti0][axis] < centers[ti1][axis]; });
+        split(begin, mid, part, count / 2);
+        split(mid, end, part + count / 2, count / 2);
+    };
+    split(0, order.size(), 0, num_parts);
+    return triangle_part;
+}
+
+float QuadricEdgeCollapse::collapse_partitioned(indexed_triangle_set &its,
+                                                uint32_t              triangle_count,
+                                                float                 maximal_error,
+                                                size_t                num_parts,
+                                                ThrowOnCancel &       throw_on_cancel,
+                                                StatusFn &            status_fn)
+{
+    // Quadrics of the whole mesh, the quadrics of vertices shared by more parts are complete only here.
+    std::vector<SymMat> vertex_quadrics = create_vertex_quadrics(its, throw_on_cancel);
+    std::vector<uint32_t> triangle_part = split_into_parts(its, num_parts);
+    throw_on_cancel();
+
+    // vertices used by triangles of more parts are locked in the parallel pass
+    const uint32_t border_part = std::numeric_limits<uint32_t>::max();
+    const uint32_t unused_part = border_part - 1;
+    std::vector<uint32_t> vertex_part(its.vertices.size(), unused_part);
+    std::vector<std::vector<uint32_t>> part_triangles(num_parts);
+    for (size_t ti = 0; ti < its.indices.size(); ++ti) {
+        uint32_t part = triangle_part[ti];
+        part_triangles[part].emplace_back(ti);
+        for (size_t j = 0; j < 3; ++j) {
+            uint32_t &vp = vertex_part[its.indices[ti][j]];
+            if (vp == unused_part) vp = part;
+            else if (vp != part) vp = border_part;
+        }
+    }
+    triangle_part = {};
+
+    // Progress of the parts weighted by their triangle counts. Parts report from their threads,
+    // status_fn is called by one thread at a time with a never decreasing value.
+    std::mutex       status_mutex;
+    std::vector<int> part_status(num_parts, 0);
+    int              reported_status = 0;
+    auto report_part_status = [&](size_t part, int percent) {
+        std::lock_guard<std::mutex> lock(status_mutex);
+        part_status[part] = percent;
+        double sum = 0.;
+        for (size_t i = 0; i < num_parts; ++i)
+            sum += double(part_status[i]) * part_triangles[i].size();
+        int status = static_cast<int>(std::round(sum * status_parts_size / (100. * its.indices.size())));
+        if (status > reported_status) {
+            reported_status = status;
+            status_fn(status);
+        }
+    };
+
+    std::vector<Indices> part_indices(num_parts);
+    std::vector<float>   part_errors(num_parts, 0.f);
+    // local index of a vertex used by one part only, written by that part
+    const uint32_t        unset_index = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> global_to_local(its.vertices.size(), unset_index);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_parts, 1),
+    [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t part = range.begin(); part < range.end(); ++part) {
+            const std::vector<uint32_t> &triangles = part_triangles[part];
+            indexed_triangle_set         part_its;
+            std::vector<uint32_t>        local_to_global;
+            std::vector<SymMat>          part_quadrics;
+            LockedVertices               locked;
+            std::unordered_map<uint32_t, uint32_t> border_to_local;
+            auto local_index = [&](uint32_t vi) {
+                bool      is_border = vertex_part[vi] == border_part;
+                uint32_t &vi_local  = is_border ? border_to_local.try_emplace(vi, unset_index).first->second : global_to_local[vi];
+                if (vi_local == unset_index) {
+                    vi_local = uint32_t(local_to_global.size());
+                    local_to_global.emplace_back(vi);
+                    part_its.vertices.emplace_back(its.vertices[vi]);
+                    part_quadrics.emplace_back(vertex_quadrics[vi]);
+                    locked.push_back(is_border);
+                }
+                return vi_local;
+            };
+            part_its.indices.reserve(triangles.size());
+            for (uint32_t ti : triangles) {
+                const Triangle &t = its.indices[ti];
+                part_its.indices.emplace_back(local_index(t[0]), local_index(t[1]), local_index(t[2]));
+            }
+
+            uint32_t part_triangle_count = static_cast<uint32_t>(
+                std::ceil(double(triangle_count) * triangles.size() / its.indices.size()));
+            StatusFn part_status_fn = [&report_part_status, part](int percent) { report_part_status(part, percent); };
+            TriangleInfos t_infos;
+            VertexInfos   v_infos;
+            EdgeInfos     e_infos;
+            if (part_triangle_count < part_its.indices.size())
+                part_errors[part] = collapse(part_its, part_triangle_count, maximal_error, &part_quadrics, locked,
+                                             throw_on_cancel, part_status_fn, t_infos, v_infos, e_infos);
+
+            // Moved vertices and their quadrics are written back, locked vertices did not change.
+            for (uint32_t vi = 0; vi < v_infos.size(); ++vi)
+                if (! locked[vi] && ! v_infos[vi].is_deleted()) {
+                    its.vertices[local_to_global[vi]]    = part_its.vertices[vi];
+                    vertex_quadrics[local_to_global[vi]] = v_infos[vi].q;
+                }
+            Indices &indices = part_indices[part];
+            indices.reserve(part_its.indices.size());
+            for (uint32_t ti = 0; ti < part_its.indices.size(); ++ti)
+                if (t_infos.empty() || ! t_infos[ti].is_deleted()) {
+                    const Triangle &t = part_its.indices[ti];
+                    indices.emplace_back(local_to_global[t[0]], local_to_global[t[1]], local_to_global[t[2]]);
+                }
+        }
+    }); // END parallel for
+    throw_on_cancel();
+    status_fn(status_parts_size);
+
+    // Vertices removed by the parallel pass are not referenced anymore, compact() drops them after the seam pass.
+    its.indices.clear();
+    for (Indices &indices : part_indices) {
+        its.indices.insert(its.indices.end(), indices.begin(), indices.end());
+        indices = {};
+    }
+
+    // Seam pass over the whole mesh continues with the quadrics accumulated by the parallel pass.
+    StatusFn seam_status_fn = [&status_fn](int percent) {
+        status_fn(status_parts_size + static_cast<int>(std::round(percent * (100 - status_parts_size) / 100.f)));
+    };
+    TriangleInfos t_infos;
+    VertexInfos   v_infos;
+    EdgeInfos     e_infos;
+    float last_collapsed_error = collapse(its, triangle_count, maximal_error, &vertex_quadrics, LockedVertices(),
+                                          throw_on_cancel, seam_status_fn, t_infos, v_infos, e_infos);
     compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    return std::max(last_collapsed_error, *std::max_element(part_errors.begin(), part_errors.end()));
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -438,13 +665,14 @@ SymMat QuadricEdgeCollapse::create_quadric(const Triangle &t,
 }
 
 std::tuple<TriangleInfos, VertexInfos, EdgeInfos, Errors> 
-QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
+QuadricEdgeCollapse::init(const indexed_triangle_set &its, const std::vector<SymMat> *vertex_quadrics, const LockedVertices &locked,
+                          ThrowOnCancel& throw_on_cancel, StatusFn& status_fn)
 {
     int status_offset = 0;
     TriangleInfos t_infos(its.indices.size());
     VertexInfos   v_infos(its.vertices.size());
     {
-        std::vector<SymMat> triangle_quadrics(its.indices.size());
+        std::vector<SymMat> triangle_quadrics(vertex_quadrics == nullptr ? its.indices.size() : 0);
         // calculate normals
         tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()),
         [&](const tbb::blocked_range<size_t> &range) {
@@ -453,7 +681,8 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
                 TriangleInfo &  t_info = t_infos[i];
                 Vec3d           normal = create_normal(t, its.vertices);
                 t_info.n = normal.cast<float>();
-                triangle_quadrics[i] = create_quadric(t, normal, its.vertices);
+                if (vertex_quadrics == nullptr)
+                    triangle_quadrics[i] = create_quadric(t, normal, its.vertices);
                 if (i % 1000000 == 0) {
                     throw_on_cancel();
                     status_fn(status_offset + (i * status_normal_size) / its.indices.size());
@@ -463,12 +692,15 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
         status_offset += status_normal_size;
 
         // sum quadrics
+        if (vertex_quadrics != nullptr)
+            for (size_t i = 0; i < v_infos.size(); i++)
+                v_infos[i].q = (*vertex_quadrics)[i];
         for (size_t i = 0; i < its.indices.size(); i++) {
             const Triangle &t = its.indices[i];
-            const SymMat &  q = triangle_quadrics[i];
             for (size_t e = 0; e < 3; e++) {
                 VertexInfo &v_info = v_infos[t[e]];
-                v_info.q += q;
+                if (vertex_quadrics == nullptr)
+                    v_info.q += triangle_quadrics[i];
                 ++v_info.count; // triangle count
             }
             if (i % 1000000 == 0) {
@@ -500,7 +732,7 @@ QuadricEdgeCollapse::init(const indexed_triangle_set &its, ThrowOnCancel& throw_
         for (size_t i = range.begin(); i < range.end(); ++i) {
             const Triangle &t      = its.indices[i];
             TriangleInfo &  t_info = t_infos[i];
-            errors[i] = calculate_error(i, t, its.vertices, v_infos, t_info.min_index);
+            errors[i] = calculate_error(i, t, its.vertices, v_infos, locked, t_info.min_index);
             if (i % 1000000 == 0) {
                 throw_on_cancel();
                 status_fn(status_offset + (i * status_calc_errors) / its.indices.size());
@@ -690,15 +922,22 @@ bool QuadricEdgeCollapse::create_no_volume(
     return false;
 }
 
-Vec3d QuadricEdgeCollapse::calculate_3errors(const Triangle &   t,
-                                             const Vertices &   vertices,
-                                             const VertexInfos &v_infos)
+Vec3d QuadricEdgeCollapse::calculate_3errors(const Triangle &      t,
+                                             const Vertices &      vertices,
+                                             const VertexInfos &   v_infos,
+                                             const LockedVertices &locked)
 {
     Vec3d error;
     for (size_t j = 0; j < 3; ++j) {
         size_t   j2  = (j == 2) ? 0 : (j + 1);
         uint32_t vi0 = t[j];
         uint32_t vi1 = t[j2];
+        if (! locked.empty() && (locked[vi0] || locked[vi1])) {
+            // edge can't be collapsed, sort it behind any maximal error
+            // Float max, the error is narrowed to float by calculate_error().
+            error[j] = std::numeric_limits<float>::max();
+            continue;
+        }
         SymMat   q(v_infos[vi0].q); // copy
         q += v_infos[vi1].q;
         error[j] = calculate_error(vi0, vi1, q, vertices);
@@ -706,13 +945,14 @@ Vec3d QuadricEdgeCollapse::calculate_3errors(const Triangle &   t,
     return error;
 }
 
-Error QuadricEdgeCollapse::calculate_error(uint32_t           ti,
-                                           const Triangle &   t,
-                                           const Vertices &   vertices,
-                                           const VertexInfos &v_infos,
-                                           unsigned char &    min_index)
+Error QuadricEdgeCollapse::calculate_error(uint32_t              ti,
+                                           const Triangle &      t,
+                                           const Vertices &      vertices,
+                                           const VertexInfos &   v_infos,
+                                           const LockedVertices &locked,
+                                           unsigned char &       min_index)
 {
-    Vec3d error = calculate_3errors(t, vertices, v_infos);
+    Vec3d error = calculate_3errors(t, vertices, v_infos, locked);
     // select min error
     min_index = (error[0] < error[1]) ? ((error[0] < error[2]) ? 0 : 2) :
                                         ((error[1] < error[2]) ? 1 : 2);
@@ -10,6 +10,8 @@ namespace Slic3r {
 
 /// <summary>
 /// Simplify mesh by Quadric metric
+/// Big meshes are split into parts simplified in parallel,
+/// the vertices shared by the parts are simplified by a final pass over the whole mesh.
 /// </summary>
 /// <param name="its">IN/OUT triangle mesh to be simplified.</param>
 /// <param name="triangle_count">Wanted triangle count.</param>
@@ -0,0 +1,180 @@
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+namespace Trace {
+
+namespace {
+
+struct ThreadBuffer
+{
+    // Only locked by the owning thread when appending and by the exporter, thus practically uncontended.
+    std::mutex         mutex;
+    std::vector<Event> events;
+    int                thread_id;
+};
+
+struct State
+{
+    std::atomic<bool>                          enabled { false };
+    std::atomic<int64_t>                       origin_us { 0 };
+    std::mutex                                 registry_mutex;
+    // Buffers are never released, the thread local pointers below keep referencing them.
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+int64_t now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadBuffer& thread_buffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        State &s = state();
+        std::lock_guard<std::mutex> lock(s.registry_mutex);
+        s.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer = s.buffers.back().get();
+        buffer->thread_id = int(s.buffers.size()) - 1;
+    }
+    return *buffer;
+}
+
+} // namespace
+
+bool enabled()
+{
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+void enable(bool enable)
+{
+    if (enable) {
+        clear();
+        state().origin_us.store(now_us(), std::memory_order_relaxed);
+    }
+    state().enabled.store(enable, std::memory_order_relaxed);
+}
+
+void clear()
+{
+    State &s = state();
+    std::lock_guard<std::mutex> lock(s.registry_mutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : s.buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+std::vector<Event> events()
+{
+    std::vector<Event> out;
+    {
+        State &s = state();
+        std::lock_guard<std::mutex> lock(s.registry_mutex);
+        for (std::unique_ptr<ThreadBuffer> &buffer : s.buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            out.insert(out.end(), buffer->events.begin(), buffer->events.end());
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Event &l, const Event &r) { return l.start_us < r.start_us; });
+    return out;
+}
+
+bool export_chrome_trace(const std::string &path)
+{
+    boost::nowide::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (! file.good()) {
+        BOOST_LOG_TRIVIAL(error) << "Trace: failed to open " << path << " for writing";
+        return false;
+    }
+    // Names and categories are string literals from the source code, they don't need JSON escaping.
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const Event &e : events()) {
+        if (! first)
+            file << ",";
+        first = false;
+        file << "\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread_id
+             << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us << ",\"args\":{";
+        if (e.object_id >= 0)
+            file << "\"object\":" << e.object_id << (e.layer_id >= 0 ? "," : "");
+        if (e.layer_id >= 0)
+            file << "\"layer\":" << e.layer_id;
+        file << "}}";
+    }
+    file << "\n]}\n";
+    file.close();
+    if (file.fail()) {
+        BOOST_LOG_TRIVIAL(error) << "Trace: failed to write " << path;
+        return false;
+    }
+    return true;
+}
+
+std::string summary_table()
+{
+    struct Stats
+    {
+        size_t  calls { 0 };
+        int64_t total_us { 0 };
+        int64_t max_us { 0 };
+    };
+    // Keyed by category / name. Compare by content, the same literal may have several addresses across translation units.
+    std::map<std::pair<std::string, std::string>, Stats> stats;
+    for (const Event &e : events()) {
+        Stats &s = stats[{ e.category, e.name }];
+        ++ s.calls;
+        s.total_us += e.duration_us;
+        s.max_us = std::max(s.max_us, e.duration_us);
+    }
+
+    std::vector<std::pair<std::pair<std::string, std::string>, Stats>> sorted(stats.begin(), stats.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &l, const auto &r) { return l.second.total_us > r.second.total_us; });
+
+    std::string out = (boost::format("%-20s %-36s %10s %12s %12s %12s\n") % "category" % "span" % "calls" % "total [ms]" % "mean [ms]" % "max [ms]").str();
+    for (const auto &[key, s] : sorted)
+        out += (boost::format("%-20s %-36s %10d %12.3f %12.3f %12.3f\n") % key.first % key.second % s.calls %
+                (double(s.total_us) * 0.001) % (double(s.total_us) * 0.001 / double(s.calls)) % (double(s.max_us) * 0.001)).str();
+    return out;
+}
+
+Span::Span(const char *name, const char *category, int object_id, int layer_id) :
+    m_name(name), m_category(category), m_object_id(object_id), m_layer_id(layer_id)
+{
+    if (enabled())
+        m_start_us = now_us();
+}
+
+void Span::finish()
+{
+    // The recording may have been switched off while the span was open.
+    if (! enabled())
+        return;
+    const int64_t end_us    = now_us();
+    const int64_t origin_us = state().origin_us.load(std::memory_order_relaxed);
+    ThreadBuffer &buffer    = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({ m_name, m_category, m_object_id, m_layer_id, buffer.thread_id,
+                              std::max<int64_t>(0, m_start_us - origin_us), end_us - m_start_us });
+}
+
+} // namespace Trace
+} // namespace Slic3r
@@ -0,0 +1,68 @@
+#ifndef libslic3r_Trace_hpp_
+#define libslic3r_Trace_hpp_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+namespace Trace {
+
+// Low overhead span recorder for the slicing pipeline.
+// Recording is switched off by default, a disabled Span costs a single relaxed atomic load.
+// When enabled, each thread appends the finished spans into its own buffer, the buffers are only
+// merged when the trace is exported, so the worker threads never contend on a shared lock.
+
+struct Event
+{
+    // Names and categories are expected to be string literals, they are not copied.
+    const char *name;
+    const char *category;
+    // Index of the PrintObject the span belongs to, -1 if not applicable.
+    int         object_id;
+    // Index of the layer the span belongs to, -1 if not applicable.
+    int         layer_id;
+    // Sequential id of the thread which recorded the span.
+    int         thread_id;
+    // Microseconds since the trace was enabled.
+    int64_t     start_us;
+    int64_t     duration_us;
+};
+
+bool enabled();
+// Enabling the recording resets the time origin and drops the spans recorded so far.
+void enable(bool enable);
+void clear();
+
+// Snapshot of all the spans recorded so far, sorted by the start time.
+std::vector<Event> events();
+
+// Write the spans in the Chrome trace event format, loadable by chrome://tracing or Perfetto.
+bool export_chrome_trace(const std::string &path);
+// Aggregate the spans by category and name: number of calls, total, mean and maximum duration.
+std::string summary_table();
+
+// Records the lifetime of the instance as a single span.
+class Span
+{
+public:
+    Span(const char *name, const char *category, int object_id = -1, int layer_id = -1);
+    ~Span() { if (m_start_us >= 0) this->finish(); }
+
+    Span(const Span &) = delete;
+    Span& operator=(const Span &) = delete;
+
+private:
+    void finish();
+
+    const char *m_name;
+    const char *m_category;
+    int         m_object_id;
+    int         m_layer_id;
+    int64_t     m_start_us { -1 };
+};
+
+} // namespace Trace
+} // namespace Slic3r
+
+#endif // libslic3r_Trace_hpp_
@@ -1,6 +1,7 @@
 #include "Exception.hpp"
 #include "TriangleMesh.hpp"
 #include "TriangleMeshSlicer.hpp"
+#include "TriangleMeshRepair.hpp"
 #include "MeshSplitImpl.hpp"
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
@@ -42,17 +43,21 @@ static void update_bounding_box(const indexed_triangle_set &its, TriangleMeshSta
     out.size                = out.max - out.min;    
 }
 
-static void fill_initial_stats(const indexed_triangle_set &its, TriangleMeshStats &out)
+static void fill_initial_stats(const indexed_triangle_set &its, const std::vector<Vec3i32> &face_neighbors, TriangleMeshStats &out)
 {
     out.number_of_facets    = its.indices.size();
     out.volume              = its_volume(its);
     update_bounding_box(its, out);
 
-    const std::vector<Vec3i32> face_neighbors = its_face_neighbors(its);
     out.number_of_parts = its_number_of_patches(its, face_neighbors);
     out.open_edges      = its_num_open_edges(face_neighbors);
 }
 
+static void fill_initial_stats(const indexed_triangle_set &its, TriangleMeshStats &out)
+{
+    fill_initial_stats(its, its_face_neighbors(its), out);
+}
+
 TriangleMesh::TriangleMesh(const std::vector<Vec3f> &vertices, const std::vector<Vec3i32> &faces) : its { faces, vertices }
 {
     fill_initial_stats(this->its, m_stats);
@@ -74,6 +79,13 @@ TriangleMesh::TriangleMesh(indexed_triangle_set &&its, const RepairedMeshErrors&
     fill_initial_stats(this->its, m_stats);
 }
 
+TriangleMesh::TriangleMesh(indexed_triangle_set &&its, const MeshRepairParams &repair_params) : its(std::move(its))
+{
+    std::vector<Vec3i32> face_neighbors;
+    m_stats.repaired_errors = its_repair(this->its, repair_params, &face_neighbors);
+    fill_initial_stats(this->its, face_neighbors, m_stats);
+}
+
 // #define SLIC3R_TRACE_REPAIR
 
 static void trianglemesh_repair_on_import(stl_file &stl)
@@ -16,6 +16,7 @@ namespace Slic3r {
 class TriangleMesh;
 class TriangleMeshSlicer;
 struct Groove;
+struct MeshRepairParams;
 struct RepairedMeshErrors {
     // How many edges were united by merging their end points with some other end points in epsilon neighborhood?
     int           edges_fixed               = 0;
@@ -92,6 +93,8 @@ public:
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i32> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
+    // Repair the mesh with its_repair(), see TriangleMeshRepair.hpp. The errors fixed are reported by stats().repaired_errors.
+    TriangleMesh(indexed_triangle_set &&M, const MeshRepairParams &repair_params);
     void clear() { this->its.clear(); this->m_stats.clear(); }
     bool from_stl(stl_file& stl, bool repair = true);
     bool  ReadSTLFile(const char *input_file, bool repair = true, ImportstlProgressFn stlFn = nullptr, int custom_header_length = 80);
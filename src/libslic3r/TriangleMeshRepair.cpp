@@ -0,0 +1,488 @@
+#include "TriangleMeshRepair.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include <boost/log/trivial.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
+namespace Slic3r {
+
+namespace meshrepair_detail {
+
+// Triangle edge to be matched with the edges of the other faces by sorting.
+// Key identifies the edge independently of its orientation: sorted vertex indices or sorted grid cells of its end points.
+template<typename Key>
+struct SortedEdge {
+    Key      key;
+    // (face_idx * 3 + edge_idx) << 1 | reversed, where reversed is set if the key was sorted from the edge end point to its start point.
+    uint32_t face_edge;
+
+    uint32_t face()     const { return face_edge / 6; }
+    int      edge()     const { return int((face_edge >> 1) % 3); }
+    bool     reversed() const { return (face_edge & 1) != 0; }
+
+    bool operator<(const SortedEdge &rhs) const { return key < rhs.key || (key == rhs.key && face_edge < rhs.face_edge); }
+};
+
+static inline uint32_t encode_face_edge(size_t face_idx, int edge_idx, bool reversed)
+{
+    return (uint32_t(face_idx * 3 + edge_idx) << 1) | uint32_t(reversed);
+}
+
+// Pair the edges [begin, end) sharing the same key, preferring the oppositely oriented edges of distinct faces.
+template<typename Key, typename MatchFn>
+static void match_edge_run(const SortedEdge<Key> *begin, const SortedEdge<Key> *end, bool match_equally_oriented, std::vector<char> &matched, MatchFn &match)
+{
+    if (end - begin == 2) {
+        // The most common case, a manifold edge.
+        if (begin[0].face() != begin[1].face() && (begin[0].reversed() != begin[1].reversed() || match_equally_oriented))
+            match(begin[0], begin[1]);
+    } else if (end - begin > 2) {
+        // Non-manifold edge. Connect the oppositely oriented edges first, then the rest if requested.
+        matched.assign(end - begin, false);
+        for (int pass = 0; pass < (match_equally_oriented ? 2 : 1); ++ pass)
+            for (const SortedEdge<Key> *a = begin; a != end; ++ a)
+                if (! matched[a - begin])
+                    for (const SortedEdge<Key> *b = a + 1; b != end; ++ b)
+                        if (! matched[b - begin] && a->face() != b->face() && (pass == 1 || a->reversed() != b->reversed())) {
+                            match(*a, *b);
+                            matched[a - begin] = matched[b - begin] = true;
+                            break;
+                        }
+    }
+}
+
+// Pair the edges of a sorted range with equal keys.
+template<typename Key, typename MatchFn>
+static void match_sorted_edges(const SortedEdge<Key> *begin, const SortedEdge<Key> *end, bool match_equally_oriented, std::vector<char> &matched, MatchFn &match)
+{
+    for (const SortedEdge<Key> *run = begin; run != end;) {
+        const SortedEdge<Key> *run_end = run + 1;
+        while (run_end != end && run_end->key == run->key)
+            ++ run_end;
+        match_edge_run(run, run_end, match_equally_oriented, matched, match);
+        run = run_end;
+    }
+}
+
+// Sort the edges in parallel, then pair the edges with equal keys.
+// Runs of equal keys are processed in parallel, match(edge_a, edge_b) is called once for each pair from multiple threads.
+template<typename Key, typename MatchFn>
+static void sort_and_match_edges(std::vector<SortedEdge<Key>> &edges, bool match_equally_oriented, MatchFn match)
+{
+    tbb::parallel_sort(edges.begin(), edges.end());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, edges.size(), 4096), [&edges, match_equally_oriented, &match](const tbb::blocked_range<size_t> &range) {
+        // Skip the run of equal keys started by the previous range, extend the last run over the end of this range.
+        size_t begin = range.begin();
+        while (begin > 0 && begin < edges.size() && edges[begin].key == edges[begin - 1].key)
+            ++ begin;
+        size_t end = range.end();
+        while (end > begin && end < edges.size() && edges[end].key == edges[end - 1].key)
+            ++ end;
+        std::vector<char> matched;
+        if (begin < end)
+            match_sorted_edges(edges.data() + begin, edges.data() + end, match_equally_oriented, matched, match);
+    });
+}
+
+static inline bool has_open_edge(const std::vector<Vec3i32> &face_neighbors)
+{
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, face_neighbors.size()), false,
+        [&face_neighbors](const tbb::blocked_range<size_t> &range, bool open) {
+            for (size_t i = range.begin(); ! open && i < range.end(); ++ i)
+                open = (face_neighbors[i].array() < 0).any();
+            return open;
+        }, [](bool a, bool b) { return a || b; });
+}
+
+// Remove faces masked out by the predicate, keeping the order of the remaining faces. Return the number of faces removed.
+template<typename Predicate>
+static int remove_faces_if(indexed_triangle_set &its, Predicate pred)
+{
+    size_t last = 0;
+    for (size_t i = 0; i < its.indices.size(); ++ i)
+        if (! pred(i)) {
+            if (last < i)
+                its.indices[last] = its.indices[i];
+            ++ last;
+        }
+    int removed = int(its.indices.size() - last);
+    its.indices.resize(last);
+    return removed;
+}
+
+// Merge vertices with equal coordinates, the vertex with the lowest index is kept.
+// Unlike its_merge_vertices(), the now unreferenced vertices are not removed.
+static void merge_equal_vertices(indexed_triangle_set &its)
+{
+    std::vector<int> sorted;
+    sorted.reserve(its.vertices.size());
+    for (int i = 0; i < int(its.vertices.size()); ++ i)
+        if (its.vertices[i].allFinite())
+            sorted.emplace_back(i);
+    auto vertex_lower = [&its](int il, int ir) {
+        const stl_vertex &l = its.vertices[il];
+        const stl_vertex &r = its.vertices[ir];
+        // Sort lexicographically by coordinates AND vertex index.
+        return l.x() < r.x() || (l.x() == r.x() && (l.y() < r.y() || (l.y() == r.y() && (l.z() < r.z() || (l.z() == r.z() && il < ir)))));
+    };
+    tbb::parallel_sort(sorted.begin(), sorted.end(), vertex_lower);
+
+    // Map each vertex to the first vertex of its run of equal vertices.
+    std::vector<int> vertex_map(its.vertices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, vertex_map.size()), [&vertex_map](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            vertex_map[i] = int(i);
+    });
+    bool merged = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, sorted.size()), false,
+        [&its, &sorted, &vertex_map](const tbb::blocked_range<size_t> &range, bool merged) {
+            auto equal = [&its, &sorted](size_t i) { return its.vertices[sorted[i - 1]] == its.vertices[sorted[i]]; };
+            // Start of the run of equal vertices the range starts with.
+            size_t start = range.begin();
+            while (start > 0 && equal(start))
+                -- start;
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                if (i > range.begin() && ! equal(i))
+                    start = i;
+                if (start != i) {
+                    vertex_map[sorted[i]] = sorted[start];
+                    merged = true;
+                }
+            }
+            return merged;
+        }, [](bool a, bool b) { return a || b; });
+
+    if (merged)
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &vertex_map](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    its.indices[i](j) = vertex_map[its.indices[i](j)];
+        });
+}
+
+// Shortest edge measured by its largest coordinate difference as admesh does.
+static float shortest_edge(const indexed_triangle_set &its)
+{
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, its.indices.size()), std::numeric_limits<float>::max(),
+        [&its](const tbb::blocked_range<size_t> &range, float shortest) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    shortest = std::min(shortest, (its.vertices[its.indices[i](j)] - its.vertices[its.indices[i]((j + 1) % 3)]).cwiseAbs().maxCoeff());
+            return shortest;
+        }, [](float a, float b) { return std::min(a, b); });
+}
+
+// Connect open edges, which end points fall into the same grid cells, by merging the vertices of the end points.
+// Return the number of edges fixed, counted the admesh way: two per pair of edges connected.
+static int merge_nearby_edges(indexed_triangle_set &its, const std::vector<Vec3i32> &face_neighbors, const Vec3f &origin, float tolerance)
+{
+    using CellKey = std::array<int32_t, 6>;
+    std::vector<SortedEdge<CellKey>> edges;
+    for (size_t face_idx = 0; face_idx < its.indices.size(); ++ face_idx)
+        for (int edge_idx = 0; edge_idx < 3; ++ edge_idx)
+            if (face_neighbors[face_idx](edge_idx) == -1) {
+                const stl_triangle_vertex_indices &face = its.indices[face_idx];
+                Vec3i32 cell1 = ((its.vertices[face(edge_idx)] - origin) / tolerance).cast<int32_t>();
+                Vec3i32 cell2 = ((its.vertices[face((edge_idx + 1) % 3)] - origin) / tolerance).cast<int32_t>();
+                if (cell1 == cell2)
+                    // Both end points fall into the same cell.
+                    continue;
+                bool reversed = std::lexicographical_compare(cell2.data(), cell2.data() + 3, cell1.data(), cell1.data() + 3);
+                if (reversed)
+                    std::swap(cell1, cell2);
+                edges.push_back({ CellKey{ cell1.x(), cell1.y(), cell1.z(), cell2.x(), cell2.y(), cell2.z() }, encode_face_edge(face_idx, edge_idx, reversed) });
+            }
+    if (edges.size() < 2)
+        return 0;
+
+    // Pairs of half edges, each half edge matched at most once.
+    std::vector<std::pair<uint32_t, uint32_t>> pairs(edges.size(), { 0, 0 });
+    std::vector<char>                          has_pair(edges.size(), false);
+    {
+        // Index of the edge in the unsorted array, to store the pairs at unique slots.
+        std::vector<uint32_t> face_edge_to_slot;
+        face_edge_to_slot.reserve(edges.size());
+        for (const SortedEdge<CellKey> &e : edges)
+            face_edge_to_slot.emplace_back(e.face_edge);
+        sort_and_match_edges(edges, true, [&face_edge_to_slot, &pairs, &has_pair](const SortedEdge<CellKey> &a, const SortedEdge<CellKey> &b) {
+            // face_edge_to_slot is sorted, as the edges were collected face by face.
+            size_t slot = std::lower_bound(face_edge_to_slot.begin(), face_edge_to_slot.end(), a.face_edge) - face_edge_to_slot.begin();
+            pairs[slot]    = { a.face_edge, b.face_edge };
+            has_pair[slot] = true;
+        });
+    }
+
+    // Merge the end points lying in the same grid cells by union-find, the lower vertex index becomes the representative.
+    std::vector<int> parent;
+    auto find = [&parent](int v) {
+        while (parent[v] != v)
+            v = parent[v] = parent[parent[v]];
+        return v;
+    };
+    int edges_fixed = 0;
+    for (size_t slot = 0; slot < pairs.size(); ++ slot)
+        if (has_pair[slot]) {
+            if (parent.empty()) {
+                parent.resize(its.vertices.size());
+                for (int i = 0; i < int(parent.size()); ++ i)
+                    parent[i] = i;
+            }
+            // End points of both edges, ordered by the grid cells.
+            auto end_points = [&its](uint32_t face_edge) {
+                const stl_triangle_vertex_indices &face = its.indices[face_edge / 6];
+                int edge_idx = int((face_edge >> 1) % 3);
+                int v1 = face(edge_idx);
+                int v2 = face((edge_idx + 1) % 3);
+                return (face_edge & 1) ? std::make_pair(v2, v1) : std::make_pair(v1, v2);
+            };
+            auto [a1, a2] = end_points(pairs[slot].first);
+            auto [b1, b2] = end_points(pairs[slot].second);
+            for (auto [va, vb] : { std::make_pair(a1, b1), std::make_pair(a2, b2) })
+                if (int ra = find(va), rb = find(vb); ra != rb)
+                    parent[std::max(ra, rb)] = std::min(ra, rb);
+            edges_fixed += 2;
+        }
+
+    if (edges_fixed > 0) {
+        // Representatives have lower indices than the vertices they represent, thus a single forward pass resolves all the roots.
+        for (int i = 0; i < int(parent.size()); ++ i)
+            parent[i] = parent[parent[i]];
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &parent](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    its.indices[i](j) = parent[its.indices[i](j)];
+        });
+    }
+    return edges_fixed;
+}
+
+// Flood fill the patches of connected faces, flip the faces not oriented consistently with the face the patch was reached from.
+// Each patch keeps the orientation of the majority of its faces. Return the number of faces flipped.
+static int fix_normal_directions(indexed_triangle_set &its, std::vector<Vec3i32> &face_neighbors, const std::function<void()> &throw_on_cancel)
+{
+    const size_t num_faces = its.indices.size();
+    std::vector<char> visited(num_faces, false);
+    std::vector<char> flip(num_faces, false);
+    // Faces of the current patch in the order of visiting, doubles as the queue.
+    std::vector<int>  queue;
+    queue.reserve(num_faces);
+    int num_flipped = 0;
+    for (size_t seed = 0; seed < num_faces; ++ seed) {
+        if (visited[seed])
+            continue;
+        queue.clear();
+        queue.emplace_back(int(seed));
+        visited[seed] = true;
+        int patch_flipped = 0;
+        for (size_t head = 0; head < queue.size(); ++ head) {
+            const int                          face_idx = queue[head];
+            const stl_triangle_vertex_indices &face     = its.indices[face_idx];
+            for (int edge_idx = 0; edge_idx < 3; ++ edge_idx)
+                if (int neighbor = face_neighbors[face_idx](edge_idx); neighbor != -1 && ! visited[neighbor]) {
+                    // Is the shared edge equally oriented in both faces?
+                    bool backwards = its_triangle_edge_index(its.indices[neighbor], its_triangle_edge(face, edge_idx)) != -1;
+                    flip[neighbor]    = flip[face_idx] != backwards;
+                    visited[neighbor] = true;
+                    patch_flipped    += flip[neighbor];
+                    queue.emplace_back(neighbor);
+                }
+        }
+        if (2 * patch_flipped > int(queue.size())) {
+            // Most of the faces were oriented the other way than the seed face. Keep their orientation.
+            for (int face_idx : queue)
+                flip[face_idx] = ! flip[face_idx];
+            patch_flipped = int(queue.size()) - patch_flipped;
+        }
+        num_flipped += patch_flipped;
+        if ((seed & 0x0ffff) == 0 && throw_on_cancel)
+            throw_on_cancel();
+    }
+
+    if (num_flipped > 0)
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_faces), [&its, &face_neighbors, &flip](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                if (flip[i]) {
+                    // Same as its_flip_triangles(): edge 0 becomes edge 2 and vice versa.
+                    std::swap(its.indices[i](1), its.indices[i](2));
+                    std::swap(face_neighbors[i](0), face_neighbors[i](2));
+                }
+        });
+    return num_flipped;
+}
+
+// Disconnect the neighbors sharing an equally oriented edge, return the number of such face edges.
+static int disconnect_backwards_edges(const indexed_triangle_set &its, std::vector<Vec3i32> &face_neighbors)
+{
+    // Find the backwards edges first, then disconnect them, as both faces of a backwards edge have to see each other.
+    std::vector<char> backwards(face_neighbors.size(), 0);
+    int num_backwards = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, face_neighbors.size()), 0,
+        [&its, &face_neighbors, &backwards](const tbb::blocked_range<size_t> &range, int num_backwards) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (int j = 0; j < 3; ++ j)
+                    if (int neighbor = face_neighbors[i](j); neighbor != -1 &&
+                        its_triangle_edge_index(its.indices[neighbor], its_triangle_edge(its.indices[i], j)) != -1) {
+                        backwards[i] |= 1 << j;
+                        ++ num_backwards;
+                    }
+            return num_backwards;
+        }, [](int a, int b) { return a + b; });
+    if (num_backwards > 0)
+        for (size_t i = 0; i < face_neighbors.size(); ++ i)
+            for (int j = 0; j < 3; ++ j)
+                if (backwards[i] & (1 << j))
+                    face_neighbors[i](j) = -1;
+    return num_backwards;
+}
+
+static std::vector<Vec3i32> face_neighbors_sorted(const indexed_triangle_set &its, bool connect_backwards_edges)
+{
+    assert(its.indices.size() < size_t(std::numeric_limits<uint32_t>::max() / 6));
+    std::vector<Vec3i32> out(its.indices.size(), Vec3i32(-1, -1, -1));
+    if (its.indices.empty())
+        return out;
+
+    // The edges are bucketed by their lower vertex index with a parallel counting sort,
+    // then each bucket is sorted by the higher vertex index. Most buckets hold just a few edges.
+    auto sorted_edge = [&its](size_t face_idx, int edge_idx) {
+        Vec2i32 edge     = its_triangle_edge(its.indices[face_idx], edge_idx);
+        bool    reversed = edge(0) > edge(1);
+        if (reversed)
+            std::swap(edge(0), edge(1));
+        return std::make_pair(edge(0), SortedEdge<uint32_t>{ uint32_t(edge(1)), encode_face_edge(face_idx, edge_idx, reversed) });
+    };
+    std::vector<std::atomic<uint32_t>> bucket_cursor(its.vertices.size() + 1);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, bucket_cursor.size()), [&bucket_cursor](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            bucket_cursor[i].store(0, std::memory_order_relaxed);
+    });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&sorted_edge, &bucket_cursor](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int edge_idx = 0; edge_idx < 3; ++ edge_idx)
+                bucket_cursor[sorted_edge(face_idx, edge_idx).first + 1].fetch_add(1, std::memory_order_relaxed);
+    });
+    // Prefix sum. bucket_start[i] is the start of the i-th bucket, bucket_cursor[i] is the insertion point into the same bucket.
+    std::vector<uint32_t> bucket_start(bucket_cursor.size());
+    uint32_t              num_edges = 0;
+    for (size_t i = 0; i < bucket_cursor.size(); ++ i) {
+        num_edges += bucket_cursor[i].load(std::memory_order_relaxed);
+        bucket_start[i] = num_edges;
+        bucket_cursor[i].store(num_edges, std::memory_order_relaxed);
+    }
+    std::vector<SortedEdge<uint32_t>> edges(num_edges);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&sorted_edge, &bucket_cursor, &edges](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int edge_idx = 0; edge_idx < 3; ++ edge_idx) {
+                auto [vertex_low, edge] = sorted_edge(face_idx, edge_idx);
+                edges[bucket_cursor[vertex_low].fetch_add(1, std::memory_order_relaxed)] = edge;
+            }
+    });
+
+    // Each edge is matched at most once, thus the threads write to distinct elements of out.
+    auto match = [&out](const SortedEdge<uint32_t> &a, const SortedEdge<uint32_t> &b) {
+        out[a.face()](a.edge()) = int(b.face());
+        out[b.face()](b.edge()) = int(a.face());
+    };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.vertices.size(), 1024), [&bucket_start, &edges, connect_backwards_edges, &match](const tbb::blocked_range<size_t> &range) {
+        std::vector<char> matched;
+        for (size_t vertex_idx = range.begin(); vertex_idx < range.end(); ++ vertex_idx) {
+            SortedEdge<uint32_t> *begin = edges.data() + bucket_start[vertex_idx];
+            SortedEdge<uint32_t> *end   = edges.data() + bucket_start[vertex_idx + 1];
+            // The edges were scattered in a nondeterministic order, sorting by the face index as well makes the result deterministic.
+            std::sort(begin, end);
+            match_sorted_edges<uint32_t>(begin, end, connect_backwards_edges, matched, match);
+        }
+    });
+    return out;
+}
+
+} // namespace meshrepair_detail
+
+std::vector<Vec3i32> its_face_neighbors_sorted(const indexed_triangle_set &its, bool connect_backwards_edges)
+{
+    return meshrepair_detail::face_neighbors_sorted(its, connect_backwards_edges);
+}
+
+RepairedMeshErrors its_repair(indexed_triangle_set &its, const MeshRepairParams &params, std::vector<Vec3i32> *face_neighbors_out)
+{
+    using namespace meshrepair_detail;
+
+    RepairedMeshErrors errors;
+    auto throw_on_cancel = [&params]() { if (params.throw_on_cancel) params.throw_on_cancel(); };
+    auto remove_degenerate_faces = [&its, &errors]() {
+        int removed = its_remove_degenerate_faces(its, false);
+        errors.degenerate_facets += removed;
+        errors.facets_removed    += removed;
+    };
+
+    BOOST_LOG_TRIVIAL(debug) << "its_repair() started, " << its.indices.size() << " facets";
+
+    // Checking exact.
+    merge_equal_vertices(its);
+    remove_degenerate_faces();
+    throw_on_cancel();
+    std::vector<Vec3i32> face_neighbors = face_neighbors_sorted(its, true);
+    throw_on_cancel();
+
+    // Checking nearby.
+    if (params.nearby_iterations > 0 && ! its.indices.empty() && has_open_edge(face_neighbors)) {
+        BoundingBoxf3 bbox      = bounding_box(its);
+        Vec3f         origin    = bbox.min.cast<float>();
+        float         tolerance = shortest_edge(its);
+        float         increment = float(bbox.size().norm()) / 10000.f;
+        for (int i = 0; i < params.nearby_iterations && tolerance > 0.f && has_open_edge(face_neighbors); ++ i) {
+            if (int edges_fixed = merge_nearby_edges(its, face_neighbors, origin, tolerance); edges_fixed > 0) {
+                errors.edges_fixed += edges_fixed;
+                remove_degenerate_faces();
+                face_neighbors = face_neighbors_sorted(its, true);
+            }
+            tolerance += increment;
+            throw_on_cancel();
+        }
+    }
+
+    // Remove unconnected.
+    if (params.remove_unconnected) {
+        int removed = remove_faces_if(its, [&face_neighbors](size_t face_idx) { return (face_neighbors[face_idx].array() == -1).all(); });
+        if (removed > 0) {
+            errors.facets_removed += removed;
+            // Faces without neighbors are not referenced by the other faces, only the face indices shifted.
+            face_neighbors = face_neighbors_sorted(its, true);
+        }
+        throw_on_cancel();
+    }
+
+    // Normal directions.
+    if (params.fix_normal_directions) {
+        errors.facets_reversed += fix_normal_directions(its, face_neighbors, params.throw_on_cancel);
+        throw_on_cancel();
+    }
+
+    // Reverse all facets if the volume is negative.
+    if (params.fix_negative_volume && its_volume(its) < 0.f) {
+        its_flip_triangles(its);
+        for (Vec3i32 &neighbors : face_neighbors)
+            std::swap(neighbors(0), neighbors(2));
+        errors.facets_reversed += int(its.indices.size());
+    }
+
+    // Neighbors sharing an equally oriented edge are not neighbors for its_face_neighbors(), report them as backwards edges.
+    errors.backwards_edges = disconnect_backwards_edges(its, face_neighbors);
+
+    its_compactify_vertices(its);
+    if (face_neighbors_out)
+        *face_neighbors_out = std::move(face_neighbors);
+
+    BOOST_LOG_TRIVIAL(debug) << "its_repair() finished, " << its.indices.size() << " facets, " << errors.edges_fixed << " edges fixed, "
+                             << errors.facets_removed << " facets removed, " << errors.facets_reversed << " facets reversed";
+    return errors;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,43 @@
+#ifndef slic3r_TriangleMeshRepair_hpp_
+#define slic3r_TriangleMeshRepair_hpp_
+
+#include <functional>
+#include <vector>
+
+#include "TriangleMesh.hpp"
+
+namespace Slic3r {
+
+struct MeshRepairParams
+{
+    // Connect open edges, which end points fall into the same grid cell, by merging their vertices,
+    // as admesh stl_check_facets_nearby() does. The grid cell size starts at the shortest edge
+    // and grows by 1/10000 of the bounding box diagonal with each iteration.
+    int                     nearby_iterations       { 2 };
+    // Remove facets with none of their edges connected.
+    bool                    remove_unconnected      { true };
+    // Orient the facets of each connected patch consistently.
+    bool                    fix_normal_directions   { true };
+    // Flip all facets if the volume of the mesh is negative.
+    bool                    fix_negative_volume     { true };
+    // Called between the passes.
+    std::function<void()>   throw_on_cancel;
+};
+
+// Repair of an indexed triangle set, replacing the admesh passes stl_check_facets_exact(), stl_check_facets_nearby(),
+// stl_remove_unconnected_facets(), stl_fix_normal_directions() and stl_calculate_volume() of TriangleMesh::from_stl().
+// Bitwise equal vertices are merged, degenerate facets are removed, then the passes above are applied in the same order.
+// The neighbors are matched by its_face_neighbors_sorted(), unreferenced vertices are removed at the end.
+// If face_neighbors is not null, it receives the face neighbors of the repaired mesh.
+RepairedMeshErrors its_repair(indexed_triangle_set &its, const MeshRepairParams &params = {}, std::vector<Vec3i32> *face_neighbors = nullptr);
+
+// Same result as its_face_neighbors(), but the triangle edges are matched by sorting them in parallel: bucketed by their
+// lower vertex index, then sorted inside the buckets. It scales to meshes with tens of millions of faces.
+// An edge shared by more than two faces is connected to one of them only.
+// If connect_backwards_edges, equally oriented edges of incorrectly oriented neighbor faces are connected as well,
+// if no oppositely oriented edge is left to connect to.
+std::vector<Vec3i32> its_face_neighbors_sorted(const indexed_triangle_set &its, bool connect_backwards_edges = false);
+
+} // namespace Slic3r
+
+#endif /* slic3r_TriangleMeshRepair_hpp_ */
@@ -17,6 +17,7 @@
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
 
 #ifndef NDEBUG
 //    #define EXPENSIVE_DEBUG_CHECKS
@@ -531,6 +532,232 @@ static inline std::vector<IntersectionLines> slice_make_lines(
     return lines;
 }
 
+// Facets active at a slicing plane, stored as a structure of arrays for slice_facets_classify().
+// The edges are stored in the order slice_facet() visits them, starting with the lowest vertex,
+// and the end points of each edge are ordered by their vertex index the same way slice_facet() orders them.
+struct SlicingFacetsSoA
+{
+    std::vector<int>                    idx;
+    std::vector<int>                    idx_vertex_lowest;
+    std::vector<float>                  max_z;
+    std::array<std::vector<float>, 3>   az;
+    std::array<std::vector<float>, 3>   bz;
+    // Outputs of slice_facets_classify().
+    std::array<std::vector<double>, 3>  t;
+    std::vector<uint8_t>                code;
+
+    size_t size() const { return idx.size(); }
+
+    void push_back(const std::vector<stl_vertex> &vertices, const stl_triangle_vertex_indices &face, int face_idx, float min_z, float max_z)
+    {
+        const int lowest = (vertices[face(1)].z() == min_z) ? 1 : ((vertices[face(2)].z() == min_z) ? 2 : 0);
+        this->idx.emplace_back(face_idx);
+        this->idx_vertex_lowest.emplace_back(lowest);
+        this->max_z.emplace_back(max_z);
+        for (int e = 0; e < 3; ++ e) {
+            int a_id = face((lowest + e) % 3);
+            int b_id = face((lowest + e + 1) % 3);
+            if (a_id > b_id)
+                std::swap(a_id, b_id);
+            this->az[e].emplace_back(vertices[a_id].z());
+            this->bz[e].emplace_back(vertices[b_id].z());
+        }
+    }
+
+    // Remove the facets ending below slice_z, keeping the order of the others.
+    void retire(float slice_z)
+    {
+        size_t j = 0;
+        for (size_t i = 0; i < this->size(); ++ i)
+            if (this->max_z[i] >= slice_z) {
+                if (i != j) {
+                    this->idx[j]               = this->idx[i];
+                    this->idx_vertex_lowest[j] = this->idx_vertex_lowest[i];
+                    this->max_z[j]             = this->max_z[i];
+                    for (int e = 0; e < 3; ++ e) {
+                        this->az[e][j] = this->az[e][i];
+                        this->bz[e][j] = this->bz[e][i];
+                    }
+                }
+                ++ j;
+            }
+        this->idx.resize(j);
+        this->idx_vertex_lowest.resize(j);
+        this->max_z.resize(j);
+        for (int e = 0; e < 3; ++ e) {
+            this->az[e].resize(j);
+            this->bz[e].resize(j);
+        }
+    }
+};
+
+enum SlicingFacetCode : uint8_t {
+    // Bits 0 to 2: edge e crosses the plane.
+    SlicingFacetCrossingMask = 0x7,
+    // A vertex lies on the plane or an intersection snapped to a vertex, slice_facet() has to resolve the facet.
+    SlicingFacetDegenerate   = 0x8,
+};
+
+// Classify all the active facets against a plane and calculate the parameters of the edge intersections.
+// The loop has no data dependent branches, thus the compiler vectorizes it for the target instruction set
+// (SSE2 / AVX2 / NEON) and processes 4 to 8 facets at once, with a scalar fallback for the other targets.
+static void slice_facets_classify(const float slice_z, SlicingFacetsSoA &facets)
+{
+    const size_t n = facets.size();
+    facets.code.resize(n);
+    for (int e = 0; e < 3; ++ e)
+        facets.t[e].resize(n);
+    for (int e = 0; e < 3; ++ e) {
+        const float *az   = facets.az[e].data();
+        const float *bz   = facets.bz[e].data();
+        double      *t    = facets.t[e].data();
+        uint8_t     *code = facets.code.data();
+        for (size_t i = 0; i < n; ++ i) {
+            const float  za    = az[i];
+            const float  zb    = bz[i];
+            const bool   cross = (za < slice_z) != (zb < slice_z);
+            // Horizontal edges divide by zero, their t is never used.
+            const double ti    = (double(slice_z) - double(zb)) / (double(za) - double(zb));
+            const bool   degenerate = za == slice_z || zb == slice_z || (cross && (ti <= 0. || ti >= 1.));
+            t[i] = ti;
+            code[i] = uint8_t((e == 0 ? 0 : code[i]) | (uint8_t(cross) << e) | (uint8_t(degenerate) << 3));
+        }
+    }
+}
+
+// slice_facet() for a facet classified by slice_facets_classify() as crossing the plane in a general position.
+static inline IntersectionLine slice_facet_general(
+    const std::vector<stl_vertex>       &vertices,
+    const stl_triangle_vertex_indices   &indices,
+    const Vec3i32                       &edge_ids,
+    const int                            idx_vertex_lowest,
+    const uint8_t                        code,
+    const double                         t[3])
+{
+    IntersectionPoint points[2];
+    size_t            num_points = 0;
+    for (int e = 0; e < 3; ++ e)
+        if (code & (1 << e)) {
+            const int k = (idx_vertex_lowest + e) % 3;
+            int a_id = indices[k];
+            int b_id = indices[(k + 1) % 3];
+            if (a_id > b_id)
+                std::swap(a_id, b_id);
+            const stl_vertex  &a     = vertices[a_id];
+            const stl_vertex  &b     = vertices[b_id];
+            IntersectionPoint &point = points[num_points ++];
+            point.x()     = coord_t(floor(double(b.x()) + (double(a.x()) - double(b.x())) * t[e] + 0.5));
+            point.y()     = coord_t(floor(double(b.y()) + (double(a.y()) - double(b.y())) * t[e] + 0.5));
+            point.edge_id = edge_ids(k);
+        }
+    assert(num_points == 2);
+    IntersectionLine line;
+    line.edge_type = IntersectionLine::FacetEdgeType::General;
+    line.a         = static_cast<const Point&>(points[1]);
+    line.b         = static_cast<const Point&>(points[0]);
+    line.edge_a_id = points[1].edge_id;
+    line.edge_b_id = points[0].edge_id;
+    return line;
+}
+
+// Sweep plane variant of slice_make_lines() for a dense stack of slicing planes, vertices already transformed.
+// slice_make_lines() binary searches the planes for each facet and serializes the insertions into the shared per layer vectors.
+// Here the facets are sorted by their lowest z instead and each worker sweeps a range of consecutive planes upwards,
+// keeping a list of the facets active at the current plane. The worker owns the lines of its planes, thus no locking is needed.
+template<typename ThrowOnCancel>
+static std::vector<IntersectionLines> slice_make_lines_sweep(
+    const std::vector<stl_vertex>                   &vertices,
+    const std::vector<stl_triangle_vertex_indices>  &indices,
+    const std::vector<Vec3i32>                      &face_edge_ids,
+    const std::vector<float>                        &zs,
+    const ThrowOnCancel                              throw_on_cancel_fn)
+{
+    struct SweepFacet {
+        float min_z;
+        float max_z;
+        int   idx;
+    };
+    std::vector<SweepFacet> facets;
+    facets.reserve(indices.size());
+    for (int face_idx = 0; face_idx < int(indices.size()); ++ face_idx) {
+        const stl_triangle_vertex_indices &face = indices[face_idx];
+        const float z0 = vertices[face(0)].z(), z1 = vertices[face(1)].z(), z2 = vertices[face(2)].z();
+        const float min_z = fminf(z0, fminf(z1, z2));
+        const float max_z = fmaxf(z0, fmaxf(z1, z2));
+        // Ignore horizontal triangles, see slice_facet_at_zs(), and triangles outside of the sliced range.
+        if (min_z != max_z && max_z >= zs.front() && min_z <= zs.back())
+            facets.push_back({ min_z, max_z, face_idx });
+    }
+    throw_on_cancel_fn();
+
+    // Facets taller than most of the others would make the sweep start far below the 1st plane of each range,
+    // they are swept separately.
+    float max_height = 0.f;
+    if (! facets.empty()) {
+        std::vector<float> heights;
+        heights.reserve(facets.size());
+        for (const SweepFacet &f : facets)
+            heights.emplace_back(f.max_z - f.min_z);
+        auto it_percentile = heights.begin() + (heights.size() * 99) / 100;
+        std::nth_element(heights.begin(), it_percentile, heights.end());
+        max_height = *it_percentile;
+    }
+    std::vector<SweepFacet> tall_facets;
+    facets.erase(std::remove_if(facets.begin(), facets.end(), [max_height, &tall_facets](const SweepFacet &f) {
+            if (f.max_z - f.min_z <= max_height)
+                return false;
+            tall_facets.emplace_back(f);
+            return true;
+        }), facets.end());
+    auto lower_min_z = [](const SweepFacet &l, const SweepFacet &r) { return l.min_z < r.min_z || (l.min_z == r.min_z && l.idx < r.idx); };
+    tbb::parallel_sort(facets.begin(), facets.end(), lower_min_z);
+    std::sort(tall_facets.begin(), tall_facets.end(), lower_min_z);
+    throw_on_cancel_fn();
+
+    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, zs.size(), 8),
+        [&vertices, &indices, &face_edge_ids, &zs, &facets, &tall_facets, max_height, &lines, throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            throw_on_cancel_fn();
+            // Facets starting below z_first - max_height end below z_first. Twice the margin to stay clear of rounding errors.
+            auto it_next = std::lower_bound(facets.begin(), facets.end(), zs[range.begin()] - 2.f * max_height,
+                [](const SweepFacet &f, float z) { return f.min_z < z; });
+            auto it_next_tall = tall_facets.begin();
+            SlicingFacetsSoA active;
+            for (size_t slice_id = range.begin(); slice_id < range.end(); ++ slice_id) {
+                const float slice_z = zs[slice_id];
+                // Retire the facets ending below this plane, activate the facets starting at or below it.
+                active.retire(slice_z);
+                for (; it_next != facets.end() && it_next->min_z <= slice_z; ++ it_next)
+                    if (it_next->max_z >= slice_z)
+                        active.push_back(vertices, indices[it_next->idx], it_next->idx, it_next->min_z, it_next->max_z);
+                for (; it_next_tall != tall_facets.end() && it_next_tall->min_z <= slice_z; ++ it_next_tall)
+                    if (it_next_tall->max_z >= slice_z)
+                        active.push_back(vertices, indices[it_next_tall->idx], it_next_tall->idx, it_next_tall->min_z, it_next_tall->max_z);
+                slice_facets_classify(slice_z, active);
+                IntersectionLines &layer_lines = lines[slice_id];
+                for (size_t i = 0; i < active.size(); ++ i) {
+                    const uint8_t code     = active.code[i];
+                    const int     face_idx = active.idx[i];
+                    if (code & SlicingFacetDegenerate) {
+                        const stl_triangle_vertex_indices &face = indices[face_idx];
+                        const stl_vertex face_vertices[3] { vertices[face(0)], vertices[face(1)], vertices[face(2)] };
+                        IntersectionLine il;
+                        if (slice_facet(slice_z, face_vertices, face, face_edge_ids[face_idx], active.idx_vertex_lowest[i], false, il) == FacetSliceType::Slicing) {
+                            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                            layer_lines.emplace_back(il);
+                        }
+                    } else if (code & SlicingFacetCrossingMask) {
+                        const double t[3] { active.t[0][i], active.t[1][i], active.t[2][i] };
+                        layer_lines.emplace_back(slice_facet_general(vertices, indices[face_idx], face_edge_ids[face_idx], active.idx_vertex_lowest[i], code, t));
+                    }
+                }
+            }
+        }
+    );
+    return lines;
+}
+
 template<typename TransformVertex, typename FaceFilter>
 static inline IntersectionLines slice_make_lines(
     const std::vector<stl_vertex>                   &mesh_vertices,
@@ -1891,9 +2118,7 @@ std::vector<Polygons> slice_mesh(
             }
         } else {
             // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-            lines = slice_make_lines(
-                transform_mesh_vertices_for_slicing(mesh, params.trafo), 
-                [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
+            lines = slice_make_lines_sweep(transform_mesh_vertices_for_slicing(mesh, params.trafo), mesh.indices, face_edge_ids, zs, throw_on_cancel);
         }
     }
 
@@ -22,6 +22,7 @@
 #include "libslic3r/Utils.hpp"
 #include "PostProcessor.hpp"
 #include "libslic3r/Format/SL1.hpp"
+#include "libslic3r/GCode/BinaryGCode.hpp"
 #include "libslic3r/Thread.hpp"
 #include "libslic3r/libslic3r.h"
 
@@ -824,6 +825,24 @@ void BackgroundSlicingProcess::finalize_gcode()
     // so neither touches the original file the G-code viewer keeps memory-mapped.
     bool post_processed = run_post_process_scripts(output_path, true, "File", export_path, m_fff_print->full_print_config());
 
+    if (m_fff_print->config().binary_gcode.value) {
+        // The G-code viewer keeps referencing the text G-code, only the exported copy is binary.
+        m_print->set_status(97, _u8L("Exporting binary G-code"));
+        std::string binary_path = m_temp_output_path + ".bgcode";
+        try {
+            BinaryGCode::convert_ascii_to_binary(output_path, binary_path, BinaryGCode::metadata_from_config(m_fff_print->full_print_config()));
+        } catch (const std::exception &ex) {
+            if (post_processed)
+                boost::filesystem::remove(output_path);
+            throw Slic3r::ExportError(ex.what());
+        }
+        if (post_processed)
+            boost::filesystem::remove(output_path);
+        output_path    = binary_path;
+        // Remove the binary temp file once copied.
+        post_processed = true;
+    }
+
     auto remove_post_processed_temp_file = [post_processed, &output_path]() {
         if (post_processed)
             try {
@@ -967,6 +986,13 @@ void BackgroundSlicingProcess::prepare_upload()
                 if (post_process)
                     m_upload_job.upload_data.upload_path = output_name_str;
             }
+            if (m_fff_print->config().binary_gcode.value) {
+                std::string source_path_str = source_path.string();
+                std::string binary_path     = source_path_str + ".bgcode";
+                BinaryGCode::convert_ascii_to_binary(source_path_str, binary_path, BinaryGCode::metadata_from_config(m_fff_print->full_print_config()));
+                boost::filesystem::remove(source_path);
+                boost::filesystem::rename(binary_path, source_path);
+            }
         }
     } else {
         m_upload_job.upload_data.upload_path = m_sla_print->print_statistics().finalize_output_path(
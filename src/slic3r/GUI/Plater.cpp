@@ -14690,7 +14690,7 @@ void Plater::load_gcode(const wxString& filename)
 {
     BOOST_LOG_TRIVIAL(trace) << __FUNCTION__ << __LINE__ << " entry and filename: " << filename;
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__;
-    if (! is_gcode_file(into_u8(filename))
+    if ((! is_gcode_file(into_u8(filename)) && ! boost::iends_with(into_u8(filename), ".bgcode"))
         || (m_last_loaded_gcode == filename && m_only_gcode)
         )
         return;
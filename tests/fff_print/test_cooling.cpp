@@ -2,6 +2,8 @@
 
 #include "test_helpers.hpp"
 
+#include "libslic3r/GCode/CoolingBuffer.hpp"
+
 #include <string>
 
 using namespace Slic3r;
@@ -25,3 +27,59 @@ TEST_CASE("Cooling consumes its internal speed markers", "[Cooling]")
     const std::string gcode = slice({ cube(20) }, { { "layer_height", 0.2 } });
     CHECK(gcode.find(";_EXTRUDE_SET_SPEED") == std::string::npos);
 }
+
+// The slow down is calculated for the layers in parallel, while the position, the feedrate and the active extruder
+// are carried over from layer to layer by a backward scan of each layer.
+TEST_CASE("Cooling carries the end state of a layer over to the next one", "[Cooling]")
+{
+    using Catch::Matchers::WithinAbs;
+
+    // X, Y, Z, E, F (mm/sec), I, J
+    std::vector<float> pos { 1.f, 2.f, 0.2f, 0.f, 50.f, 7.f, 8.f };
+    unsigned int       extruder = 0;
+
+    SECTION("Last axis words and tool change") {
+        const std::string gcode =
+            "T1\n"
+            "G1 Z0.4 F600\n"
+            "G1 X10 Y20 E1.5 F1800 ;_EXTRUDE_SET_SPEED\n"
+            "M106 S255\n"
+            "G1 X11 E2.5\n"
+            "; T0 is not a tool change\n"
+            "G1 Y21";
+        CoolingBuffer::advance_end_state(gcode, "T", 2, pos, extruder);
+        CHECK_THAT(pos[0], WithinAbs(11., 1e-5));
+        CHECK_THAT(pos[1], WithinAbs(21., 1e-5));
+        CHECK_THAT(pos[2], WithinAbs(0.4, 1e-5));
+        CHECK_THAT(pos[3], WithinAbs(2.5, 1e-5));
+        CHECK_THAT(pos[4], WithinAbs(30., 1e-5));
+        // Not written by the layer, carried over.
+        CHECK_THAT(pos[5], WithinAbs(7., 1e-5));
+        CHECK_THAT(pos[6], WithinAbs(8., 1e-5));
+        CHECK(extruder == 1);
+    }
+
+    SECTION("Arc center is relative to the preceding position") {
+        const std::string gcode =
+            "G1 X10 Y20 Z0.4 E1 F600\n"
+            "G2 X12 Y20 I1 J0 E2\n";
+        CoolingBuffer::advance_end_state(gcode, "T", 2, pos, extruder);
+        CHECK_THAT(pos[0], WithinAbs(12., 1e-5));
+        CHECK_THAT(pos[3], WithinAbs(2., 1e-5));
+        CHECK_THAT(pos[4], WithinAbs(10., 1e-5));
+        CHECK_THAT(pos[5], WithinAbs(11., 1e-5));
+        CHECK_THAT(pos[6], WithinAbs(20., 1e-5));
+        CHECK(extruder == 0);
+    }
+
+    SECTION("Missing axes keep their values") {
+        CoolingBuffer::advance_end_state("G1 E0.5\nT5\n", "T", 2, pos, extruder);
+        CHECK_THAT(pos[0], WithinAbs(1., 1e-5));
+        CHECK_THAT(pos[1], WithinAbs(2., 1e-5));
+        CHECK_THAT(pos[2], WithinAbs(0.2, 1e-5));
+        CHECK_THAT(pos[3], WithinAbs(0.5, 1e-5));
+        CHECK_THAT(pos[4], WithinAbs(50., 1e-5));
+        // T5 is out of range of the extruders.
+        CHECK(extruder == 0);
+    }
+}
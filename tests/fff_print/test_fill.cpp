@@ -4,12 +4,17 @@
 #include <cmath>
 #include <map>
 #include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/FillGyroid.hpp"
+#include "libslic3r/Fill/FillRectilinear.hpp"
+#include "libslic3r/Fill/FillTpmsD.hpp"
+#include "libslic3r/Fill/Lightning/Generator.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Layer.hpp"
@@ -698,3 +703,157 @@ TEST_CASE("Solid infill direction offsets every layer when no template is set",
         CHECK(delta == 30);
     }
 }
+
+TEST_CASE("Wave patterns reused by the islands of a surface do not change the infill", "[Fill]")
+{
+    const ExPolygon small_square(Polygon({ Point::new_scale(0, 0), Point::new_scale(10, 0), Point::new_scale(10, 10), Point::new_scale(0, 10) }));
+    const ExPolygon large_square(Polygon({ Point::new_scale(30, 5), Point::new_scale(60, 5), Point::new_scale(60, 35), Point::new_scale(30, 35) }));
+    FillParams fill_params;
+    fill_params.density     = 0.2f;
+    fill_params.dont_adjust = true;
+    for (const char *pattern : { "gyroid", "tpmsd", "tpmsfk" }) {
+        for (double z : { 0.2, 1.4, 7.6 }) {
+            auto make_filler = [z](const char *pattern) {
+                std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type(pattern));
+                filler->spacing = 0.45;
+                filler->angle   = float(PI / 4.);
+                filler->z       = z;
+                return filler;
+            };
+            // The first filler fills another island at the same z first.
+            std::unique_ptr<Slic3r::Fill> reused = make_filler(pattern);
+            Surface small_surface(stInternal, small_square);
+            reused->fill_surface(&small_surface, fill_params);
+            Surface large_surface(stInternal, large_square);
+            const Polylines paths_reused = reused->fill_surface(&large_surface, fill_params);
+            std::unique_ptr<Slic3r::Fill> fresh = make_filler(pattern);
+            const Polylines paths_fresh = fresh->fill_surface(&large_surface, fill_params);
+            INFO("pattern " << pattern << " z " << z);
+            REQUIRE(! paths_fresh.empty());
+            REQUIRE(paths_reused == paths_fresh);
+            // The islands differ in size and thus in the start of their patterns, the wave generated for the first island
+            // is reused for the second one. TPMS-FK samples its field instead of tiling a wave.
+            if (const auto *gyroid = dynamic_cast<const FillGyroid*>(reused.get()))
+                CHECK(gyroid->wave_periods().num_generated == 1);
+            else if (const auto *tpmsd = dynamic_cast<const FillTpmsD*>(reused.get()))
+                CHECK(tpmsd->wave_period().num_generated == 1);
+        }
+    }
+}
+
+TEST_CASE("Rectilinear scan conversion matches the per line evaluation", "[Fill]")
+{
+    // Reference: the vertical lines range and the intersections evaluated independently for each vertical line,
+    // as slice_region_by_vertical_lines() did before the contour segments were swept across the vertical lines.
+    auto vlines_range_loops = [](coord_t x0, coord_t line_spacing, size_t n_vlines, coord_t l, coord_t r) {
+        int il = (l - x0) / line_spacing;
+        while (il * line_spacing + x0 < l)
+            ++ il;
+        il = std::max(int(0), il);
+        int ir = (r - x0 + line_spacing) / line_spacing;
+        while (ir * line_spacing + x0 > r)
+            -- ir;
+        ir = std::min(int(n_vlines) - 1, ir);
+        return std::make_pair(il, ir);
+    };
+    auto pos_p_per_line = [](const Point &p1, const Point &p2, coord_t this_x) {
+        int64_t pos_p, pos_q;
+        if (p2.x() > p1.x()) {
+            pos_p = this_x - p1.x();
+            pos_q = p2.x() - p1.x();
+        } else {
+            pos_p = p1.x() - this_x;
+            pos_q = p1.x() - p2.x();
+        }
+        pos_p *= int64_t(p2.y() - p1.y());
+        pos_p += p1.y() * pos_q;
+        return std::make_pair(pos_p, pos_q);
+    };
+
+    std::mt19937 rng(3141);
+    // Coordinates of up to 500mm, the vertical lines cover a part of the segments' range only to exercise the clamping.
+    std::uniform_int_distribution<coord_t> coord(- scaled<coord_t>(250.), scaled<coord_t>(250.));
+    std::uniform_int_distribution<coord_t> spacing(1, scaled<coord_t>(5.));
+    std::uniform_int_distribution<int>     num_lines(1, 200);
+    std::uniform_int_distribution<int>     snap(0, 3);
+    for (size_t iter = 0; iter < 100000; ++ iter) {
+        const coord_t line_spacing = spacing(rng);
+        const size_t  n_vlines     = size_t(num_lines(rng));
+        const coord_t x0           = coord(rng);
+        Point p1(coord(rng), coord(rng));
+        Point p2(coord(rng), coord(rng));
+        // Short segments and end points snapped to a vertical line.
+        if (snap(rng) == 0)
+            p2 = p1 + Point(coord(rng) / 1000, coord(rng) / 1000);
+        if (snap(rng) == 0)
+            p1.x() = x0 + (p1.x() - x0) / line_spacing * line_spacing;
+        if (snap(rng) == 0)
+            p2.x() = x0 + (p2.x() - x0) / line_spacing * line_spacing;
+        const coord_t l = std::min(p1.x(), p2.x());
+        const coord_t r = std::max(p1.x(), p2.x());
+        auto [il, ir] = FillRectilinearScan::vlines_range(x0, line_spacing, n_vlines, l, r);
+        auto [il_ref, ir_ref] = vlines_range_loops(x0, line_spacing, n_vlines, l, r);
+        INFO("x0 " << x0 << ", line_spacing " << line_spacing << ", n_vlines " << n_vlines << ", p1 " << p1.x() << "," << p1.y() << ", p2 " << p2.x() << "," << p2.y());
+        REQUIRE((il <= ir) == (il_ref <= ir_ref));
+        if (il > ir)
+            continue;
+        REQUIRE(il == il_ref);
+        REQUIRE(ir == ir_ref);
+        // Intersections at a general position, the end points are evaluated separately by slice_region_by_vertical_lines().
+        FillRectilinearScan::SegmentVLinesStepper stepper(p1, p2, line_spacing);
+        for (int i = il; i <= ir; ++ i) {
+            const coord_t this_x = x0 + i * line_spacing;
+            if (this_x == p1.x() || this_x == p2.x())
+                continue;
+            auto [pos_p_ref, pos_q_ref] = pos_p_per_line(p1, p2, this_x);
+            REQUIRE(stepper.next_pos_p(this_x) == pos_p_ref);
+            REQUIRE(stepper.pos_q() == pos_q_ref);
+        }
+    }
+}
+
+TEST_CASE("Lightning trees support the top surface of a cube", "[Fill]")
+{
+    Print print;
+    Slic3r::Test::init_and_process_print({Slic3r::Test::cube(20)}, print,
+                                        {{"sparse_infill_pattern", "lightning"},
+                                         {"sparse_infill_density", "15%"},
+                                         {"top_shell_layers", 3},
+                                         {"layer_height", 0.2}});
+    const PrintObject &object = *print.objects().front();
+    const FillLightning::Generator generator(object, []() {});
+
+    // The topmost layer with sparse infill is below the top solid shells.
+    int top_infill_layer = -1;
+    for (int layer_id = int(object.layer_count()) - 1; layer_id >= 0 && top_infill_layer == -1; -- layer_id)
+        for (const LayerRegion *layerm : object.get_layer(layer_id)->regions())
+            if (layerm->fill_surfaces.has(stInternal))
+                top_infill_layer = layer_id;
+    REQUIRE(top_infill_layer > 0);
+    REQUIRE(! generator.getTreesForLayer(size_t(top_infill_layer)).tree_roots.empty());
+
+    for (size_t layer_id = 0; layer_id < object.layer_count(); ++ layer_id) {
+        INFO("Layer " << layer_id);
+        const FillLightning::Layer    &lightning_layer = generator.getTreesForLayer(layer_id);
+        const FillLightning::NodePool &nodes           = lightning_layer.nodes;
+        const BoundingBox              bbox            = get_extents(object.get_layer(int(layer_id))->lslices).inflated(scaled<coord_t>(0.5));
+        // Each node belongs to a single tree, its parent lists it among its children.
+        std::vector<int> tree_of_node(nodes.size(), -1);
+        for (size_t tree_id = 0; tree_id < lightning_layer.tree_roots.size(); ++ tree_id) {
+            const FillLightning::NodeIdx root = lightning_layer.tree_roots[tree_id];
+            REQUIRE(nodes[root].isRoot());
+            nodes.visitNodes(root, [&nodes, &tree_of_node, &bbox, tree_id](FillLightning::NodeIdx idx) {
+                REQUIRE(tree_of_node[idx] == -1);
+                tree_of_node[idx] = int(tree_id);
+                REQUIRE(bbox.contains(nodes[idx].p));
+                uint32_t num_children = 0;
+                for (FillLightning::NodeIdx child = nodes[idx].first_child; child != FillLightning::invalid_node_idx; child = nodes[child].next_sibling, ++ num_children)
+                    REQUIRE(nodes[child].parent == idx);
+                REQUIRE(nodes[idx].num_children == num_children);
+            });
+        }
+    }
+
+    // The trees are printed as the sparse infill.
+    CHECK(dominant_fill_angle(*object.get_layer(top_infill_layer), sparse_role) != -1);
+}
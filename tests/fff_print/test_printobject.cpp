@@ -111,6 +111,70 @@ SCENARIO("Perimeter generation", "[PrintObject]") {
     }
 }
 
+TEST_CASE("Layers with equal perimeter inputs are detected", "[PrintObject]")
+{
+    Slic3r::Print print;
+    Slic3r::Test::init_and_process_print({cube(20)}, print, { { "wall_loops", 3 } });
+    const PrintObject &object = *print.objects().front();
+    const Layer       &source = *object.get_layer(4);
+    for (size_t layer_idx = 6; layer_idx + 6 < object.layer_count(); layer_idx += 2) {
+        const Layer &layer = *object.get_layer(int(layer_idx));
+        REQUIRE(layer.perimeters_inputs_hash() == source.perimeters_inputs_hash());
+        REQUIRE(layer.perimeters_inputs_equal(source));
+    }
+    // The top and bottom shells see different neighbors.
+    REQUIRE(! object.get_layer(0)->perimeters_inputs_equal(source));
+    REQUIRE(! object.layers().back()->perimeters_inputs_equal(*object.get_layer(int(object.layer_count()) - 3)));
+}
+
+TEST_CASE("Copied perimeters match the perimeters generated for each layer", "[PrintObject]")
+{
+    // Outputs of Layer::make_perimeters() of all regions of a layer.
+    struct LayerExtrusions {
+        Polylines  perimeters, thin_fills;
+        ExPolygons fill_expolygons;
+        double     perimeters_volume { 0. };
+    };
+    auto collect = [](const PrintObject &object) {
+        std::vector<LayerExtrusions> out;
+        for (const Layer *layer : object.layers()) {
+            LayerExtrusions &dst = out.emplace_back();
+            for (const LayerRegion *layerm : layer->regions()) {
+                layerm->perimeters.collect_polylines(dst.perimeters);
+                layerm->thin_fills.collect_polylines(dst.thin_fills);
+                append(dst.fill_expolygons, layerm->fill_expolygons);
+                dst.perimeters_volume += layerm->perimeters.total_volume();
+            }
+        }
+        return out;
+    };
+
+    Slic3r::Print print;
+    Slic3r::Test::init_and_process_print({TestMesh::cube_with_hole}, print, { { "wall_loops", 3 } });
+    PrintObject &object = *print.objects_mutable().front();
+    const std::vector<LayerExtrusions> memoized = collect(object);
+
+    // Regenerate the perimeters of every layer from the slices they were generated from,
+    // the same way PrintObject::make_perimeters() and PrintObject::simplify_extrusion_path() do.
+    for (Layer *layer : object.layers())
+        layer->restore_untyped_slices();
+    for (Layer *layer : object.layers()) {
+        layer->make_perimeters();
+        layer->simplify_wall_extrusion_path();
+    }
+    const std::vector<LayerExtrusions> reference = collect(object);
+
+    REQUIRE(memoized.size() == reference.size());
+    for (size_t layer_idx = 0; layer_idx < memoized.size(); ++ layer_idx) {
+        INFO("Layer " << layer_idx);
+        REQUIRE(! reference[layer_idx].perimeters.empty());
+        CHECK(memoized[layer_idx].perimeters == reference[layer_idx].perimeters);
+        CHECK(memoized[layer_idx].thin_fills == reference[layer_idx].thin_fills);
+        CHECK(memoized[layer_idx].fill_expolygons == reference[layer_idx].fill_expolygons);
+        CHECK(memoized[layer_idx].perimeters_volume == Catch::Approx(reference[layer_idx].perimeters_volume));
+    }
+}
+
 TEST_CASE("Initial layer height is honored", "[PrintObject]")
 {
     const std::string gcode = Slic3r::Test::slice({cube(20)}, {
@@ -0,0 +1,229 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/ExtrusionEntityCollection.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include "test_helpers.hpp"
+#include "test_utils.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace Slic3r;
+using namespace Slic3r::Test;
+
+namespace {
+
+// Data of a layer or of a support layer compared after the slice cache was loaded back.
+struct CachedLayer
+{
+    coordf_t                    print_z { 0. };
+    coordf_t                    slice_z { 0. };
+    coordf_t                    height { 0. };
+    ExPolygons                  lslices;
+    std::vector<SurfaceType>    surface_types;
+    ExPolygons                  surfaces;
+    Polylines                   extrusions;
+    std::vector<ExtrusionRole>  extrusion_roles;
+    std::vector<double>         extrusion_mm3_per_mm;
+};
+
+void collect_extrusions(const ExtrusionEntityCollection &collection, CachedLayer &out)
+{
+    for (const ExtrusionEntity *entity : collection.flatten().entities) {
+        entity->collect_polylines(out.extrusions);
+        out.extrusion_roles.emplace_back(entity->role());
+        out.extrusion_mm3_per_mm.emplace_back(entity->min_mm3_per_mm());
+    }
+}
+
+CachedLayer cached_layer(const Layer &layer)
+{
+    CachedLayer out;
+    out.print_z = layer.print_z;
+    out.slice_z = layer.slice_z;
+    out.height  = layer.height;
+    out.lslices = layer.lslices;
+    for (const LayerRegion *layerm : layer.regions()) {
+        for (const Surface &surface : layerm->slices.surfaces) {
+            out.surface_types.emplace_back(surface.surface_type);
+            out.surfaces.emplace_back(surface.expolygon);
+        }
+        collect_extrusions(layerm->perimeters, out);
+        collect_extrusions(layerm->thin_fills, out);
+        collect_extrusions(layerm->fills, out);
+    }
+    return out;
+}
+
+struct CachedObject
+{
+    std::vector<CachedLayer> layers;
+    std::vector<CachedLayer> support_layers;
+};
+
+CachedObject cached_object(const PrintObject &object)
+{
+    CachedObject out;
+    for (const Layer *layer : object.layers())
+        out.layers.emplace_back(cached_layer(*layer));
+    for (const SupportLayer *support_layer : object.support_layers()) {
+        CachedLayer &layer = out.support_layers.emplace_back(cached_layer(*support_layer));
+        collect_extrusions(support_layer->support_fills, layer);
+    }
+    return out;
+}
+
+void check_same_layers(const std::vector<CachedLayer> &loaded, const std::vector<CachedLayer> &expected)
+{
+    REQUIRE(loaded.size() == expected.size());
+    for (size_t i = 0; i < loaded.size(); ++ i) {
+        INFO("Layer " << i);
+        CHECK(loaded[i].print_z == expected[i].print_z);
+        CHECK(loaded[i].slice_z == expected[i].slice_z);
+        CHECK(loaded[i].height == expected[i].height);
+        CHECK(loaded[i].lslices == expected[i].lslices);
+        CHECK(loaded[i].surface_types == expected[i].surface_types);
+        CHECK(loaded[i].surfaces == expected[i].surfaces);
+        CHECK(loaded[i].extrusions == expected[i].extrusions);
+        CHECK(loaded[i].extrusion_roles == expected[i].extrusion_roles);
+        CHECK(loaded[i].extrusion_mm3_per_mm == expected[i].extrusion_mm3_per_mm);
+    }
+}
+
+void check_same_object(const CachedObject &loaded, const CachedObject &expected)
+{
+    check_same_layers(loaded.layers, expected.layers);
+    check_same_layers(loaded.support_layers, expected.support_layers);
+}
+
+// The overhang gets support layers, so that both kinds of layer records are written.
+void process_print_with_support(Print &print)
+{
+    init_and_process_print({ TestMesh::overhang }, print, {
+        { "enable_support",     1 },
+        { "support_type",       "normal(auto)" },
+        { "layer_height",       0.3 },
+    });
+}
+
+// The slice cache of the only object of the print.
+std::string slice_cache_file(const ScopedTemporaryDir &dir)
+{
+    std::vector<boost::filesystem::path> files { boost::filesystem::directory_iterator(dir.path()), boost::filesystem::directory_iterator() };
+    REQUIRE(files.size() == 1);
+    return files.front().string();
+}
+
+std::string read_file(const std::string &file_name)
+{
+    std::ifstream in(file_name, std::ios::binary);
+    return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+void write_file(const std::string &file_name, const std::string &data)
+{
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), std::streamsize(data.size()));
+}
+
+// Layout of the binary cache: a 32 bytes header with the hash at offset 16, the number of records,
+// the end offsets of the records relative to the first record and the records themselves.
+constexpr size_t slice_cache_hash_offset         = 16;
+constexpr size_t slice_cache_record_table_offset = 32;
+
+} // namespace
+
+TEST_CASE("Slice cache restores the layers it was exported from", "[SliceCache]") {
+    const bool binary = GENERATE(true, false);
+    INFO((binary ? "binary cache" : "text cache"));
+
+    Print print;
+    process_print_with_support(print);
+    const CachedObject expected = cached_object(*print.objects().front());
+    REQUIRE(! expected.layers.empty());
+    REQUIRE(! expected.support_layers.empty());
+
+    ScopedTemporaryDir dir("orca-slice-cache");
+    REQUIRE(print.export_cached_data(dir.string(), ! binary) == 0);
+    REQUIRE(boost::algorithm::ends_with(slice_cache_file(dir), binary ? ".bin" : ".json"));
+
+    // Loading clears the layers of the print before they are recreated from the cache.
+    REQUIRE(print.load_cached_data(dir.string()) == 0);
+    check_same_object(cached_object(*print.objects().front()), expected);
+}
+
+TEST_CASE("Truncated or corrupted slice cache is rejected", "[SliceCache]") {
+    Print print;
+    process_print_with_support(print);
+    ScopedTemporaryDir dir("orca-slice-cache");
+    REQUIRE(print.export_cached_data(dir.string(), false) == 0);
+    const std::string file_name = slice_cache_file(dir);
+    std::string       data      = read_file(file_name);
+
+    SECTION("Truncated file") {
+        data.pop_back();
+    }
+    SECTION("Corrupted layer record") {
+        // Claim more coordinates than the last record holds.
+        uint64_t num_records = 0;
+        std::memcpy(&num_records, data.data() + slice_cache_record_table_offset, sizeof(num_records));
+        REQUIRE(num_records > 1);
+        uint64_t last_record_begin = 0;
+        std::memcpy(&last_record_begin, data.data() + slice_cache_record_table_offset + sizeof(uint64_t) * (num_records - 1), sizeof(last_record_begin));
+        const size_t records_offset = slice_cache_record_table_offset + sizeof(uint64_t) * (num_records + 1);
+        const uint64_t num_coords   = std::numeric_limits<uint32_t>::max();
+        std::memcpy(data.data() + records_offset + last_record_begin, &num_coords, sizeof(num_coords));
+    }
+    write_file(file_name, data);
+    CHECK(print.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_LOAD_FAILED);
+}
+
+TEST_CASE("Slice cache exported for a different object is rejected", "[SliceCache]") {
+    Print print;
+    process_print_with_support(print);
+    ScopedTemporaryDir dir("orca-slice-cache");
+
+    SECTION("Binary cache") {
+        REQUIRE(print.export_cached_data(dir.string(), false) == 0);
+        const std::string file_name = slice_cache_file(dir);
+        std::string       data      = read_file(file_name);
+        uint64_t          hash      = 0;
+        std::memcpy(&hash, data.data() + slice_cache_hash_offset, sizeof(hash));
+        ++ hash;
+        std::memcpy(data.data() + slice_cache_hash_offset, &hash, sizeof(hash));
+        write_file(file_name, data);
+    }
+    SECTION("Text cache") {
+        REQUIRE(print.export_cached_data(dir.string(), true) == 0);
+        const std::string file_name = slice_cache_file(dir);
+        nlohmann::json    root_json = nlohmann::json::parse(read_file(file_name));
+        root_json["slice_cache_hash"] = root_json.at("slice_cache_hash").get<uint64_t>() + 1;
+        write_file(file_name, root_json.dump());
+    }
+    CHECK(print.load_cached_data(dir.string()) == CLI_IMPORT_CACHE_DATA_CAN_NOT_USE);
+}
+
+TEST_CASE("Text slice cache written before the hash was stored still loads", "[SliceCache]") {
+    Print print;
+    process_print_with_support(print);
+    const CachedObject expected = cached_object(*print.objects().front());
+
+    ScopedTemporaryDir dir("orca-slice-cache");
+    REQUIRE(print.export_cached_data(dir.string(), true) == 0);
+    const std::string file_name = slice_cache_file(dir);
+    nlohmann::json    root_json = nlohmann::json::parse(read_file(file_name));
+    REQUIRE(root_json.erase("slice_cache_hash") == 1);
+    write_file(file_name, root_json.dump());
+
+    REQUIRE(print.load_cached_data(dir.string()) == 0);
+    check_same_object(cached_object(*print.objects().front()), expected);
+}
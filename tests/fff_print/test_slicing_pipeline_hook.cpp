@@ -27,6 +27,7 @@ TEST_CASE("slicing pipeline hook setter is a no-op-safe injection", "[slicing_pi
 
 #include <vector>
 #include <algorithm>
+#include <iterator>
 using namespace Slic3r::Test;
 
 TEST_CASE("SlicingPipeline hook fires once per step per object in order", "[slicing_pipeline]") {
@@ -62,8 +63,36 @@ TEST_CASE("SlicingPipeline hook fires once per step per object in order", "[slic
     CHECK(idx(S::posPrepareInfill) < idx(S::posInfill));     // ...and before the fills are built
 }
 
+// With several objects the PrepareInfill and Infill hooks stay paired per object: an object's fills are built
+// right after its PrepareInfill hook ran, before the PrepareInfill hook of the next object fires.
+TEST_CASE("SlicingPipeline PrepareInfill and Infill hooks fire paired per object", "[slicing_pipeline]") {
+    struct Call { const Slic3r::PrintObject* obj; Slic3r::SlicingPipelineStepPlugin step; };
+    std::vector<Call> calls;
+    Slic3r::Print::set_slicing_pipeline_hook_fn(
+        [&](Slic3r::Print&, const Slic3r::PrintObject* o, Slic3r::SlicingPipelineStepPlugin s){ calls.push_back({o, s}); });
+
+    Slic3r::Print print; Slic3r::Model model;
+    Slic3r::DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+    config.set_key_value("slicing_pipeline_plugin", new Slic3r::ConfigOptionStrings({"probe"})); // activate
+    init_print({TestMesh::overhang, TestMesh::L, TestMesh::cube_with_hole}, print, model, config);
+    print.process();
+    Slic3r::Print::set_slicing_pipeline_hook_fn(nullptr);
+
+    using S = Slic3r::SlicingPipelineStepPlugin;
+    std::vector<Call> infill_calls;
+    std::copy_if(calls.begin(), calls.end(), std::back_inserter(infill_calls),
+        [](const Call& c){ return c.step == S::posPrepareInfill || c.step == S::posInfill; });
+    REQUIRE(infill_calls.size() == 2 * print.objects().size());
+    for (size_t i = 0; i < infill_calls.size(); i += 2) {
+        CHECK(infill_calls[i].step == S::posPrepareInfill);
+        CHECK(infill_calls[i + 1].step == S::posInfill);
+        CHECK(infill_calls[i].obj == infill_calls[i + 1].obj);
+    }
+}
+
 #include <sstream>
 #include <cmath>
+#include <atomic>
 
 // Exported G-code carries a few nondeterministic comment lines unrelated to toolpaths: a
 // wall-clock timestamp ("; generated by ..."), ObjectID-derived ids (from a process-global
@@ -115,6 +144,54 @@ TEST_CASE("Inactive hook: process output is byte-identical (no-op hook == unset)
     CHECK(strip_nondeterministic_gcode_lines(run(true,  true)) == baseline);  // active no-op hook fires everywhere, mutates nothing
 }
 
+// Without an active plugin each object runs its chain of steps up to the support generation as an independent task,
+// with the plugin active the steps run in a loop over all objects each. Both must produce the same G-code for several
+// different objects, including the support generation and the steps after it. The tree support reads the layer counts
+// of all the objects to generate the lslices for the skirt, thus it must only run once all the objects are sliced.
+TEST_CASE("Objects processed as independent chains match the per-step loops", "[slicing_pipeline]") {
+    auto run = [](const std::string &support_type, bool activate) {
+        Slic3r::Print print; Slic3r::Model model;
+        auto config = Slic3r::DynamicPrintConfig::full_print_config();
+        config.set_key_value("enable_support", new Slic3r::ConfigOptionBool(true));
+        config.set_deserialize_strict({ { "support_type", support_type }, { "skirt_loops", 1 }, { "skirt_height", 3 } });
+        if (activate) {
+            config.set_key_value("slicing_pipeline_plugin", new Slic3r::ConfigOptionStrings({"probe"}));
+            Slic3r::Print::set_slicing_pipeline_hook_fn([](Slic3r::Print&, const Slic3r::PrintObject*, Slic3r::SlicingPipelineStepPlugin){});
+        }
+        init_print({TestMesh::overhang, TestMesh::L, TestMesh::cube_with_hole}, print, model, config);
+        std::string g = Slic3r::Test::gcode(print);
+        Slic3r::Print::set_slicing_pipeline_hook_fn(nullptr);
+        return g;
+    };
+    for (const std::string support_type : { "normal(auto)", "tree(auto)" }) {
+        INFO("support_type " << support_type);
+        CHECK(strip_nondeterministic_gcode_lines(run(support_type, false)) == strip_nondeterministic_gcode_lines(run(support_type, true)));
+    }
+}
+
+// The objects processed concurrently report the progress of their steps through one status callback.
+// The callback must not be entered concurrently and the progress of the object steps must not go back.
+TEST_CASE("Objects processed concurrently report serialized, non-decreasing progress", "[slicing_pipeline]") {
+    Slic3r::Print print; Slic3r::Model model;
+    init_print({TestMesh::overhang, TestMesh::L, TestMesh::cube_with_hole, TestMesh::pyramid}, print, model,
+        Slic3r::DynamicPrintConfig::full_print_config());
+    std::vector<int> percents;
+    std::atomic<int> callers { 0 };
+    bool             overlapped = false;
+    print.set_status_callback([&](const Slic3r::PrintBase::SlicingStatus &status) {
+        if (callers.fetch_add(1) != 0)
+            overlapped = true;
+        // Skirt & brim (70) is the first print-wide step after the object steps (5 to 50, and 71 for the auto-lift).
+        if (status.percent >= 0 && status.percent < 70)
+            percents.emplace_back(status.percent);
+        callers.fetch_sub(1);
+    });
+    print.process();
+    CHECK_FALSE(overlapped);
+    REQUIRE_FALSE(percents.empty());
+    CHECK(std::is_sorted(percents.begin(), percents.end()));
+}
+
 // Gating negative path. With the option EMPTY the plugin is inactive, so a
 // registered hook must NOT fire even once across a full slice (m_pipeline_plugin_active
 // stays false in Print::apply). Distinct from the byte-identical test above: this asserts
@@ -1,8 +1,11 @@
 #include <catch2/catch_all.hpp>
 #include "test_utils.hpp"
 
+#include <random>
+
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeIndirectParallel.hpp>
 
 using namespace Slic3r;
 
@@ -58,3 +61,88 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Catch::Approx(0.5));
     REQUIRE(closest_point.z() == Catch::Approx(1.));
 }
+
+static void random_rays(const BoundingBoxf3 &bbox, size_t num_rays, std::vector<Vec3d> &origins, std::vector<Vec3d> &dirs)
+{
+    std::mt19937 rng(1618);
+    std::uniform_real_distribution<double> unit(0., 1.);
+    std::normal_distribution<double>       normal;
+    origins.clear();
+    dirs.clear();
+    for (size_t i = 0; i < num_rays; ++ i) {
+        origins.emplace_back(bbox.min + Vec3d(unit(rng), unit(rng), unit(rng)).cwiseProduct(bbox.size()));
+        dirs.emplace_back(Vec3d(normal(rng), normal(rng), normal(rng)).normalized());
+    }
+}
+
+TEST_CASE("Batched ray casting matches casting single rays", "[AABBIndirect]")
+{
+    for (const char *name : { "frog_legs.obj", "extruder_idler.obj", "ipadstand.obj" }) {
+        SECTION(name) {
+            TriangleMesh mesh = load_model(name);
+            REQUIRE_FALSE(mesh.empty());
+            auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
+            std::vector<Vec3d> origins, dirs;
+            random_rays(mesh.bounding_box(), 10000, origins, dirs);
+            AABBTreeIndirect::RayHits hits;
+            AABBTreeIndirect::intersect_rays_first_hit(mesh.its.vertices, mesh.its.indices, tree, origins, dirs, hits);
+            REQUIRE(hits.size() == origins.size());
+            for (size_t i = 0; i < origins.size(); ++ i) {
+                igl::Hit<float> hit;
+                bool intersected = AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, origins[i], dirs[i], hit);
+                REQUIRE(hits.hit(i) == intersected);
+                if (intersected)
+                    REQUIRE(hits.t[i] == Catch::Approx(hit.t));
+            }
+
+            AABBTreeIndirect::RayHits parallel_hits;
+            AABBTreeIndirect::intersect_rays_first_hit_parallel(mesh.its.vertices, mesh.its.indices, tree, origins, dirs, parallel_hits);
+            REQUIRE(parallel_hits.face == hits.face);
+            REQUIRE(parallel_hits.t == hits.t);
+        }
+    }
+}
+
+TEST_CASE("Parallel build produces the same tree as the serial build", "[AABBIndirect]")
+{
+    // frog_legs.obj has enough triangles for the subtrees to be built in parallel.
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    REQUIRE(mesh.its.indices.size() > 2 * AABBTreeIndirect::parallel_build_threshold);
+    auto tree          = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
+    auto parallel_tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set_parallel(mesh.its.vertices, mesh.its.indices);
+    REQUIRE(parallel_tree.nodes().size() == tree.nodes().size());
+    for (size_t i = 0; i < tree.nodes().size(); ++ i) {
+        const auto &node          = tree.nodes()[i];
+        const auto &parallel_node = parallel_tree.nodes()[i];
+        REQUIRE(parallel_node.idx == node.idx);
+        if (node.is_valid())
+            REQUIRE(parallel_node.bbox.isApprox(node.bbox));
+    }
+}
+
+TEST_CASE("Benchmark building a tree and batched ray casting", "[AABBIndirect][.benchmark]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    REQUIRE_FALSE(mesh.empty());
+    BENCHMARK("build") { return AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices); };
+    BENCHMARK("parallel build") { return AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set_parallel(mesh.its.vertices, mesh.its.indices); };
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
+    std::vector<Vec3d> origins, dirs;
+    random_rays(mesh.bounding_box(), 100000, origins, dirs);
+    BENCHMARK("single rays") {
+        std::vector<igl::Hit<float>> hits(origins.size());
+        for (size_t i = 0; i < origins.size(); ++ i)
+            AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, origins[i], dirs[i], hits[i]);
+        return hits;
+    };
+    BENCHMARK("batched rays") {
+        AABBTreeIndirect::RayHits hits;
+        AABBTreeIndirect::intersect_rays_first_hit(mesh.its.vertices, mesh.its.indices, tree, origins, dirs, hits);
+        return hits;
+    };
+    BENCHMARK("parallel batched rays") {
+        AABBTreeIndirect::RayHits hits;
+        AABBTreeIndirect::intersect_rays_first_hit_parallel(mesh.its.vertices, mesh.its.indices, tree, origins, dirs, hits);
+        return hits;
+    };
+}
@@ -309,3 +309,46 @@ TEST_CASE("Beading interpolation tolerates a thicker side with fewer insets", "[
         CHECK(result.bead_widths[i] == expected.bead_widths[i]);
     }
 }
+
+// Islands are generated in parallel and merged by their inset index, the result has to match generating the islands one by one.
+TEST_CASE("Arachne walls of many islands match the walls of the single islands", "[Arachne]") {
+    const coord_t bead_width = scaled<coord_t>(0.42);
+    const auto    params     = make_bbl_x1c_028_params(50);
+
+    Polygons outline;
+    for (int i = 0; i < 6; ++ i)
+        for (int j = 0; j < 6; ++ j) {
+            // Squares of growing size, some of them thin enough to get a single odd wall.
+            const double size = 0.5 + 0.3 * (i * 6 + j);
+            Polygon square { Point::new_scale(10. * i, 10. * j), Point::new_scale(10. * i + size, 10. * j),
+                             Point::new_scale(10. * i + size, 10. * j + size), Point::new_scale(10. * i, 10. * j + size) };
+            outline.emplace_back(std::move(square));
+        }
+
+    auto total_length = [](const std::vector<VariableWidthLines> &toolpaths, size_t inset_idx) {
+        double length = 0.;
+        if (inset_idx < toolpaths.size())
+            for (const ExtrusionLine &line : toolpaths[inset_idx])
+                length += line.getLength();
+        return length;
+    };
+
+    WallToolPaths all_islands(outline, bead_width, bead_width, 3, 0, 0.2, params);
+    const std::vector<VariableWidthLines> &toolpaths = all_islands.getToolPaths();
+    REQUIRE(! toolpaths.empty());
+
+    std::vector<double> lengths_single(toolpaths.size(), 0.);
+    for (const Polygon &island : outline) {
+        Polygons island_outline { island };
+        WallToolPaths single_island(island_outline, bead_width, bead_width, 3, 0, 0.2, params);
+        const std::vector<VariableWidthLines> &single_toolpaths = single_island.getToolPaths();
+        REQUIRE(single_toolpaths.size() <= toolpaths.size());
+        for (size_t inset_idx = 0; inset_idx < single_toolpaths.size(); ++ inset_idx)
+            lengths_single[inset_idx] += total_length(single_toolpaths, inset_idx);
+    }
+    for (size_t inset_idx = 0; inset_idx < toolpaths.size(); ++ inset_idx) {
+        for (const ExtrusionLine &line : toolpaths[inset_idx])
+            CHECK(line.inset_idx == inset_idx);
+        CHECK(total_length(toolpaths, inset_idx) == Catch::Approx(lengths_single[inset_idx]).epsilon(1e-4));
+    }
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/GCode/BinaryGCode.hpp"
+
+#include "test_utils.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <sstream>
+
+using namespace Slic3r;
+
+static std::string read_file(const boost::filesystem::path &path)
+{
+    boost::nowide::ifstream file(path.string(), std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST_CASE("Binary G-code round trip", "[BinaryGCode]")
+{
+    // 1x1 PNG.
+    const std::string png_base64 = "iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAADUlEQVR42mNk+M9QDwADhgGAWjR9awAAAABJRU5ErkJggg==";
+    std::string gcode = "; HEADER_BLOCK_START\n; generated by OrcaSlicer\n; total layer number: 10\n; HEADER_BLOCK_END\n\n"
+                        "; THUMBNAIL_BLOCK_START\n\n;\n; thumbnail begin 1x1 " + std::to_string(png_base64.size()) + "\n; " +
+                        png_base64 + "\n; thumbnail end\n; THUMBNAIL_BLOCK_END\n\n";
+    const size_t moves_begin = gcode.size();
+    // Long enough to be split into several G-code blocks.
+    for (int i = 0; i < 20000; ++ i)
+        gcode += "G1 X" + std::to_string(i % 200) + " Y" + std::to_string((i * 7) % 200) + " E0.0" + std::to_string(i % 10) + "\n";
+
+    ScopedTemporaryFile ascii_file(".gcode");
+    ScopedTemporaryFile binary_file(".bgcode");
+    ScopedTemporaryFile decoded_file(".gcode");
+    const boost::filesystem::path &ascii_path   = ascii_file.path();
+    const boost::filesystem::path &binary_path  = binary_file.path();
+    const boost::filesystem::path &decoded_path = decoded_file.path();
+    {
+        boost::nowide::ofstream file(ascii_path.string(), std::ios::binary);
+        file << gcode;
+    }
+
+    BinaryGCode::Metadata metadata;
+    metadata.slicer.emplace_back("Producer", "test");
+    BinaryGCode::convert_ascii_to_binary(ascii_path.string(), binary_path.string(), metadata);
+    REQUIRE(BinaryGCode::is_binary_gcode_file(binary_path.string()));
+    REQUIRE(! BinaryGCode::is_binary_gcode_file(ascii_path.string()));
+    REQUIRE(boost::filesystem::file_size(binary_path) < gcode.size() / 2);
+
+    BinaryGCode::convert_binary_to_ascii(binary_path.string(), decoded_path.string());
+    std::string decoded = read_file(decoded_path);
+
+    SECTION("G-code and thumbnails are restored") {
+        REQUIRE(decoded.find("; thumbnail begin 1x1 " + std::to_string(png_base64.size())) != std::string::npos);
+        REQUIRE(decoded.find("; total layer number: 10") != std::string::npos);
+        REQUIRE(decoded.substr(decoded.find("G1 ")) == gcode.substr(moves_begin));
+    }
+
+    SECTION("Corrupted block is detected") {
+        std::string binary = read_file(binary_path);
+        binary[binary.size() / 2] ^= 0x55;
+        {
+            boost::nowide::ofstream file(binary_path.string(), std::ios::binary | std::ios::trunc);
+            file << binary;
+        }
+        REQUIRE_THROWS(BinaryGCode::convert_binary_to_ascii(binary_path.string(), decoded_path.string()));
+    }
+
+    SECTION("Decoded file is removed with its owner") {
+        std::string path;
+        {
+            BinaryGCode::DecodedFile owner(binary_path.string());
+            path = owner.path();
+            REQUIRE(read_file(path) == decoded);
+        }
+        REQUIRE(! boost::filesystem::exists(path));
+    }
+}
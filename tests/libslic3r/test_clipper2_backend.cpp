@@ -0,0 +1,168 @@
+#include <catch2/catch_all.hpp>
+
+#include <functional>
+#include <limits>
+#include <numeric>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/ExPolygon.hpp"
+
+using namespace Slic3r;
+
+// Differential tests of the Clipper2 backend of ClipperUtils against ClipperLib.
+// The backends place the vertices of round and square joins differently, the results are compared by their area,
+// by the area of their symmetric difference and by the distance of the vertices of one result to the outline of the other.
+// Clipper2 also splits the output at vertices where an output contour touches itself, ClipperLib makes a hole there,
+// thus the number of polygons is only compared for inputs in a general position.
+
+class ScopedClipperBackend
+{
+public:
+    ScopedClipperBackend(ClipperUtils::Backend backend) : m_saved(ClipperUtils::backend()) { ClipperUtils::set_backend(backend); }
+    ~ScopedClipperBackend() { ClipperUtils::set_backend(m_saved); }
+private:
+    ClipperUtils::Backend m_saved;
+};
+
+static double total_area(const Polygons &polygons)
+{
+    return std::accumulate(polygons.begin(), polygons.end(), 0., [](double a, const Polygon &p) { return a + p.area(); });
+}
+
+static double total_area(const ExPolygons &expolygons)
+{
+    return std::accumulate(expolygons.begin(), expolygons.end(), 0., [](double a, const ExPolygon &e) { return a + e.area(); });
+}
+
+template<typename Result>
+static std::pair<Result, Result> run_both(const std::function<Result()> &fn)
+{
+    Result clipperlib, clipper2;
+    {
+        ScopedClipperBackend backend(ClipperUtils::Backend::ClipperLib);
+        clipperlib = fn();
+    }
+    {
+        ScopedClipperBackend backend(ClipperUtils::Backend::Clipper2);
+        clipper2 = fn();
+    }
+    return { std::move(clipperlib), std::move(clipper2) };
+}
+
+// Area of the symmetric difference of two regions, calculated with ClipperLib.
+static double symmetric_difference_area(const Polygons &a, const Polygons &b)
+{
+    ScopedClipperBackend backend(ClipperUtils::Backend::ClipperLib);
+    return total_area(diff_ex(a, b)) + total_area(diff_ex(b, a));
+}
+
+// Maximum distance of a vertex of one set of polygons to the outline of the other set and vice versa.
+static double vertex_distance(const Polygons &a, const Polygons &b)
+{
+    auto one_way = [](const Polygons &from, const Polygons &to) {
+        const Lines lines = to_lines(to);
+        double      dmax  = 0.;
+        for (const Polygon &polygon : from)
+            for (const Point &pt : polygon.points) {
+                double dmin = std::numeric_limits<double>::max();
+                for (const Line &line : lines)
+                    dmin = std::min(dmin, line.distance_to(pt));
+                dmax = std::max(dmax, dmin);
+            }
+        return dmax;
+    };
+    return std::max(one_way(a, b), one_way(b, a));
+}
+
+// The outlines may differ by a few units due to rounding of the intersection points, unless a larger tolerance is given for round joins.
+static void check_same(const std::pair<Polygons, Polygons> &results, double epsilon = 1e-6, bool same_count = true, double max_vertex_distance = 5.)
+{
+    if (same_count)
+        CHECK(results.first.size() == results.second.size());
+    const double area = total_area(results.first);
+    CHECK(total_area(results.second) == Catch::Approx(area).epsilon(epsilon));
+    CHECK(symmetric_difference_area(results.first, results.second) <= epsilon * area);
+    CHECK(vertex_distance(results.first, results.second) <= max_vertex_distance);
+}
+
+static void check_same(const std::pair<ExPolygons, ExPolygons> &results, double epsilon = 1e-6, bool same_count = true, double max_vertex_distance = 5.)
+{
+    if (same_count)
+        CHECK(results.first.size() == results.second.size());
+    check_same(std::make_pair(to_polygons(results.first), to_polygons(results.second)), epsilon, false, max_vertex_distance);
+}
+
+TEST_CASE("Clipper2 backend matches ClipperLib", "[ClipperUtils]")
+{
+    const coord_t mm = scaled<coord_t>(1.);
+    // CCW oriented contour
+    Polygon   square{ { 0, 0 }, { 10 * mm, 0 }, { 10 * mm, 10 * mm }, { 0, 10 * mm } };
+    // CW oriented contour
+    Polygon   hole{ { 3 * mm, 3 * mm }, { 3 * mm, 7 * mm }, { 7 * mm, 7 * mm }, { 7 * mm, 3 * mm } };
+    ExPolygon square_with_hole(square, hole);
+    Polygon   square2 = square;
+    square2.translate(5 * mm, 3 * mm);
+    Polygon   star;
+    for (int i = 0; i < 10; ++ i) {
+        double r = (i % 2 == 0 ? 8. : 3.) * mm;
+        double a = 2. * PI * i / 10.;
+        star.points.emplace_back(coord_t(r * cos(a)) + 15 * mm, coord_t(r * sin(a)) + 5 * mm);
+    }
+    const Polygons   polygons { square, square2, star };
+    const ExPolygons expolygons { square_with_hole, ExPolygon(star) };
+
+    SECTION("offset") {
+        check_same(run_both<Polygons>([&]() { return offset(polygons, float(mm)); }));
+        check_same(run_both<Polygons>([&]() { return offset(polygons, - float(mm) / 4.f); }));
+        check_same(run_both<Polygons>([&]() { return offset(Polygons{ hole }, float(mm)); }));
+        check_same(run_both<ExPolygons>([&]() { return offset_ex(expolygons, float(mm) / 2.f); }));
+        check_same(run_both<ExPolygons>([&]() { return offset_ex(expolygons, - float(mm) / 2.f); }));
+        check_same(run_both<ExPolygons>([&]() { return offset2_ex(expolygons, - float(mm), float(mm) / 2.f); }));
+        check_same(run_both<ExPolygons>([&]() { return shrink_ex(polygons, float(mm) / 2.f); }));
+        // Round joins are approximated by different polygons.
+        check_same(run_both<ExPolygons>([&]() { return offset_ex(expolygons, float(mm), jtRound, mm / 100.); }), 1e-3, true, mm / 100.);
+    }
+    SECTION("offset drops edges shorter than the shortest edge length") {
+        // Vertices 1um apart along the bottom edge, shorter than ClipperOffsetShortestEdgeFactor times the offset.
+        Polygon jagged = square;
+        for (coord_t x = 9 * mm; x > 0; x -= mm / 1000)
+            jagged.points.insert(jagged.points.begin() + 1, Point(x, (x / (mm / 1000)) % 2));
+        auto results = run_both<Polygons>([&]() { return offset(Polygons{ jagged }, float(mm), jtMiter, 3.); });
+        check_same(results);
+        REQUIRE(results.first.size() == 1);
+        REQUIRE(results.second.size() == 1);
+        CHECK(results.first.front().size() == results.second.front().size());
+    }
+    SECTION("offset of polylines") {
+        Polylines polylines { Polyline({ { 0, 0 }, { 10 * mm, 0 }, { 10 * mm, 10 * mm } }) };
+        check_same(run_both<Polygons>([&]() { return offset(polylines, float(mm) / 2.f); }));
+    }
+    SECTION("boolean operations") {
+        check_same(run_both<Polygons>([&]() { return union_(polygons); }));
+        check_same(run_both<ExPolygons>([&]() { return union_ex(polygons); }));
+        check_same(run_both<Polygons>([&]() { return diff(Polygons{ square }, Polygons{ square2, star }); }));
+        check_same(run_both<ExPolygons>([&]() { return diff_ex(expolygons, Polygons{ square2 }); }));
+        check_same(run_both<ExPolygons>([&]() { return intersection_ex(expolygons, Polygons{ square2 }); }));
+        check_same(run_both<ExPolygons>([&]() { return intersection_ex(expolygons, Polygons{ square2 }, ApplySafetyOffset::Yes); }));
+        // The star overlaps the square with a hole, the xor touches itself.
+        check_same(run_both<ExPolygons>([&]() { return xor_ex(expolygons, ExPolygons{ ExPolygon(square2) }); }), 1e-6, false);
+    }
+    SECTION("polytree output") {
+        ExPolygon star_apart(star);
+        star_apart.translate(5 * mm, 0);
+        auto results = run_both<std::pair<int, int>>([&]() {
+            ClipperLib::PolyTree polytree = union_pt(ExPolygons{ square_with_hole, star_apart });
+            return std::make_pair(polytree.Total(), polytree.ChildCount());
+        });
+        CHECK(results.first == results.second);
+    }
+    SECTION("clipping of polylines") {
+        Polylines polylines { Polyline({ { - mm, 5 * mm }, { 30 * mm, 5 * mm } }), Polyline({ { 5 * mm, - mm }, { 5 * mm, 11 * mm } }) };
+        auto intersections = run_both<Polylines>([&]() { return intersection_pl(polylines, expolygons); });
+        CHECK(intersections.first.size() == intersections.second.size());
+        CHECK(total_length(intersections.second) == Catch::Approx(total_length(intersections.first)));
+        auto differences = run_both<Polylines>([&]() { return diff_pl(polylines, expolygons); });
+        CHECK(differences.first.size() == differences.second.size());
+        CHECK(total_length(differences.second) == Catch::Approx(total_length(differences.first)));
+    }
+}
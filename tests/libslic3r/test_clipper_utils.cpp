@@ -299,3 +299,71 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Clipper keeps its edge arrays between operations", "[ClipperUtils]") {
+    const auto UNIT = coord_t(1. / SCALING_FACTOR);
+    Polygon square{ { 0, 0 }, { 10 * UNIT, 0 }, { 10 * UNIT, 10 * UNIT }, { 0, 10 * UNIT } };
+    Polygon square2 = square;
+    square2.translate(5 * UNIT, 5 * UNIT);
+    Polygon circle;
+    for (int i = 0; i < 100; ++ i)
+        circle.points.emplace_back(coord_t(4. * UNIT * cos(2. * PI * i / 100.)), coord_t(4. * UNIT * sin(2. * PI * i / 100.)));
+
+    auto run = [](ClipperLib::Clipper &clipper, const Polygons &subject, const Polygons &clip) {
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+        ClipperLib::Paths out;
+        clipper.Execute(ClipperLib::ctDifference, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        clipper.Clear();
+        return out;
+    };
+    auto run_fresh = [&run](const Polygons &subject, const Polygons &clip) {
+        ClipperLib::Clipper clipper;
+        return run(clipper, subject, clip);
+    };
+
+    SECTION("ClipperLib::Clipper reuses the kept edge arrays") {
+        ClipperLib::Clipper clipper;
+        clipper.KeepEdgeBuffers(1000);
+        REQUIRE(run(clipper, { square, circle }, { square2 }) == run_fresh({ square, circle }, { square2 }));
+        const size_t kept = clipper.KeptEdgeBuffers();
+        REQUIRE(kept >= circle.size() + 2 * square.size());
+        // Smaller operations are served from the kept arrays, thus no new arrays are kept.
+        REQUIRE(run(clipper, { square }, { square2 }) == run_fresh({ square }, { square2 }));
+        REQUIRE(run(clipper, { circle }, { square }) == run_fresh({ circle }, { square }));
+        REQUIRE(clipper.KeptEdgeBuffers() == kept);
+        REQUIRE(run(clipper, { square, circle }, { square2 }) == run_fresh({ square, circle }, { square2 }));
+        REQUIRE(clipper.KeptEdgeBuffers() == kept);
+    }
+
+    SECTION("ClipperLib::Clipper keeps no more edges than allowed") {
+        ClipperLib::Clipper clipper;
+        clipper.KeepEdgeBuffers(50);
+        REQUIRE(run(clipper, { square, circle }, { square2 }) == run_fresh({ square, circle }, { square2 }));
+        REQUIRE(clipper.KeptEdgeBuffers() <= 50);
+        REQUIRE(clipper.KeptEdgeBuffers() > 0);
+    }
+
+    SECTION("ClipperUtils operations share the engine of the thread") {
+        const ExPolygons diff_ref  = diff_ex(Polygons{ square, circle }, Polygons{ square2 });
+        const ExPolygons union_ref = union_ex(Polygons{ square, square2 });
+        {
+            ClipperUtils::ThreadClipper clipper;
+            REQUIRE(clipper.shared());
+            // The previous operations of this thread left their edge arrays in the engine.
+            REQUIRE(clipper->KeptEdgeBuffers() > 0);
+            REQUIRE(clipper->NumEdges() == 0);
+            // An operation started while the engine is leased gets an engine of its own.
+            ClipperUtils::ThreadClipper nested;
+            REQUIRE(! nested.shared());
+            REQUIRE(union_ex(Polygons{ square, square2 }) == union_ref);
+        }
+        for (size_t i = 0; i < 3; ++ i) {
+            REQUIRE(diff_ex(Polygons{ square, circle }, Polygons{ square2 }) == diff_ref);
+            REQUIRE(union_ex(Polygons{ square, square2 }) == union_ref);
+        }
+        ClipperUtils::ThreadClipper clipper;
+        REQUIRE(clipper.shared());
+        REQUIRE(clipper->KeptEdgeBuffers() <= ClipperUtils::ThreadClipper::keep_edges_max);
+    }
+}
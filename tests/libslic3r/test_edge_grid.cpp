@@ -0,0 +1,110 @@
+#include <catch2/catch_all.hpp>
+
+#include <random>
+
+#include "libslic3r/EdgeGrid.hpp"
+#include "libslic3r/Exception.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+
+#include "test_utils.hpp"
+
+using namespace Slic3r;
+
+static ExPolygons slice_model_in_the_middle(const char *name)
+{
+    TriangleMesh mesh = load_model(name);
+    REQUIRE_FALSE(mesh.empty());
+    const BoundingBoxf3 bb = mesh.bounding_box();
+    return slice_mesh_ex(mesh.its, std::vector<float>{ float(0.5 * (bb.min.z() + bb.max.z())) }).front();
+}
+
+static Points random_points(const BoundingBox &bbox, size_t num_points)
+{
+    std::mt19937 rng(2718);
+    std::uniform_int_distribution<coord_t> dist_x(bbox.min.x(), bbox.max.x());
+    std::uniform_int_distribution<coord_t> dist_y(bbox.min.y(), bbox.max.y());
+    Points pts;
+    pts.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i)
+        pts.emplace_back(dist_x(rng), dist_y(rng));
+    return pts;
+}
+
+TEST_CASE("Batched EdgeGrid queries match the point queries", "[EdgeGrid]")
+{
+    for (const char *name : { "frog_legs.obj", "extruder_idler.obj", "ipadstand.obj" }) {
+        SECTION(name) {
+            ExPolygons expolygons = slice_model_in_the_middle(name);
+            REQUIRE_FALSE(expolygons.empty());
+            const BoundingBox bbox = get_extents(expolygons);
+            EdgeGrid::Grid grid(bbox.inflated(scaled<coord_t>(1.)));
+            grid.create(expolygons, scaled<coord_t>(1.));
+            grid.prepare_batched_queries();
+            // Query points in and around the grid, with a search radius below and above the grid resolution.
+            const Points pts = random_points(bbox.inflated(scaled<coord_t>(3.)), 20000);
+            for (coord_t search_radius : { scaled<coord_t>(0.4), scaled<coord_t>(2.5) }) {
+                std::vector<EdgeGrid::Grid::ClosestPointResult> batch = grid.closest_points_signed_distance(pts, search_radius);
+                REQUIRE(batch.size() == pts.size());
+                for (size_t i = 0; i < pts.size(); ++ i) {
+                    EdgeGrid::Grid::ClosestPointResult single = grid.closest_point_signed_distance(pts[i], search_radius);
+                    REQUIRE(batch[i].valid() == single.valid());
+                    if (single.valid())
+                        REQUIRE(batch[i].distance == Catch::Approx(single.distance));
+                }
+            }
+            grid.calculate_sdf();
+            std::vector<coordf_t> distances = grid.signed_distances(pts, scaled<coord_t>(0.4));
+            for (size_t i = 0; i < pts.size(); ++ i) {
+                coordf_t distance;
+                REQUIRE(grid.signed_distance(pts[i], scaled<coord_t>(0.4), distance));
+                REQUIRE(distances[i] == Catch::Approx(distance));
+            }
+        }
+    }
+}
+
+TEST_CASE("Batched EdgeGrid queries require prepared closed contours", "[EdgeGrid]")
+{
+    const coord_t mm = scaled<coord_t>(1.);
+    const Points  pts { { 5 * mm, 5 * mm }, { 20 * mm, 5 * mm } };
+    SECTION("closed contours") {
+        EdgeGrid::Grid grid;
+        grid.create(Polygons{ Polygon{ { 0, 0 }, { 10 * mm, 0 }, { 10 * mm, 10 * mm }, { 0, 10 * mm } } }, mm);
+        REQUIRE_THROWS_AS(grid.closest_points_signed_distance(pts, 2 * mm), Slic3r::LogicError);
+        grid.prepare_batched_queries();
+        REQUIRE(grid.closest_points_signed_distance(pts, 6 * mm).size() == pts.size());
+        // Creating the grid again drops the prepared edges.
+        grid.create(Polygons{ Polygon{ { 0, 0 }, { 20 * mm, 0 }, { 20 * mm, 20 * mm }, { 0, 20 * mm } } }, mm);
+        REQUIRE_THROWS_AS(grid.closest_points_signed_distance(pts, 2 * mm), Slic3r::LogicError);
+    }
+    SECTION("open contours") {
+        EdgeGrid::Grid grid;
+        grid.create(std::vector<Points>{ Points{ { 0, 0 }, { 10 * mm, 0 }, { 10 * mm, 10 * mm } } }, mm, true);
+        REQUIRE_THROWS_AS(grid.prepare_batched_queries(), Slic3r::InvalidArgument);
+        REQUIRE_THROWS_AS(grid.closest_points_signed_distance(pts, 2 * mm), Slic3r::LogicError);
+    }
+}
+
+TEST_CASE("Benchmark batched EdgeGrid queries", "[EdgeGrid][.benchmark]")
+{
+    ExPolygons expolygons = slice_model_in_the_middle("frog_legs.obj");
+    const BoundingBox bbox = get_extents(expolygons);
+    EdgeGrid::Grid grid(bbox.inflated(scaled<coord_t>(1.)));
+    grid.create(expolygons, scaled<coord_t>(1.));
+    grid.prepare_batched_queries();
+    // Queries around the contours, as the seam placement or the elephant foot compensation make them.
+    const Points contour_points = to_points(expolygons);
+    Points       pts            = random_points(BoundingBox(Point(- scaled<coord_t>(0.5), - scaled<coord_t>(0.5)), Point(scaled<coord_t>(0.5), scaled<coord_t>(0.5))), 200000);
+    for (size_t i = 0; i < pts.size(); ++ i)
+        pts[i] += contour_points[i % contour_points.size()];
+    const coord_t search_radius = scaled<coord_t>(0.5);
+    BENCHMARK("point by point") {
+        std::vector<EdgeGrid::Grid::ClosestPointResult> out;
+        out.reserve(pts.size());
+        for (const Point &pt : pts)
+            out.emplace_back(grid.closest_point_signed_distance(pt, search_radius));
+        return out;
+    };
+    BENCHMARK("batched") { return grid.closest_points_signed_distance(pts, search_radius); };
+}
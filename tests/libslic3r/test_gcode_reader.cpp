@@ -0,0 +1,73 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/GCodeReader.hpp"
+
+#include <boost/nowide/fstream.hpp>
+
+#include <string>
+#include <vector>
+
+#include "test_utils.hpp"
+
+using namespace Slic3r;
+
+namespace {
+
+struct ParsedLine
+{
+    std::string raw;
+    float       x, y, e, f;
+    bool        has_x, has_e;
+    float       reader_e;
+
+    bool operator==(const ParsedLine &rhs) const
+    {
+        return raw == rhs.raw && x == rhs.x && y == rhs.y && e == rhs.e && f == rhs.f && has_x == rhs.has_x && has_e == rhs.has_e &&
+               reader_e == rhs.reader_e;
+    }
+};
+
+static std::vector<ParsedLine> collect(bool parallel, const std::string &path, std::vector<size_t> &lines_ends)
+{
+    GCodeReader reader;
+    DynamicPrintConfig config;
+    config.set_key_value("use_relative_e_distances", new ConfigOptionBool(true));
+    reader.apply_config(config);
+
+    std::vector<ParsedLine> out;
+    auto callback = [&out](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        out.push_back({ line.raw(), line.x(), line.y(), line.e(), line.f(), line.has_x(), line.has_e(), reader.e() });
+    };
+    bool ok = parallel ? reader.parse_file_parallel(path, callback, lines_ends) : reader.parse_file(path, callback, lines_ends);
+    REQUIRE(ok);
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("Parallel G-code parsing matches the serial parser", "[GCodeReader]")
+{
+    ScopedTemporaryFile tmp(".gcode");
+    {
+        boost::nowide::ofstream f(tmp.string(), std::ios::binary);
+        // Several megabytes, so that the file spans multiple blocks of the parallel parser,
+        // mixing line endings, line numbers, comments and empty lines.
+        for (int i = 0; i < 120000; ++ i) {
+            f << "; LAYER_CHANGE " << i << "\n";
+            f << "N" << i << " G1 X" << (i % 200) * 0.5 << " Y" << (i % 170) * 0.25 << " E0.0123 F1800\r\n";
+            f << "G1 F3000 ; feedrate only\n";
+            f << "\n";
+            f << "  M106 S" << (i % 255) << "\n";
+        }
+        // Last line without the trailing end of line.
+        f << "G1 X1 Y2 E0.5";
+    }
+
+    std::vector<size_t> serial_ends, parallel_ends;
+    std::vector<ParsedLine> serial   = collect(false, tmp.string(), serial_ends);
+    std::vector<ParsedLine> parallel = collect(true, tmp.string(), parallel_ends);
+
+    REQUIRE(serial.size() == parallel.size());
+    CHECK(serial == parallel);
+    CHECK(serial_ends == parallel_ends);
+}
@@ -2,8 +2,10 @@
 #include <fstream>
 #include <random>
 #include <catch2/catch_all.hpp>
+#include <tbb/task_arena.h>
 
 #include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshRepair.hpp"
 
 #include "test_utils.hpp"
 
@@ -313,3 +315,90 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Simplify big mesh by Quadric edge collapse in parallel parts", "[its]")
+{
+    // Big enough to be split into parts simplified by the threads of the arena, then the seams are simplified.
+    indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 600.);
+    uint32_t wanted_count = sphere.indices.size() / 20;
+    indexed_triangle_set its = sphere; // copy
+    tbb::task_arena arena(8);
+    arena.execute([&its, wanted_count]() { its_quadric_edge_collapse(its, wanted_count); });
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(!exist_triangle_with_twice_vertices(its.indices));
+    CHECK(its_volume(its) == Catch::Approx(its_volume(sphere)).epsilon(0.01));
+
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.01f;
+    cfg.max_distance         = 0.05f;
+    CHECK(is_similar(sphere, its, cfg));
+    CHECK(is_similar(its, sphere, cfg));
+}
+
+TEST_CASE("Parallel Quadric edge collapse does not depend on the number of threads", "[its]")
+{
+    indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 600.);
+    uint32_t wanted_count = sphere.indices.size() / 20;
+    indexed_triangle_set its1 = sphere;
+    indexed_triangle_set its8 = sphere;
+    tbb::task_arena(1).execute([&its1, wanted_count]() { its_quadric_edge_collapse(its1, wanted_count); });
+    tbb::task_arena(8).execute([&its8, wanted_count]() { its_quadric_edge_collapse(its8, wanted_count); });
+    CHECK(its1.vertices == its8.vertices);
+    CHECK(its1.indices == its8.indices);
+}
+
+TEST_CASE("Face neighbors by sorting edges match its_face_neighbors", "[its]")
+{
+    indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 100.);
+    CHECK(its_face_neighbors_sorted(sphere) == its_face_neighbors(sphere));
+
+    // Two triangles sharing an equally oriented edge are only neighbors if backwards edges are connected.
+    indexed_triangle_set its;
+    its.vertices = { Vec3f(0.f, 0.f, 0.f), Vec3f(1.f, 0.f, 0.f), Vec3f(0.f, 1.f, 0.f), Vec3f(0.f, -1.f, 0.f) };
+    its.indices  = { Vec3i32(0, 1, 2), Vec3i32(0, 1, 3) };
+    CHECK(its_num_open_edges(its_face_neighbors_sorted(its)) == 6);
+    CHECK(its_num_open_edges(its_face_neighbors_sorted(its, true)) == 4);
+}
+
+TEST_CASE("Repair a triangle soup of a cube", "[its]")
+{
+    indexed_triangle_set cube = its_make_cube(10., 10., 10.);
+    indexed_triangle_set soup;
+    for (const Vec3i32 &face : cube.indices) {
+        int base = int(soup.vertices.size());
+        for (int i = 0; i < 3; ++ i)
+            soup.vertices.emplace_back(cube.vertices[face(i)]);
+        soup.indices.emplace_back(base, base + 1, base + 2);
+    }
+    // Flip a face, add a degenerate face and shift a vertex a bit, so that its edges have to be connected by the nearby check.
+    std::swap(soup.indices[3](1), soup.indices[3](2));
+    soup.indices.emplace_back(0, 0, 1);
+    soup.vertices[5] += Vec3f(0.0001f, 0.f, 0.f);
+    // An isolated triangle far away.
+    soup.vertices.insert(soup.vertices.end(), { Vec3f(100.f, 0.f, 0.f), Vec3f(101.f, 0.f, 0.f), Vec3f(100.f, 1.f, 0.f) });
+    soup.indices.emplace_back(int(soup.vertices.size()) - 3, int(soup.vertices.size()) - 2, int(soup.vertices.size()) - 1);
+
+    TriangleMesh mesh(std::move(soup), MeshRepairParams());
+    const RepairedMeshErrors &errors = mesh.stats().repaired_errors;
+    CHECK(errors.degenerate_facets == 1);
+    CHECK(errors.facets_removed == 2);
+    CHECK(errors.facets_reversed == 1);
+    CHECK(errors.edges_fixed > 0);
+    CHECK(errors.backwards_edges == 0);
+    CHECK(mesh.its.indices.size() == 12);
+    CHECK(mesh.its.vertices.size() == 8);
+    CHECK(mesh.stats().manifold());
+    CHECK(mesh.stats().number_of_parts == 1);
+    CHECK(mesh.volume() == Catch::Approx(1000.f).epsilon(0.001));
+}
+
+TEST_CASE("Repair flips a mesh with a negative volume", "[its]")
+{
+    indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 60.);
+    indexed_triangle_set its    = sphere;
+    its_flip_triangles(its);
+    RepairedMeshErrors errors = its_repair(its);
+    CHECK(errors.facets_reversed == int(its.indices.size()));
+    CHECK(its.indices == sphere.indices);
+    CHECK(its_volume(its) > 0.f);
+}
@@ -0,0 +1,307 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/EdgeGrid.hpp"
+#include "libslic3r/Fill/Lightning/DistanceField.hpp"
+#include "libslic3r/Fill/Lightning/Layer.hpp"
+#include "libslic3r/Fill/Lightning/TreeNode.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::FillLightning;
+
+// Exposes the tree reductions applied by NodePool::propagateToNextLayer().
+class TestNodePool : public NodePool
+{
+public:
+    using NodePool::compact;
+    using NodePool::detachChild;
+    using NodePool::straighten;
+};
+
+// Checks the parent, children and sibling links of the tree of root, marks its nodes as visited.
+// Returns the number of nodes of the tree.
+static size_t check_tree(const NodePool &nodes, NodeIdx root, std::vector<bool> &visited)
+{
+    REQUIRE(root < nodes.size());
+    REQUIRE(nodes[root].isRoot());
+    REQUIRE(nodes[root].prev_sibling == invalid_node_idx);
+    REQUIRE(nodes[root].next_sibling == invalid_node_idx);
+    visited.resize(nodes.size(), false);
+    size_t num_nodes = 0;
+    nodes.visitNodes(root, [&nodes, &visited, &num_nodes](NodeIdx idx) {
+        REQUIRE(! visited[idx]);
+        visited[idx] = true;
+        ++ num_nodes;
+        const Node &node         = nodes[idx];
+        NodeIdx     prev         = invalid_node_idx;
+        uint32_t    num_children = 0;
+        for (NodeIdx child = node.first_child; child != invalid_node_idx; child = nodes[child].next_sibling) {
+            REQUIRE(nodes[child].parent == idx);
+            REQUIRE(nodes[child].prev_sibling == prev);
+            prev = child;
+            ++ num_children;
+        }
+        REQUIRE(node.last_child == prev);
+        REQUIRE(node.num_children == num_children);
+    });
+    return num_nodes;
+}
+
+static size_t check_tree(const NodePool &nodes, NodeIdx root)
+{
+    std::vector<bool> visited;
+    return check_tree(nodes, root, visited);
+}
+
+// Branches of the tree of root in the order of visitBranches().
+static Lines tree_branches(const NodePool &nodes, NodeIdx root)
+{
+    Lines out;
+    nodes.visitBranches(root, [&out](const Point &a, const Point &b) { out.emplace_back(a, b); });
+    return out;
+}
+
+// Branches of the tree of root as sorted undirected segments, thus independent of the tree's root.
+static std::vector<std::array<coord_t, 4>> tree_edges(const NodePool &nodes, NodeIdx root)
+{
+    std::vector<std::array<coord_t, 4>> out;
+    for (const Line &l : tree_branches(nodes, root)) {
+        std::array<coord_t, 4> a { l.a.x(), l.a.y(), l.b.x(), l.b.y() };
+        std::array<coord_t, 4> b { l.b.x(), l.b.y(), l.a.x(), l.a.y() };
+        out.emplace_back(std::min(a, b));
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+static Polygon square(double cx, double cy, double half_size)
+{
+    return Polygon({ Point::new_scale(cx - half_size, cy - half_size), Point::new_scale(cx + half_size, cy - half_size),
+                     Point::new_scale(cx + half_size, cy + half_size), Point::new_scale(cx - half_size, cy + half_size) });
+}
+
+TEST_CASE("Rerooting reverses the links up to the old root", "[Lightning]")
+{
+    NodePool nodes;
+    const NodeIdx a = nodes.addNode(Point::new_scale(0, 0));
+    const NodeIdx b = nodes.addChild(a, Point::new_scale(10, 0));
+    const NodeIdx c = nodes.addChild(b, Point::new_scale(20, 0));
+    const NodeIdx d = nodes.addChild(a, Point::new_scale(0, 10));
+    const NodeIdx e = nodes.addChild(b, Point::new_scale(10, 10));
+    const NodeIdx f = nodes.addChild(c, Point::new_scale(20, 10));
+    REQUIRE(check_tree(nodes, a) == 6);
+    const auto edges = tree_edges(nodes, a);
+
+    nodes.reroot(c);
+
+    REQUIRE(check_tree(nodes, c) == 6);
+    REQUIRE(tree_edges(nodes, c) == edges);
+    REQUIRE(nodes[b].parent == c);
+    REQUIRE(nodes[a].parent == b);
+    REQUIRE(nodes[d].parent == a);
+    REQUIRE(nodes[e].parent == b);
+    REQUIRE(nodes[f].parent == c);
+    REQUIRE(nodes[a].num_children == 1);
+    REQUIRE(nodes[b].num_children == 2);
+    REQUIRE(nodes.hasOffspring(c, d));
+    REQUIRE(! nodes.hasOffspring(a, c));
+
+    // Rerooting at a leaf of the former root, then back at the former root restores the tree.
+    nodes.reroot(d);
+    REQUIRE(check_tree(nodes, d) == 6);
+    nodes.reroot(a);
+    REQUIRE(check_tree(nodes, a) == 6);
+    REQUIRE(tree_edges(nodes, a) == edges);
+}
+
+TEST_CASE("Straightening collapses colinear nodes", "[Lightning]")
+{
+    TestNodePool nodes;
+    const NodeIdx root = nodes.addNode(Point::new_scale(0, 0));
+    NodeIdx       leaf = root;
+    for (int i = 1; i <= 10; ++ i)
+        leaf = nodes.addChild(leaf, Point::new_scale(i, 0));
+    REQUIRE(check_tree(nodes, root) == 11);
+
+    SECTION("Segments longer than the maximum colinear distance are kept") {
+        nodes.straighten(root, scaled<coord_t>(0.2), scaled<coord_t>(1.5));
+        REQUIRE(check_tree(nodes, root) == 11);
+    }
+
+    SECTION("A colinear chain collapses into a single segment") {
+        nodes.straighten(root, scaled<coord_t>(0.2), scaled<coord_t>(20.));
+        REQUIRE(check_tree(nodes, root) == 2);
+        REQUIRE(nodes[root].first_child == leaf);
+        REQUIRE(nodes[leaf].p == Point::new_scale(10, 0));
+        // The collapsed nodes are cut off the tree.
+        for (NodeIdx idx = 0; idx < nodes.size(); ++ idx)
+            if (idx != root && idx != leaf)
+                REQUIRE(check_tree(nodes, idx) == 1);
+    }
+
+    SECTION("Colinear chains of a junction collapse up to the junction") {
+        const NodeIdx junction = nodes.addChild(root, Point::new_scale(0, 10));
+        NodeIdx left = junction, right = junction;
+        for (int i = 1; i <= 5; ++ i) {
+            left  = nodes.addChild(left,  Point::new_scale(- i, 10));
+            right = nodes.addChild(right, Point::new_scale(0, 10 + i));
+        }
+        REQUIRE(check_tree(nodes, root) == 22);
+        nodes.straighten(root, scaled<coord_t>(0.2), scaled<coord_t>(20.));
+        REQUIRE(check_tree(nodes, root) == 5);
+        REQUIRE(nodes[junction].num_children == 2);
+        REQUIRE(nodes[junction].first_child == left);
+        REQUIRE(nodes[junction].last_child == right);
+        // The junction is moved by at most the straightening magnitude.
+        REQUIRE((nodes[junction].p - Point::new_scale(0, 10)).cast<double>().norm() <= scaled<double>(0.2) + 1.);
+    }
+}
+
+TEST_CASE("Compacting drops the nodes cut off the trees", "[Lightning]")
+{
+    TestNodePool nodes;
+    // Unreachable nodes are interleaved with the nodes of two trees.
+    std::vector<NodeIdx> roots { nodes.addNode(Point::new_scale(0, 0)) };
+    nodes.addNode(Point::new_scale(50, 50));
+    const NodeIdx a   = nodes.addChild(roots.front(), Point::new_scale(10, 0));
+    const NodeIdx cut = nodes.addChild(a, Point::new_scale(10, 5));
+    nodes.addChild(cut, Point::new_scale(10, 8));
+    nodes.addChild(a, Point::new_scale(20, 0));
+    roots.push_back(nodes.addNode(Point::new_scale(0, 30)));
+    nodes.addChild(roots.front(), Point::new_scale(0, 10));
+    nodes.addChild(nodes.addChild(roots.back(), Point::new_scale(10, 30)), Point::new_scale(10, 40));
+    nodes.addChild(roots.back(), Point::new_scale(0, 40));
+    // Cut a sub-tree off the first tree.
+    nodes.detachChild(a, cut);
+    REQUIRE(nodes[a].num_children == 1);
+    std::vector<Lines> branches;
+    size_t             num_nodes = 0;
+    for (NodeIdx root : roots) {
+        branches.emplace_back(tree_branches(nodes, root));
+        num_nodes += check_tree(nodes, root);
+    }
+    REQUIRE(num_nodes < nodes.size());
+
+    nodes.compact(roots);
+
+    REQUIRE(nodes.size() == num_nodes);
+    std::vector<bool> visited;
+    for (size_t i = 0; i < roots.size(); ++ i) {
+        check_tree(nodes, roots[i], visited);
+        REQUIRE(tree_branches(nodes, roots[i]) == branches[i]);
+        // The nodes are numbered in depth-first pre-order of the trees.
+        NodeIdx next_idx = roots[i];
+        nodes.visitNodes(roots[i], [&next_idx](NodeIdx idx) { REQUIRE(idx == next_idx ++); });
+    }
+    REQUIRE(roots.front() == 0);
+    REQUIRE(std::count(visited.begin(), visited.end(), true) == long(nodes.size()));
+}
+
+TEST_CASE("Trees propagated to an equal outline keep their shape", "[Lightning]")
+{
+    const Polygons outline { square(0, 0, 20) };
+    EdgeGrid::Grid outline_locator(get_extents(outline).inflated(SCALED_EPSILON));
+    outline_locator.create(outline, locator_cell_size());
+
+    NodePool nodes;
+    std::vector<NodeIdx> roots { nodes.addNode(Point::new_scale(-19, 0)), nodes.addNode(Point::new_scale(19, 5)) };
+    const NodeIdx a = nodes.addChild(roots.front(), Point::new_scale(-10, 0));
+    nodes.addChild(nodes.addChild(a, Point::new_scale(-5, 5)), Point::new_scale(0, 12));
+    nodes.addChild(a, Point::new_scale(-5, -5));
+    nodes.addChild(nodes.addChild(roots.back(), Point::new_scale(10, 5)), Point::new_scale(10, -10));
+    // Not reachable from the roots.
+    nodes.addNode(Point::new_scale(0, 0));
+
+    NodePool             nodes_below;
+    std::vector<NodeIdx> roots_below;
+    nodes.propagateToNextLayer(roots, nodes_below, roots_below, outline, outline_locator, 0, 0, 0);
+
+    REQUIRE(roots_below.size() == roots.size());
+    size_t num_nodes = 0;
+    for (size_t i = 0; i < roots.size(); ++ i) {
+        num_nodes += check_tree(nodes_below, roots_below[i]);
+        REQUIRE(tree_branches(nodes_below, roots_below[i]) == tree_branches(nodes, roots[i]));
+        REQUIRE(nodes_below[roots_below[i]].last_grounding_location == std::make_optional(nodes[roots[i]].p));
+    }
+    REQUIRE(nodes_below.size() == num_nodes);
+}
+
+TEST_CASE("Lightning trees of a stack of layers match the reference", "[Lightning]")
+{
+    // The outlines grow towards the top, a hole is bridged above layer 8, thus the trees are realigned
+    // to the smaller outlines below and the overhang over the hole grows new trees.
+    constexpr int         num_layers = 20;
+    std::vector<Polygons> outlines(num_layers);
+    for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        outlines[layer_id] = { square(0, 0, 8. + 0.15 * layer_id) };
+        if (layer_id > 8) {
+            Polygon hole = square(1, 2, 3);
+            hole.reverse();
+            outlines[layer_id].emplace_back(std::move(hole));
+        }
+    }
+    // Parameters of the Generator for a 0.45mm infill line width, 15% density and 0.2mm layers.
+    const coord_t supporting_radius      = coord_t(scaled<coord_t>(0.45) / 0.15f);
+    const coord_t wall_supporting_radius = scaled<coord_t>(0.2);
+    const coord_t prune_length           = wall_supporting_radius;
+    const coord_t straightening_distance = wall_supporting_radius;
+    std::vector<Polygons> overhangs(num_layers);
+    for (int layer_id = num_layers - 1; layer_id >= 0; -- layer_id)
+        overhangs[layer_id] = diff(offset(outlines[layer_id], - float(wall_supporting_radius)),
+            layer_id + 1 < num_layers ? outlines[layer_id + 1] : Polygons());
+
+    // The layer loop of Generator::generateTrees().
+    std::vector<Layer> layers(num_layers);
+    const coord_t      cell_size = locator_cell_size();
+    EdgeGrid::Grid     outlines_locator(get_extents(outlines.back()).inflated(SCALED_EPSILON));
+    outlines_locator.create(outlines.back(), cell_size);
+    DistanceField      distance_field;
+    for (int layer_id = num_layers - 1; layer_id >= 0; -- layer_id) {
+        Layer                     &layer                        = layers[layer_id];
+        const BoundingBox          outlines_bbox                = get_extents(outlines[layer_id]);
+        const std::vector<NodeIdx> to_be_reconnected_tree_roots = layer.tree_roots;
+        layer.generateNewTrees(distance_field, overhangs[layer_id], outlines[layer_id], outlines_bbox, outlines_locator, supporting_radius, wall_supporting_radius, []() {});
+        layer.reconnectRoots(to_be_reconnected_tree_roots, outlines[layer_id], outlines_bbox, outlines_locator, supporting_radius, wall_supporting_radius);
+        if (layer_id == 0)
+            break;
+        BoundingBox below_outlines_bbox = get_extents(outlines[layer_id - 1]).inflated(SCALED_EPSILON);
+        if (const BoundingBox &outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
+            below_outlines_bbox.merge(outlines_locator_bbox);
+        if (! layer.tree_roots.empty())
+            below_outlines_bbox.merge(get_extents(layer.nodes, layer.tree_roots).inflated(SCALED_EPSILON));
+        outlines_locator.set_bbox(below_outlines_bbox);
+        outlines_locator.create(outlines[layer_id - 1], cell_size);
+        layer.propagateToNextLayer(layers[layer_id - 1], outlines[layer_id - 1], outlines_locator, prune_length, straightening_distance, cell_size / 2);
+    }
+
+    // Number of trees, number of branches and their length per layer, generated by the implementation
+    // linking the tree nodes by shared pointers, which preceded the node pool.
+    struct Reference { size_t num_trees; size_t num_branches; double length; };
+    const Reference reference[num_layers] = {
+        {  1, 21,  42.107999 }, {  1, 22,  44.136109 }, {  1, 22,  46.259164 }, {  1, 24,  48.583646 },
+        {  1, 26,  51.240195 }, {  1, 26,  53.898743 }, {  1, 26,  56.762384 }, {  2, 27,  59.972115 },
+        {  1, 28,  67.169552 }, {  5, 20,  48.493333 }, {  5, 23,  52.310771 }, {  6, 27,  53.094182 },
+        {  6, 27,  57.197313 }, {  7, 28,  61.748377 }, {  8, 29,  67.088616 }, {  8, 31,  75.653893 },
+        {  9, 32,  81.841895 }, {  9, 32,  88.218327 }, { 14, 34,  96.529554 }, { 14, 38, 104.894271 }
+    };
+    for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        INFO("Layer " << layer_id);
+        const Layer      &layer = layers[layer_id];
+        std::vector<bool> visited;
+        size_t            num_branches = 0;
+        double            length       = 0.;
+        for (NodeIdx root : layer.tree_roots) {
+            num_branches += check_tree(layer.nodes, root, visited) - 1;
+            for (const Line &l : tree_branches(layer.nodes, root))
+                length += unscaled(l.length());
+        }
+        CHECK(layer.tree_roots.size() == reference[layer_id].num_trees);
+        CHECK(num_branches == reference[layer_id].num_branches);
+        CHECK(length == Catch::Approx(reference[layer_id].length).epsilon(1e-6));
+    }
+}
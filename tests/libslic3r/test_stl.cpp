@@ -1,7 +1,16 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/Format/StreamingMeshImport.hpp"
+
+#include "test_utils.hpp"
 
 using namespace Slic3r;
 
@@ -55,3 +64,93 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+TEST_CASE("Streaming import matches the STL and OBJ loaders", "[stl]")
+{
+	for (const char *name : { "ASCII/20mmbox-LF.stl", "ASCII/20mmbox-CRLF.stl", "ASCII/20mmbox-nonstandard.stl", "Geräte/20mmbox-čřšřěá.stl" }) {
+		SECTION(name) {
+			indexed_triangle_set its;
+			REQUIRE(its_load_stl_streaming(stl_path(name).c_str(), its));
+			TriangleMesh mesh;
+			REQUIRE(mesh.ReadSTLFile(stl_path(name).c_str()));
+			CHECK(its.indices.size() == mesh.its.indices.size());
+			CHECK(its.vertices.size() == mesh.its.vertices.size());
+			CHECK(its_volume(its) == Catch::Approx(mesh.volume()));
+		}
+	}
+	for (const char *name : { "frog_legs.obj", "extruder_idler_quads.obj", "ipadstand.obj" }) {
+		SECTION(name) {
+			indexed_triangle_set its;
+			REQUIRE(its_load_obj_streaming((std::string(TEST_DATA_DIR) + "/" + name).c_str(), its) == ObjStreamingResult::Ok);
+			TriangleMesh mesh = load_model(name);
+			// load_obj() flips a mesh with a negative volume, the streaming importer leaves it to the caller.
+			if (its_volume(its) < 0)
+				its_flip_triangles(its);
+			CHECK(its.vertices == mesh.its.vertices);
+			CHECK(its.indices == mesh.its.indices);
+		}
+	}
+}
+
+TEST_CASE("Streaming STL import reports progress from the calling thread", "[stl]")
+{
+	// A binary STL spanning several parse blocks: a strip of 220000 facets, 11MB.
+	const size_t num_facets = 220000;
+	const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("streaming-%%%%-%%%%.stl")).string();
+	{
+		boost::nowide::ofstream out(path, std::ios::binary);
+		char header[80] = {};
+		out.write(header, sizeof(header));
+		const uint32_t cnt = uint32_t(num_facets);
+		out.write(reinterpret_cast<const char*>(&cnt), sizeof(cnt));
+		for (size_t i = 0; i < num_facets; ++ i) {
+			const float x = float(i / 2);
+			const float facet[12] = { 0.f, 0.f, 1.f,
+				x, float(i % 2), 0.f, x + 1.f, 0.f, 0.f, x + float(i % 2), 1.f, 0.f };
+			out.write(reinterpret_cast<const char*>(facet), sizeof(facet));
+			const uint16_t attr = 0;
+			out.write(reinterpret_cast<const char*>(&attr), sizeof(attr));
+		}
+	}
+	const std::thread::id this_thread = std::this_thread::get_id();
+
+	SECTION("progress") {
+		std::vector<int> progress;
+		bool             other_thread = false;
+		indexed_triangle_set its;
+		REQUIRE(its_load_stl_streaming(path.c_str(), its, [&](int current, int total, bool &, std::string &, std::string &) {
+			other_thread |= std::this_thread::get_id() != this_thread;
+			progress.emplace_back(100 * current / total);
+		}));
+		CHECK(its.indices.size() == num_facets);
+		CHECK(! other_thread);
+		CHECK(! progress.empty());
+		CHECK(std::is_sorted(progress.begin(), progress.end()));
+	}
+	SECTION("cancel") {
+		int calls = 0;
+		indexed_triangle_set its;
+		REQUIRE(! its_load_stl_streaming(path.c_str(), its, [&](int, int, bool &cancel, std::string &, std::string &) {
+			++ calls;
+			cancel = true;
+		}));
+		CHECK(calls == 1);
+		CHECK(its.indices.empty());
+	}
+	boost::filesystem::remove(path);
+}
+
+TEST_CASE("Streaming OBJ import releases the mesh when falling back to ObjParser", "[stl]")
+{
+	const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("streaming-%%%%-%%%%.obj")).string();
+	{
+		// Vertex colors are detected by the second pass only, after the mesh was allocated.
+		boost::nowide::ofstream out(path);
+		out << "v 0 0 0\nv 1 0 0\nv 0 1 0 1 0 0\nf 1 2 3\n";
+	}
+	indexed_triangle_set its;
+	CHECK(its_load_obj_streaming(path.c_str(), its) == ObjStreamingResult::Unsupported);
+	CHECK(its.vertices.capacity() == 0);
+	CHECK(its.indices.capacity() == 0);
+	boost::filesystem::remove(path);
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/Trace.hpp"
+#include "test_utils.hpp"
+
+#include <boost/nowide/fstream.hpp>
+
+#include <sstream>
+#include <thread>
+
+using namespace Slic3r;
+
+TEST_CASE("Trace spans are recorded only when enabled", "[Trace]")
+{
+    Trace::enable(false);
+    { Trace::Span span("disabled", "test"); }
+    Trace::enable(true);
+    { Trace::Span span("enabled", "test", 3, 7); }
+    std::thread([]() { Trace::Span span("worker", "test", 4); }).join();
+    Trace::enable(false);
+
+    std::vector<Trace::Event> events = Trace::events();
+    REQUIRE(events.size() == 2);
+    const Trace::Event &main_event   = std::string(events[0].name) == "enabled" ? events[0] : events[1];
+    const Trace::Event &worker_event = std::string(events[0].name) == "enabled" ? events[1] : events[0];
+    REQUIRE(std::string(worker_event.name) == "worker");
+    REQUIRE(main_event.object_id == 3);
+    REQUIRE(main_event.layer_id == 7);
+    REQUIRE(worker_event.layer_id == -1);
+    REQUIRE(main_event.thread_id != worker_event.thread_id);
+    REQUIRE(main_event.duration_us >= 0);
+
+    // Re-enabling starts a new recording.
+    Trace::enable(true);
+    Trace::enable(false);
+    REQUIRE(Trace::events().empty());
+}
+
+TEST_CASE("Trace exports Chrome trace and summary", "[Trace]")
+{
+    Trace::enable(true);
+    for (int layer = 0; layer < 3; ++ layer)
+        Trace::Span span("make_perimeters", "Layer", 0, layer);
+    Trace::enable(false);
+
+    std::string summary = Trace::summary_table();
+    REQUIRE(summary.find("make_perimeters") != std::string::npos);
+    REQUIRE(summary.find(" 3 ") != std::string::npos);
+
+    ScopedTemporaryFile path(".json");
+    REQUIRE(Trace::export_chrome_trace(path.string()));
+    std::stringstream content;
+    {
+        boost::nowide::ifstream file(path.string());
+        content << file.rdbuf();
+    }
+    REQUIRE(content.str().find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(content.str().find("\"layer\":2") != std::string::npos);
+}
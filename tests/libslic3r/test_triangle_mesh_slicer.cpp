@@ -0,0 +1,83 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Geometry.hpp"
+
+#include "test_utils.hpp"
+
+using namespace Slic3r;
+
+// A stack of planes is sliced by the z-sweep with the batched facet classification,
+// a single plane by slicing each facet at the planes it spans.
+static std::vector<Polygons> slice_plane_by_plane(const indexed_triangle_set &its, const std::vector<float> &zs, const MeshSlicingParams &params)
+{
+    std::vector<Polygons> out;
+    out.reserve(zs.size());
+    for (float z : zs)
+        out.emplace_back(std::move(slice_mesh(its, std::vector<float>{ z }, params).front()));
+    return out;
+}
+
+static std::vector<float> slicing_planes(const indexed_triangle_set &its, float layer_height)
+{
+    const BoundingBoxf3 bb = TriangleMesh(its).bounding_box();
+    std::vector<float> zs;
+    for (float z = float(bb.min.z()) + 0.5f * layer_height; z < float(bb.max.z()); z += layer_height)
+        zs.emplace_back(z);
+    return zs;
+}
+
+static void check_same_slices(const std::vector<Polygons> &sweep, const std::vector<Polygons> &reference)
+{
+    REQUIRE(sweep.size() == reference.size());
+    for (size_t i = 0; i < sweep.size(); ++ i) {
+        double area_sweep = 0., area_reference = 0.;
+        for (const Polygon &p : sweep[i])
+            area_sweep += p.area();
+        for (const Polygon &p : reference[i])
+            area_reference += p.area();
+        CHECK(sweep[i].size() == reference[i].size());
+        CHECK(area_sweep == Catch::Approx(area_reference).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("Sweep slicing matches slicing plane by plane", "[TriangleMeshSlicer]")
+{
+    MeshSlicingParams params;
+    // The plane by plane path transforms the vertices the same way as the sweep only for a non-identity transformation.
+    params.trafo = Geometry::assemble_transform(Vec3d(1., 2., 0.), Vec3d(0.1, 0.2, 0.3));
+
+    SECTION("sphere, planes through the vertices") {
+        indexed_triangle_set its = its_make_sphere(10., 2. * PI / 64.);
+        std::vector<float> zs;
+        for (const stl_vertex &v : its.vertices)
+            zs.emplace_back(v.z());
+        sort_remove_duplicates(zs);
+        zs.erase(zs.begin());
+        zs.pop_back();
+        // Keep the vertices on the planes.
+        params.trafo = Geometry::assemble_transform(Vec3d(1., 2., 0.));
+        check_same_slices(slice_mesh(its, zs, params), slice_plane_by_plane(its, zs, params));
+    }
+
+    for (const char *name : { "frog_legs.obj", "extruder_idler.obj", "ipadstand.obj" }) {
+        SECTION(name) {
+            TriangleMesh mesh = load_model(name);
+            REQUIRE_FALSE(mesh.empty());
+            std::vector<float> zs = slicing_planes(mesh.its, 0.05f);
+            check_same_slices(slice_mesh(mesh.its, zs, params), slice_plane_by_plane(mesh.its, zs, params));
+        }
+    }
+}
+
+TEST_CASE("Benchmark sweep slicing against slicing plane by plane", "[TriangleMeshSlicer][.benchmark]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    REQUIRE_FALSE(mesh.empty());
+    std::vector<float> zs = slicing_planes(mesh.its, 0.05f);
+    MeshSlicingParams params;
+    params.trafo = Geometry::assemble_transform(Vec3d(1., 2., 0.));
+    BENCHMARK("sweep") { return slice_mesh(mesh.its, zs, params); };
+    BENCHMARK("plane by plane") { return slice_plane_by_plane(mesh.its, zs, params); };
+}